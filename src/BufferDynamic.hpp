@@ -28,6 +28,7 @@
 #include "mpi.hpp"
 #include "Particle.hpp"
 #include <vector>
+#include <cstring>
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 
@@ -72,6 +73,25 @@ namespace espressopp {
       pos      = 0;
     }
 
+    /** number of bytes write(Particle&, extradata, shift) produces */
+    static int particleDataSize(int extradata)
+    {
+      int size = sizeof(ParticlePosition);
+      if (extradata & DATA_PROPERTIES) size += sizeof(ParticleProperties);
+      if (extradata & DATA_MOMENTUM) size += sizeof(ParticleMomentum);
+      if (extradata & DATA_LOCAL) size += sizeof(ParticleLocal);
+      return size;
+    }
+
+    /** make room for size bytes beyond the current position, so that
+        the following writes of that many bytes do not reallocate */
+    void reserve(int size) { extend(pos + size); }
+
+    /** raw buffer, e.g. for persistent communication requests. The
+        address only changes when the buffer has to grow. */
+    char* getBuffer() { return buf; }
+    int getCapacity() const { return capacity; }
+
   protected:
 
     static LOG4ESPP_DECL_LOGGER(logger);
@@ -93,7 +113,7 @@ namespace espressopp {
        // fprintf(stderr, "realloc buffer from %d to capacity %d, used size = %d\n", capacity, size, usedSize);
        capacity = size;
        char* newBuf = new char[capacity];
-       for (int i = 0; i < usedSize; i++) newBuf[i] = buf[i];
+       if (usedSize > 0) std::memcpy(newBuf, buf, usedSize);
        dynBuf.reset(newBuf);
        buf = dynBuf.get();
     }
@@ -113,6 +133,16 @@ namespace espressopp {
     explicit InBuffer(const mpi::communicator &comm) : Buffer(comm) {
     }
 
+    /** prepare for reading a message of msgSize bytes that is received
+        directly into getBuffer() */
+    void prepare(int msgSize) {
+      if (msgSize > capacity) {
+        allocate(msgSize);
+      }
+      usedSize = msgSize;
+      pos      = 0;
+    }
+
     template <class T>
     void readAll(T& val) { 
       T* tbuf = (T*) (buf + pos); 
@@ -226,6 +256,19 @@ namespace espressopp {
       return req;
     }
 
+    // non-blocking receive of a message whose size is known in advance,
+    // unlike irecv(sender, tag) this does not wait for the message to arrive
+    mpi::request irecv(longint sender, int tag, int msgSize) {
+      if (msgSize > capacity) {
+        allocate(msgSize);
+      }
+
+      mpi::request req = comm.irecv(sender, tag, buf, msgSize);
+      usedSize = msgSize;
+      pos      = 0;   // reset the buffer position
+      return req;
+    }
+
   };
 
   class OutBuffer : public Buffer {
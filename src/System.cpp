@@ -30,6 +30,7 @@
 #include "esutil/Error.hpp"
 
 #include <limits>
+#include <stdexcept>
 
 #include <mpi4py/mpi4py.h>
 
@@ -47,6 +48,7 @@ namespace espressopp {
     CommunicatorIsInitialized = false;
     
     maxCutoff = 0.0;
+    numThreads = 1;
   }
 
   System::System(python::object _pyobj) {
@@ -71,6 +73,7 @@ namespace espressopp {
 
     comm = newcomm;
     maxCutoff = 0.0;
+    numThreads = 1;
   }
 
   void System::setSkin(real _skin){
@@ -92,6 +95,20 @@ namespace espressopp {
     return skin;
   }
 
+  void System::setNumThreads(int _numThreads){
+    if (_numThreads < 1) {
+      throw std::invalid_argument("numThreads has to be at least 1");
+    }
+#ifdef _OPENMP
+    numThreads = _numThreads;
+#else
+    if (_numThreads > 1 && comm->rank() == 0) {
+      std::cout << "Warning! ESPResSo++ was built without OpenMP, numThreads is ignored"
+                << std::endl;
+    }
+#endif
+  }
+
   void System::addInteraction(shared_ptr< interaction::Interaction > ia){
     shortRangeInteractions.push_back(ia);
     
@@ -196,6 +213,7 @@ namespace espressopp {
 
     class_< System > ("System", init<>())
       .add_property("skin", &System::getSkin, &System::setSkin)
+      .add_property("numThreads", &System::getNumThreads, &System::setNumThreads)
     
       .def(init< python::object >())
       .def_readwrite("storage", &System::storage)
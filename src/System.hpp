@@ -55,6 +55,7 @@ namespace espressopp {
     interaction::InteractionList shortRangeInteractions;
 
     real maxCutoff;     // maximal cutoff over all of the interactions
+    int numThreads;     // threads per rank of the threaded force loops
 
     bool CommunicatorIsInitialized;
 
@@ -64,6 +65,11 @@ namespace espressopp {
     
     void setSkin(real);
     real getSkin();
+
+    /** Number of threads used by the threaded force loops on each
+        rank, 1 by default. Has no effect unless built WITH_OPENMP. */
+    void setNumThreads(int);
+    int getNumThreads() const { return numThreads; }
     
     void scaleVolume(real s, bool particleCoordinates);
     void scaleVolume(Real3D s, bool particleCoordinates);
@@ -40,6 +40,9 @@ class.
 * the boundary conditions `bc` for the system (e.g. OrthorhombicBC)
 * a random number generator `rng` which is for example used by a thermostat
 * the `skin` which is needed for the Verlet lists and the cell grid
+* `numThreads`, the number of threads each MPI rank uses for the threaded
+  force loops (only effective when built with ``-DWITH_OPENMP=ON``, default
+  is 1 so that several ranks on one node do not oversubscribe its cores)
 * a list of short range interactions that apply to the system these
   interactions are added with the `addInteraction()` method of the System
 
@@ -49,6 +52,7 @@ Example (not complete):
 >>> LJSystem.bc   = espressopp.bc.OrthorhombicBC(rng, boxsize)
 >>> LJSystem.rng
 >>> LJSystem.skin = 0.4
+>>> LJSystem.numThreads = 4
 >>> LJSystem.addInteraction(interLJ)
 
 
@@ -231,7 +235,7 @@ if pmi.isController:
     __metaclass__ = pmi.Proxy
     pmiproxydefs = dict(
       cls = 'espressopp.SystemLocal',
-      pmiproperty = ['storage', 'bc', 'rng', 'skin', 'maxCutoff', 'integrator'],
+      pmiproperty = ['storage', 'bc', 'rng', 'skin', 'maxCutoff', 'integrator', 'numThreads'],
       pmicall = ['addInteraction','removeInteraction', 'removeInteractionByName',
             'getInteraction', 'getNumberOfInteractions','scaleVolume', 'setTrace',
             'getAllInteractions', 'getInteractionByName', 'getNameOfInteraction']
@@ -23,6 +23,7 @@
 */
 
 #include "python.hpp"
+#include <algorithm>
 #include "VerletList.hpp"
 #include "Real3D.hpp"
 #include "Particle.hpp"
@@ -208,6 +209,10 @@ void DynamicExcludeList::registerPython() {
     cutVerlet = cut + system -> getSkin();
     cutsq = cutVerlet * cutVerlet;
     builds = 0;
+    compact = false;
+    subCellBuild = false;
+    nInteriorPairs = -1;
+    exclusionsDirty = true;
 
     exList = boost::make_shared<ExcludeList>();
     isDynamicExList = false;
@@ -231,12 +236,16 @@ void DynamicExcludeList::registerPython() {
     cutVerlet = cut + system -> getSkin();
     cutsq = cutVerlet * cutVerlet;
     builds = 0;
+    compact = false;
+    subCellBuild = false;
+    nInteriorPairs = -1;
+    exclusionsDirty = true;
 
     exList = dynamicExList_->getExList();
 
     isDynamicExList = true;
 
-    dynamicExList_->onListUpdated.connect(boost::bind(&VerletList::rebuild, this));
+    dynamicExList_->onListUpdated.connect(boost::bind(&VerletList::onExclusionsUpdated, this));
 
     // proxy signals from DynamicExclude list to signals of VerletList.
     dynamicExcludeList->onPairExclude.connect(onPairExclude);
@@ -282,6 +291,22 @@ void DynamicExcludeList::registerPython() {
     cutsq = cutVerlet * cutVerlet;
     
     vlPairs.clear();
+    neighborList.clear();
+    nInteriorPairs = -1;
+
+    if (compact || subCellBuild) {
+      if (exclusionsDirty) updateExclusionArrays();
+      if (subCellBuild) {
+        rebuildSubCells();
+      } else {
+        rebuildCompact();
+      }
+      builds++;
+      LOG4ESPP_DEBUG(theLogger, "rebuilt compact VerletList (count=" << builds << "), cutsq = " << cutsq
+                   << " local size = " << neighborList.size());
+      timeRebuild_ += wallTimer.getElapsedTime() - time0;
+      return;
+    }
 
     // add particles to adress zone
     CellList cl = getSystem()->storage->getRealCells();
@@ -319,7 +344,324 @@ void DynamicExcludeList::registerPython() {
 
     vlPairs.add(pt1, pt2); // add pair to Verlet List
   }
+
+  inline void VerletList::checkPairCompact(Particle& pt1, Particle& pt2, int index2,
+                                           const longint *exBegin, const longint *exEnd)
+  {
+    Real3D d = pt1.position() - pt2.position();
+    if (d.sqr() > cutsq) return;
+    if (exBegin != exEnd && std::binary_search(exBegin, exEnd, pt2.id())) return;
+    neighborList.neighbors.push_back(index2);
+  }
   
+  /*-------------------------------------------------------------*/
+
+  void VerletList::rebuildCompact()
+  {
+    storage::Storage &storage = *getSystem()->storage;
+    CellList &localCells = storage.getLocalCells();
+    const Cell *firstCell = storage.getFirstCell();
+
+    // number the particles cell after cell
+    std::vector<int> cellOffset(localCells.size());
+    std::vector<bool> isReal(localCells.size(), false);
+    int n = 0;
+    for (size_t c = 0; c < localCells.size(); ++c) {
+      cellOffset[c] = n;
+      n += localCells[c]->particles.size();
+    }
+    CellList &realCells = storage.getRealCells();
+    for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+      isReal[*it - firstCell] = true;
+    }
+
+    neighborList.particles.resize(n);
+    neighborList.start.resize(n + 1);
+
+    int i = 0;
+    for (size_t c = 0; c < localCells.size(); ++c) {
+      ParticleList &pl = localCells[c]->particles;
+      for (size_t k = 0; k < pl.size(); ++k, ++i) {
+        Particle &pt1 = pl[k];
+        neighborList.particles[i] = &pt1;
+        neighborList.start[i] = neighborList.neighbors.size();
+        if (!isReal[c]) continue;
+
+        const longint *exBegin, *exEnd;
+        getExclusions(pt1.id(), exBegin, exEnd);
+
+        // same order of candidates as the CellListAllPairsIterator
+        for (size_t l = k + 1; l < pl.size(); ++l) {
+          checkPairCompact(pt1, pl[l], cellOffset[c] + l, exBegin, exEnd);
+        }
+        for (NeighborCellList::Iterator nit(localCells[c]->neighborCells); nit.isValid(); ++nit) {
+          if (nit->useForAllPairs) continue;
+          ParticleList &npl = nit->cell->particles;
+          int offset = cellOffset[nit->cell - firstCell];
+          for (size_t l = 0; l < npl.size(); ++l) {
+            checkPairCompact(pt1, npl[l], offset + l, exBegin, exEnd);
+          }
+        }
+      }
+    }
+    neighborList.start[n] = neighborList.neighbors.size();
+  }
+
+  /*-------------------------------------------------------------*/
+
+  void VerletList::rebuildSubCells()
+  {
+    storage::Storage &storage = *getSystem()->storage;
+    CellList &localCells = storage.getLocalCells();
+    const Cell *firstCell = storage.getFirstCell();
+
+    std::vector<bool> isRealCell(localCells.size(), false);
+    CellList &realCells = storage.getRealCells();
+    for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+      isRealCell[*it - firstCell] = true;
+    }
+
+    // ghost cells whose particles pair with the reals of a cell: only the
+    // half shell of neighbor cells, as in the cell based build, so that a
+    // pair across a node or periodic boundary is listed on one side only
+    std::vector<std::vector<int> > ghostPartners(localCells.size());
+    for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+      std::vector<int> &partners = ghostPartners[*it - firstCell];
+      for (NeighborCellList::Iterator nit((*it)->neighborCells); nit.isValid(); ++nit) {
+        int c = nit->cell - firstCell;
+        if (!nit->useForAllPairs && !isRealCell[c]) partners.push_back(c);
+      }
+    }
+
+    // number the particles cell after cell, as in the NeighborList
+    std::vector<Particle*> particles;
+    std::vector<char> isGhost;
+    std::vector<int> cellOf;
+    for (size_t c = 0; c < localCells.size(); ++c) {
+      ParticleList &pl = localCells[c]->particles;
+      for (size_t k = 0; k < pl.size(); ++k) {
+        particles.push_back(&pl[k]);
+        isGhost.push_back(!isRealCell[c]);
+        cellOf.push_back(c);
+      }
+    }
+    const int n = particles.size();
+
+    if (compact) {
+      neighborList.start.resize(n + 1);
+    }
+    if (n == 0) {
+      if (compact) neighborList.start[0] = 0;
+      return;
+    }
+
+    // sub-cell grid over the bounding box of the real and ghost particles,
+    // the sub-cells are at least half the Verlet cutoff wide
+    Real3D lo = particles[0]->position();
+    Real3D hi = lo;
+    for (int i = 1; i < n; ++i) {
+      const Real3D &pos = particles[i]->position();
+      for (int d = 0; d < 3; ++d) {
+        if (pos[d] < lo[d]) lo[d] = pos[d];
+        if (pos[d] > hi[d]) hi[d] = pos[d];
+      }
+    }
+    int nsub[3];
+    for (int d = 0; d < 3; ++d) {
+      nsub[d] = std::max(1, int((hi[d] - lo[d]) / (0.5 * cutVerlet)));
+    }
+    // do not use (many) more sub-cells than particles
+    while (longint(nsub[0]) * nsub[1] * nsub[2] > 4 * n + 64) {
+      int d = std::max_element(nsub, nsub + 3) - nsub;
+      nsub[d] = (nsub[d] + 1) / 2;
+    }
+    real len[3], invLen[3];
+    int range[3];
+    for (int d = 0; d < 3; ++d) {
+      real extent = hi[d] - lo[d];
+      len[d] = extent / nsub[d];
+      invLen[d] = extent > 0.0 ? nsub[d] / extent : 0.0;
+      range[d] = len[d] > 0.0 ? std::min(nsub[d] - 1, int(ceil(cutVerlet / len[d]))) : 0;
+    }
+    const int nSubCells = nsub[0] * nsub[1] * nsub[2];
+
+    // counting sort by sub-cell, reals before ghosts within each sub-cell;
+    // subStart[2*s] are the reals of sub-cell s, subStart[2*s+1] its ghosts
+    std::vector<int> subCell(n);
+    std::vector<int> subStart(2 * nSubCells + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      const Real3D &pos = particles[i]->position();
+      int s[3];
+      for (int d = 0; d < 3; ++d) {
+        s[d] = std::min(nsub[d] - 1, int((pos[d] - lo[d]) * invLen[d]));
+      }
+      subCell[i] = (s[2] * nsub[1] + s[1]) * nsub[0] + s[0];
+      ++subStart[2 * subCell[i] + isGhost[i] + 1];
+    }
+    for (int k = 0; k < 2 * nSubCells; ++k) {
+      subStart[k + 1] += subStart[k];
+    }
+    std::vector<int> sorted(n), sortedPos(n);
+    std::vector<real> px(n), py(n), pz(n);
+    {
+      std::vector<int> fill(subStart.begin(), subStart.end() - 1);
+      for (int i = 0; i < n; ++i) {
+        int a = fill[2 * subCell[i] + isGhost[i]]++;
+        const Real3D &pos = particles[i]->position();
+        sorted[a] = i;
+        sortedPos[i] = a;
+        px[a] = pos[0]; py[a] = pos[1]; pz[a] = pos[2];
+      }
+    }
+
+    // stencil of the sub-cells that can hold particles within the cutoff,
+    // split into the upper half (all particles) and lower half (ghosts only);
+    // the ghosts are filtered by their cell with ghostPartners
+    std::vector<int> stencil[3];
+    std::vector<bool> upperHalf;
+    for (int oz = -range[2]; oz <= range[2]; ++oz) {
+      for (int oy = -range[1]; oy <= range[1]; ++oy) {
+        for (int ox = -range[0]; ox <= range[0]; ++ox) {
+          if (ox == 0 && oy == 0 && oz == 0) continue;
+          real gx = std::max(std::abs(ox) - 1, 0) * len[0];
+          real gy = std::max(std::abs(oy) - 1, 0) * len[1];
+          real gz = std::max(std::abs(oz) - 1, 0) * len[2];
+          if (gx * gx + gy * gy + gz * gz > cutsq) continue;
+          stencil[0].push_back(ox);
+          stencil[1].push_back(oy);
+          stencil[2].push_back(oz);
+          upperHalf.push_back(oz > 0 || (oz == 0 && (oy > 0 || (oy == 0 && ox > 0))));
+        }
+      }
+    }
+
+    for (int i = 0; i < n; ++i) {
+      if (compact) neighborList.start[i] = neighborList.neighbors.size();
+      if (isGhost[i]) continue;
+
+      Particle &pt1 = *particles[i];
+      const longint *exBegin, *exEnd;
+      getExclusions(pt1.id(), exBegin, exEnd);
+
+      const std::vector<int> &partners = ghostPartners[cellOf[i]];
+      const int a = sortedPos[i];
+      const real x = px[a], y = py[a], z = pz[a];
+      const int s = subCell[i];
+      const int sx = s % nsub[0];
+      const int sy = (s / nsub[0]) % nsub[1];
+      const int sz = s / (nsub[0] * nsub[1]);
+
+      for (int o = -1; o < int(upperHalf.size()); ++o) {
+        int b, bEnd;
+        if (o < 0) {
+          // own sub-cell: the reals after i and all ghosts
+          b = a + 1;
+          bEnd = subStart[2 * s + 2];
+        } else {
+          int tx = sx + stencil[0][o];
+          int ty = sy + stencil[1][o];
+          int tz = sz + stencil[2][o];
+          if (tx < 0 || tx >= nsub[0] || ty < 0 || ty >= nsub[1] || tz < 0 || tz >= nsub[2]) continue;
+          int t = (tz * nsub[1] + ty) * nsub[0] + tx;
+          b = upperHalf[o] ? subStart[2 * t] : subStart[2 * t + 1];
+          bEnd = subStart[2 * t + 2];
+        }
+        for (; b < bEnd; ++b) {
+          real dx = x - px[b];
+          real dy = y - py[b];
+          real dz = z - pz[b];
+          if (dx * dx + dy * dy + dz * dz > cutsq) continue;
+          int j = sorted[b];
+          if (isGhost[j] &&
+              std::find(partners.begin(), partners.end(), cellOf[j]) == partners.end()) continue;
+          Particle &pt2 = *particles[j];
+          if (exBegin != exEnd && std::binary_search(exBegin, exEnd, pt2.id())) continue;
+          if (compact) {
+            neighborList.neighbors.push_back(j);
+          } else {
+            vlPairs.add(pt1, pt2);
+          }
+        }
+      }
+    }
+
+    if (compact) {
+      neighborList.start[n] = neighborList.neighbors.size();
+      neighborList.particles.swap(particles);
+    }
+  }
+
+  /*-------------------------------------------------------------*/
+
+  void VerletList::updateExclusionArrays()
+  {
+    std::vector<std::pair<longint, longint> > pairs(exList->begin(), exList->end());
+    std::sort(pairs.begin(), pairs.end());
+
+    exclusionRange.clear();
+    exclusionPartners.resize(pairs.size());
+    for (size_t k = 0; k < pairs.size(); ++k) {
+      exclusionPartners[k] = pairs[k].second;
+      if (k == 0 || pairs[k].first != pairs[k-1].first) {
+        exclusionRange[pairs[k].first] = std::make_pair(int(k), int(k));
+      }
+      exclusionRange[pairs[k].first].second = k + 1;
+    }
+    exclusionsDirty = false;
+  }
+
+  void VerletList::getExclusions(longint pid, const longint *&begin, const longint *&end) const
+  {
+    boost::unordered_map<longint, std::pair<int, int> >::const_iterator it = exclusionRange.find(pid);
+    if (it == exclusionRange.end()) {
+      begin = end = 0;
+    } else {
+      begin = &exclusionPartners[0] + it->second.first;
+      end = &exclusionPartners[0] + it->second.second;
+    }
+  }
+
+  void VerletList::onExclusionsUpdated()
+  {
+    exclusionsDirty = true;
+    rebuild();
+  }
+
+  /*-------------------------------------------------------------*/
+
+  // moves pairs without ghost to the front
+  struct IsInteriorPair {
+    bool operator()(const ParticlePair &pair) const {
+      return !pair.first->ghost() && !pair.second->ghost();
+    }
+  };
+
+  long VerletList::partitionInteriorPairs()
+  {
+    PairList &pairs = getPairs();
+    if (nInteriorPairs < 0) {
+      nInteriorPairs = std::partition(pairs.begin(), pairs.end(), IsInteriorPair()) - pairs.begin();
+      LOG4ESPP_DEBUG(theLogger, nInteriorPairs << " of " << pairs.size() << " pairs need no ghosts");
+    }
+    return nInteriorPairs;
+  }
+
+  /*-------------------------------------------------------------*/
+
+  void VerletList::setCompact(bool _compact)
+  {
+    if (compact == _compact) return;
+    compact = _compact;
+    rebuild();
+  }
+
+  void VerletList::setSubCellBuild(bool _subCellBuild)
+  {
+    if (subCellBuild == _subCellBuild) return;
+    subCellBuild = _subCellBuild;
+    rebuild();
+  }
+
   /*-------------------------------------------------------------*/
   
   int VerletList::totalSize() const
@@ -335,13 +677,20 @@ void DynamicExcludeList::registerPython() {
   int VerletList::localSize() const
   {
     System& system = getSystemRef();
-    return vlPairs.size();
+    return compact ? neighborList.size() : vlPairs.size();
   }
 
   python::tuple VerletList::getPair(int i) {
-	  if (i <= 0 || i > vlPairs.size()) {
+	  if (i <= 0 || i > localSize()) {
 	    std::cout << "ERROR VerletList pair " << i << " does not exists" << std::endl;
 	    return python::make_tuple();
+	  } else if (compact) {
+	    // row of the (i-1)-th neighbor entry
+	    std::vector<int>::const_iterator row = std::upper_bound(
+	      neighborList.start.begin(), neighborList.start.end(), i-1);
+	    int p1 = row - neighborList.start.begin() - 1;
+	    int p2 = neighborList.neighbors[i-1];
+	    return python::make_tuple(neighborList.particles[p1]->id(), neighborList.particles[p2]->id());
 	  } else {
 	    return python::make_tuple(vlPairs[i-1].first->id(), vlPairs[i-1].second->id());
 	  }
@@ -354,6 +703,7 @@ void DynamicExcludeList::registerPython() {
       } else {
         exList->insert(std::make_pair(pid1, pid2));
         exList->insert(std::make_pair(pid2, pid1));
+        exclusionsDirty = true;
         onPairExclude(pid1, pid2);
       }
       return true;
@@ -365,6 +715,7 @@ void DynamicExcludeList::registerPython() {
     } else {
       exList->erase(std::make_pair(pid1, pid2));
       exList->erase(std::make_pair(pid2, pid1));
+      exclusionsDirty = true;
       onPairUnexclude(pid1, pid2);
     }
   }
@@ -372,6 +723,19 @@ void DynamicExcludeList::registerPython() {
   longint VerletList::excludeListSize() const {
     return exList->size();
   }
+
+  std::vector<longint> VerletList::getExcludeList() const {
+    const ExcludeList &ex = isDynamicExList ? *dynamicExcludeList->getExList() : *exList;
+    std::vector<longint> ret;
+    for (ExcludeList::const_iterator it = ex.begin(); it != ex.end(); ++it) {
+      // every pair is stored in both orders
+      if (it->first < it->second) {
+        ret.push_back(it->first);
+        ret.push_back(it->second);
+      }
+    }
+    return ret;
+  }
   
 
   /*-------------------------------------------------------------*/
@@ -401,6 +765,8 @@ void DynamicExcludeList::registerPython() {
       .def(init<shared_ptr<System>, real, shared_ptr<DynamicExcludeList>, bool>())
       .add_property("system", &SystemAccess::getSystem)
       .add_property("builds", &VerletList::getBuilds, &VerletList::setBuilds)
+      .add_property("compact", &VerletList::isCompact, &VerletList::setCompact)
+      .add_property("subCellBuild", &VerletList::getSubCellBuild, &VerletList::setSubCellBuild)
       .def("totalSize", &VerletList::totalSize)
       .def("localSize", &VerletList::localSize)
       .def("getPair", &VerletList::getPair)
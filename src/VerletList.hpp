@@ -34,6 +34,7 @@
 #include "integrator/MDIntegrator.hpp"
 #include "boost/signals2.hpp"
 #include "boost/unordered_set.hpp"
+#include "boost/unordered_map.hpp"
 #include "FixedPairList.hpp"
 #include "FixedTripleList.hpp"
 #include "FixedQuadrupleList.hpp"
@@ -83,6 +84,31 @@ class DynamicExcludeList {
 
 };
 
+  /** Compact half neighbor list in compressed sparse row layout.
+
+      The local particles are addressed by 32-bit indices, numbered cell
+      after cell in the order of Storage::getLocalCells(). The neighbors of particle i
+      are neighbors[start[i]] ... neighbors[start[i+1]-1], every pair is
+      stored only once. Ghost particles have empty rows.
+  */
+  struct NeighborList {
+    /// local index -> particle
+    std::vector<Particle*> particles;
+    /// row offsets into neighbors, numParticles()+1 entries
+    std::vector<int> start;
+    /// local indices of the neighbors
+    std::vector<int> neighbors;
+
+    size_t numParticles() const { return particles.size(); }
+    size_t size() const { return neighbors.size(); }
+
+    void clear() {
+      particles.clear();
+      start.clear();
+      neighbors.clear();
+    }
+  };
+
   class VerletList : public SystemAccess {
 
   public:
@@ -100,10 +126,87 @@ class DynamicExcludeList {
 
     ~VerletList();
 
+    /** The pair list, only filled if the list is not compact. Loops
+        that do not need the pair index should use PairIterator, which
+        walks either layout. */
     PairList& getPairs() {
       return vlPairs;
     }
 
+    /** Iterates the pairs of either layout without expanding a compact
+        list into a pair list:
+
+        for (VerletList::PairIterator it(*vl); it.isValid(); ++it) {
+          Particle &p1 = *it->first; ...
+        }
+    */
+    class PairIterator {
+    public:
+      PairIterator(VerletList &vl)
+        : compact(vl.isCompact()), nl(vl.neighborList), i(0), n(0), k(0) {
+        if (compact) {
+          n = nl.numParticles();
+          findRow();
+        } else {
+          cur = vl.vlPairs.empty() ? 0 : &vl.vlPairs[0];
+          end = cur + vl.vlPairs.size();
+        }
+      }
+
+      PairIterator &operator++() {
+        if (compact) {
+          ++k;
+          findRow();
+        } else {
+          ++cur;
+        }
+        return *this;
+      }
+
+      bool isValid() const { return compact ? i < n : cur != end; }
+
+      const ParticlePair &operator*() const { return compact ? pair : *cur; }
+      const ParticlePair *operator->() const { return &**this; }
+
+    private:
+      // move to the row of neighbor entry k, skipping empty rows
+      void findRow() {
+        while (i < n && k >= nl.start[i+1]) ++i;
+        if (i < n) pair = ParticlePair(nl.particles[i], nl.particles[nl.neighbors[k]]);
+      }
+
+      bool compact;
+      const NeighborList &nl;
+      long i, n;
+      int k;
+      ParticlePair pair;
+      const ParticlePair *cur, *end;
+    };
+
+    /** Reorder the pair list so that the pairs of two real particles
+        come first and return their number. These pairs need no ghost
+        data, which allows computing them while the ghost communication
+        is in flight. The order is kept until the next rebuild. Only
+        for the pair list layout, compact rows are split by the caller. */
+    long partitionInteriorPairs();
+
+    /** The compact neighbor list, only filled if isCompact() */
+    NeighborList& getNeighborList() {
+      return neighborList;
+    }
+
+    /** If set, rebuild() fills the compact neighbor list instead of the
+        pair list. Consumers either check isCompact() (e.g.
+        VerletListInteractionTemplate) or loop with PairIterator. */
+    void setCompact(bool _compact);
+    bool isCompact() const { return compact; }
+
+    /** If set, rebuild() bins the particles into sub-cells of at least
+        half the Verlet cutoff and only visits the sub-cells within the
+        cutoff, instead of walking all pairs of neighboring cells. */
+    void setSubCellBuild(bool _subCellBuild);
+    bool getSubCellBuild() const { return subCellBuild; }
+
     python::tuple getPair(int i);
     
     real getVerletCutoff(); // returns cutoff + skin
@@ -130,6 +233,9 @@ class DynamicExcludeList {
 
     longint excludeListSize() const;
 
+    /** The excluded pairs as flat (pid1, pid2) list with pid1 < pid2 */
+    std::vector<longint> getExcludeList() const;
+
     /** Get the number of times the Verlet list has been rebuilt */
     int getBuilds() const { return builds; }
 
@@ -145,7 +251,27 @@ class DynamicExcludeList {
   protected:
 
     void checkPair(Particle &pt1, Particle &pt2);
+    void checkPairCompact(Particle &pt1, Particle &pt2, int index2,
+                          const longint *exBegin, const longint *exEnd);
+    void rebuildCompact();
+    void rebuildSubCells();
     PairList vlPairs;
+    NeighborList neighborList;
+    bool compact;
+    bool subCellBuild;
+    long nInteriorPairs;  //!< -1 if the pairs are not partitioned
+
+    /** The exclusions as sorted per-particle arrays: the partners of
+        particle pid are exclusionPartners[r.first ... r.second-1] with
+        r = exclusionRange[pid]. Rebuilt from exList when it changed, so
+        that the build loops do one hash lookup per particle instead of
+        one per pair. */
+    boost::unordered_map<longint, std::pair<int, int> > exclusionRange;
+    std::vector<longint> exclusionPartners;
+    bool exclusionsDirty;
+    void updateExclusionArrays();
+    void getExclusions(longint pid, const longint *&begin, const longint *&end) const;
+    void onExclusionsUpdated();
     shared_ptr<ExcludeList> exList; // exclusion list
     shared_ptr<DynamicExcludeList> dynamicExcludeList;
     bool isDynamicExList;
@@ -45,6 +45,23 @@ espressopp.VerletList
 
 		:rtype: returns a list of all pairs
 
+.. attribute:: espressopp.VerletList.compact
+
+		If True, the list is stored as a compact half neighbor list
+		(one row of 32-bit local indices per particle) instead of a
+		list of particle pointer pairs. This halves the memory of
+		the list and lets the force loop keep the force on particle
+		i in registers. All consumers walk the compact rows
+		directly, the pairs are never expanded. (default: False)
+
+.. attribute:: espressopp.VerletList.subCellBuild
+
+		If True, the list is rebuilt by binning the particles into
+		sub-cells of at least half the Verlet cutoff and only visiting
+		the sub-cells within the cutoff. Exclusions are checked against
+		sorted per-particle arrays. This saves most of the distance
+		checks of the default cell pair walk. (default: False)
+
 .. function:: espressopp.VerletList.localSize()
 
 		:rtype: returns local number of pairs
@@ -219,7 +236,7 @@ if pmi.isController:
     __metaclass__ = pmi.Proxy
     pmiproxydefs = dict(
       cls = 'espressopp.VerletListLocal',
-      pmiproperty = [ 'builds' ],
+      pmiproperty = [ 'builds', 'compact', 'subCellBuild' ],
       pmicall = [ 'totalSize', 'exclude', 'connect', 'disconnect', 'getVerletCutoff', 'setVerletCutoff' ],
       pmiinvoke = [ 'getAllPairs', 'get_timers', 'excludeListSize' ]
     )
@@ -28,7 +28,6 @@
 #include "System.hpp"
 #include "storage/Storage.hpp"
 #include "bc/BC.hpp"
-#include "iterator/CellListAllPairsIterator.hpp"
 #include "iterator/CellListIterator.hpp"
 
 namespace espressopp {
@@ -75,75 +74,119 @@ namespace espressopp {
     void VerletListAdress::rebuild()
     {
       vlPairs.clear();
+      vlPairIdx.clear();
       adrZone.clear(); // particles in adress zone
       cgZone.clear(); // particles in CG zone
+      adrZoneIdx.clear();
+      cgZoneIdx.clear();
       adrPairs.clear(); // pairs in adress zone
+      adrPairIdx.clear();
+      atParticles.clear();
       const bc::BC& bc = *getSystemRef().bc;
 
       // get local cells
-      CellList localcells = getSystem()->storage->getLocalCells();
-
-      // if adrCenter is not set, the center of adress zone moves along with some particles
-      if (!adrCenterSet) {
-          // loop over all VP particles (reals and ghosts) on node
-          for (CellListIterator it(localcells); it.isValid(); ++it) {
-
-                // loop over positions
-                for (std::vector<Real3D*>::iterator it2 = adrPositions.begin(); it2 != adrPositions.end(); ++it2){
-                    Real3D dist;
-                    real distsq;
-                    bc.getMinimumImageVectorBox(dist, it->getPos(), **it2);
-
-                    if (getAdrRegionType()){ // spherical adress region
-                       distsq=dist.sqr();
-                    }
-                    else {  // slab-type adress region
-                       distsq=dist[0]*dist[0];
-                    }
-                    if (distsq <= adrsq) {
-                        adrZone.insert(&(*it));
-                        break; // do not need to loop further
-                    }
-                }
-                // if not near enough to any adrPositions, put in cgZone
-                if (adrZone.count(&(*it)) == 0) {
-                    cgZone.insert(&(*it));
-                }
-          }
+      storage::Storage &storage = *getSystem()->storage;
+      CellList &localcells = storage.getLocalCells();
+      const Cell *firstCell = storage.getFirstCell();
+      shared_ptr<FixedTupleListAdress> fixedtupleList = storage.getFixedTuples();
+
+      // number the VPs (reals and ghosts) cell after cell
+      cellOffset.resize(localcells.size());
+      int n = 0;
+      for (size_t c = 0; c < localcells.size(); ++c) {
+        cellOffset[localcells[c] - firstCell] = n;
+        n += localcells[c]->particles.size();
       }
-      // center of adress zone is fixed
-      else {
-          for (CellListIterator it(localcells); it.isValid(); ++it) {
+      zoneFlags.assign(n, 0);
+      atStart.resize(n + 1);
+
+      int i = 0;
+      for (size_t c = 0; c < localcells.size(); ++c) {
+        ParticleList &pl = localcells[c]->particles;
+        for (size_t k = 0; k < pl.size(); ++k, ++i) {
+          Particle &pt = pl[k];
+          bool inAdrZone = false;
+
+          // if adrCenter is not set, the center of adress zone moves along with some particles
+          if (!adrCenterSet) {
+              // loop over positions
+              for (std::vector<Real3D*>::iterator it2 = adrPositions.begin(); it2 != adrPositions.end(); ++it2){
+                  Real3D dist;
+                  real distsq;
+                  bc.getMinimumImageVectorBox(dist, pt.getPos(), **it2);
+
+                  if (getAdrRegionType()){ // spherical adress region
+                     distsq=dist.sqr();
+                  }
+                  else {  // slab-type adress region
+                     distsq=dist[0]*dist[0];
+                  }
+                  if (distsq <= adrsq) {
+                      inAdrZone = true;
+                      break; // do not need to loop further
+                  }
+              }
+          }
+          // center of adress zone is fixed
+          else {
               Real3D dist;
               real distsq;
-              bc.getMinimumImageVectorBox(dist, it->getPos(), adrCenter);
-              //Real3D dist = it->getPos() - adrCenter;                                   					        // CHANGE FOR X SPLIT VS SPHERE
-              //real dist = it->getPos()[0] - adrCenter[0];                                  					        // CHANGE FOR X SPLIT VS SPHERE
-              //real distsq = dist.sqr();                                                                                                 // CHANGE FOR X SPLIT VS SPHERE
-              //real distsq = dist*dist;                                                                                                // CHANGE FOR X SPLIT VS SPHERE
+              bc.getMinimumImageVectorBox(dist, pt.getPos(), adrCenter);
               if (getAdrRegionType()){ // spherical adress region
                 distsq=dist.sqr();
               }
               else {  // slab-type adress region
                 distsq=dist[0]*dist[0];
               }
-              if (distsq <= adrsq) {
-                  adrZone.insert(&(*it));
-              }
-              else {
-                  cgZone.insert(&(*it));
-              }
+              inAdrZone = (distsq <= adrsq);
           }
 
-      }
-
-      // add particles to adress pairs and VL
-      CellList cl = getSystem()->storage->getRealCells();
-      int count=0;
+          if (inAdrZone) {
+              zoneFlags[i] |= ADR_ZONE;
+              adrZone.push_back(&pt);
+              adrZoneIdx.push_back(i);
+          }
+          else {
+              cgZone.push_back(&pt);
+              cgZoneIdx.push_back(i);
+          }
 
-      for (CellListAllPairsIterator it(cl); it.isValid(); ++it) {
-        checkPair(*it->first, *it->second);
-        count+=1;
+          // copy the AT particles of the VP, so that the interactions do
+          // not need to look up the tuples on every step
+          atStart[i] = atParticles.size();
+          if (fixedtupleList) {
+              FixedTupleListAdress::iterator it3 = fixedtupleList->find(&pt);
+              if (it3 != fixedtupleList->end()) {
+                  atParticles.insert(atParticles.end(), it3->second.begin(), it3->second.end());
+                  zoneFlags[i] |= HAS_AT;
+              }
+          }
+        }
+      }
+      atStart[n] = atParticles.size();
+
+      // add particles to adress pairs and VL, same pair order as the
+      // CellListAllPairsIterator
+      CellList &realcells = storage.getRealCells();
+      for (CellList::Iterator cit(realcells); cit.isValid(); ++cit) {
+        ParticleList &pl = (*cit)->particles;
+        int offset = cellOffset[*cit - firstCell];
+
+        for (size_t k = 0; k < pl.size(); ++k) {
+          for (size_t l = k + 1; l < pl.size(); ++l) {
+            checkPair(pl[k], pl[l], offset + k, offset + l);
+          }
+        }
+        for (NeighborCellList::Iterator nit((*cit)->neighborCells); nit.isValid(); ++nit) {
+          if (nit->useForAllPairs) continue;
+          ParticleList &npl = nit->cell->particles;
+          int noffset = cellOffset[nit->cell - firstCell];
+          for (size_t k = 0; k < pl.size(); ++k) {
+            for (size_t l = 0; l < npl.size(); ++l) {
+              checkPair(pl[k], npl[l], offset + k, noffset + l);
+            }
+          }
+        }
       }
 
       LOG4ESPP_INFO(theLogger, "rebuilt VerletList, cutsq = " << cutsq
@@ -153,7 +196,7 @@ namespace espressopp {
 
     /*-------------------------------------------------------------*/
 
-    void VerletListAdress::checkPair(Particle& pt1, Particle& pt2)
+    void VerletListAdress::checkPair(Particle& pt1, Particle& pt2, int index1, int index2)
     {
 
       Real3D d = pt1.position() - pt2.position();
@@ -168,13 +211,17 @@ namespace espressopp {
       if (exList.count(std::make_pair(pt1.id(), pt2.id())) == 1) return;
       if (exList.count(std::make_pair(pt2.id(), pt1.id())) == 1) return;
       // see if it's in the adress zone
-      if (adrZone.count(&pt1) == 1 || adrZone.count(&pt2) == 1) {
+      if ((zoneFlags[index1] | zoneFlags[index2]) & ADR_ZONE) {
           if (distsq > adrcutsq) return;
           adrPairs.add(pt1, pt2); // add to adress pairs
+          adrPairIdx.push_back(index1);
+          adrPairIdx.push_back(index2);
       }
       else {
           if (distsq > cutsq) return;
           vlPairs.add(pt1, pt2); // add pair to Verlet List
+          vlPairIdx.push_back(index1);
+          vlPairIdx.push_back(index2);
       }
     }
 
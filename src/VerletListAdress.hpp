@@ -60,8 +60,25 @@ namespace espressopp {
     // AdResS stuff
     PairList& getAdrPairs() { return adrPairs; }
     std::set<longint>& getAdrList() { return adrList; }
-    std::set<Particle*>& getAdrZone() { return adrZone; }
-    std::set<Particle*>& getCGZone() { return cgZone; }
+    std::vector<Particle*>& getAdrZone() { return adrZone; }
+    std::vector<Particle*>& getCGZone() { return cgZone; }
+
+    /** Flat AdResS data, valid until the next rebuild. The local VPs
+        (reals and ghosts) are numbered cell after cell over the local
+        cells, getZoneFlags() holds the ZoneFlags of each of them. */
+    enum ZoneFlags { ADR_ZONE = 1, HAS_AT = 2 };
+    std::vector<unsigned char>& getZoneFlags() { return zoneFlags; }
+    /** local indices of the VPs in getAdrZone() and getCGZone() */
+    std::vector<int>& getAdrZoneIndices() { return adrZoneIdx; }
+    std::vector<int>& getCGZoneIndices() { return cgZoneIdx; }
+    /** local indices of the two VPs of each pair of getPairs() and
+        getAdrPairs() */
+    std::vector<int>& getPairIndices() { return vlPairIdx; }
+    std::vector<int>& getAdrPairIndices() { return adrPairIdx; }
+    /** AT particles of the local VP i if it has the flag HAS_AT, taken
+        from the FixedTupleListAdress of the storage at the last rebuild */
+    Particle** atBegin(int i) { return &atParticles[0] + atStart[i]; }
+    Particle** atEnd(int i) { return &atParticles[0] + atStart[i + 1]; }
     std::vector<Real3D*>& getAdrPositions() { return adrPositions; }
     //std::set<Particle*>& getAdrZone() { return adrZone; }
     real getHy() { return dHy; }
@@ -100,9 +117,18 @@ namespace espressopp {
 
     // AdResS stuff
     std::set<longint> adrList;   // pids of particles defining center of adress zone, if set
-    std::set<Particle*> adrZone; // particles that are in the AdResS zone
-    std::set<Particle*> cgZone; // particles not in adress zone (same as in vlPairs)
+    std::vector<Particle*> adrZone; // particles that are in the AdResS zone
+    std::vector<Particle*> cgZone; // particles not in adress zone (same as in vlPairs)
     PairList adrPairs;           // pairs that are in AdResS zone
+
+    std::vector<unsigned char> zoneFlags; // ZoneFlags of the local VPs
+    std::vector<int> cellOffset;   // local index of the first VP of each cell
+    std::vector<int> adrZoneIdx;   // local indices of adrZone
+    std::vector<int> cgZoneIdx;    // local indices of cgZone
+    std::vector<int> vlPairIdx;    // local indices of vlPairs, 2 per pair
+    std::vector<int> adrPairIdx;   // local indices of adrPairs, 2 per pair
+    std::vector<int> atStart;      // AT particles of VP i: atParticles[atStart[i] .. atStart[i+1])
+    std::vector<Particle*> atParticles;
     real dEx, dHy; // size of the expicit and hybrid zone
     real adrsq, adrcutsq, adrCutverlet, cutverlet;
     real skin;
@@ -114,7 +140,7 @@ namespace espressopp {
     //void isPairInAdrZone(Particle &pt1, Particle &pt2); // not used anymore
 
 
-    void checkPair(Particle &pt1, Particle &pt2);
+    void checkPair(Particle &pt1, Particle &pt2, int index1, int index2);
     PairList vlPairs;
     boost::unordered_set<std::pair<longint, longint> > exList; // exclusion list
     real cutsq;
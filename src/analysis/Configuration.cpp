@@ -35,7 +35,8 @@ namespace espressopp {
   namespace analysis {
 
     Configuration::Configuration(bool _pos, bool _vel, bool _force, bool _radius)
-                : gatherPos(_pos), gatherVel(_vel), gatherForce(_force), gatherRadius(_radius)
+                : gatherPos(_pos), gatherVel(_vel), gatherForce(_force), gatherRadius(_radius),
+                  nStored(0)
     {
     }
 
@@ -44,55 +45,79 @@ namespace espressopp {
 	  gatherVel=false;
 	  gatherForce=false;
 	  gatherRadius=false;
+	  nStored=0;
     }
 
     Configuration::~Configuration()
     {
     }
 
-    void Configuration::set(size_t index, real x, real y, real z) {
-      if (gatherPos)
-        coordinates[index] = Real3D(x, y, z);
-      else {
-    	  std::cout << "Error: This configuration does not store coordinates" << std::endl;
+    void Configuration::reserve(size_t idRange) {
+      stored.reserve(idRange);
+      if (gatherPos)    coordinates.reserve(idRange);
+      if (gatherVel)    velocities.reserve(idRange);
+      if (gatherForce)  forces.reserve(idRange);
+      if (gatherRadius) radii.reserve(idRange);
+    }
+
+    void Configuration::insert(size_t index) {
+      if (index >= stored.size()) {
+        size_t idRange = index + 1;
+        stored.resize(idRange, 0);
+        if (gatherPos)    coordinates.resize(idRange, Real3D(0.0));
+        if (gatherVel)    velocities.resize(idRange, Real3D(0.0));
+        if (gatherForce)  forces.resize(idRange, Real3D(0.0));
+        if (gatherRadius) radii.resize(idRange, 0.0);
+      }
+      if (!stored[index]) {
+        stored[index] = 1;
+        nStored++;
       }
     }
 
+    void Configuration::set(size_t index, real x, real y, real z) {
+      setCoordinates(index, Real3D(x, y, z));
+    }
+
     void Configuration::setCoordinates(size_t index, Real3D _pos) {
-      if (gatherPos)
+      if (gatherPos) {
+        insert(index);
         coordinates[index] = _pos;
-      else {
+      } else {
     	  std::cout << "Error: This configuration does not store coordinates" << std::endl;
       }
     }
 
     void Configuration::setVelocities(size_t index, Real3D _vel) {
-      if (gatherVel)
+      if (gatherVel) {
+        insert(index);
         velocities[index] = _vel;
-      else {
+      } else {
     	  std::cout << "Error: This configuration does not store velocities" << std::endl;
       }
     }
 
     void Configuration::setForces(size_t index, Real3D _forces) {
-      if (gatherForce)
+      if (gatherForce) {
+        insert(index);
         forces[index] = _forces;
-      else {
+      } else {
     	  std::cout << "Error: This configuration does not store forces" << std::endl;
       }
     }
 
     void Configuration::setRadius(size_t index, real _radius) {
-      if (gatherRadius)
+      if (gatherRadius) {
+        insert(index);
         radii[index] = _radius;
-      else {
+      } else {
     	  std::cout << "Error: This configuration does not store radii" << std::endl;
       }
     }
 
     Real3D Configuration::getCoordinates(size_t index) {
       if (gatherPos)
-        return coordinates[index];
+        return hasId(index) ? coordinates[index] : Real3D(0.0);
       else {
     	  std::cout << "Error: This configuration has no information about coordinates" << std::endl;
     	  return Real3D(0,0,0);
@@ -101,7 +126,7 @@ namespace espressopp {
 
     Real3D Configuration::getVelocities(size_t index) {
       if (gatherVel)
-        return velocities[index];
+        return hasId(index) ? velocities[index] : Real3D(0.0);
       else {
     	  std::cout << "Error: This configuration has no information about velocities" << std::endl;
     	  return Real3D(0,0,0);
@@ -110,7 +135,7 @@ namespace espressopp {
 
     Real3D Configuration::getForces(size_t index) {
       if (gatherForce)
-        return forces[index];
+        return hasId(index) ? forces[index] : Real3D(0.0);
       else {
     	  std::cout << "Error: This configuration has no information about forces" << std::endl;
     	  return Real3D(0,0,0);
@@ -119,7 +144,7 @@ namespace espressopp {
 
     real Configuration::getRadius(size_t index) {
       if (gatherRadius)
-        return radii[index];
+        return hasId(index) ? radii[index] : 0.0;
       else {
     	  std::cout << "Error: This configuration has no information about radii" << std::endl;
     	  return 0;
@@ -127,17 +152,16 @@ namespace espressopp {
     }
 
     size_t Configuration::getSize() {
-      size_t sizePos    = coordinates.size();
-      size_t sizeVel    = velocities.size();
-      size_t sizeForce  = forces.size();
-      size_t sizeRadius = radii.size();
-
-      if (sizePos    > 0) return sizePos;
-      if (sizeVel    > 0) return sizeVel;
-      if (sizeForce  > 0) return sizeForce;
-      if (sizeRadius > 0) return sizeRadius;
+      return nStored;
+    }
 
-      return 0;
+    std::vector<size_t> Configuration::getIds() {
+      std::vector<size_t> ids;
+      ids.reserve(nStored);
+      for (size_t id = 0; id < stored.size(); id++) {
+        if (stored[id]) ids.push_back(id);
+      }
+      return ids;
     }
 
 /*
@@ -179,6 +203,22 @@ namespace espressopp {
     inline object pass_through(object const& o) { return o; }
 */
 
+    namespace {
+      // conf[id] raises an IndexError for ids that are not stored
+      Real3D getItem(Configuration& conf, size_t index) {
+        if (!conf.hasId(index)) throw std::out_of_range("particle id not in configuration");
+        return conf.getCoordinates(index);
+      }
+
+      // for id in conf: iterates over the stored ids in increasing order
+      object iterIds(Configuration& conf) {
+        std::vector<size_t> ids = conf.getIds();
+        list result;
+        for (size_t i = 0; i < ids.size(); i++) result.append(ids[i]);
+        return result.attr("__iter__")();
+      }
+    }
+
     void Configuration::registerPython() {
       using namespace espressopp::python;
 /*
@@ -190,7 +230,9 @@ namespace espressopp {
       class_<Configuration>
         ("analysis_Configuration", no_init)
       .add_property("size", &Configuration::getSize)
-      .def("__getitem__", &Configuration::getCoordinates)
+      .def("__len__", &Configuration::getSize)
+      .def("__getitem__", &getItem)
+      .def("__iter__", &iterIds)
       // .def("__iter__", &Configuration::getIterator)
       ;
     }
@@ -27,6 +27,7 @@
 #include "types.hpp"
 #include "SystemAccess.hpp"
 #include <map>
+#include <vector>
 
 namespace espressopp {
   namespace analysis {
@@ -49,7 +50,13 @@ namespace espressopp {
     };
     */
 
-    /** Class that stores particle positions for later analysis. */
+    /** Class that stores particle positions for later analysis.
+
+        The data is kept in flat arrays indexed by the particle id, so
+        setting and looking up a particle is O(1) and iterating over the
+        ids visits them in increasing order. The getters return zero for
+        ids that were not set.
+    */
     class Configuration {
     public:
       Configuration();
@@ -60,6 +67,12 @@ namespace espressopp {
       Real3D getForces(size_t id);
       real getRadius(size_t id);
       size_t getSize();
+      /** true if data of particle id was set */
+      bool hasId(size_t id) { return id < stored.size() && stored[id]; }
+      /** ids of the stored particles in increasing order */
+      std::vector<size_t> getIds();
+      /** reserve the arrays for the ids 0 ... idRange-1 */
+      void reserve(size_t idRange);
       void set(size_t id, real x, real y, real z);
       void setCoordinates(size_t id, Real3D _pos);
       void setVelocities(size_t id, Real3D _vel);
@@ -68,11 +81,15 @@ namespace espressopp {
       static void registerPython();
       // class ConfigurationIterator getIterator();
     private:
+      void insert(size_t id);
+
       bool gatherPos, gatherVel, gatherForce, gatherRadius;
-      std::map<size_t, Real3D> coordinates;
-      std::map<size_t, Real3D> velocities;
-      std::map<size_t, Real3D> forces;
-      std::map<size_t, real> radii;
+      std::vector<char> stored;  // stored[id] != 0 if particle id was set
+      size_t nStored;
+      std::vector<Real3D> coordinates;
+      std::vector<Real3D> velocities;
+      std::vector<Real3D> forces;
+      std::vector<real> radii;
     };
   }
 }
@@ -26,13 +26,15 @@
 #include "storage/Storage.hpp"
 #include "iterator/CellListIterator.hpp"
 #include "bc/BC.hpp"
+#include "esutil/Error.hpp"
 #include "mpi.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <utility>
 
 using namespace espressopp;
 
-#define DEFAULT_TAG 71
-
 namespace espressopp {
   namespace analysis {
 
@@ -116,185 +118,188 @@ namespace espressopp {
       configurations.push_back(config);
     }
 
-    void Configurations::gather() {
+    int Configurations::getStride()
+    {
+      return (gatherPos ? 3 : 0) + (gatherVel ? 3 : 0) + (gatherForce ? 3 : 0)
+        + (gatherRadius ? 1 : 0);
+    }
 
+    void Configurations::packLocal(std::vector<longint>& ids, std::vector<real>& values)
+    {
       System& system = getSystemRef();
-  
-      // determine number of local particles and total particles
-
-      int myN = system.storage->getNRealParticles();
-      int maxN;   // maximal number of particles one processor has
-      int totalN; // totlal number of particles all processors have
-
-      boost::mpi::all_reduce(*system.comm, myN, maxN, boost::mpi::maximum<int>());
-      boost::mpi::all_reduce(*system.comm, myN, totalN, std::plus<int>());
-
-      LOG4ESPP_INFO(logger, "#Partices: me = " << myN << ", max = " << maxN
-                            << ", totalN = " << totalN);
-
-      int*  ids         = new int [maxN];  // buffer for gather
-      Real3D* coordinates;
-      Real3D* velocities;
-      Real3D* forces;
-      real* radii;
-
-      if (gatherPos)    coordinates = new Real3D [maxN];  // buffer for gather
-      if (gatherVel)    velocities  = new Real3D [maxN];  // buffer for gather
-      if (gatherForce)  forces      = new Real3D [maxN];  // buffer for gather
-      if (gatherRadius) radii       = new real [maxN];  // buffer for gather
-
-      // fill the buffer with my values
 
+      std::vector< std::pair<longint, Particle*> > local;
+      local.reserve(system.storage->getNRealParticles());
       CellList realCells = system.storage->getRealCells();
-
-      int i = 0; 
       for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
-        ids[i] = cit->id();
+        local.push_back(std::make_pair(cit->id(), &*cit));
+      }
+      std::sort(local.begin(), local.end());
+
+      int stride = getStride();
+      ids.resize(local.size());
+      values.resize(local.size() * stride);
+      real* v = values.empty() ? 0 : &values[0];
+      for (size_t i = 0; i < local.size(); i++) {
+        Particle& p = *local[i].second;
+        ids[i] = local[i].first;
         if (gatherPos) {
-          Real3D pos = cit->position();
-          Int3D img = cit->image();
+          Real3D pos = p.position();
+          Int3D img = p.image();
           if (folded)
         	system.bc->foldPosition(pos, img);
           else
         	system.bc->unfoldPosition(pos, img);
-          coordinates[i] = pos;
+          for (int k = 0; k < 3; k++) *v++ = pos[k];
         }
-        if (gatherVel)    velocities[i]  = cit->velocity();
-        if (gatherForce)  forces[i]      = cit->force();
-        if (gatherRadius) radii[i]       = cit->radius();
-        i++;
+        if (gatherVel)    for (int k = 0; k < 3; k++) *v++ = p.velocity()[k];
+        if (gatherForce)  for (int k = 0; k < 3; k++) *v++ = p.force()[k];
+        if (gatherRadius) *v++ = p.radius();
       }
+    }
 
-      if (i != myN) {
-        LOG4ESPP_ERROR(logger, "mismatch for number of local particles");
-      }
+    void Configurations::gather() {
 
-      // each proc sends its data to master process
-
-      if (system.comm->rank() == 0) {
-
-         ConfigurationPtr config = make_shared<Configuration> (); //totalN
-
-         // root process collects data from all processors and sets it
-
-         int nproc = system.comm->size();
-
-         for (int iproc = 0; iproc < nproc; iproc++) {
-           int nother;
-           if (iproc) {
-              int nIds, nVals;   // number of received values
-              int tmp;
-              boost::mpi::request req;
-              boost::mpi::status  stat;
-              LOG4ESPP_DEBUG(logger, "receive tags from " << iproc);
-              req = system.comm->irecv<int>(iproc, DEFAULT_TAG, ids, maxN);
-              system.comm->send(iproc, DEFAULT_TAG, 0);
-              stat = req.wait();
-              nIds = *stat.count<int>();
-              if (gatherPos) {
-                req = system.comm->irecv<Real3D>(iproc, DEFAULT_TAG, coordinates, maxN);
-                system.comm->send(iproc, DEFAULT_TAG, 0);
-                stat = req.wait();
-                nVals = *stat.count<Real3D>();
-                if (nVals != nIds) {
-                  LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                                nIds << " ids, but " << nVals << " coordinates");
-                }
-              }
-              if (gatherVel) {
-                req = system.comm->irecv<Real3D>(iproc, DEFAULT_TAG, velocities, maxN);
-                system.comm->send(iproc, DEFAULT_TAG, 0);
-                stat = req.wait();
-                nVals = *stat.count<Real3D>();
-                if (nVals != nIds) {
-                  LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                                nIds << " ids, but " << nVals << " velocities");
-                }
-              }
-              if (gatherForce) {
-                req = system.comm->irecv<Real3D>(iproc, DEFAULT_TAG, forces, maxN);
-                system.comm->send(iproc, DEFAULT_TAG, 0);
-                stat = req.wait();
-                nVals = *stat.count<Real3D>();
-                if (nVals != nIds) {
-                  LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                                nIds << " ids, but " << nVals << " forces");
-                }
-              }
-              if (gatherRadius) {
-                req = system.comm->irecv<real>(iproc, DEFAULT_TAG, radii, maxN);
-                system.comm->send(iproc, DEFAULT_TAG, 0);
-                stat = req.wait();
-                nVals = *stat.count<real>();
-                if (nVals != nIds) {
-                  LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                                nIds << " ids, but " << nVals << " radii");
-                }
-              }
-              nother = nIds;
-           } else {
-             nother = myN;
-           }
-   
-           LOG4ESPP_INFO(logger, "add " << nother << " coordinates of proc " << iproc);
-
-           for (int i = 0; i < nother; i++) {
-             //LOG4ESPP_DEBUG(logger, "set coordinates of particle with id = " << index <<
-             //                       ": " << coordinates[3*i] << " " <<  coordinates[3*i+1] << " " << coordinates[3*i+2]);
-             int index = ids[i];
-             if (gatherPos)    config->setCoordinates(index, coordinates[i]);
-             if (gatherVel)    config->setVelocities(index, velocities[i]);
-             if (gatherForce)  config->setForces(index, forces[i]);
-             if (gatherRadius) config->setRadius(index, radii[i]);
-           }
+      System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      int nproc = comm.size();
+      int stride = getStride();
+
+      std::vector<longint> ids;
+      std::vector<real> values;
+      packLocal(ids, values);
+      int myN = ids.size();
+
+      // node 0 receives the id sorted arrays of all nodes one after the
+      // other, one MPI_Gatherv per array
+
+      std::vector<int> counts;
+      boost::mpi::gather(comm, myN, counts, 0);
+
+      std::vector<int> idDispls, valueCounts, valueDispls;
+      std::vector<longint> allIds;
+      std::vector<real> allValues;
+      int totalN = 0;
+      if (comm.rank() == 0) {
+        idDispls.resize(nproc);
+        valueCounts.resize(nproc);
+        valueDispls.resize(nproc);
+        for (int iproc = 0; iproc < nproc; iproc++) {
+          idDispls[iproc] = totalN;
+          valueCounts[iproc] = stride * counts[iproc];
+          valueDispls[iproc] = stride * totalN;
+          totalN += counts[iproc];
         }
+        allIds.resize(totalN);
+        allValues.resize(stride * totalN);
+        LOG4ESPP_INFO(logger, "gather " << totalN << " particles of " << nproc << " procs");
+      }
+
+      MPI_Gatherv(ids.empty() ? 0 : &ids[0], myN, boost::mpi::get_mpi_datatype<longint>(),
+                  allIds.empty() ? 0 : &allIds[0], counts.empty() ? 0 : &counts[0],
+                  idDispls.empty() ? 0 : &idDispls[0], boost::mpi::get_mpi_datatype<longint>(),
+                  0, comm);
+      if (stride > 0) {
+        MPI_Gatherv(values.empty() ? 0 : &values[0], stride * myN,
+                    boost::mpi::get_mpi_datatype<real>(),
+                    allValues.empty() ? 0 : &allValues[0],
+                    valueCounts.empty() ? 0 : &valueCounts[0],
+                    valueDispls.empty() ? 0 : &valueDispls[0],
+                    boost::mpi::get_mpi_datatype<real>(), 0, comm);
+      }
+
+      if (comm.rank() == 0) {
+
+         ConfigurationPtr config = make_shared<Configuration>
+           (gatherPos, gatherVel, gatherForce, gatherRadius);
+
+         longint maxId = -1;
+         for (int i = 0; i < totalN; i++) maxId = std::max(maxId, allIds[i]);
+         config->reserve(maxId + 1);
+
+         const real* v = allValues.empty() ? 0 : &allValues[0];
+         for (int i = 0; i < totalN; i++) {
+           size_t index = allIds[i];
+           if (gatherPos)    { config->setCoordinates(index, Real3D(v[0], v[1], v[2])); v += 3; }
+           if (gatherVel)    { config->setVelocities(index, Real3D(v[0], v[1], v[2])); v += 3; }
+           if (gatherForce)  { config->setForces(index, Real3D(v[0], v[1], v[2])); v += 3; }
+           if (gatherRadius) { config->setRadius(index, v[0]); v += 1; }
+         }
 
         LOG4ESPP_INFO(logger, "save the latest configuration");
 
         pushConfig(config);
+      }
+    }
 
-      } else {
+    void Configurations::gatherToFile(std::string filename) {
 
-       LOG4ESPP_INFO(logger, "proc " << system.comm->rank() << " sends data " 
-                      << " of " << myN << " particles");
-
-       // not master process, send data to master process
-
-       int tmp;
-
-       boost::mpi::status stat;
-
-       // wait for a signal (empty message) before sending
-
-       system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-       system.comm->send<int>(0, DEFAULT_TAG, ids, myN);
-       if (gatherPos) {
-         system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-         system.comm->send<Real3D>(0, DEFAULT_TAG, coordinates, myN);
-       }
-       if (gatherVel) {
-         system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-         system.comm->send<Real3D>(0, DEFAULT_TAG, velocities, myN);
-       }
-       if (gatherForce) {
-         system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-         system.comm->send<Real3D>(0, DEFAULT_TAG, forces, myN);
-       }
-       if (gatherRadius) {
-         system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-         system.comm->send<real>(0, DEFAULT_TAG, radii, myN);
-       }
+      System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      esutil::Error err(system.comm);
+      int stride = getStride();
+
+      std::vector<longint> ids;
+      std::vector<real> values;
+      packLocal(ids, values);
+      int myN = ids.size();
+
+      longint myMax = ids.empty() ? -1 : ids.back();
+      longint maxId;
+      boost::mpi::all_reduce(comm, myMax, maxId, boost::mpi::maximum<longint>());
+      int64_t idRange = maxId + 1;
+
+      // the records of this node, in increasing id and thus file order
+      const int recordSize = sizeof(int64_t) + stride * sizeof(real);
+      std::vector<char> records(myN * recordSize);
+      std::vector<MPI_Aint> displs(myN);
+      std::vector<int> lengths(myN, recordSize);
+      for (int i = 0; i < myN; i++) {
+        char* r = &records[i * recordSize];
+        int64_t exists = 1;
+        memcpy(r, &exists, sizeof(int64_t));
+        if (stride > 0) memcpy(r + sizeof(int64_t), &values[i * stride], stride * sizeof(real));
+        displs[i] = (MPI_Aint) ids[i] * recordSize;
       }
 
-      // ToDo: remove first configuration if capacity is exhausted
-
-      // master process saves the configuration
+      MPI_File fh;
+      int rc = MPI_File_open(comm, const_cast<char*>(filename.c_str()),
+                             MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &fh);
+      if (rc != MPI_SUCCESS) err.setException("Configurations: cannot open " + filename);
+      err.checkException();
+
+      // unused ids stay zero
+      MPI_File_set_size(fh, 0);
+      MPI_File_set_size(fh, sizeof(FileHeader) + idRange * recordSize);
+
+      MPI_Status status;
+      if (comm.rank() == 0) {
+        FileHeader h;
+        memset(&h, 0, sizeof(FileHeader));
+        memcpy(h.magic, "ESPPCONF", sizeof(h.magic));
+        h.version = 1;
+        h.flags = (gatherPos ? FLAG_POS : 0) | (gatherVel ? FLAG_VEL : 0)
+          | (gatherForce ? FLAG_FORCE : 0) | (gatherRadius ? FLAG_RADIUS : 0)
+          | (folded ? FLAG_FOLDED : 0);
+        h.idRange = idRange;
+        if (MPI_File_write_at(fh, 0, &h, sizeof(FileHeader), MPI_BYTE, &status) != MPI_SUCCESS)
+          rc = MPI_ERR_OTHER;
+      }
 
-      if (gatherRadius) delete [] radii;
-      if (gatherForce)  delete [] forces;
-      if (gatherVel)    delete [] velocities;
-      if (gatherPos)    delete [] coordinates;
-      delete [] ids;
+      MPI_Datatype filetype;
+      MPI_Type_create_hindexed(myN, lengths.empty() ? 0 : &lengths[0],
+                               displs.empty() ? 0 : &displs[0], MPI_BYTE, &filetype);
+      MPI_Type_commit(&filetype);
+      MPI_File_set_view(fh, sizeof(FileHeader), MPI_BYTE, filetype,
+                        const_cast<char*>("native"), MPI_INFO_NULL);
+      if (MPI_File_write_all(fh, records.empty() ? 0 : &records[0], records.size(),
+                             MPI_BYTE, &status) != MPI_SUCCESS)
+        rc = MPI_ERR_OTHER;
+      MPI_Type_free(&filetype);
+      MPI_File_close(&fh);
+
+      if (rc != MPI_SUCCESS) err.setException("Configurations: cannot write to " + filename);
+      err.checkException();
     }
 
     // Python wrapping
@@ -309,10 +314,12 @@ namespace espressopp {
 
       class_<Configurations>
         ("analysis_Configurations", init< shared_ptr< System > >())
+      .def(init< shared_ptr< System >, bool, bool, bool, bool, bool >())
       .add_property("size", &Configurations::getSize)
       .add_property("capacity", &Configurations::getCapacity, 
                                 &Configurations::setCapacity)
       .def("gather", &Configurations::gather)
+      .def("gatherToFile", &Configurations::gatherToFile)
       .def("__getitem__", &Configurations::get)
       .def("back", &Configurations::back)
       .def("all", &Configurations::all)
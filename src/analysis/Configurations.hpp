@@ -24,6 +24,10 @@
 #ifndef _ANALYSIS_CONFIGURATIONS_HPP
 #define _ANALYSIS_CONFIGURATIONS_HPP
 
+#include <stdint.h>
+#include <string>
+#include <vector>
+
 #include "types.hpp"
 #include "SystemAccess.hpp"
 #include "Configuration.hpp"
@@ -35,6 +39,11 @@ namespace espressopp {
 
         Important: this class can also be used if the number of
         particles changes between different snapshots.
+
+        gather() collects the particles with one MPI_Gatherv per array
+        into a Configuration on node 0. gatherToFile() writes a snapshot
+        without collecting it: every node writes the records of its own
+        particles with MPI-IO at the offset given by the particle id.
     */
 
     typedef std::vector<ConfigurationPtr> ConfigurationList;
@@ -49,6 +58,7 @@ namespace espressopp {
     	  gatherVel = false;
     	  gatherForce = false;
     	  gatherRadius = false;
+    	  folded = false;
     	  maxConfigs = 0;
       }
       Configurations(shared_ptr<System> system, bool _pos, bool _vel, bool _force, bool _radius, bool _folded)
@@ -73,6 +83,24 @@ namespace espressopp {
 
       void gather();
 
+      /** Write a snapshot of the current particles to a binary file
+          without collecting it on one node. The file is a FileHeader
+          followed by idRange records, the record of particle id at
+          offset id * record size. A record is an int64_t, 1 if the
+          particle exists and 0 for unused ids, followed by the position,
+          velocity, force and radius, each only if gathered. Collective.
+      */
+      void gatherToFile(std::string filename);
+
+      struct FileHeader {
+        char magic[8];      // "ESPPCONF"
+        int version;
+        int flags;          // FLAG_*
+        int64_t idRange;    // largest id + 1
+      };
+
+      enum { FLAG_POS = 1, FLAG_VEL = 2, FLAG_FORCE = 4, FLAG_RADIUS = 8, FLAG_FOLDED = 16 };
+
       ConfigurationPtr get(int stackpos);
 
       ConfigurationPtr back();
@@ -90,6 +118,12 @@ namespace espressopp {
     private:
 
       void pushConfig(ConfigurationPtr config);
+
+      /** number of reals gathered per particle */
+      int getStride();
+
+      /** ids and values of the real particles of this node, sorted by id */
+      void packLocal(std::vector<longint>& ids, std::vector<real>& values);
  
       ConfigurationList configurations;
 
@@ -42,6 +42,13 @@ espressopp.analysis.Configurations
 * `size`
   number of stored configurations
 
+* `gatherToFile(filename)`
+  write the current configuration to a binary file without collecting
+  it on one node, see :py:func:`read_configuration_file`
+
+gather() collects the particles of all nodes with one MPI_Gatherv per
+array; a configuration stores them in arrays indexed by the particle id.
+
 usage:
 
 storing trajectory
@@ -58,9 +65,10 @@ iterate over all stored configurations:
 
 >>> for conf in configurations:
 
-iterate over all particles stored in configuration:
+iterate over all particles stored in configuration, in increasing order
+of the ids (conf[pid] raises an IndexError for ids that are not stored):
 
->>>   for pid in conf
+>>>   for pid in conf:
 >>>     particle_coords = conf[pid]
 >>>     print pid, particle_coords
 
@@ -68,9 +76,14 @@ access particle with id <pid> of stored configuration <n>:
 
 >>> print "particle coord: ",configurations[n][pid]
 
-.. function:: espressopp.analysis.Configurations(system)
+.. function:: espressopp.analysis.Configurations(system, pos=True, vel=False, force=False, radius=False, folded=False)
 
 		:param system:
+		:param bool pos: gather the positions
+		:param bool vel: gather the velocities
+		:param bool force: gather the forces
+		:param bool radius: gather the radii
+		:param bool folded: fold the positions into the box
 		:type system:
 
 .. function:: espressopp.analysis.Configurations.back()
@@ -84,6 +97,19 @@ access particle with id <pid> of stored configuration <n>:
 .. function:: espressopp.analysis.Configurations.gather()
 
 		:rtype:
+
+.. function:: espressopp.analysis.Configurations.gatherToFile(filename)
+
+		Every node writes the records of its particles at offsets given by
+		the particle ids with MPI-IO.
+
+		:param filename:
+
+.. function:: espressopp.analysis.read_configuration_file(filename)
+
+		Reads a file written by gatherToFile and returns a dictionary with
+		the ids and, as far as gathered, pos, v, f and radius sorted by
+		id, and folded. Needs numpy.
 """
 
 from espressopp.esutil import cxxinit
@@ -94,11 +120,13 @@ from _espressopp import analysis_Configurations
 
 class ConfigurationsLocal(ObservableLocal, analysis_Configurations):
 
-    def __init__(self, system):
+    def __init__(self, system, pos=True, vel=False, force=False, radius=False, folded=False):
 	if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
-          cxxinit(self, analysis_Configurations, system)
+          cxxinit(self, analysis_Configurations, system, pos, vel, force, radius, folded)
     def gather(self):
         return self.cxxclass.gather(self)
+    def gatherToFile(self, filename):
+        return self.cxxclass.gatherToFile(self, filename)
     def clear(self):
         return self.cxxclass.clear(self)
     def __iter__(self):
@@ -106,12 +134,32 @@ class ConfigurationsLocal(ObservableLocal, analysis_Configurations):
     def back(self):
         return self.cxxclass.back(self)
 
+def read_configuration_file(filename):
+    import numpy as np
+
+    header = np.dtype([('magic', 'S8'), ('version', 'i4'), ('flags', 'i4'), ('idRange', 'i8')])
+    f = open(filename, 'rb')
+    h = np.fromfile(f, header, 1)[0]
+    if h['magic'] != 'ESPPCONF':
+        raise IOError('{} is not a configuration file'.format(filename))
+    fields = [('exists', 'i8')]
+    for flag, name, shape in [(1, 'pos', 3), (2, 'v', 3), (4, 'f', 3), (8, 'radius', 1)]:
+        if h['flags'] & flag:
+            fields.append((name, 'f8', shape) if shape > 1 else (name, 'f8'))
+    records = np.fromfile(f, np.dtype(fields), int(h['idRange']))
+    f.close()
+    ids = np.nonzero(records['exists'])[0]
+    result = dict(id=ids, folded=bool(h['flags'] & 16))
+    for name in records.dtype.names[1:]:
+        result[name] = records[name][ids]
+    return result
+
 if pmi.isController :
     class Configurations(Observable):
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
             cls =  'espressopp.analysis.ConfigurationsLocal',
-            pmicall = [ "gather", "clear", "back" ],
+            pmicall = [ "gather", "gatherToFile", "clear", "back" ],
             localcall = ["__getitem__", "__iter__"],
             pmiproperty = ["capacity", "size"]
             )
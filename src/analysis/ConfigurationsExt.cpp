@@ -30,11 +30,10 @@
 #include "bc/BC.hpp"
 #include "mpi.h"
 #include <cmath>
+#include <vector>
 
 using namespace espressopp;
 
-#define DEFAULT_TAG 71
-
 namespace espressopp {
   namespace analysis {
 
@@ -122,191 +121,87 @@ namespace espressopp {
     void ConfigurationsExt::gather() {
 
       System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      int nproc = comm.size();
 
-      // determine number of local particles and total particles
+      // fill the buffers with my values, 6 values (position, velocity) per id
 
       int myN = system.storage->getNRealParticles();
-      int maxN;   // maximal number of particles one processor has
-      int totalN; // totlal number of particles all processors have
-
-      boost::mpi::all_reduce(*system.comm, myN, maxN, boost::mpi::maximum<int>());
-      boost::mpi::all_reduce(*system.comm, myN, totalN, std::plus<int>());
-
-      LOG4ESPP_INFO(logger, "#Partices: me = " << myN << ", max = " << maxN
-                            << ", totalN = " << totalN);
-
-      real* coordinates = new real [3 * maxN];  // buffer for gather
-      real* velocities  = new real [3 * maxN];  // buffer for gather
-      int*  ids         = new int [maxN];  // buffer for gather
-
-      // fill the buffer with my values
+      std::vector<longint> ids;
+      std::vector<real> values;
+      ids.reserve(myN);
+      values.reserve(6 * myN);
 
+      Real3D L = system.bc->getBoxL();
       CellList realCells = system.storage->getRealCells();
-
-      int i = 0;
-
-      if( unfolded ){
-        for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
-
-          ids[i] = cit->id();
-
-          Real3D& pos = cit->position();
-          Real3D& vel = cit->velocity();
+      for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
+        ids.push_back(cit->id());
+        Real3D pos = cit->position();
+        if (unfolded) {
           Int3D& img = cit->image();
-          Real3D L = system.bc->getBoxL();
-
-          coordinates[3*i]   = pos[0] + img[0] * L[0];
-          coordinates[3*i+1] = pos[1] + img[1] * L[1];
-          coordinates[3*i+2] = pos[2] + img[2] * L[2];
-
-          velocities[3*i]   = vel[0];
-          velocities[3*i+1] = vel[1];
-          velocities[3*i+2] = vel[2];
-
-          i++;
+          for (int k = 0; k < 3; k++) pos[k] += img[k] * L[k];
         }
+        for (int k = 0; k < 3; k++) values.push_back(pos[k]);
+        for (int k = 0; k < 3; k++) values.push_back(cit->velocity()[k]);
       }
-      else{
-        for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
-
-          ids[i] = cit->id();
-
-          Real3D& pos = cit->position();
-          Real3D& vel = cit->velocity();
-
-          coordinates[3*i]   = pos[0];
-          coordinates[3*i+1] = pos[1];
-          coordinates[3*i+2] = pos[2];
-
-          velocities[3*i]   = vel[0];
-          velocities[3*i+1] = vel[1];
-          velocities[3*i+2] = vel[2];
 
-          i++;
-        }
-      }
-
-      if (i != myN) {
+      if (int(ids.size()) != myN) {
         LOG4ESPP_ERROR(logger, "mismatch for number of local particles");
+        myN = ids.size();
       }
 
-      // each proc sends its data to master process
-
-      if (system.comm->rank() == 0) {
-
-         ConfigurationExtPtr config = make_shared<ConfigurationExt> (); //totalN
-
-         // root process collects data from all processors and sets it
-
-         int nproc = system.comm->size();
-
-         for (int iproc = 0; iproc < nproc; iproc++) {
-
-           int nother;
-
-           if (iproc) {
-
-              int nIds, nCoords, nVelocs; // number of received values
-              //int tmp;
-
-              boost::mpi::request req;
-              boost::mpi::status  stat;
-
-              LOG4ESPP_DEBUG(logger, "receive tags from " << iproc);
-
-              req = system.comm->irecv<int>(iproc, DEFAULT_TAG, ids, maxN);
-              system.comm->send(iproc, DEFAULT_TAG, 0);
-              stat = req.wait();
-              nIds = *stat.count<int>();
-
-              req = system.comm->irecv<real>(iproc, DEFAULT_TAG, coordinates, 3*maxN);
-              system.comm->send(iproc, DEFAULT_TAG, 0);
-              stat = req.wait();
-              nCoords = *stat.count<real>();
-
-              // make sure to have 3 coordinate values for each id
-
-              if (nCoords != 3 * nIds) {
-                LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                              nIds << " ids, but " << nCoords << " coordinates");
-              }
-
-
-              req = system.comm->irecv<real>(iproc, DEFAULT_TAG, velocities, 3*maxN);
-              system.comm->send(iproc, DEFAULT_TAG, 0);
-              stat = req.wait();
-              nVelocs = *stat.count<real>();
-
-              // make sure to have 3 velocities values for each id
-
-              if (nVelocs != 3 * nIds) {
-                LOG4ESPP_ERROR(logger, "serious error collecting data, got " <<
-                              nIds << " ids, but " << nVelocs << " velocities");
-              }
-
-              nother = nIds;
-
-           } else {
-             nother = myN;
-           }
-
-
-           LOG4ESPP_INFO(logger, "add " << nother << " coordinates of proc " << iproc);
-
-           for (int i = 0; i < nother; i++) {
-
-             int index = ids[i];
-
-             LOG4ESPP_INFO(logger, "set coordianates of particle with id = " << index <<
-                                   ": " << coordinates[3*i] << " " <<  coordinates[3*i+1] << " " << coordinates[3*i+2] <<
-                                   "and velocities: " <<  velocities[3*i] << " " <<  velocities[3*i+1] << " " << velocities[3*i+2]);
-
-             RealND _vec(6);  // p[0].p[1].p[2].v[0].v[1].v[2]
-
-             for (int k=0; k<3; k++)
-               _vec.setItem(k, coordinates[3*i + k]);
-
-             for (int k=0; k<3; k++)
-               _vec.setItem(k+3, velocities[3*i + k]);
-
-             config->set(index, _vec);
-           }
+      // node 0 receives the arrays of all nodes one after the other,
+      // one MPI_Gatherv per array
+
+      std::vector<int> counts;
+      boost::mpi::gather(comm, myN, counts, 0);
+
+      std::vector<int> idDispls, valueCounts, valueDispls;
+      std::vector<longint> allIds;
+      std::vector<real> allValues;
+      int totalN = 0;
+      if (comm.rank() == 0) {
+        idDispls.resize(nproc);
+        valueCounts.resize(nproc);
+        valueDispls.resize(nproc);
+        for (int iproc = 0; iproc < nproc; iproc++) {
+          idDispls[iproc] = totalN;
+          valueCounts[iproc] = 6 * counts[iproc];
+          valueDispls[iproc] = 6 * totalN;
+          totalN += counts[iproc];
         }
+        allIds.resize(totalN);
+        allValues.resize(6 * totalN);
+        LOG4ESPP_INFO(logger, "gather " << totalN << " particles of " << nproc << " procs");
+      }
+
+      MPI_Gatherv(ids.empty() ? 0 : &ids[0], myN, boost::mpi::get_mpi_datatype<longint>(),
+                  allIds.empty() ? 0 : &allIds[0], counts.empty() ? 0 : &counts[0],
+                  idDispls.empty() ? 0 : &idDispls[0], boost::mpi::get_mpi_datatype<longint>(),
+                  0, comm);
+      MPI_Gatherv(values.empty() ? 0 : &values[0], 6 * myN,
+                  boost::mpi::get_mpi_datatype<real>(),
+                  allValues.empty() ? 0 : &allValues[0],
+                  valueCounts.empty() ? 0 : &valueCounts[0],
+                  valueDispls.empty() ? 0 : &valueDispls[0],
+                  boost::mpi::get_mpi_datatype<real>(), 0, comm);
+
+      if (comm.rank() == 0) {
+
+         ConfigurationExtPtr config = make_shared<ConfigurationExt> ();
+
+         const real* v = allValues.empty() ? 0 : &allValues[0];
+         for (int i = 0; i < totalN; i++, v += 6) {
+           RealND _vec(6);  // p[0].p[1].p[2].v[0].v[1].v[2]
+           for (int k = 0; k < 6; k++)
+             _vec.setItem(k, v[k]);
+           config->set(allIds[i], _vec);
+         }
 
         LOG4ESPP_INFO(logger, "save the latest configuration");
 
         pushConfig(config);
-
-      } else {
-
-       LOG4ESPP_INFO(logger, "proc " << system.comm->rank() << " sends data "
-                      << " of " << myN << " particles");
-
-       // not master process, send data to master process
-
-       int tmp;
-
-       boost::mpi::request requests[2];
-       boost::mpi::status stat;
-
-       // wait for a signal (empty message) before sending
-
-       requests[0] = system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-       system.comm->send<int>(0, DEFAULT_TAG, ids, myN);
-       stat = requests[0].wait();
-       requests[1] = system.comm->irecv<int>(0, DEFAULT_TAG, tmp);
-       stat = requests[1].wait();
-       system.comm->send<real>(0, DEFAULT_TAG, coordinates, 3*myN);
-       system.comm->send<real>(0, DEFAULT_TAG, velocities, 3*myN);
       }
-
-      // ToDo: remove first configuration if capacity is exhausted
-
-      // master process saves the configuration
-
-      delete [] coordinates;
-      delete [] velocities;
-      delete [] ids;
     }
 
     // Python wrapping
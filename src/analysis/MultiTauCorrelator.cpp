@@ -0,0 +1,321 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <fftw3.h>
+#include <boost/serialization/vector.hpp>
+
+#include "MultiTauCorrelator.hpp"
+#include "PressureTensor.hpp"
+#include "storage/Storage.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "esutil/Error.hpp"
+
+namespace espressopp {
+  namespace analysis {
+
+    using namespace iterator;
+
+    LOG4ESPP_LOGGER(MultiTauCorrelator::theLogger, "MultiTauCorrelator");
+
+    MultiTauCorrelator::MultiTauCorrelator(shared_ptr< System > system, shared_ptr< Observable > _observable,
+                                           int _p, int _m, int _numLevels, real _dt, bool _exact)
+    : ParticleAccess(system), quantity(OBSERVABLE), observable(_observable) {
+      setup(_p, _m, _numLevels, _dt, _exact);
+    }
+
+    MultiTauCorrelator::MultiTauCorrelator(shared_ptr< System > system, std::string _quantity,
+                                           int _p, int _m, int _numLevels, real _dt, bool _exact)
+    : ParticleAccess(system) {
+      if (_quantity == "stress") {
+        quantity = STRESS;
+      } else if (_quantity == "velocity") {
+        quantity = VELOCITY;
+      } else {
+        throw std::runtime_error("MultiTauCorrelator: unknown quantity " + _quantity +
+                                 ", use stress or velocity");
+      }
+      setup(_p, _m, _numLevels, _dt, _exact);
+    }
+
+    void MultiTauCorrelator::setup(int _p, int _m, int _numLevels, real _dt, bool _exact) {
+      if (_m < 2 || _p < _m || _p % _m != 0 || _numLevels < 1) {
+        throw std::runtime_error("MultiTauCorrelator: needs m >= 2, p a multiple of m and at least one level");
+      }
+      p = _p;
+      m = _m;
+      numLevels = _numLevels;
+      dt = _dt;
+      exact = _exact;
+      reset();
+    }
+
+    void MultiTauCorrelator::reset() {
+      d = 0;
+      nSamples = 0;
+      shift.clear();
+      insertIndex.clear();
+      nInserted.clear();
+      accumulator.clear();
+      nAccumulated.clear();
+      average.clear();
+      correlation.clear();
+      nCorrelation.clear();
+      series.clear();
+      idToChannel.clear();
+    }
+
+    void MultiTauCorrelator::allocate(int _d) {
+      d = _d;
+      shift.assign(numLevels, std::vector< real >(p * d, 0.0));
+      insertIndex.assign(numLevels, 0);
+      nInserted.assign(numLevels, 0);
+      accumulator.assign(numLevels, std::vector< real >(d, 0.0));
+      nAccumulated.assign(numLevels, 0);
+      average.assign(numLevels, std::vector< real >(d, 0.0));
+      correlation.assign(numLevels, std::vector< real >(p, 0.0));
+      nCorrelation.assign(numLevels, std::vector< longint >(p, 0));
+      if (exact) series.assign(d, std::vector< real >());
+    }
+
+    void MultiTauCorrelator::sample() {
+      System& system = getSystemRef();
+      esutil::Error err(system.comm);
+      bool isRoot = (system.comm->rank() == 0);
+
+      std::vector< real > x;
+      switch (quantity) {
+        case OBSERVABLE:
+          switch (observable->getResultType()) {
+            case Observable::real_vector:
+              x = observable->compute_real_vector();
+              break;
+            case Observable::real_scalar:
+              x.push_back(observable->compute_real());
+              break;
+            case Observable::int_scalar:
+              x.push_back(observable->compute_int());
+              break;
+            case Observable::old_format:
+              x.push_back(observable->compute());
+              break;
+            default:
+              err.setException("MultiTauCorrelator: the result type of the observable is not supported");
+          }
+          break;
+        case STRESS: {
+          Tensor pt = PressureTensor(getSystem()).computeRaw();
+          x.push_back(pt[3]);
+          x.push_back(pt[4]);
+          x.push_back(pt[5]);
+          break;
+        }
+        case VELOCITY:
+          if (!getVelocities(x)) {
+            err.setException("MultiTauCorrelator: the set of particles changed between two samples");
+          }
+          break;
+      }
+
+      if (isRoot && !x.empty()) {
+        if (d != 0 && (int) x.size() != d) {
+          std::stringstream msg;
+          msg << "MultiTauCorrelator: sample of size " << x.size() << ", expected " << d;
+          err.setException(msg.str());
+        } else {
+          add(x);
+        }
+      }
+      err.checkException();
+    }
+
+    bool MultiTauCorrelator::getVelocities(std::vector< real >& x) {
+      System& system = getSystemRef();
+
+      std::vector< longint > ids;
+      std::vector< real > v;
+      CellList realCells = system.storage->getRealCells();
+      for (CellListIterator cit(realCells); !cit.isDone(); ++cit) {
+        ids.push_back(cit->id());
+        v.push_back(cit->velocity()[0]);
+        v.push_back(cit->velocity()[1]);
+        v.push_back(cit->velocity()[2]);
+      }
+
+      if (system.comm->rank() != 0) {
+        boost::mpi::gather(*system.comm, ids, 0);
+        boost::mpi::gather(*system.comm, v, 0);
+        return true;
+      }
+
+      std::vector< std::vector< longint > > allIds;
+      std::vector< std::vector< real > > allV;
+      boost::mpi::gather(*system.comm, ids, allIds, 0);
+      boost::mpi::gather(*system.comm, v, allV, 0);
+
+      // the first sample fixes the channels, in the order of the ids
+      if (idToChannel.empty()) {
+        std::vector< longint > sortedIds;
+        for (size_t r = 0; r < allIds.size(); ++r) {
+          sortedIds.insert(sortedIds.end(), allIds[r].begin(), allIds[r].end());
+        }
+        std::sort(sortedIds.begin(), sortedIds.end());
+        for (size_t i = 0; i < sortedIds.size(); ++i) {
+          idToChannel[sortedIds[i]] = 3 * i;
+        }
+      }
+
+      x.assign(3 * idToChannel.size(), 0.0);
+      size_t n = 0;
+      for (size_t r = 0; r < allIds.size(); ++r) {
+        for (size_t i = 0; i < allIds[r].size(); ++i) {
+          boost::unordered_map< longint, int >::const_iterator it = idToChannel.find(allIds[r][i]);
+          if (it == idToChannel.end()) return false;
+          x[it->second] = allV[r][3 * i];
+          x[it->second + 1] = allV[r][3 * i + 1];
+          x[it->second + 2] = allV[r][3 * i + 2];
+          n++;
+        }
+      }
+      return n == idToChannel.size();
+    }
+
+    void MultiTauCorrelator::add(const std::vector< real >& x) {
+      if (d == 0) allocate(x.size());
+      nSamples++;
+      if (exact) {
+        for (int c = 0; c < d; ++c) series[c].push_back(x[c]);
+      }
+      addLevel(&x[0], 0);
+    }
+
+    void MultiTauCorrelator::addLevel(const real* x, int k) {
+      std::vector< real >& sh = shift[k];
+      int pos = insertIndex[k];
+      std::copy(x, x + d, &sh[pos * d]);
+      nInserted[k]++;
+
+      // correlate the new entry with the stored ones, lags below p/m are
+      // already covered by the finer level
+      int jmin = (k == 0) ? 0 : p / m;
+      int jmax = std::min< longint >(p, nInserted[k]);
+      for (int j = jmin; j < jmax; ++j) {
+        const real* y = &sh[((pos - j + p) % p) * d];
+        real sum = 0.0;
+        for (int c = 0; c < d; ++c) sum += x[c] * y[c];
+        correlation[k][j] += sum;
+        nCorrelation[k][j]++;
+      }
+      insertIndex[k] = (pos + 1) % p;
+
+      // pass the block average on to the next level
+      if (k + 1 < numLevels) {
+        std::vector< real >& acc = accumulator[k];
+        for (int c = 0; c < d; ++c) acc[c] += x[c];
+        if (++nAccumulated[k] == m) {
+          for (int c = 0; c < d; ++c) {
+            average[k][c] = acc[c] / m;
+            acc[c] = 0.0;
+          }
+          nAccumulated[k] = 0;
+          addLevel(&average[k][0], k + 1);
+        }
+      }
+    }
+
+    python::list MultiTauCorrelator::compute() {
+      python::list ret;
+      longint blockSize = 1;
+      for (int k = 0; k < (int) correlation.size(); ++k, blockSize *= m) {
+        for (int j = (k == 0) ? 0 : p / m; j < p; ++j) {
+          if (nCorrelation[k][j] == 0) continue;
+          real tau = j * blockSize * dt;
+          ret.append(python::make_tuple(tau, correlation[k][j] / (nCorrelation[k][j] * d)));
+        }
+      }
+      return ret;
+    }
+
+    python::list MultiTauCorrelator::computeExact() {
+      python::list ret;
+      if (!exact) {
+        System& system = getSystemRef();
+        esutil::Error err(system.comm);
+        err.setException("MultiTauCorrelator: computeExact needs exact=True");
+        err.checkException();
+        return ret;
+      }
+      if (nSamples == 0) return ret;
+
+      // zero padding to 2n avoids the wrap around of the cyclic correlation
+      int n = nSamples;
+      int nfft = 2 * n;
+      real* in = (real*) fftw_malloc(sizeof(real) * nfft);
+      fftw_complex* out = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * (nfft / 2 + 1));
+      std::vector< real > power(nfft / 2 + 1, 0.0);
+
+      fftw_plan forward = fftw_plan_dft_r2c_1d(nfft, in, out, FFTW_ESTIMATE);
+      for (int c = 0; c < d; ++c) {
+        std::copy(series[c].begin(), series[c].end(), in);
+        std::fill(in + n, in + nfft, 0.0);
+        fftw_execute(forward);
+        for (int i = 0; i < nfft / 2 + 1; ++i) {
+          power[i] += out[i][0] * out[i][0] + out[i][1] * out[i][1];
+        }
+      }
+      fftw_destroy_plan(forward);
+
+      for (int i = 0; i < nfft / 2 + 1; ++i) {
+        out[i][0] = power[i];
+        out[i][1] = 0.0;
+      }
+      fftw_plan backward = fftw_plan_dft_c2r_1d(nfft, out, in, FFTW_ESTIMATE);
+      fftw_execute(backward);
+      fftw_destroy_plan(backward);
+
+      for (int j = 0; j < n; ++j) {
+        ret.append(python::make_tuple(j * dt, in[j] / ((real) nfft * (n - j) * d)));
+      }
+
+      fftw_free(in);
+      fftw_free(out);
+      return ret;
+    }
+
+    // Python wrapping
+    void MultiTauCorrelator::registerPython() {
+      using namespace espressopp::python;
+
+      class_< MultiTauCorrelator, bases< ParticleAccess >, boost::noncopyable >
+        ("analysis_MultiTauCorrelator",
+         init< shared_ptr< System >, shared_ptr< Observable >, int, int, int, real, bool >())
+        .def(init< shared_ptr< System >, std::string, int, int, int, real, bool >())
+        .add_property("n_samples", &MultiTauCorrelator::getNumberOfSamples)
+        .def("sample", &MultiTauCorrelator::sample)
+        .def("reset", &MultiTauCorrelator::reset)
+        .def("compute", &MultiTauCorrelator::compute)
+        .def("computeExact", &MultiTauCorrelator::computeExact)
+        ;
+    }
+  }
+}
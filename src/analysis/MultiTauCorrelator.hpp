@@ -0,0 +1,134 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _ANALYSIS_MULTITAUCORRELATOR_HPP
+#define _ANALYSIS_MULTITAUCORRELATOR_HPP
+
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#include "python.hpp"
+#include "types.hpp"
+#include "ParticleAccess.hpp"
+#include "Observable.hpp"
+
+namespace espressopp {
+  namespace analysis {
+
+    /** On-the-fly autocorrelation with the multi-tau (logarithmic block
+        averaging) scheme, J. Ramirez et al., J. Chem. Phys. 133 (2010) 154103.
+
+        Level 0 keeps the last p samples, level k keeps the last p averages
+        over blocks of m^k samples. A new entry of level k is correlated
+        with the stored entries at j = 0..p-1 (level 0) or j = p/m..p-1
+        (level k > 0), which gives the lags j m^k. Memory is
+        O(numLevels p d) and the work is O(p d) per sample on average, for
+        d channels, independent of the length of the run.
+
+        The correlation is averaged over the channels,
+        C(tau) = < x_c(t) x_c(t+tau) >_{t,c}. The sampled quantity is either
+        - an Observable with a real_scalar, int_scalar or real_vector result,
+        - "stress": the off-diagonal components xy, xz, yz of the pressure tensor,
+        - "velocity": the velocities of all particles, collected on rank 0
+          and kept in the order of the particle ids.
+
+        With exact set the full series is stored as well and computeExact()
+        returns the correlation at every lag via FFT. This memory grows with
+        the run and is meant for offline use.
+
+        perform_action() takes a sample, so the correlator can be run from
+        the integrator with ExtAnalyze. The correlations are kept on rank 0.
+    */
+    class MultiTauCorrelator : public ParticleAccess {
+    public:
+      MultiTauCorrelator(shared_ptr< System > system, shared_ptr< Observable > _observable,
+                         int _p, int _m, int _numLevels, real _dt, bool _exact);
+      MultiTauCorrelator(shared_ptr< System > system, std::string _quantity,
+                         int _p, int _m, int _numLevels, real _dt, bool _exact);
+      ~MultiTauCorrelator() {}
+
+      void perform_action() { sample(); }
+
+      /** measure the quantity and add it to the correlator */
+      void sample();
+
+      /** drop all samples and correlations */
+      void reset();
+
+      /** list of (tau, C(tau)) for all lags with data, on rank 0 */
+      python::list compute();
+
+      /** list of (tau, C(tau)) for all lags 0..n-1 of the stored series
+          (exact mode only), on rank 0 */
+      python::list computeExact();
+
+      longint getNumberOfSamples() const { return nSamples; }
+
+      static void registerPython();
+
+    private:
+      enum Quantity { OBSERVABLE, STRESS, VELOCITY };
+
+      void setup(int _p, int _m, int _numLevels, real _dt, bool _exact);
+      void allocate(int _d);
+      void add(const std::vector< real >& x);
+      void addLevel(const real* x, int k);
+      bool getVelocities(std::vector< real >& x);
+
+      Quantity quantity;
+      shared_ptr< Observable > observable;
+
+      int p;          // entries per level
+      int m;          // block size between two levels
+      int numLevels;
+      real dt;        // time between two samples
+      bool exact;
+
+      int d;          // number of channels, set by the first sample
+      longint nSamples;
+
+      // per level: ring buffer of p entries of d values, the slot of the
+      // next entry, the number of entries so far and the block sum for
+      // the next level
+      std::vector< std::vector< real > > shift;
+      std::vector< int > insertIndex;
+      std::vector< longint > nInserted;
+      std::vector< std::vector< real > > accumulator;
+      std::vector< int > nAccumulated;
+      std::vector< std::vector< real > > average;
+
+      // per level and j: sum of the products and number of samples
+      std::vector< std::vector< real > > correlation;
+      std::vector< std::vector< longint > > nCorrelation;
+
+      // full series, channel after channel (exact mode)
+      std::vector< std::vector< real > > series;
+
+      // first of the three velocity channels of each particle id
+      boost::unordered_map< longint, int > idToChannel;
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
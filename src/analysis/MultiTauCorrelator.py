@@ -0,0 +1,127 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+**************************************
+espressopp.analysis.MultiTauCorrelator
+**************************************
+
+On-the-fly autocorrelation function with the multi-tau scheme
+(J. Ramirez et al., J. Chem. Phys. 133 (2010) 154103). Unlike
+:class:`espressopp.analysis.Autocorrelation`, the series is not stored:
+the correlator keeps `levels` blocks of `p` values, where block k holds
+averages over m^k samples. Memory and work per sample are constant, the
+lags are spaced logarithmically up to p*m^(levels-1) samples.
+
+The correlation is averaged over the components of the sampled quantity,
+C(tau) = < x_c(t) x_c(t+tau) >. The quantity is either an observable
+(scalar or vector) or one of
+
+- 'stress': the off-diagonal components of the pressure tensor (for Green-Kubo viscosities)
+- 'velocity': the velocities of all particles (velocity autocorrelation function)
+
+Example:
+
+>>> corr = espressopp.analysis.MultiTauCorrelator(system, quantity='stress', dt=integrator.dt*10)
+>>> ext = espressopp.integrator.ExtAnalyze(corr, interval=10)
+>>> integrator.addExtension(ext)
+>>> integrator.run(1000000)
+>>> for tau, c in corr.compute():
+>>>   print tau, c
+
+.. function:: espressopp.analysis.MultiTauCorrelator(system, observable=None, quantity=None, p=16, m=2, levels=20, dt=1.0, exact=False)
+
+		:param system: system object
+		:param observable: observable to correlate
+		:param quantity: 'stress' or 'velocity', if no observable is given
+		:param p: number of values per block, a multiple of m
+		:param m: averaging factor between two blocks
+		:param levels: number of blocks
+		:param dt: time between two samples, used for the lags
+		:param exact: also store the full series for computeExact()
+		:type system: shared_ptr<System>
+		:type observable: shared_ptr<Observable>
+		:type quantity: str
+		:type p: int
+		:type m: int
+		:type levels: int
+		:type dt: real
+		:type exact: bool
+
+.. function:: espressopp.analysis.MultiTauCorrelator.sample()
+
+		Measures the quantity and adds it. This is what ExtAnalyze calls.
+
+.. function:: espressopp.analysis.MultiTauCorrelator.compute()
+
+		:return: list of (tau, C(tau)) tuples
+		:rtype: list
+
+.. function:: espressopp.analysis.MultiTauCorrelator.computeExact()
+
+		Correlation at all lags of the stored series, computed by FFT.
+		Only available with exact=True.
+
+		:return: list of (tau, C(tau)) tuples
+		:rtype: list
+
+.. function:: espressopp.analysis.MultiTauCorrelator.reset()
+
+		Drops all samples.
+"""
+
+from espressopp.esutil import cxxinit
+from espressopp import pmi
+
+from espressopp.ParticleAccess import *
+from _espressopp import analysis_MultiTauCorrelator
+
+class MultiTauCorrelatorLocal(ParticleAccessLocal, analysis_MultiTauCorrelator):
+
+    def __init__(self, system, observable=None, quantity=None, p=16, m=2, levels=20, dt=1.0, exact=False):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            if observable is not None:
+                cxxinit(self, analysis_MultiTauCorrelator, system, observable, p, m, levels, dt, exact)
+            else:
+                cxxinit(self, analysis_MultiTauCorrelator, system, quantity, p, m, levels, dt, exact)
+
+    def sample(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.sample(self)
+
+    def reset(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.reset(self)
+
+    def compute(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.compute(self)
+
+    def computeExact(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.computeExact(self)
+
+if pmi.isController:
+    class MultiTauCorrelator(ParticleAccess):
+        __metaclass__ = pmi.Proxy
+        pmiproxydefs = dict(
+            cls = 'espressopp.analysis.MultiTauCorrelatorLocal',
+            pmicall = [ 'sample', 'reset', 'compute', 'computeExact' ],
+            pmiproperty = [ 'n_samples' ]
+            )
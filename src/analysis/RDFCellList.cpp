@@ -0,0 +1,276 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "RDFCellList.hpp"
+#include "storage/Storage.hpp"
+#include "FixedTupleListAdress.hpp"
+#include "bc/BC.hpp"
+#include "esutil/Error.hpp"
+
+#ifndef M_PIl
+#define M_PIl 3.1415926535897932384626433832795029L
+#endif
+
+namespace espressopp {
+  namespace analysis {
+
+    LOG4ESPP_LOGGER(RDFCellList::theLogger, "RDFCellList");
+
+    RDFCellList::RDFCellList(shared_ptr< System > system, real _rMax, int _nBins,
+                             bool _atomistic, real _span)
+    : ParticleAccess(system), rMax(_rMax), nBins(_nBins), atomistic(_atomistic), span(_span) {
+      if (rMax <= 0.0 || nBins < 1) {
+        throw std::runtime_error("RDFCellList: needs rmax > 0 and at least one bin");
+      }
+      reset();
+
+      esutil::Error err(system->comm);
+      if (!cellsLargeEnough()) {
+        err.setException(tooSmallMessage());
+      }
+      err.checkException();
+    }
+
+    bool RDFCellList::cellsLargeEnough() {
+      // the partners come from the ghost layer, which is one cell wide
+      storage::Storage& storage = *getSystemRef().storage;
+      Int3D cellGrid = storage.getInt3DCellGrid();
+      real cellSize = std::min(std::min(
+        (storage.getLocalBoxXMax() - storage.getLocalBoxXMin()) / cellGrid[0],
+        (storage.getLocalBoxYMax() - storage.getLocalBoxYMin()) / cellGrid[1]),
+        (storage.getLocalBoxZMax() - storage.getLocalBoxZMin()) / cellGrid[2]);
+      return rMax <= cellSize;
+    }
+
+    std::string RDFCellList::tooSmallMessage() const {
+      std::stringstream msg;
+      msg << "RDFCellList: rmax " << rMax << " is larger than the cells, "
+          << "use fewer cells or a smaller rmax";
+      return msg.str();
+    }
+
+    void RDFCellList::reset() {
+      nSamples = 0;
+      sumVolume = 0.0;
+      cellsTooSmall = false;
+      missingTuples = false;
+      histograms.clear();
+      nReference.clear();
+      nParticles.clear();
+    }
+
+    bool RDFCellList::isReference(const Site& s, real Lx, real halfLx) const {
+      if (span <= 0.0) return true;
+      // ghosts carry shifted images
+      real x = s.pos[0] - floor(s.pos[0] / Lx) * Lx;
+      return fabs(x - halfLx) < span;
+    }
+
+    void RDFCellList::collectSites(std::vector< std::vector< Site > >& sites) {
+      storage::Storage& storage = *getSystemRef().storage;
+      CellList& localCells = storage.getLocalCells();
+      shared_ptr< FixedTupleListAdress > fixedtupleList = storage.getFixedTuples();
+
+      std::vector< bool > isReal(localCells.size(), false);
+      CellList& realCells = storage.getRealCells();
+      for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+        isReal[*it - storage.getFirstCell()] = true;
+      }
+
+      sites.resize(localCells.size());
+      for (size_t c = 0; c < localCells.size(); ++c) {
+        std::vector< Site >& cs = sites[c];
+        cs.clear();
+        ParticleList& pl = localCells[c]->particles;
+        for (size_t k = 0; k < pl.size(); ++k) {
+          Particle& p = pl[k];
+          if (!atomistic) {
+            Site s = { p.position(), (int) p.type(), p.id() };
+            cs.push_back(s);
+            continue;
+          }
+          FixedTupleListAdress::iterator it;
+          if (!fixedtupleList || (it = fixedtupleList->find(&p)) == fixedtupleList->end()) {
+            if (isReal[c]) missingTuples = true;
+            continue;
+          }
+          for (std::vector< Particle* >::iterator at = it->second.begin(); at != it->second.end(); ++at) {
+            Site s = { (*at)->position(), (int) (*at)->type(), p.id() };
+            cs.push_back(s);
+          }
+        }
+      }
+    }
+
+    void RDFCellList::addPair(const Site& s1, const Site& s2, real Lx, real halfLx) {
+      Real3D d = s1.pos - s2.pos;
+      real r2 = d.sqr();
+      if (r2 >= rMax * rMax) return;
+      int bin = (int) (sqrt(r2) * nBins / rMax);
+      if (bin >= nBins) return;
+      if (isReference(s1, Lx, halfLx)) {
+        std::vector< real >& h = histograms[std::make_pair(s1.type, s2.type)];
+        if (h.empty()) h.resize(nBins, 0.0);
+        h[bin] += 1.0;
+      }
+      if (isReference(s2, Lx, halfLx)) {
+        std::vector< real >& h = histograms[std::make_pair(s2.type, s1.type)];
+        if (h.empty()) h.resize(nBins, 0.0);
+        h[bin] += 1.0;
+      }
+    }
+
+    void RDFCellList::sample() {
+      System& system = getSystemRef();
+      storage::Storage& storage = *system.storage;
+
+      // the cells may have shrunk since the constructor checked them,
+      // e.g. by load balancing
+      if (!cellsLargeEnough()) {
+        cellsTooSmall = true;
+        return;
+      }
+
+      Real3D L = system.bc->getBoxL();
+      real Lx = L[0];
+      real halfLx = 0.5 * L[0];
+
+      std::vector< std::vector< Site > > sites;
+      collectSites(sites);
+
+      CellList& realCells = storage.getRealCells();
+      const Cell* firstCell = storage.getFirstCell();
+      for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+        const std::vector< Site >& cs = sites[*it - firstCell];
+        for (size_t k = 0; k < cs.size(); ++k) {
+          nParticles[cs[k].type] += 1.0;
+          if (isReference(cs[k], Lx, halfLx)) nReference[cs[k].type] += 1.0;
+
+          // same order of candidates as the CellListAllPairsIterator
+          for (size_t l = k + 1; l < cs.size(); ++l) {
+            if (cs[k].molecule != cs[l].molecule) addPair(cs[k], cs[l], Lx, halfLx);
+          }
+          for (NeighborCellList::Iterator nit((*it)->neighborCells); nit.isValid(); ++nit) {
+            if (nit->useForAllPairs) continue;
+            const std::vector< Site >& ns = sites[nit->cell - firstCell];
+            for (size_t l = 0; l < ns.size(); ++l) {
+              addPair(cs[k], ns[l], Lx, halfLx);
+            }
+          }
+        }
+      }
+
+      sumVolume += L[0] * L[1] * L[2];
+      nSamples++;
+    }
+
+    python::list RDFCellList::compute(int type1, int type2) {
+      System& system = getSystemRef();
+      esutil::Error err(system.comm);
+      if (cellsTooSmall) {
+        err.setException(tooSmallMessage());
+      }
+      if (missingTuples) {
+        err.setException("RDFCellList: atomistic mode, but no atomistic AdResS particles found");
+      }
+      err.checkException();
+
+      python::list ret;
+      if (nSamples == 0) return ret;
+
+      // the only communication: all histograms and counts in one reduction
+      int maxType = -1;
+      for (std::map< int, real >::const_iterator it = nParticles.begin(); it != nParticles.end(); ++it) {
+        maxType = std::max(maxType, it->first);
+      }
+      // partners in the ghost layer may have types without local particles
+      for (std::map< std::pair< int, int >, std::vector< real > >::const_iterator it = histograms.begin();
+           it != histograms.end(); ++it) {
+        maxType = std::max(maxType, std::max(it->first.first, it->first.second));
+      }
+      int globalMaxType;
+      boost::mpi::all_reduce(*system.comm, maxType, globalMaxType, boost::mpi::maximum< int >());
+      int ntypes = globalMaxType + 1;
+
+      std::vector< real > local(ntypes * ntypes * nBins + 2 * ntypes, 0.0);
+      real* nRef = &local[ntypes * ntypes * nBins];
+      real* nPart = nRef + ntypes;
+      for (std::map< std::pair< int, int >, std::vector< real > >::const_iterator it = histograms.begin();
+           it != histograms.end(); ++it) {
+        std::copy(it->second.begin(), it->second.end(),
+                  &local[(it->first.first * ntypes + it->first.second) * nBins]);
+      }
+      for (std::map< int, real >::const_iterator it = nReference.begin(); it != nReference.end(); ++it) {
+        nRef[it->first] = it->second;
+      }
+      for (std::map< int, real >::const_iterator it = nParticles.begin(); it != nParticles.end(); ++it) {
+        nPart[it->first] = it->second;
+      }
+      std::vector< real > total(local.size(), 0.0);
+      boost::mpi::all_reduce(*system.comm, &local[0], local.size(), &total[0], std::plus< real >());
+
+      std::vector< real > hist(nBins, 0.0);
+      real nA = 0.0, nB = 0.0;
+      for (int a = 0; a < ntypes; ++a) {
+        if (type1 >= 0 && a != type1) continue;
+        nA += total[ntypes * ntypes * nBins + a];
+        for (int b = 0; b < ntypes; ++b) {
+          if (type2 >= 0 && b != type2) continue;
+          const real* h = &total[(a * ntypes + b) * nBins];
+          for (int i = 0; i < nBins; ++i) hist[i] += h[i];
+        }
+      }
+      for (int b = 0; b < ntypes; ++b) {
+        if (type2 >= 0 && b != type2) continue;
+        nB += total[ntypes * ntypes * nBins + ntypes + b];
+      }
+
+      // nA and nB are sums over the samples, as is sumVolume
+      real rhoB = nB / sumVolume;
+      real dr = rMax / nBins;
+      for (int i = 0; i < nBins; ++i) {
+        real r0 = i * dr;
+        real r1 = r0 + dr;
+        real shell = 4.0 / 3.0 * M_PIl * (r1 * r1 * r1 - r0 * r0 * r0);
+        real norm = nA * rhoB * shell;
+        ret.append(python::make_tuple(r0 + 0.5 * dr, norm > 0.0 ? hist[i] / norm : 0.0));
+      }
+      return ret;
+    }
+
+    // Python wrapping
+    void RDFCellList::registerPython() {
+      using namespace espressopp::python;
+
+      class_< RDFCellList, bases< ParticleAccess >, boost::noncopyable >
+        ("analysis_RDFCellList", init< shared_ptr< System >, real, int, bool, real >())
+        .add_property("n_samples", &RDFCellList::getNumberOfSamples)
+        .def("sample", &RDFCellList::sample)
+        .def("reset", &RDFCellList::reset)
+        .def("compute", &RDFCellList::compute)
+        ;
+    }
+  }
+}
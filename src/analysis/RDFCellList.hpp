@@ -0,0 +1,119 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _ANALYSIS_RDFCELLLIST_HPP
+#define _ANALYSIS_RDFCELLLIST_HPP
+
+#include <map>
+#include <vector>
+
+#include "python.hpp"
+#include "types.hpp"
+#include "Real3D.hpp"
+#include "ParticleAccess.hpp"
+
+namespace espressopp {
+  namespace analysis {
+
+    /** Radial distribution functions from the cell grid of the domain
+        decomposition.
+
+        Unlike RadialDistrF and RDFatomistic, the configuration is not
+        broadcast: every node loops over the pairs of its real cells and
+        their neighbor cells, as the Verlet list does, so the ghost layer
+        of one cell provides all partners up to rMax. rMax therefore must
+        not exceed the smallest cell size, which the constructor checks
+        collectively; cells that shrink later are reported by compute().
+        The work is O(N rMax^3) and the memory O(nBins) per type pair.
+
+        Each sample adds to local histograms per (reference type, partner
+        type) and to the number of reference particles and of particles
+        of each type. Nothing is communicated until compute(), which
+        reduces all histograms at once, so sampling every few steps with
+        ExtAnalyze costs about as much as one Verlet list rebuild.
+
+        g_ab(r) = H_ab(r) / (N_a rho_b V_shell(r)), summed over the samples,
+        with rho_b = N_b / V.
+
+        In atomistic mode the sites are the AdResS atomistic particles of
+        the fixed tuples and pairs within the same molecule are skipped.
+        With span > 0 only the sites with |x - Lx/2| < span are taken as
+        reference particles, as in the span based RDFatomistic.
+    */
+    class RDFCellList : public ParticleAccess {
+    public:
+      RDFCellList(shared_ptr< System > system, real _rMax, int _nBins,
+                  bool _atomistic, real _span);
+      ~RDFCellList() {}
+
+      void perform_action() { sample(); }
+
+      /** add the pairs of the current configuration to the histograms */
+      void sample();
+
+      /** drop all samples */
+      void reset();
+
+      /** list of (r, g(r)) for the types type1 and type2 over all samples,
+          a negative type stands for all types */
+      python::list compute(int type1, int type2);
+
+      longint getNumberOfSamples() const { return nSamples; }
+
+      static void registerPython();
+
+    private:
+      struct Site {
+        Real3D pos;
+        int type;
+        size_t molecule;  // id of the VP the site belongs to
+      };
+
+      void collectSites(std::vector< std::vector< Site > >& sites);
+      void addPair(const Site& s1, const Site& s2, real Lx, real halfLx);
+      bool isReference(const Site& s, real Lx, real halfLx) const;
+      bool cellsLargeEnough();
+      std::string tooSmallMessage() const;
+
+      real rMax;
+      int nBins;
+      bool atomistic;
+      real span;
+
+      longint nSamples;
+      real sumVolume;
+
+      // problems found while sampling, reported collectively by compute()
+      bool cellsTooSmall;
+      bool missingTuples;
+
+      // local sums over the samples, keyed by (reference type, partner type)
+      // and by type
+      std::map< std::pair< int, int >, std::vector< real > > histograms;
+      std::map< int, real > nReference;
+      std::map< int, real > nParticles;
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
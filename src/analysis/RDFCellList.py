@@ -0,0 +1,117 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+*******************************
+espressopp.analysis.RDFCellList
+*******************************
+
+Radial distribution functions from the cell grid of the domain
+decomposition. Every node only looks at the pairs of its own cells and of
+the ghost layer, so the cost grows with N rmax^3 instead of N^2 and no
+configuration is broadcast. rmax must not be larger than the smallest cell
+of the domain decomposition, i.e. the local box length divided by the
+number of cells in that direction. With the cell grid of
+espressopp.tools.decomp.cellGrid(box, nodeGrid, rc, skin) the cells are at
+least rc + skin, so any rmax <= rc + skin works. The constructor raises an
+error for a larger rmax; if the cells shrink later, e.g. by load balancing,
+compute() raises it.
+
+Each sample is added to local histograms of all pairs of particle types.
+The nodes only communicate in compute(), which combines all samples so far:
+
+.. math:: g_{ab}(r) = \frac{H_{ab}(r)}{N_a \rho_b V_{shell}(r)}
+
+With atomistic=True the AdResS atomistic particles are used, as in
+:class:`espressopp.analysis.RDFatomistic`, and pairs within one molecule are
+skipped. With span > 0 only the particles with \|x - Lx/2\| < span are taken as
+reference particles.
+
+Example:
+
+>>> rdf = espressopp.analysis.RDFCellList(system, rmax=2.5, bins=100)
+>>> ext = espressopp.integrator.ExtAnalyze(rdf, interval=100)
+>>> integrator.addExtension(ext)
+>>> integrator.run(100000)
+>>> for r, g in rdf.compute(type1=0, type2=1):
+>>>   print r, g
+
+.. function:: espressopp.analysis.RDFCellList(system, rmax, bins=100, atomistic=False, span=0.0)
+
+		:param system: system object
+		:param rmax: largest distance, at most the smallest cell size
+		:param bins: number of bins
+		:param atomistic: use the atomistic AdResS particles
+		:param span: half width of the slab of reference particles, 0 for all
+		:type system: shared_ptr<System>
+		:type rmax: real
+		:type bins: int
+		:type atomistic: bool
+		:type span: real
+
+.. function:: espressopp.analysis.RDFCellList.sample()
+
+		Adds the current configuration. This is what ExtAnalyze calls.
+
+.. function:: espressopp.analysis.RDFCellList.compute(type1=-1, type2=-1)
+
+		:param type1: type of the reference particles, -1 for all
+		:param type2: type of the partners, -1 for all
+		:type type1: int
+		:type type2: int
+		:return: list of (r, g(r)) tuples
+		:rtype: list
+
+.. function:: espressopp.analysis.RDFCellList.reset()
+
+		Drops all samples.
+"""
+
+from espressopp.esutil import cxxinit
+from espressopp import pmi
+
+from espressopp.ParticleAccess import *
+from _espressopp import analysis_RDFCellList
+
+class RDFCellListLocal(ParticleAccessLocal, analysis_RDFCellList):
+
+    def __init__(self, system, rmax, bins=100, atomistic=False, span=0.0):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            cxxinit(self, analysis_RDFCellList, system, rmax, bins, atomistic, span)
+
+    def sample(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.sample(self)
+
+    def reset(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.reset(self)
+
+    def compute(self, type1=-1, type2=-1):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.compute(self, type1, type2)
+
+if pmi.isController:
+    class RDFCellList(ParticleAccess):
+        __metaclass__ = pmi.Proxy
+        pmiproxydefs = dict(
+            cls = 'espressopp.analysis.RDFCellListLocal',
+            pmicall = [ 'sample', 'reset', 'compute' ],
+            pmiproperty = [ 'n_samples' ]
+            )
@@ -32,6 +32,8 @@ Option 2 (spanbased = False): the routine can also calculate unnormalized RDFs u
 
 In any case, only pairs of atomistic particles belonging to two different coarse-grained particles are considered. Furthermore, note that the routine uses L_y / half (L_y is the box length in y-direction) as the maximum distance for the RDF calculation, which is then binned according to rdfN during the computation. Hence, L_y should be the shortest box side (or, equally short as L_x and/or L_z).
 
+The configuration is broadcast to all nodes and all pairs are looped over. For large systems and for averages over many configurations, :class:`espressopp.analysis.RDFCellList` with atomistic=True works on the cell grid instead.
+
 Examples:
 
 >>> rdf_0_1 = espressopp.analysis.RDFatomistic(system = system, type1 = 0, type2 = 1, spanbased = True, span = 1.5)
@@ -24,6 +24,10 @@ r"""
 espressopp.analysis.RadialDistrF
 ********************************
 
+Radial distribution function up to half the box length. The configuration
+is broadcast to all nodes and all pairs are looped over, which costs
+O(N^2). For large systems and for averages over many configurations use
+:class:`espressopp.analysis.RDFCellList`.
 
 .. function:: espressopp.analysis.RadialDistrF(system)
 
@@ -24,6 +24,10 @@ r"""
 espressopp.analysis.StaticStructF
 *********************************
 
+Structure factor from direct sums over the particles for every q vector.
+This costs O(N Nq) and one reduction per q vector;
+:class:`espressopp.analysis.StaticStructFMesh` uses an FFT of the density
+instead.
 
 .. function:: espressopp.analysis.StaticStructF(system)
 
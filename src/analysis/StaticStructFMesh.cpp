@@ -0,0 +1,261 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "StaticStructFMesh.hpp"
+#include "storage/Storage.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "bc/BC.hpp"
+#include "esutil/Error.hpp"
+
+#ifndef M_PIl
+#define M_PIl 3.1415926535897932384626433832795029L
+#endif
+
+namespace espressopp {
+  namespace analysis {
+
+    using namespace iterator;
+
+    LOG4ESPP_LOGGER(StaticStructFMesh::theLogger, "StaticStructFMesh");
+
+    // B-spline weights M_P(w + P-1-j), j = 0..P-1, of mesh points
+    // floor(u)-P+1+j for a particle at u = floor(u) + w
+    static void bsplineWeights(real w, int P, real* data) {
+      data[0] = 1.0;
+      for (int n = 2; n <= P; n++) {
+        real div = 1.0 / (n - 1);
+        data[n-1] = div * w * data[n-2];
+        for (int k = 1; k < n - 1; k++) {
+          data[n-k-1] = div * ((w + k) * data[n-k-2] + (n - k - w) * data[n-k-1]);
+        }
+        data[0] = div * (1.0 - w) * data[0];
+      }
+    }
+
+    StaticStructFMesh::StaticStructFMesh(shared_ptr< System > system, Int3D _M, int _P,
+                                         int _nBins, real _qMax)
+    : ParticleAccess(system), M(_M), P(_P), nBins(_nBins), qMax(_qMax) {
+      if (P < 1 || P > 7 || P > M[0] || P > M[1] || P > M[2] || nBins < 1) {
+        throw std::runtime_error("StaticStructFMesh: the assignment order has to be in 1..7 and "
+                                 "not larger than the mesh, and at least one bin is needed");
+      }
+
+      Real3D L = system->bc->getBoxL();
+      if (qMax <= 0.0) {
+        qMax = M_PIl * std::min(std::min(M[0] / L[0], M[1] / L[1]), M[2] / L[2]);
+      }
+
+      for (int d = 0; d < 3; d++) {
+        window[d].resize(M[d]);
+        for (int k = 0; k < M[d]; k++) {
+          int m = (2 * k <= M[d]) ? k : k - M[d];
+          real x = M_PIl * m / M[d];
+          real sinc = (m == 0) ? 1.0 : sin(x) / x;
+          window[d][k] = 1.0 / pow(sinc, P);
+        }
+      }
+
+      fft = make_shared< esutil::SlabFFT >(system->comm, M, FFTW_ESTIMATE);
+      meshes.push_back(fft->allocate());
+      reset();
+    }
+
+    StaticStructFMesh::~StaticStructFMesh() {
+      for (size_t c = 0; c < meshes.size(); c++) fftw_free(meshes[c]);
+    }
+
+    void StaticStructFMesh::addType(int type) {
+      if (std::find(types.begin(), types.end(), type) != types.end()) return;
+      types.push_back(type);
+      meshes.push_back(fft->allocate());
+      reset();
+    }
+
+    void StaticStructFMesh::reset() {
+      size_t nm = meshes.size();
+      nSamples = 0;
+      nK.assign(nBins, 0.0);
+      sumQ.assign(nBins, 0.0);
+      sumRho2.assign(nBins * nm * nm, 0.0);
+      nParticles.assign(nm, 0.0);
+    }
+
+    int StaticStructFMesh::channel(int type) const {
+      if (type < 0) return 0;
+      std::vector< int >::const_iterator it = std::find(types.begin(), types.end(), type);
+      return (it == types.end()) ? -1 : 1 + (it - types.begin());
+    }
+
+    void StaticStructFMesh::spread(real Linv[3]) {
+      CellList realCells = getSystemRef().storage->getRealCells();
+      size_t nm = meshes.size();
+
+      std::vector< Int3D > g;
+      std::vector< real > w;
+      std::vector< int > ch;
+      for (CellListIterator it(realCells); it.isValid(); ++it) {
+        Int3D Gi;
+        for (int d = 0; d < 3; d++) {
+          real u = it->position()[d] * M[d] * Linv[d];
+          real fl = floor(u);
+          Gi[d] = (int) fl - P + 1;
+          w.resize(w.size() + P);
+          bsplineWeights(u - fl, P, &w[w.size() - P]);
+        }
+        g.push_back(Gi);
+        ch.push_back(channel(it->type()));
+      }
+
+      fft->brickFor(g, P, brickLo, brickLen);
+      bricks.resize(nm);
+      for (size_t c = 0; c < nm; c++) {
+        bricks[c].assign((size_t) brickLen[0] * brickLen[1] * brickLen[2], 0.0);
+      }
+
+      for (size_t n = 0; n < g.size(); n++) {
+        const real* wn = &w[3 * P * n];
+        fft->spread(brickLo, brickLen, g[n], P, wn, 1.0, &bricks[0][0]);
+        nParticles[0] += 1.0;
+        if (ch[n] > 0) {
+          fft->spread(brickLo, brickLen, g[n], P, wn, 1.0, &bricks[ch[n]][0]);
+          nParticles[ch[n]] += 1.0;
+        }
+      }
+    }
+
+    void StaticStructFMesh::bin(real Linv[3]) {
+      size_t nm = meshes.size();
+      int kyStart = fft->getLocalKYStart();
+      int nky = fft->getLocalNKY();
+      real dq = qMax / nBins;
+
+      size_t idx = 0;
+      for (int y = 0; y < nky; y++) {
+        int ky = kyStart + y;
+        int my = (2 * ky <= M[1]) ? ky : ky - M[1];
+        for (int kx = 0; kx < M[0]; kx++) {
+          int mx = (2 * kx <= M[0]) ? kx : kx - M[0];
+          for (int kz = 0; kz < M[2]; kz++, idx++) {
+            int mz = (2 * kz <= M[2]) ? kz : kz - M[2];
+            // skip k = 0 and the Nyquist planes, which are not symmetric
+            if (mx == 0 && my == 0 && mz == 0) continue;
+            if (2 * mx == M[0] || 2 * my == M[1] || 2 * mz == M[2]) continue;
+
+            real qx = 2.0 * M_PIl * mx * Linv[0];
+            real qy = 2.0 * M_PIl * my * Linv[1];
+            real qz = 2.0 * M_PIl * mz * Linv[2];
+            real q = sqrt(qx * qx + qy * qy + qz * qz);
+            if (q >= qMax) continue;
+            int b = (int) (q / dq);
+
+            real corr = window[0][kx] * window[1][ky] * window[2][kz];
+            corr *= corr;
+            nK[b] += 1.0;
+            sumQ[b] += q;
+            real* s = &sumRho2[b * nm * nm];
+            for (size_t c1 = 0; c1 < nm; c1++) {
+              const fftw_complex& r1 = meshes[c1][idx];
+              for (size_t c2 = c1; c2 < nm; c2++) {
+                const fftw_complex& r2 = meshes[c2][idx];
+                s[c1 * nm + c2] += corr * (r1[0] * r2[0] + r1[1] * r2[1]);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    void StaticStructFMesh::sample() {
+      Real3D L = getSystemRef().bc->getBoxL();
+      real Linv[3] = { 1.0 / L[0], 1.0 / L[1], 1.0 / L[2] };
+
+      spread(Linv);
+      for (size_t c = 0; c < meshes.size(); c++) {
+        fft->addBricks(brickLo, brickLen, bricks[c], meshes[c]);
+        fft->forward(meshes[c]);
+      }
+      bin(Linv);
+      nSamples++;
+    }
+
+    python::list StaticStructFMesh::compute(int type1, int type2) {
+      System& system = getSystemRef();
+      esutil::Error err(system.comm);
+      int c1 = channel(type1);
+      int c2 = channel(type2);
+      if (c1 < 0 || c2 < 0) {
+        std::stringstream msg;
+        msg << "StaticStructFMesh: no mesh for type " << (c1 < 0 ? type1 : type2)
+            << ", use addType";
+        err.setException(msg.str());
+      }
+      err.checkException();
+      if (c1 > c2) std::swap(c1, c2);
+
+      python::list ret;
+      if (nSamples == 0) return ret;
+
+      // the only communication: all sums in one reduction
+      size_t nm = meshes.size();
+      std::vector< real > local;
+      local.reserve(2 * nBins + sumRho2.size() + nm);
+      local.insert(local.end(), nK.begin(), nK.end());
+      local.insert(local.end(), sumQ.begin(), sumQ.end());
+      local.insert(local.end(), sumRho2.begin(), sumRho2.end());
+      local.insert(local.end(), nParticles.begin(), nParticles.end());
+      std::vector< real > total(local.size(), 0.0);
+      boost::mpi::all_reduce(*system.comm, &local[0], local.size(), &total[0], std::plus< real >());
+
+      const real* totNK = &total[0];
+      const real* totQ = totNK + nBins;
+      const real* totRho2 = totQ + nBins;
+      const real* totN = totRho2 + sumRho2.size();
+
+      // nK and the particle numbers are sums over the samples
+      real norm = sqrt(totN[c1] * totN[c2]) / nSamples;
+      for (int b = 0; b < nBins; b++) {
+        if (totNK[b] == 0.0) continue;
+        real s = (norm > 0.0) ? totRho2[(b * nm + c1) * nm + c2] / (totNK[b] * norm) : 0.0;
+        ret.append(python::make_tuple(totQ[b] / totNK[b], s));
+      }
+      return ret;
+    }
+
+    // Python wrapping
+    void StaticStructFMesh::registerPython() {
+      using namespace espressopp::python;
+
+      class_< StaticStructFMesh, bases< ParticleAccess >, boost::noncopyable >
+        ("analysis_StaticStructFMesh", init< shared_ptr< System >, Int3D, int, int, real >())
+        .add_property("n_samples", &StaticStructFMesh::getNumberOfSamples)
+        .def("addType", &StaticStructFMesh::addType)
+        .def("sample", &StaticStructFMesh::sample)
+        .def("reset", &StaticStructFMesh::reset)
+        .def("compute", &StaticStructFMesh::compute)
+        ;
+    }
+  }
+}
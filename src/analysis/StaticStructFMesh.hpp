@@ -0,0 +1,120 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _ANALYSIS_STATICSTRUCTFMESH_HPP
+#define _ANALYSIS_STATICSTRUCTFMESH_HPP
+
+#include <vector>
+#include <fftw3.h>
+
+#include "python.hpp"
+#include "types.hpp"
+#include "Int3D.hpp"
+#include "ParticleAccess.hpp"
+#include "esutil/SlabFFT.hpp"
+
+namespace espressopp {
+  namespace analysis {
+
+    /** Static structure factor from the Fourier transform of the density
+        on a mesh.
+
+        The particles are spread onto an M[0] x M[1] x M[2] mesh with
+        B-splines of order P, as in CoulombKSpaceSPME, and the mesh is
+        transformed with the distributed esutil::SlabFFT. rho(k) is
+        divided by the transform of the assignment window,
+        prod_d sinc(pi m_d / M_d)^P, and |rho(k)|^2 is binned in |q|
+        up to qMax. The cost per sample is O(N P^3 + M^3 log M) instead
+        of O(N Nq) for StaticStructF.
+
+        Besides all particles, a density mesh is kept for every type
+        added with addType(), which gives the partial structure factors
+        S_ab(q) = Re < rho_a(q) rho_b(q)^* > / sqrt(N_a N_b).
+
+        Every node bins the k vectors of its k space slab. The sums are
+        kept over all samples and only reduced in compute(), so sampling
+        costs one spreading and one FFT per mesh. Aliasing grows towards
+        the Nyquist wave number pi M_d / L_d, which is the default qMax.
+    */
+    class StaticStructFMesh : public ParticleAccess {
+    public:
+      StaticStructFMesh(shared_ptr< System > system, Int3D _M, int _P,
+                        int _nBins, real _qMax);
+      ~StaticStructFMesh();
+
+      void perform_action() { sample(); }
+
+      /** add a mesh for the particles of the given type, resets the samples */
+      void addType(int type);
+
+      /** spread, transform and bin the current configuration */
+      void sample();
+
+      /** drop all samples */
+      void reset();
+
+      /** list of (q, S(q)) over all samples for the types type1 and type2,
+          a negative type stands for all particles */
+      python::list compute(int type1, int type2);
+
+      longint getNumberOfSamples() const { return nSamples; }
+
+      static void registerPython();
+
+    private:
+      void spread(real Linv[3]);
+      void bin(real Linv[3]);
+      int channel(int type) const;
+
+      Int3D M;
+      int P;
+      int nBins;
+      real qMax;
+
+      // types with their own mesh, mesh 0 holds all particles
+      std::vector< int > types;
+
+      shared_ptr< esutil::SlabFFT > fft;
+      std::vector< fftw_complex* > meshes;
+
+      // brick covering the stencils of the local particles, one per mesh
+      Int3D brickLo, brickLen;
+      std::vector< std::vector< real > > bricks;
+
+      // window correction 1/sinc(pi m/M)^P per direction
+      std::vector< real > window[3];
+
+      longint nSamples;
+
+      // local sums over the samples: per bin the number of k vectors and
+      // their |q|, per bin and pair of meshes Re rho_a rho_b^*, per mesh
+      // the number of particles
+      std::vector< real > nK;
+      std::vector< real > sumQ;
+      std::vector< real > sumRho2;
+      std::vector< real > nParticles;
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
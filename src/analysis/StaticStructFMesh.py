@@ -0,0 +1,117 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+*************************************
+espressopp.analysis.StaticStructFMesh
+*************************************
+
+Static structure factor from the FFT of the density on a mesh. The
+particles are spread onto the mesh with B-splines of order P, the mesh is
+transformed with the distributed FFT of the k space Coulomb methods and the
+assignment window is divided out. |rho(q)|^2 is binned in |q| from 0 to
+qmax:
+
+.. math:: S(q) = \frac{1}{N} \langle |\rho(\mathbf{q})|^2 \rangle_{|\mathbf{q}| = q}
+
+For every type in types a separate mesh is kept, which gives the partial
+structure factors
+
+.. math:: S_{ab}(q) = \frac{1}{\sqrt{N_a N_b}} \langle \mathrm{Re}\, \rho_a(\mathbf{q}) \rho_b(\mathbf{q})^* \rangle
+
+The samples are summed up on every node and only combined in compute().
+Aliasing grows towards the Nyquist wave number pi M/L, the default qmax, so
+the mesh should be about twice as fine as the largest q of interest.
+
+Example:
+
+>>> sq = espressopp.analysis.StaticStructFMesh(system, mesh=(64, 64, 64), P=5, bins=200, types=[0, 1])
+>>> ext = espressopp.integrator.ExtAnalyze(sq, interval=100)
+>>> integrator.addExtension(ext)
+>>> integrator.run(100000)
+>>> for q, s in sq.compute(type1=0, type2=1):
+>>>   print q, s
+
+.. function:: espressopp.analysis.StaticStructFMesh(system, mesh, P=5, bins=100, qmax=0.0, types=[])
+
+		:param system: system object
+		:param mesh: number of mesh points in x, y and z
+		:param P: order of the B-spline assignment, 1 to 7
+		:param bins: number of q bins
+		:param qmax: largest q, 0 for the Nyquist wave number
+		:param types: particle types for partial structure factors
+		:type system: shared_ptr<System>
+		:type mesh: Int3D
+		:type P: int
+		:type bins: int
+		:type qmax: real
+		:type types: list of ints
+
+.. function:: espressopp.analysis.StaticStructFMesh.sample()
+
+		Adds the current configuration. This is what ExtAnalyze calls.
+
+.. function:: espressopp.analysis.StaticStructFMesh.compute(type1=-1, type2=-1)
+
+		:param type1: first type, -1 for all particles
+		:param type2: second type, -1 for all particles
+		:type type1: int
+		:type type2: int
+		:return: list of (q, S(q)) tuples, q is the mean |q| of the bin
+		:rtype: list
+
+.. function:: espressopp.analysis.StaticStructFMesh.reset()
+
+		Drops all samples.
+"""
+
+from espressopp.esutil import cxxinit
+from espressopp import pmi
+
+from espressopp.ParticleAccess import *
+from _espressopp import analysis_StaticStructFMesh
+
+class StaticStructFMeshLocal(ParticleAccessLocal, analysis_StaticStructFMesh):
+
+    def __init__(self, system, mesh, P=5, bins=100, qmax=0.0, types=[]):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            cxxinit(self, analysis_StaticStructFMesh, system, mesh, P, bins, qmax)
+            for t in types:
+                self.cxxclass.addType(self, t)
+
+    def sample(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.sample(self)
+
+    def reset(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.reset(self)
+
+    def compute(self, type1=-1, type2=-1):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.compute(self, type1, type2)
+
+if pmi.isController:
+    class StaticStructFMesh(ParticleAccess):
+        __metaclass__ = pmi.Proxy
+        pmiproxydefs = dict(
+            cls = 'espressopp.analysis.StaticStructFMeshLocal',
+            pmicall = [ 'sample', 'reset', 'compute' ],
+            pmiproperty = [ 'n_samples' ]
+            )
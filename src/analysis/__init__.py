@@ -53,9 +53,12 @@ from espressopp.analysis.MeanSquareInternalDist import *
 from espressopp.analysis.Autocorrelation import *
 from espressopp.analysis.RadialDistrF import *
 from espressopp.analysis.StaticStructF import *
+from espressopp.analysis.StaticStructFMesh import *
 from espressopp.analysis.RDFatomistic import *
+from espressopp.analysis.RDFCellList import *
 from espressopp.analysis.Energy import *
 from espressopp.analysis.Viscosity import *
+from espressopp.analysis.MultiTauCorrelator import *
 from espressopp.analysis.XDensity import *
 from espressopp.analysis.XTemperature import *
 from espressopp.analysis.XPressure import *
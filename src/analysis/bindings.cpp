@@ -47,8 +47,11 @@
 #include "Autocorrelation.hpp"
 #include "RadialDistrF.hpp"
 #include "StaticStructF.hpp"
+#include "StaticStructFMesh.hpp"
 #include "RDFatomistic.hpp"
+#include "RDFCellList.hpp"
 #include "Viscosity.hpp"
+#include "MultiTauCorrelator.hpp"
 #include "XDensity.hpp"
 #include "XTemperature.hpp"
 #include "XPressure.hpp"
@@ -113,7 +116,9 @@ namespace espressopp {
       MeanSquareInternalDist::registerPython();
       RadialDistrF::registerPython();
       StaticStructF::registerPython();
+      StaticStructFMesh::registerPython();
       RDFatomistic::registerPython();
+      RDFCellList::registerPython();
       XDensity::registerPython();
       XTemperature::registerPython();
       XPressure::registerPython();
@@ -123,6 +128,7 @@ namespace espressopp {
 
       Autocorrelation::registerPython();
       Viscosity::registerPython();
+      MultiTauCorrelator::registerPython();
 
       LBOutput::registerPython();
       LBOutputScreen::registerPython();
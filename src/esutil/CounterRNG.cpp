@@ -0,0 +1,41 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include "CounterRNG.hpp"
+
+namespace espressopp {
+  namespace esutil {
+
+    //////////////////////////////////////////////////
+    // REGISTRATION WITH PYTHON
+    //////////////////////////////////////////////////
+    void
+    CounterRNG::registerPython() {
+      using namespace espressopp::python;
+
+      class_< CounterRNG >("esutil_CounterRNG", init< boost::python::optional< long > >())
+        .def("seed", &CounterRNG::seed)
+        .def("get_seed", &CounterRNG::get_seed)
+        .def("uniform3", &CounterRNG::uniform3)
+        .def("normal3", &CounterRNG::normal3);
+    }
+  }
+}
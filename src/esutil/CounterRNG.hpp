@@ -0,0 +1,128 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _ESUTIL_COUNTERRNG_HPP
+#define _ESUTIL_COUNTERRNG_HPP
+
+#include <cmath>
+#include <boost/cstdint.hpp>
+
+#include "types.hpp"
+#include "Real3D.hpp"
+
+namespace espressopp {
+  namespace esutil {
+
+    /** Counter-based random number generator (Philox4x32-10,
+        J. K. Salmon et al., SC'11, doi:10.1145/2063384.2063405).
+
+        Unlike RNG it has no state that advances: the random numbers are a
+        pure function of the seed and a counter built from the step, one
+        or two particle ids and a stream number that tells apart different
+        uses within the same step. The noise of a particle or a pair is
+        thus independent of the order of the loops, of the number of ranks
+        and of which rank owns the particle, and the generator can be
+        called from any number of threads or vectorized loops at once.
+
+        The seed has to be the same on all ranks. Ids and the step enter
+        modulo 2^32, the stream modulo 2^16. Single particle counters use
+        the pair (id, id), which no pair of two particles can produce.
+    */
+    class CounterRNG {
+    public:
+      CounterRNG(long _seed = 12345) { seed(_seed); }
+
+      void seed(long _seed) {
+        seed_ = _seed;
+        key[0] = (boost::uint32_t)((unsigned long)_seed);
+        key[1] = (boost::uint32_t)((unsigned long long)(unsigned long)_seed >> 32);
+      }
+
+      long get_seed() const { return seed_; }
+
+      /** four uniformly distributed numbers in (0,1) for a particle */
+      void uniform4(longint step, longint id, int stream, real* u) const {
+        uniform4(step, id, id, stream, u);
+      }
+
+      /** four uniformly distributed numbers in (0,1) for a pair of
+          particles, the same for (id1, id2) and (id2, id1) */
+      void uniform4(longint step, longint id1, longint id2, int stream, real* u) const {
+        if (id2 < id1) { longint tmp = id1; id1 = id2; id2 = tmp; }
+        boost::uint32_t ctr[4];
+        ctr[0] = (boost::uint32_t)id1;
+        ctr[1] = (boost::uint32_t)id2;
+        ctr[2] = (boost::uint32_t)step;
+        ctr[3] = ((boost::uint32_t)stream << 16) ^ (boost::uint32_t)((unsigned long long)step >> 32);
+        philox(ctr, key[0], key[1]);
+        for (int i = 0; i < 4; i++) {
+          u[i] = (ctr[i] + 0.5) * (1.0 / 4294967296.0);
+        }
+      }
+
+      Real3D uniform3(longint step, longint id, int stream) const {
+        real u[4];
+        uniform4(step, id, stream, u);
+        return Real3D(u[0], u[1], u[2]);
+      }
+
+      /** three normally distributed numbers (mean 0, sigma 1), from
+          the Box-Muller transform of uniform4 */
+      Real3D normal3(longint step, longint id, int stream) const {
+        real u[4];
+        uniform4(step, id, stream, u);
+        real r0 = sqrt(-2.0 * log(u[0]));
+        real r1 = sqrt(-2.0 * log(u[2]));
+        return Real3D(r0 * cos(2.0 * M_PI * u[1]),
+                      r0 * sin(2.0 * M_PI * u[1]),
+                      r1 * cos(2.0 * M_PI * u[3]));
+      }
+
+      static void registerPython();
+
+    private:
+      long seed_;
+      boost::uint32_t key[2];
+
+      static void mulhilo(boost::uint32_t a, boost::uint32_t b,
+                          boost::uint32_t& hi, boost::uint32_t& lo) {
+        boost::uint64_t p = (boost::uint64_t)a * b;
+        hi = (boost::uint32_t)(p >> 32);
+        lo = (boost::uint32_t)p;
+      }
+
+      /** ten Philox rounds on the counter, in place */
+      static void philox(boost::uint32_t* ctr, boost::uint32_t k0, boost::uint32_t k1) {
+        for (int round = 0; round < 10; round++) {
+          boost::uint32_t hi0, lo0, hi1, lo1;
+          mulhilo(0xD2511F53u, ctr[0], hi0, lo0);
+          mulhilo(0xCD9E8D57u, ctr[2], hi1, lo1);
+          boost::uint32_t c0 = hi1 ^ ctr[1] ^ k0;
+          boost::uint32_t c2 = hi0 ^ ctr[3] ^ k1;
+          ctr[0] = c0; ctr[1] = lo1; ctr[2] = c2; ctr[3] = lo0;
+          k0 += 0x9E3779B9u;
+          k1 += 0xBB67AE85u;
+        }
+      }
+    };
+  }
+}
+#endif
@@ -0,0 +1,68 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+****************************
+espressopp.esutil.CounterRNG
+****************************
+
+Counter-based random number generator (Philox4x32-10). The random numbers
+are a pure function of the seed, the step, the particle id and a stream
+number, so they do not depend on the domain decomposition. The seed has to
+be the same on all CPUs.
+
+>>> crng = espressopp.esutil.CounterRNG(12345)
+>>> crng.uniform3(step, pid, 0)   # Real3D, components uniform in (0,1)
+>>> crng.normal3(step, pid, 0)    # Real3D, components normal distributed
+
+.. function:: espressopp.esutil.CounterRNG(seed)
+
+        :param seed: (default: 12345)
+        :type seed: int
+
+.. function:: espressopp.esutil.CounterRNG.uniform3(step, pid, stream)
+
+        :param step: integration step
+        :param pid: particle id
+        :param stream: number that separates independent uses in one step
+        :type step: int
+        :type pid: int
+        :type stream: int
+        :rtype: Real3D
+
+.. function:: espressopp.esutil.CounterRNG.normal3(step, pid, stream)
+
+        Same as uniform3 with normal distributed components (mean 0, sigma 1).
+"""
+from espressopp import pmi
+
+from _espressopp import esutil_CounterRNG
+
+class CounterRNGLocal(esutil_CounterRNG):
+    pass
+
+if pmi.isController:
+    class CounterRNG(object):
+        __metaclass__ = pmi.Proxy
+        'Counter-based random number generator.'
+        pmiproxydefs = dict(
+            cls = 'espressopp.esutil.CounterRNGLocal',
+            localcall = [ 'uniform3', 'normal3' ],
+            pmicall = [ 'seed', 'get_seed' ]
+            )
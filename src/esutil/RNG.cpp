@@ -24,6 +24,8 @@
 #include "RNG.hpp"
 #include "mpi.hpp"
 #include "types.hpp"
+#include <sstream>
+#include <stdexcept>
 
 using namespace boost;
 
@@ -77,6 +79,20 @@ namespace espressopp {
       return boostRNG;
     }
 
+    std::string RNG::getState() {
+      std::ostringstream os;
+      os << seed_ << ' ' << *boostRNG << ' ' << normalVariate.distribution();
+      return os.str();
+    }
+
+    void RNG::setState(const std::string& state) {
+      std::istringstream is(state);
+      is >> seed_ >> *boostRNG >> normalVariate.distribution();
+      if (!is) {
+        throw std::runtime_error("RNG: invalid state");
+      }
+    }
+
     //////////////////////////////////////////////////
     // REGISTRATION WITH PYTHON
     //////////////////////////////////////////////////
@@ -96,7 +112,9 @@ namespace espressopp {
         .def("gamma", &RNG::gammaOf1)
         .def("gamma", &RNG::gamma)
         .def("uniformOnSphere", &RNG::uniformOnSphere)
-        .def("get_seed", &RNG::get_seed);
+        .def("get_seed", &RNG::get_seed)
+        .def("getState", &RNG::getState)
+        .def("setState", &RNG::setState);
     }
   }
 }
@@ -26,6 +26,7 @@
 #include <boost/random.hpp>
 #include "Real3D.hpp"
 #include <vector>
+#include <string>
 
 
 #include "types.hpp"
@@ -73,6 +74,13 @@ namespace espressopp {
 
       shared_ptr< RNGType > getBoostRNG();
 
+      /** Gets the state of the generator and of the normal variate of
+          this CPU as text, for checkpoints. */
+      std::string getState();
+
+      /** Restores a state returned by getState(). */
+      void setState(const std::string& state);
+
       static void registerPython();
 
     private:
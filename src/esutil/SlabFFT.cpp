@@ -0,0 +1,332 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SlabFFT.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace espressopp {
+  namespace esutil {
+
+    SlabFFT::SlabFFT(shared_ptr< mpi::communicator > _comm, const Int3D& _mesh,
+                     unsigned flags)
+      : comm(_comm), mesh(_mesh),
+        plan2DForward(NULL), plan2DBackward(NULL),
+        plan1DForward(NULL), plan1DBackward(NULL)
+    {
+      if (mesh[0] < 1 || mesh[1] < 1 || mesh[2] < 1) {
+        throw std::invalid_argument("SlabFFT: mesh size has to be positive");
+      }
+
+      nprocs = comm->size();
+      rank = comm->rank();
+      xStart = blockStart(mesh[0], rank);
+      nx = blockSize(mesh[0], rank);
+      kyStart = blockStart(mesh[1], rank);
+      nky = blockSize(mesh[1], rank);
+      localSize = std::max((size_t) nx * mesh[1] * mesh[2],
+                           (size_t) nky * mesh[0] * mesh[2]);
+
+      // plans are made on a scratch array, planning may overwrite it
+      fftw_complex* scratch = allocate();
+
+      if (nx > 0) {
+        int n2D[2] = { mesh[1], mesh[2] };
+        int dist = mesh[1] * mesh[2];
+        plan2DForward = fftw_plan_many_dft(2, n2D, nx, scratch, NULL, 1, dist,
+                                           scratch, NULL, 1, dist, FFTW_FORWARD, flags);
+        plan2DBackward = fftw_plan_many_dft(2, n2D, nx, scratch, NULL, 1, dist,
+                                            scratch, NULL, 1, dist, FFTW_BACKWARD, flags);
+      }
+
+      if (nky > 0) {
+        // 1D transforms along kx for all local (ky, kz) pairs
+        fftw_iodim dim;
+        dim.n = mesh[0];
+        dim.is = dim.os = mesh[2];
+        fftw_iodim loops[2];
+        loops[0].n = nky;
+        loops[0].is = loops[0].os = mesh[0] * mesh[2];
+        loops[1].n = mesh[2];
+        loops[1].is = loops[1].os = 1;
+        plan1DForward = fftw_plan_guru_dft(1, &dim, 2, loops, scratch, scratch,
+                                           FFTW_FORWARD, flags);
+        plan1DBackward = fftw_plan_guru_dft(1, &dim, 2, loops, scratch, scratch,
+                                            FFTW_BACKWARD, flags);
+      }
+
+      fftw_free(scratch);
+    }
+
+    SlabFFT::~SlabFFT() {
+      if (plan2DForward) fftw_destroy_plan(plan2DForward);
+      if (plan2DBackward) fftw_destroy_plan(plan2DBackward);
+      if (plan1DForward) fftw_destroy_plan(plan1DForward);
+      if (plan1DBackward) fftw_destroy_plan(plan1DBackward);
+    }
+
+    fftw_complex* SlabFFT::allocate() const {
+      fftw_complex* data = (fftw_complex*) fftw_malloc(std::max(localSize, (size_t) 1) *
+                                                        sizeof(fftw_complex));
+      memset(data, 0, std::max(localSize, (size_t) 1) * sizeof(fftw_complex));
+      return data;
+    }
+
+    int SlabFFT::blockOwner(int n, int i) const {
+      int base = n / nprocs;
+      int rem = n % nprocs;
+      if (i < rem * (base + 1)) return i / (base + 1);
+      return rem + (i - rem * (base + 1)) / base;
+    }
+
+    void SlabFFT::forward(fftw_complex* data) {
+      if (plan2DForward) fftw_execute_dft(plan2DForward, data, data);
+      transposeXToY(data);
+      if (plan1DForward) fftw_execute_dft(plan1DForward, data, data);
+    }
+
+    void SlabFFT::backward(fftw_complex* data) {
+      if (plan1DBackward) fftw_execute_dft(plan1DBackward, data, data);
+      transposeYToX(data);
+      if (plan2DBackward) fftw_execute_dft(plan2DBackward, data, data);
+    }
+
+    void SlabFFT::transposeXToY(fftw_complex* data) {
+      const int M0 = mesh[0], M1 = mesh[1], M2 = mesh[2];
+      std::vector< int > sendCounts(nprocs), recvCounts(nprocs);
+      for (int r = 0; r < nprocs; ++r) {
+        sendCounts[r] = 2 * nx * getNKY(r) * M2;
+        recvCounts[r] = 2 * getNX(r) * nky * M2;
+      }
+
+      // pack: for every destination the local planes restricted to its ky range
+      sendBuf.resize(2 * localSize);
+      real* out = sendBuf.empty() ? NULL : &sendBuf[0];
+      for (int r = 0; r < nprocs; ++r) {
+        int y0 = blockStart(M1, r), ny = getNKY(r);
+        for (int xl = 0; xl < nx; ++xl) {
+          memcpy(out, data[(xl * M1 + y0) * M2], 2 * ny * M2 * sizeof(real));
+          out += 2 * ny * M2;
+        }
+      }
+
+      exchange(sendCounts, recvCounts);
+
+      const real* in = recvBuf.empty() ? NULL : &recvBuf[0];
+      for (int s = 0; s < nprocs; ++s) {
+        int x0 = getXStart(s), nxs = getNX(s);
+        for (int xl = 0; xl < nxs; ++xl) {
+          for (int yl = 0; yl < nky; ++yl) {
+            memcpy(data[(yl * M0 + x0 + xl) * M2], in, 2 * M2 * sizeof(real));
+            in += 2 * M2;
+          }
+        }
+      }
+    }
+
+    void SlabFFT::transposeYToX(fftw_complex* data) {
+      const int M0 = mesh[0], M1 = mesh[1], M2 = mesh[2];
+      std::vector< int > sendCounts(nprocs), recvCounts(nprocs);
+      for (int r = 0; r < nprocs; ++r) {
+        sendCounts[r] = 2 * getNX(r) * nky * M2;
+        recvCounts[r] = 2 * nx * getNKY(r) * M2;
+      }
+
+      sendBuf.resize(2 * localSize);
+      real* out = sendBuf.empty() ? NULL : &sendBuf[0];
+      for (int r = 0; r < nprocs; ++r) {
+        int x0 = getXStart(r), nxr = getNX(r);
+        for (int xl = 0; xl < nxr; ++xl) {
+          for (int yl = 0; yl < nky; ++yl) {
+            memcpy(out, data[(yl * M0 + x0 + xl) * M2], 2 * M2 * sizeof(real));
+            out += 2 * M2;
+          }
+        }
+      }
+
+      exchange(sendCounts, recvCounts);
+
+      const real* in = recvBuf.empty() ? NULL : &recvBuf[0];
+      for (int s = 0; s < nprocs; ++s) {
+        int y0 = blockStart(M1, s), ny = getNKY(s);
+        for (int xl = 0; xl < nx; ++xl) {
+          for (int yl = 0; yl < ny; ++yl) {
+            memcpy(data[(xl * M1 + y0 + yl) * M2], in, 2 * M2 * sizeof(real));
+            in += 2 * M2;
+          }
+        }
+      }
+    }
+
+    void SlabFFT::exchange(const std::vector< int >& sendCounts,
+                           const std::vector< int >& recvCounts) {
+      const int tag = 0x5ff7;
+      size_t recvTotal = 0;
+      for (int r = 0; r < nprocs; ++r) recvTotal += recvCounts[r];
+      recvBuf.resize(recvTotal);
+
+      std::vector< mpi::request > requests;
+      size_t sendOffset = 0, recvOffset = 0;
+      for (int r = 0; r < nprocs; ++r) {
+        if (r == rank) {
+          if (sendCounts[r] > 0) {
+            memcpy(&recvBuf[recvOffset], &sendBuf[sendOffset], sendCounts[r] * sizeof(real));
+          }
+        } else {
+          if (recvCounts[r] > 0) {
+            requests.push_back(comm->irecv(r, tag, &recvBuf[recvOffset], recvCounts[r]));
+          }
+          if (sendCounts[r] > 0) {
+            requests.push_back(comm->isend(r, tag, &sendBuf[sendOffset], sendCounts[r]));
+          }
+        }
+        sendOffset += sendCounts[r];
+        recvOffset += recvCounts[r];
+      }
+      mpi::wait_all(requests.begin(), requests.end());
+    }
+  
+    void SlabFFT::gatherBricks(const Int3D& lo, const Int3D& len) {
+      int brick[6] = { lo[0], lo[1], lo[2], len[0], len[1], len[2] };
+      allBricks.clear();
+      mpi::all_gather(*comm, brick, 6, allBricks);
+    }
+
+    size_t SlabFFT::brickOverlap(int r, int s) const {
+      size_t planes = 0;
+      for (int i = 0; i < allBricks[6*r + 3]; ++i) {
+        if (getXOwner(brickToMesh(r, 0, i)) == s) planes++;
+      }
+      return planes * allBricks[6*r + 4] * allBricks[6*r + 5];
+    }
+
+    void SlabFFT::exchangeBricks(std::vector< std::vector< real > >& sendBufs,
+                                 std::vector< std::vector< real > >& recvBufs,
+                                 const std::vector< size_t >& recvCounts) {
+      const int tag = 0x5ff8;
+      std::vector< mpi::request > requests;
+      for (int r = 0; r < nprocs; ++r) {
+        if (r == rank) continue;
+        recvBufs[r].resize(recvCounts[r]);
+        if (!recvBufs[r].empty()) {
+          requests.push_back(comm->irecv(r, tag, &recvBufs[r][0], recvBufs[r].size()));
+        }
+        if (!sendBufs[r].empty()) {
+          requests.push_back(comm->isend(r, tag, &sendBufs[r][0], sendBufs[r].size()));
+        }
+      }
+      mpi::wait_all(requests.begin(), requests.end());
+      recvBufs[rank].swap(sendBufs[rank]);
+    }
+
+    void SlabFFT::brickFor(const std::vector< Int3D >& firstPoints, int P,
+                           Int3D& lo, Int3D& len) const {
+      if (firstPoints.empty()) {
+        lo = Int3D(0);
+        len = Int3D(0);
+        return;
+      }
+      lo = firstPoints[0];
+      Int3D hi = firstPoints[0];
+      for (size_t n = 1; n < firstPoints.size(); n++) {
+        for (int d = 0; d < 3; d++) {
+          lo[d] = std::min(lo[d], firstPoints[n][d]);
+          hi[d] = std::max(hi[d], firstPoints[n][d]);
+        }
+      }
+      for (int d = 0; d < 3; d++) {
+        len[d] = std::min(hi[d] - lo[d] + P, mesh[d]);
+      }
+    }
+
+    void SlabFFT::addBricks(const Int3D& lo, const Int3D& len,
+                            const std::vector< real >& brick, fftw_complex* data) {
+      gatherBricks(lo, len);
+
+      // every plane of the local brick goes to the owner of its x-slab
+      std::vector< std::vector< real > > sendBufs(nprocs), recvBufs(nprocs);
+      size_t plane = (size_t) len[1] * len[2];
+      for (int i = 0; i < len[0]; ++i) {
+        std::vector< real >& buf = sendBufs[getXOwner(brickToMesh(rank, 0, i))];
+        buf.insert(buf.end(), brick.begin() + i * plane, brick.begin() + (i + 1) * plane);
+      }
+
+      std::vector< size_t > recvCounts(nprocs);
+      for (int r = 0; r < nprocs; ++r) recvCounts[r] = brickOverlap(r, rank);
+      exchangeBricks(sendBufs, recvBufs, recvCounts);
+
+      memset(data, 0, localSize * sizeof(fftw_complex));
+      const int M1 = mesh[1], M2 = mesh[2];
+      for (int r = 0; r < nprocs; ++r) {
+        const real* in = recvBufs[r].empty() ? NULL : &recvBufs[r][0];
+        for (int i = 0; i < allBricks[6*r + 3]; ++i) {
+          int gx = brickToMesh(r, 0, i);
+          if (getXOwner(gx) != rank) continue;
+          for (int j = 0; j < allBricks[6*r + 4]; ++j) {
+            fftw_complex* row = &data[((gx - xStart) * M1 + brickToMesh(r, 1, j)) * M2];
+            for (int k = 0; k < allBricks[6*r + 5]; ++k) {
+              row[brickToMesh(r, 2, k)][0] += *in++;
+            }
+          }
+        }
+      }
+    }
+
+    void SlabFFT::getBricks(const Int3D& lo, const Int3D& len,
+                            fftw_complex* const* meshes, int ncomp,
+                            std::vector< real >& brick) {
+      gatherBricks(lo, len);
+
+      const int M1 = mesh[1], M2 = mesh[2];
+      std::vector< std::vector< real > > sendBufs(nprocs), recvBufs(nprocs);
+      for (int r = 0; r < nprocs; ++r) {
+        sendBufs[r].reserve(ncomp * brickOverlap(r, rank));
+        for (int i = 0; i < allBricks[6*r + 3]; ++i) {
+          int gx = brickToMesh(r, 0, i);
+          if (getXOwner(gx) != rank) continue;
+          for (int j = 0; j < allBricks[6*r + 4]; ++j) {
+            size_t row = ((gx - xStart) * M1 + brickToMesh(r, 1, j)) * M2;
+            for (int k = 0; k < allBricks[6*r + 5]; ++k) {
+              size_t index = row + brickToMesh(r, 2, k);
+              for (int c = 0; c < ncomp; ++c) sendBufs[r].push_back(meshes[c][index][0]);
+            }
+          }
+        }
+      }
+
+      std::vector< size_t > recvCounts(nprocs);
+      for (int r = 0; r < nprocs; ++r) recvCounts[r] = ncomp * brickOverlap(rank, r);
+      exchangeBricks(sendBufs, recvBufs, recvCounts);
+
+      // planes arrive per owner in the order of the local brick
+      size_t plane = (size_t) ncomp * len[1] * len[2];
+      brick.resize(plane * len[0]);
+      std::vector< size_t > pos(nprocs, 0);
+      for (int i = 0; i < len[0]; ++i) {
+        int owner = getXOwner(brickToMesh(rank, 0, i));
+        std::copy(recvBufs[owner].begin() + pos[owner],
+                  recvBufs[owner].begin() + pos[owner] + plane,
+                  brick.begin() + i * plane);
+        pos[owner] += plane;
+      }
+    }
+  }
+}
@@ -0,0 +1,163 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _ESUTIL_SLABFFT_HPP
+#define _ESUTIL_SLABFFT_HPP
+
+#include <vector>
+#include <fftw3.h>
+
+#include "types.hpp"
+#include "mpi.hpp"
+#include "Int3D.hpp"
+
+namespace espressopp {
+  namespace esutil {
+
+    /** Distributed complex 3D FFT on a slab decomposition of the mesh.
+
+        In real space every rank owns the planes x in [xStart, xStart+nx)
+        with the full y and z range, stored as ((x-xStart)*M1 + y)*M2 + z.
+        In k space every rank owns ky in [kyStart, kyStart+nky) with the
+        full kx and kz range, stored as ((ky-kyStart)*M0 + kx)*M2 + kz.
+        The forward transform does the 2D FFTs of the local planes, a
+        global transpose and the 1D FFTs along x; the backward transform
+        runs the same steps in reverse. Both are unnormalized.
+
+        The FFTW plans are created once in the constructor.
+    */
+    class SlabFFT {
+    public:
+      SlabFFT(shared_ptr< mpi::communicator > _comm, const Int3D& _mesh,
+              unsigned flags = FFTW_MEASURE);
+      ~SlabFFT();
+
+      const Int3D& getMesh() const { return mesh; }
+
+      /** first x plane and number of x planes of a rank in real space */
+      int getXStart(int rank) const { return blockStart(mesh[0], rank); }
+      int getNX(int rank) const { return blockSize(mesh[0], rank); }
+      int getXOwner(int x) const { return blockOwner(mesh[0], x); }
+
+      /** first ky plane and number of ky planes of a rank in k space */
+      int getKYStart(int rank) const { return blockStart(mesh[1], rank); }
+      int getNKY(int rank) const { return blockSize(mesh[1], rank); }
+
+      int getLocalXStart() const { return xStart; }
+      int getLocalNX() const { return nx; }
+      int getLocalKYStart() const { return kyStart; }
+      int getLocalNKY() const { return nky; }
+
+      /** number of complex values a local array must hold */
+      size_t getLocalSize() const { return localSize; }
+
+      /** allocate a suitably aligned local array, release with fftw_free */
+      fftw_complex* allocate() const;
+
+      /** in-place transform from the real space to the k space layout */
+      void forward(fftw_complex* data);
+
+      /** in-place transform from the k space to the real space layout */
+      void backward(fftw_complex* data);
+
+      /** Brick (lo, len) that holds the P^3 stencils of the given first
+          (lowest) stencil points: lo is the smallest first point, len
+          reaches to the largest one plus P-1, cut to the mesh size if
+          the stencils span the mesh, so that the brick wraps around.
+          The brick is empty if there are no points. */
+      void brickFor(const std::vector< Int3D >& firstPoints, int P,
+                    Int3D& lo, Int3D& len) const;
+
+      /** Add value * wx[i] * wy[j] * wz[k] to the P^3 stencil points from
+          first on of the brick (lo, len), w holds wx, wy and wz, P each. */
+      void spread(const Int3D& lo, const Int3D& len, const Int3D& first, int P,
+                  const real* w, real value, real* brick) const {
+        for (int i = 0; i < P; i++) {
+          int xpos = (first[0] - lo[0] + i) % mesh[0];
+          for (int j = 0; j < P; j++) {
+            int ypos = (first[1] - lo[1] + j) % mesh[1];
+            real wxy = value * w[i] * w[P + j];
+            real* row = &brick[((size_t) xpos * len[1] + ypos) * len[2]];
+            for (int k = 0; k < P; k++) {
+              row[(first[2] - lo[2] + k) % mesh[2]] += wxy * w[2*P + k];
+            }
+          }
+        }
+      }
+
+      /** Sum the bricks of all ranks into the real part of the local
+          real space slab of mesh; the slab is cleared first. A brick
+          covers len[d] consecutive mesh points from lo[d] on (lo may lie
+          outside the mesh, indices are periodic, len[d] <= mesh[d]) and
+          is stored as (i*len[1] + j)*len[2] + k. Collective call.
+      */
+      void addBricks(const Int3D& lo, const Int3D& len,
+                     const std::vector< real >& brick, fftw_complex* mesh);
+
+      /** Inverse of addBricks: collect the real parts of ncomp real space
+          meshes on the local brick, ncomp values per brick point.
+          Collective call.
+      */
+      void getBricks(const Int3D& lo, const Int3D& len,
+                     fftw_complex* const* meshes, int ncomp,
+                     std::vector< real >& brick);
+
+    private:
+      shared_ptr< mpi::communicator > comm;
+      Int3D mesh;
+      int nprocs, rank;
+      int xStart, nx, kyStart, nky;
+      size_t localSize;
+
+      fftw_plan plan2DForward, plan2DBackward;
+      fftw_plan plan1DForward, plan1DBackward;
+
+      std::vector< real > sendBuf, recvBuf;
+
+      int blockSize(int n, int r) const { return n / nprocs + (r < n % nprocs ? 1 : 0); }
+      int blockStart(int n, int r) const {
+        int rem = n % nprocs;
+        return r * (n / nprocs) + (r < rem ? r : rem);
+      }
+      int blockOwner(int n, int i) const;
+
+      /** redistribute between the x-slab and the ky-slab layout */
+      void transposeXToY(fftw_complex* data);
+      void transposeYToX(fftw_complex* data);
+      void exchange(const std::vector< int >& sendCounts,
+                    const std::vector< int >& recvCounts);
+
+      /** brick descriptors (lo, len) of all ranks */
+      std::vector< int > allBricks;
+      void gatherBricks(const Int3D& lo, const Int3D& len);
+      int brickToMesh(int r, int dir, int i) const {
+        int g = (allBricks[6*r + dir] + i) % mesh[dir];
+        return (g < 0) ? g + mesh[dir] : g;
+      }
+      /** number of points of the brick of rank r in the x-slab of rank s */
+      size_t brickOverlap(int r, int s) const;
+      void exchangeBricks(std::vector< std::vector< real > >& sendBufs,
+                          std::vector< std::vector< real > >& recvBufs,
+                          const std::vector< size_t >& recvCounts);
+    };
+  }
+}
+
+#endif
@@ -58,6 +58,7 @@ else:
 pmiimport('espressopp.esutil')
 
 from espressopp.esutil.RNG import *
+from espressopp.esutil.CounterRNG import *
 from espressopp.esutil.UniformOnSphere import *
 from espressopp.esutil.NormalVariate import *
 from espressopp.esutil.GammaVariate import *
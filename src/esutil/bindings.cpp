@@ -23,6 +23,7 @@
 #include "bindings.hpp"
 #include "Collectives.hpp"
 #include "RNG.hpp"
+#include "CounterRNG.hpp"
 #include "UniformOnSphere.hpp"
 #include "NormalVariate.hpp"
 #include "GammaVariate.hpp"
@@ -35,6 +36,7 @@ namespace espressopp {
     void registerPython() {
       Collectives::registerPython();
       RNG::registerPython();
+      CounterRNG::registerPython();
       UniformOnSphere::registerPython();
       NormalVariate::registerPython();
       GammaVariate::registerPython();
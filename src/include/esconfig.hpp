@@ -31,6 +31,14 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+// vectorization hint for the batched pair kernels, requires OpenMP 4.0
+// (e.g. -fopenmp), otherwise the loops are left to the auto-vectorizer
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define ESPP_PRAGMA_SIMD _Pragma("omp simd")
+#else
+#define ESPP_PRAGMA_SIMD
+#endif
+
 namespace espressopp {
   // define to "float" for single precision (i.e. typedef float real;)
   // define to "double" for double precision (i.e. typedef double real;)
@@ -166,7 +166,7 @@ namespace espressopp {
 
       Alist.clear();
       // loop over VL pairs
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         // If criteria for reaction match, add the indices to Alist
@@ -135,7 +135,7 @@ void ChemicalReaction::React() {
   effective_pairs_.clear();
 
   // loop over VL pairs
-  for (PairList::Iterator it(verlet_list_->getPairs()); it.isValid(); ++it) {
+  for (VerletList::PairIterator it(*verlet_list_); it.isValid(); ++it) {
     Particle &p1 = *it->first;
     Particle &p2 = *it->second;
     int reaction_idx_ = 0;
@@ -54,6 +54,10 @@ namespace espressopp {
 
       rng = system->rng;
 
+      useCounterRNG = false;
+      counterRNG.seed(rng->get_seed());
+      counterStream = 0;
+
       LOG4ESPP_INFO(theLogger, "DPD constructed");
     }
 
@@ -85,6 +89,14 @@ namespace espressopp {
       return temperature;
     }
 
+    void DPDThermostat::setCounterRNG(bool _useCounterRNG) {
+      useCounterRNG = _useCounterRNG;
+    }
+
+    bool DPDThermostat::getCounterRNG() {
+      return useCounterRNG;
+    }
+
     DPDThermostat::~DPDThermostat() {
         disconnect();
     }
@@ -122,7 +134,7 @@ namespace espressopp {
         system.storage->updateGhostsV();
 
         // loop over VL pairs
-        for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+        for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
             Particle &p1 = *it->first;
             Particle &p2 = *it->second;
 
@@ -143,7 +155,15 @@ namespace espressopp {
         // standard DPD part
         real veldiff = (p1.velocity() - p2.velocity()) * r;
         real friction = pref1 * omega2 * veldiff;
-        real noise = pref2 * omega * ((*rng)() - 0.5);
+        real ranval;
+        if (useCounterRNG) {
+          real u[4];
+          counterRNG.uniform4(integrator->getStep(), p1.id(), p2.id(), counterStream, u);
+          ranval = u[0];
+        } else {
+          ranval = (*rng)();
+        }
+        real noise = pref2 * omega * (ranval - 0.5);
 
         Real3D f = (noise - friction) * r;
         p1.force() += f;
@@ -162,7 +182,14 @@ namespace espressopp {
 		if (tgamma > 0.0) {
 		  real distinv = omega;
 
-		  Real3D noisevec((*rng)() - 0.5, (*rng)() - 0.5, (*rng)() - 0.5);
+		  Real3D noisevec;
+		  if (useCounterRNG) {
+			  real u[4];
+			  counterRNG.uniform4(integrator->getStep(), p1.id(), p2.id(), counterStream + 2, u);
+			  noisevec = Real3D(u[0] - 0.5, u[1] - 0.5, u[2] - 0.5);
+		  } else {
+			  noisevec = Real3D((*rng)() - 0.5, (*rng)() - 0.5, (*rng)() - 0.5);
+		  }
 
 		  // damping, random force
 		  Real3D f_damp(0.0, 0.0, 0.0), f_rand(0.0, 0.0, 0.0);
@@ -209,6 +236,9 @@ namespace espressopp {
       pref2 = sqrt(24.0 * temperature * gamma/timestep);
       pref3 = tgamma;
       pref4 = sqrt(24.0 * temperature * tgamma);
+
+      // follow a reseeding of system.rng between runs
+      counterRNG.seed(rng->get_seed());
     }
 
     /** very nasty: if we recalculate force when leaving/reentering the integrator,
@@ -227,6 +257,7 @@ namespace espressopp {
     	pref2       *= sqrt(3.0);
     	pref4buffer = pref4;
     	pref4       *= sqrt(3.0);
+    	counterStream = 1;  // the first step of run() uses the same counter
         
     }
 
@@ -238,6 +269,7 @@ namespace espressopp {
         
         pref2 = pref2buffer;
         pref4 = pref4buffer;
+        counterStream = 0;
         
     }
 
@@ -254,6 +286,7 @@ namespace espressopp {
         .add_property("gamma", &DPDThermostat::getGamma, &DPDThermostat::setGamma)
         .add_property("tgamma", &DPDThermostat::getTGamma, &DPDThermostat::setTGamma)
         .add_property("temperature", &DPDThermostat::getTemperature, &DPDThermostat::setTemperature)
+        .add_property("counterRNG", &DPDThermostat::getCounterRNG, &DPDThermostat::setCounterRNG)
         ;
     }
   }
@@ -32,6 +32,7 @@
 
 #include "Extension.hpp"
 #include "VelocityVerlet.hpp"
+#include "esutil/CounterRNG.hpp"
 
 
 #include "boost/signals2.hpp"
@@ -59,6 +60,11 @@ namespace espressopp {
         void setTemperature(real temperature);
         real getTemperature();
 
+        /** draw the pair noise from the counter-based RNG keyed on step
+            and both particle ids, independent of the domain decomposition */
+        void setCounterRNG(bool _useCounterRNG);
+        bool getCounterRNG();
+
         void initialize();
 
         /** update of forces to thermalize the system */
@@ -101,6 +107,10 @@ namespace espressopp {
         shared_ptr<VerletList> verletList;
         shared_ptr< esutil::RNG > rng;  //!< random number generator used for friction term
 
+        bool useCounterRNG;
+        esutil::CounterRNG counterRNG;  //!< seeded from rng at every run, same on all CPUs
+        int counterStream;              //!< different stream while recalculating forces
+
     };
   }
 }
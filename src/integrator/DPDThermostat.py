@@ -31,6 +31,12 @@ espressopp.integrator.DPDThermostat
 		:param vl: 
 		:type system: 
 		:type vl: 
+
+.. py:data:: espressopp.integrator.DPDThermostat.counterRNG
+
+		If True the pair noise is drawn from a counter-based RNG keyed on the
+		step and both particle ids, which makes the trajectory independent of
+		the number of CPUs (default: False).
 """
 from espressopp.esutil import cxxinit
 from espressopp import pmi
@@ -53,5 +59,5 @@ if pmi.isController :
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
             cls =  'espressopp.integrator.DPDThermostatLocal',
-            pmiproperty = [ 'gamma', 'tgamma', 'temperature' ]
+            pmiproperty = [ 'gamma', 'tgamma', 'temperature', 'counterRNG' ]
             )
@@ -56,6 +56,14 @@ namespace espressopp {
 
       rng = system->rng;
 
+      useCounterRNG = false;
+      counterRNG.seed(rng->get_seed());
+      counterStream = 0;
+
+      baoab = false;
+      baoabC1 = 1.0;
+      baoabC2 = 0.0;
+
       LOG4ESPP_INFO(theLogger, "Langevin constructed");
 
 
@@ -79,6 +87,27 @@ namespace espressopp {
         return adress;
     }
 
+    void LangevinThermostat::setCounterRNG(bool _useCounterRNG) {
+        useCounterRNG = _useCounterRNG;
+    }
+
+    bool LangevinThermostat::getCounterRNG() {
+        return useCounterRNG;
+    }
+
+    void LangevinThermostat::setBAOAB(bool _baoab) {
+        if (_baoab == baoab) return;
+        // reconnect if the thermostat is already attached to an integrator
+        bool connected = _initialize.connected();
+        if (connected) disconnect();
+        baoab = _baoab;
+        if (connected) connect();
+    }
+
+    bool LangevinThermostat::getBAOAB() {
+        return baoab;
+    }
+
     void LangevinThermostat::setTemperature(real _temperature)
     {
       temperature = _temperature;
@@ -102,10 +131,31 @@ namespace espressopp {
         _thermalize.disconnect();
         _thermalizeAdr.disconnect();
 
+        if (baoabIntegrator) {
+            if (baoabIntegrator->getBAOABThermostat() == this) {
+                baoabIntegrator->setBAOABThermostat(0);
+            }
+            baoabIntegrator.reset();
+        }
     }
 
     void LangevinThermostat::connect() {
 
+        if (baoab) {
+            // the velocity update is done by the integrator itself
+            if (adress) {
+                throw std::runtime_error("LangevinThermostat: BAOAB is not available for AdResS");
+            }
+            baoabIntegrator = boost::dynamic_pointer_cast< VelocityVerlet >(integrator);
+            if (!baoabIntegrator) {
+                throw std::runtime_error("LangevinThermostat: BAOAB requires the VelocityVerlet integrator");
+            }
+            _initialize = integrator->runInit.connect(
+                    boost::bind(&LangevinThermostat::initialize, this));
+            baoabIntegrator->setBAOABThermostat(this);
+            return;
+        }
+
         // connect to initialization inside run()
         _initialize = integrator->runInit.connect(
                 boost::bind(&LangevinThermostat::initialize, this));
@@ -171,7 +221,13 @@ namespace espressopp {
 
       // get a random value for each vector component
 
-      Real3D ranval((*rng)() - 0.5, (*rng)() - 0.5, (*rng)() - 0.5);
+      Real3D ranval;
+      if (useCounterRNG) {
+        ranval = counterRNG.uniform3(integrator->getStep(), p.id(), counterStream);
+        ranval -= Real3D(0.5);
+      } else {
+        ranval = Real3D((*rng)() - 0.5, (*rng)() - 0.5, (*rng)() - 0.5);
+      }
 
       p.force() += pref1 * p.velocity() * p.mass() +
                    pref2 * ranval * massf;
@@ -186,6 +242,12 @@ namespace espressopp {
       pref1 = -gamma;
       pref2 = sqrt(24.0 * temperature * gamma / timestep);
 
+      baoabC1 = exp(-gamma * timestep);
+      baoabC2 = sqrt(temperature * (1.0 - baoabC1 * baoabC1));
+
+      // follow a reseeding of system.rng between runs
+      counterRNG.seed(rng->get_seed());
+
 
       LOG4ESPP_INFO(theLogger, "init, timestep = " << timestep <<
           ", gamma = " << gamma <<
@@ -207,6 +269,7 @@ namespace espressopp {
 
       pref2buffer = pref2;
       pref2       *= sqrt(3.0);
+      counterStream = 1;  // the first step of run() uses the same counter
     }
 
     /** Opposite to heatUp */
@@ -216,6 +279,7 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "coolDown");
 
       pref2 = pref2buffer;
+      counterStream = 0;
     }
 
     /** Add valid type id. */
@@ -251,6 +315,8 @@ namespace espressopp {
         .add_property("adress", &LangevinThermostat::getAdress, &LangevinThermostat::setAdress)
         .add_property("gamma", &LangevinThermostat::getGamma, &LangevinThermostat::setGamma)
         .add_property("temperature", &LangevinThermostat::getTemperature, &LangevinThermostat::setTemperature)
+        .add_property("counterRNG", &LangevinThermostat::getCounterRNG, &LangevinThermostat::setCounterRNG)
+        .add_property("baoab", &LangevinThermostat::getBAOAB, &LangevinThermostat::setBAOAB)
         ;
 
 
@@ -31,6 +31,8 @@
 
 #include "Extension.hpp"
 #include "VelocityVerlet.hpp"
+#include "esutil/RNG.hpp"
+#include "esutil/CounterRNG.hpp"
 
 #include "boost/unordered_set.hpp"
 #include "boost/signals2.hpp"
@@ -58,6 +60,34 @@ namespace espressopp {
         void setAdress(bool _adress);
         bool getAdress();
 
+        /** draw the noise from the counter-based RNG keyed on step and
+            particle id, independent of the domain decomposition */
+        void setCounterRNG(bool _useCounterRNG);
+        bool getCounterRNG();
+
+        /** BAOAB mode: instead of adding friction and noise to the forces
+            after every force calculation, the thermostat updates the
+            velocities exactly (Ornstein-Uhlenbeck step) inside the position
+            update of VelocityVerlet::integrate1(), in the same sweep over
+            the particles. Needs VelocityVerlet, not available for AdResS. */
+        void setBAOAB(bool _baoab);
+        bool getBAOAB();
+
+        /** O step of BAOAB for one particle, v = c1 v + c2/sqrt(m) xi */
+        void frictionThermoBAOAB(Particle& p) {
+          if ((has_excl && exclusions.count(p.id()) > 0) || (has_types && !valid_type_ids.count(p.type()))) {
+            return;
+          }
+          Real3D xi;
+          if (useCounterRNG) {
+            xi = counterRNG.normal3(integrator->getStep(), p.id(), counterStream);
+          } else {
+            xi = Real3D(rng->normal(), rng->normal(), rng->normal());
+          }
+          p.velocity() *= baoabC1;
+          p.velocity() += (baoabC2 / sqrt(p.mass())) * xi;
+        }
+
         void initialize();
 
         /** update of forces to thermalize the system */
@@ -117,8 +147,17 @@ namespace espressopp {
 
         real pref2buffer; //!< temporary to save value between heatUp/coolDown
 
+        bool baoab;
+        real baoabC1;  //!< exp(-gamma dt)
+        real baoabC2;  //!< sqrt(kT (1 - c1^2))
+        shared_ptr< VelocityVerlet > baoabIntegrator;  //!< integrator the O step is fused into
+
         shared_ptr< esutil::RNG > rng;  //!< random number generator used for friction term
 
+        bool useCounterRNG;
+        esutil::CounterRNG counterRNG;  //!< seeded from rng at every run, same on all CPUs
+        int counterStream;              //!< different stream while recalculating forces
+
         /** Logger */
         static LOG4ESPP_DECL_LOGGER(theLogger);
 
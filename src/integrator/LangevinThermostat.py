@@ -36,6 +36,13 @@ Example:
 >>> # set temperature
 >>> langevin.adress = True
 >>> # set adress (default is False)
+>>> langevin.counterRNG = True
+>>> # draw the noise from a counter-based RNG keyed on step and particle id,
+>>> # this makes the trajectory independent of the number of CPUs (default is False)
+>>> langevin.baoab = True
+>>> # update the velocities exactly inside the position update of the
+>>> # VelocityVerlet integrator (BAOAB splitting) instead of adding friction
+>>> # and noise to the forces, not available for AdResS (default is False)
 >>> integrator.addExtension(langevin)
 >>> # add extensions to a previously defined integrator
 
@@ -85,6 +92,6 @@ if pmi.isController :
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
             cls =  'espressopp.integrator.LangevinThermostatLocal',
-            pmiproperty = [ 'gamma', 'temperature', 'adress' ],
+            pmiproperty = [ 'gamma', 'temperature', 'adress', 'counterRNG', 'baoab' ],
             pmicall = ['addExclusions', 'removeExclpid', 'add_valid_type_id', 'remove_valid_type_id', 'add_valid_types']
             )
@@ -88,15 +88,10 @@ namespace espressopp {
          mpi::all_reduce(*getSystem()->comm, _Npart, _totNPart, std::plus<int>());
          setTotNPart(_totNPart);
 
-         /* if coupling is present initialise related flags, coefficients and arrays */
-         fOnPart = std::vector<Real3D>(_totNPart+1,Real3D(0.));   // +1 as id starts with 1
+         /* if coupling is present initialise related flags and coefficients */
          if (_totNPart != 0) {
             setDoCoupling(true);                            // make LB to MD coupling
             setFricCoeff(5.);                               // friction coeffitient
-
-            for(int _id = 0; _id <= _totNPart; _id++) {
-               setFOnPart(_id, Real3D(0.));
-            }
          }
 
          /* setup domain decompositions for LB */
@@ -127,16 +122,56 @@ namespace espressopp {
       void LatticeBoltzmann::disconnect() {
          _recalc2.disconnect();
          _befIntV.disconnect();
+         _beforeSend.disconnect();
+         _afterRecv.disconnect();
 
-         delete (lbfluid);
-         delete (ghostlat);
-         delete (lbmom);
-         delete (lbfor);
       }
 
       void LatticeBoltzmann::connect() {
          _recalc2 = integrator->recalc2.connect ( boost::bind(&LatticeBoltzmann::zeroMDCMVel, this));
          _befIntV = integrator->befIntV.connect ( boost::bind(&LatticeBoltzmann::makeLBStep, this));
+         _beforeSend = getSystem()->storage->beforeSendParticles.connect
+            ( boost::bind(&LatticeBoltzmann::beforeSendParticles, this, _1, _2));
+         _afterRecv = getSystem()->storage->afterRecvParticles.connect
+            ( boost::bind(&LatticeBoltzmann::afterRecvParticles, this, _1, _2));
+      }
+
+/*******************************************************************************************/
+
+      /* COUPLING FORCES LEAVE THE CPU TOGETHER WITH THEIR PARTICLES */
+      void LatticeBoltzmann::beforeSendParticles(ParticleList& pl, OutBuffer& buf) {
+         std::vector<longint> toSend;
+         std::vector<real> toSendForce;
+         toSend.reserve(pl.size());
+         toSendForce.reserve(3*pl.size());
+
+         for (ParticleList::Iterator pit(pl); pit.isValid(); ++pit) {
+            boost::unordered_map<longint, Real3D>::iterator it = fOnPart.find(pit->id());
+            if (it != fOnPart.end()) {
+               toSend.push_back(it->first);
+               for (int _dir = 0; _dir < 3; _dir++) toSendForce.push_back(it->second[_dir]);
+               fOnPart.erase(it);
+            }
+         }
+         buf.write(toSend);
+         buf.write(toSendForce);
+      }
+
+      void LatticeBoltzmann::afterRecvParticles(ParticleList& pl, InBuffer& buf) {
+         std::vector<longint> received;
+         std::vector<real> receivedForce;
+         buf.read(received);
+         buf.read(receivedForce);
+
+         if (receivedForce.size() != 3*received.size()) {
+            LOG4ESPP_ERROR(theLogger, "read garbage while receiving coupling forces");
+            return;
+         }
+         for (size_t i = 0; i < received.size(); i++) {
+            fOnPart[received[i]] = Real3D(receivedForce[3*i],
+                                          receivedForce[3*i+1],
+                                          receivedForce[3*i+2]);
+         }
       }
 
 /*******************************************************************************************/
@@ -238,11 +273,11 @@ namespace espressopp {
       bool LatticeBoltzmann::doCoupling () {return coupling;}
 
       void LatticeBoltzmann::setExtForceLoc (Int3D _Ni, Real3D _extForceLoc) {
-         return (*lbfor)[_Ni[0]][_Ni[1]][_Ni[2]].setExtForceLoc(_extForceLoc);   }
+         return lbfor[getSiteIdx(_Ni[0],_Ni[1],_Ni[2])].setExtForceLoc(_extForceLoc);   }
       Real3D LatticeBoltzmann::getExtForceLoc (Int3D _Ni) {
-         return (*lbfor)[_Ni[0]][_Ni[1]][_Ni[2]].getExtForceLoc();   }
+         return lbfor[getSiteIdx(_Ni[0],_Ni[1],_Ni[2])].getExtForceLoc();   }
       void LatticeBoltzmann::addExtForceLoc (Int3D _Ni, Real3D _extForceLoc) {
-         return (*lbfor)[_Ni[0]][_Ni[1]][_Ni[2]].addExtForceLoc(_extForceLoc);   }
+         return lbfor[getSiteIdx(_Ni[0],_Ni[1],_Ni[2])].addExtForceLoc(_extForceLoc);   }
 
       void LatticeBoltzmann::setFricCoeff (real _fricCoeff) { fricCoeff = _fricCoeff;}
       real LatticeBoltzmann::getFricCoeff () { return fricCoeff;}
@@ -256,25 +291,30 @@ namespace espressopp {
       void LatticeBoltzmann::setTotNPart (int _totNPart) { totNPart = _totNPart;}
       int LatticeBoltzmann::getTotNPart () { return totNPart;}
 
-      void LatticeBoltzmann::setFOnPart (int _id, Real3D _fOnPart) {fOnPart[_id] = _fOnPart;}
-      Real3D LatticeBoltzmann::getFOnPart (int _id) {return fOnPart[_id];}
-      void LatticeBoltzmann::addFOnPart (int _id, Real3D _fOnPart) {fOnPart[_id] += _fOnPart;}
+      void LatticeBoltzmann::setFOnPart (longint _id, Real3D _fOnPart) {fOnPart[_id] = _fOnPart;}
+      Real3D LatticeBoltzmann::getFOnPart (longint _id) {
+         boost::unordered_map<longint, Real3D>::const_iterator it = fOnPart.find(_id);
+         return (it != fOnPart.end()) ? it->second : Real3D(0.);
+      }
+      void LatticeBoltzmann::addFOnPart (longint _id, Real3D _fOnPart) {
+         setFOnPart(_id, getFOnPart(_id) + _fOnPart);
+      }
 
       void LatticeBoltzmann::keepLBDump () { setPrevDumpStep(0);}
 
       /* Setter and getter for access to population values */
       void LatticeBoltzmann::setPops (Int3D _Ni, int _l, real _value) {
-         (*lbfluid)[_Ni[0]][_Ni[1]][_Ni[2]].setF_i(_l, _value);   }
+         lbfluid.setValue(getSiteIdx(_Ni[0],_Ni[1],_Ni[2]), _l, _value);   }
       real LatticeBoltzmann::getPops (Int3D _Ni, int _l) {
-         return (*lbfluid)[_Ni[0]][_Ni[1]][_Ni[2]].getF_i(_l);   }
+         return lbfluid.getValue(getSiteIdx(_Ni[0],_Ni[1],_Ni[2]), _l);   }
 
       void LatticeBoltzmann::setGhostFluid (Int3D _Ni, int _l, real _value) {
-         (*ghostlat)[_Ni[0]][_Ni[1]][_Ni[2]].setF_i(_l, _value);   }
+         ghostlat.setValue(getSiteIdx(_Ni[0],_Ni[1],_Ni[2]), _l, _value);   }
 
       void LatticeBoltzmann::setLBMom (Int3D _Ni, int _l, real _value) {
-         (*lbmom)[_Ni[0]][_Ni[1]][_Ni[2]].setMom_i(_l, _value);   }
+         lbmom.setValue(getSiteIdx(_Ni[0],_Ni[1],_Ni[2]), _l, _value);   }
       real LatticeBoltzmann::getLBMom (Int3D _Ni, int _l) {
-         return (*lbmom)[_Ni[0]][_Ni[1]][_Ni[2]].getMom_i(_l);   }
+         return lbmom.getValue(getSiteIdx(_Ni[0],_Ni[1],_Ni[2]), _l);   }
 
       /* Helpers for MD to LB (and vice versa) unit conversion */
       real LatticeBoltzmann::convMassMDtoLB() {return 1.;}
@@ -304,29 +344,13 @@ namespace espressopp {
       void LatticeBoltzmann::initLatticeSize() {
          Int3D _numSites = getMyNi();
 
-         /* stretch lattices resizing them in 3 dimensions */
-         lbfluid = new lblattice;
-         ghostlat = new lblattice;
-         lbmom = new lbmoments;
-         lbfor = new lbforces;
-
-         (*lbfluid).resize(_numSites[0]);
-         (*ghostlat).resize(_numSites[0]);
-         (*lbmom).resize(_numSites[0]);
-         (*lbfor).resize(_numSites[0]);
-
-         for (int i = 0; i < _numSites[0]; i++) {
-            (*lbfluid)[i].resize(_numSites[1]);
-            (*ghostlat)[i].resize(_numSites[1]);
-            (*lbmom)[i].resize(_numSites[1]);
-            (*lbfor)[i].resize(_numSites[1]);
-            for (int j = 0; j < _numSites[1]; j++) {
-               (*lbfluid)[i][j].resize(_numSites[2]);
-               (*ghostlat)[i][j].resize(_numSites[2]);
-               (*lbmom)[i][j].resize(_numSites[2]);
-               (*lbfor)[i][j].resize(_numSites[2]);
-            }
-         }
+         int _nSites = _numSites[0] * _numSites[1] * _numSites[2];
+
+         /* one contiguous array per population (and per moment), see getSiteIdx() */
+         lbfluid.resize(_nSites, getNumVels());
+         ghostlat.resize(_nSites, getNumVels());
+         lbmom.resize(_nSites, 4);
+         lbfor.assign(_nSites, LBForce());
       }
 
 /*******************************************************************************************/
@@ -423,16 +447,9 @@ namespace espressopp {
                setPhi(l, sqrt(mu / getInvB(l)));
             }
 
-            // set phi on every lattice site
-            Int3D _Ni = getMyNi();
-            for (int i = 0; i < _Ni[0]; i++) {
-               for (int j = 0; j < _Ni[1]; j++) {
-                  for (int k = 0; k < _Ni[2]; k++) {
-                     for (int l = 0; l < getNumVels(); l++) {
-                        (*lbfluid)[i][j][k].setPhiLoc(l,getPhi(l));
-                     }
-                  }
-               }
+            // set phi for the collision on the lattice sites
+            for (int l = 0; l < getNumVels(); l++) {
+               LBSite::setPhiLoc(l,getPhi(l));
             }
 
             if (_myRank == 0) {
@@ -519,6 +536,7 @@ namespace espressopp {
          bool _extForce = doExtForce();
          bool _fluct = doFluct();
          bool _coupling = doCoupling();
+         int _numVels = getNumVels();
          Int3D _myNi = getMyNi();
 
          // copy forces from halo region to the real one //
@@ -526,17 +544,38 @@ namespace espressopp {
             copyForcesFromHalo();
          }
 
+         // shift of the flat site index along every velocity vector and
+         // the arrays of the populations before and after streaming
+         int _shift[19];
+         real *_src[19], *_dst[19];
+         for (int l = 0; l < _numVels; l++) {
+            _shift[l] = getSiteIdx((int)c_i[l][0], (int)c_i[l][1], (int)c_i[l][2]);
+            _src[l] = lbfluid.getComp(l);
+            _dst[l] = ghostlat.getComp(l);
+         }
+
          // collision-streaming //
+         // fused in one sweep: the populations of a site are gathered from
+         // the SoA arrays, relaxed in registers and pushed straight to the
+         // neighbours; periodic boundaries are handled in commHalo() //
          real timer = colstream.getElapsedTime();
+         LBSite _site;
          for (int i = _offset; i < _myNi[0]-_offset; i++) {
             for (int j = _offset; j < _myNi[1]-_offset; j++) {
-               for (int k = _offset; k < _myNi[2]-_offset; k++) {
-                  Real3D _f = (*lbfor)[i][j][k].getExtForceLoc()
-                            + (*lbfor)[i][j][k].getCouplForceLoc();
+               int _s = getSiteIdx(i, j, _offset);
+               for (int k = _offset; k < _myNi[2]-_offset; k++, _s++) {
+                  Real3D _f = lbfor[_s].getExtForceLoc()
+                            + lbfor[_s].getCouplForceLoc();
+
+                  for (int l = 0; l < _numVels; l++) {
+                     _site.setF_i(l, _src[l][_s]);
+                  }
+
+                  _site.collision(_fluct, _extForce, _coupling, _f, gamma);
 
-                  (*lbfluid)[i][j][k].collision(_fluct, _extForce,
-                                                _coupling, _f, gamma);
-                  streaming (i,j,k);
+                  for (int l = 0; l < _numVels; l++) {
+                     _dst[l][_s + _shift[l]] = _site.getF_i(l);
+                  }
                }
             }
          }
@@ -547,23 +586,17 @@ namespace espressopp {
          commHalo();
          time_comm += ( comm.getElapsedTime() - timer );
 
-         /* swapping of the pointers to the lattices */
+         /* swapping of the lattices (only the array pointers are exchanged) */
          timer = swapping.getElapsedTime();
-         lblattice *tmp = lbfluid;
-         lbfluid = ghostlat;
-         ghostlat = tmp;
+         lbfluid.swap(ghostlat);
          time_sw += ( swapping.getElapsedTime() - timer );
 
          //#note: should one cancel this condition if pure lb is in use?
          //or move setCouplForceLoc into the collision loop?
          if (_coupling) {
             // set to zero coupling forces if the coupling exists
-            for (int i = 0; i < _myNi[0]; i++) {
-               for (int j = 0; j < _myNi[1]; j++) {
-                  for (int k = 0; k < _myNi[2]; k++) {
-                     (*lbfor)[i][j][k].setCouplForceLoc( Real3D(0.) );
-                  }
-               }
+            for (size_t _s = 0; _s < lbfor.size(); _s++) {
+               lbfor[_s].setCouplForceLoc( Real3D(0.) );
             }
          }
 
@@ -572,43 +605,6 @@ namespace espressopp {
          copyDenMomToHalo();
       }
 
-/*******************************************************************************************/
-
-      /* STREAMING ALONG THE VELOCITY VECTORS. SERIAL */
-      // periodic boundaries are handled separately in commHalo() //
-      void LatticeBoltzmann::streaming(int _i, int _j, int _k) {
-
-         // assign iterations
-         int _ip = _i + 1; int _im = _i - 1;
-         int _jp = _j + 1; int _jm = _j - 1;
-         int _kp = _k + 1; int _km = _k - 1;
-
-         // do not move the staying populations
-         (*ghostlat)[_i][_j][_k].setF_i(0,(*lbfluid)[_i][_j][_k].getF_i(0));
-
-         // move populations to the nearest neighbors
-         (*ghostlat)[_ip][_j][_k].setF_i(1,(*lbfluid)[_i][_j][_k].getF_i(1));
-         (*ghostlat)[_im][_j][_k].setF_i(2,(*lbfluid)[_i][_j][_k].getF_i(2));
-         (*ghostlat)[_i][_jp][_k].setF_i(3,(*lbfluid)[_i][_j][_k].getF_i(3));
-         (*ghostlat)[_i][_jm][_k].setF_i(4,(*lbfluid)[_i][_j][_k].getF_i(4));
-         (*ghostlat)[_i][_j][_kp].setF_i(5,(*lbfluid)[_i][_j][_k].getF_i(5));
-         (*ghostlat)[_i][_j][_km].setF_i(6,(*lbfluid)[_i][_j][_k].getF_i(6));
-
-         // move populations to the next-to-the-nearest neighbors
-         (*ghostlat)[_ip][_jp][_k].setF_i(7,(*lbfluid)[_i][_j][_k].getF_i(7));
-         (*ghostlat)[_im][_jm][_k].setF_i(8,(*lbfluid)[_i][_j][_k].getF_i(8));
-         (*ghostlat)[_ip][_jm][_k].setF_i(9,(*lbfluid)[_i][_j][_k].getF_i(9));
-         (*ghostlat)[_im][_jp][_k].setF_i(10,(*lbfluid)[_i][_j][_k].getF_i(10));
-         (*ghostlat)[_ip][_j][_kp].setF_i(11,(*lbfluid)[_i][_j][_k].getF_i(11));
-         (*ghostlat)[_im][_j][_km].setF_i(12,(*lbfluid)[_i][_j][_k].getF_i(12));
-         (*ghostlat)[_ip][_j][_km].setF_i(13,(*lbfluid)[_i][_j][_k].getF_i(13));
-         (*ghostlat)[_im][_j][_kp].setF_i(14,(*lbfluid)[_i][_j][_k].getF_i(14));
-         (*ghostlat)[_i][_jp][_kp].setF_i(15,(*lbfluid)[_i][_j][_k].getF_i(15));
-         (*ghostlat)[_i][_jm][_km].setF_i(16,(*lbfluid)[_i][_j][_k].getF_i(16));
-         (*ghostlat)[_i][_jp][_km].setF_i(17,(*lbfluid)[_i][_j][_k].getF_i(17));
-         (*ghostlat)[_i][_jm][_kp].setF_i(18,(*lbfluid)[_i][_j][_k].getF_i(18));
-      }
-
 /*******************************************************************************************/
 
       /* SCHEME OF MD TO LB COUPLING */
@@ -680,12 +676,12 @@ namespace espressopp {
                   _ip = bin[0] + _i; _jp = bin[1] + _j; _kp = bin[2] + _k;
 
                   // force acting onto the fluid node at the moment (midpoint scheme)
-                  Real3D _f = (*lbfor)[_ip][_jp][_kp].getExtForceLoc()
-                            + (*lbfor)[_ip][_jp][_kp].getCouplForceLoc();
-                  Real3D _jLoc = Real3D((*lbmom)[_ip][_jp][_kp].getMom_i(1)+_f[0],
-                                        (*lbmom)[_ip][_jp][_kp].getMom_i(2)+_f[1],
-                                        (*lbmom)[_ip][_jp][_kp].getMom_i(3)+_f[2] );
-                  real _invDenLoc = 1. / (*lbmom)[_ip][_jp][_kp].getMom_i(0);
+                  Real3D _f = lbfor[getSiteIdx(_ip,_jp,_kp)].getExtForceLoc()
+                            + lbfor[getSiteIdx(_ip,_jp,_kp)].getCouplForceLoc();
+                  Real3D _jLoc = Real3D(lbmom.getValue(getSiteIdx(_ip,_jp,_kp), 1)+_f[0],
+                                        lbmom.getValue(getSiteIdx(_ip,_jp,_kp), 2)+_f[1],
+                                        lbmom.getValue(getSiteIdx(_ip,_jp,_kp), 3)+_f[2] );
+                  real _invDenLoc = 1. / lbmom.getValue(getSiteIdx(_ip,_jp,_kp), 0);
 
                   Real3D _u = _jLoc * _invDenLoc * _convCoeff;
                   interpVel += _u * delta[3 * _i] * delta[3 * _j + 1] * delta[3 * _k + 2];
@@ -715,7 +711,7 @@ namespace espressopp {
                   _fLoc *= delta[3*_i]; _fLoc *= delta[3*_j+1]; _fLoc *= delta[3*_k+2];
 
                   // add coupling force to the correspondent lattice cite
-                  (*lbfor)[_ip][_jp][_kp].addCouplForceLoc(_fLoc);
+                  lbfor[getSiteIdx(_ip,_jp,_kp)].addCouplForceLoc(_fLoc);
                }
             }
          }
@@ -729,19 +725,30 @@ namespace espressopp {
          int _numVels = getNumVels();
          int _offset = getHaloSkin();
 
+         real *_den = lbmom.getComp(0);
+         real *_jx = lbmom.getComp(1);
+         real *_jy = lbmom.getComp(2);
+         real *_jz = lbmom.getComp(3);
+
+         // sum up the populations row by row, the innermost loops run over
+         // contiguous memory of one population
+         int _len = _myNi[2] - 2*_offset;
          for (int i = _offset; i<_myNi[0]-_offset; ++i) {
             for (int j = _offset; j<_myNi[1]-_offset; ++j) {
-               for (int k = _offset; k<_myNi[2]-_offset; ++k) {
-                  real denLoc = 0.;
-                  Real3D jLoc = Real3D(0.);
-                  for (int l = 0; l < _numVels; l++) {
-                     denLoc += (*lbfluid)[i][j][k].getF_i(l);
-                     jLoc += (*lbfluid)[i][j][k].getF_i(l)*getCi(l);
+               int _s0 = getSiteIdx(i, j, _offset);
+               for (int k = 0; k < _len; k++) {
+                  _den[_s0+k] = 0.;
+                  _jx[_s0+k] = 0.; _jy[_s0+k] = 0.; _jz[_s0+k] = 0.;
+               }
+               for (int l = 0; l < _numVels; l++) {
+                  const real *_f = lbfluid.getComp(l) + _s0;
+                  Real3D _c = getCi(l);
+                  for (int k = 0; k < _len; k++) {
+                     _den[_s0+k] += _f[k];
+                     _jx[_s0+k] += _c[0]*_f[k];
+                     _jy[_s0+k] += _c[1]*_f[k];
+                     _jz[_s0+k] += _c[2]*_f[k];
                   }
-                  (*lbmom)[i][j][k].setMom_i(0,denLoc);
-                  (*lbmom)[i][j][k].setMom_i(1,jLoc[0]);
-                  (*lbmom)[i][j][k].setMom_i(2,jLoc[1]);
-                  (*lbmom)[i][j][k].setMom_i(3,jLoc[2]);
                }
             }
          }
@@ -877,11 +884,8 @@ namespace espressopp {
             std::string filenameForces = "couplForces";
             filenameForces.insert(0,prefix); filenameForces.append(suffix);
 
-            // fill in the coupling forces acting on MD-particles with zeros //
-            int _totNPart = getTotNPart();
-            for ( int _id = 0; _id <= _totNPart; _id++ ) {
-               setFOnPart( _id, Real3D(0.) );
-            }
+            // forget the coupling forces acting on MD-particles //
+            fOnPart.clear();
 
             // access particles' data and open a file to read couplForces from //
             long int _id;
@@ -909,7 +913,7 @@ namespace espressopp {
                for (int _i = 0; _i < _myNi[0]; _i++) {
                   for (int _j = 0; _j < _myNi[1]; _j++) {
                      for (int _k = 0; _k < _myNi[2]; _k++) {
-                        (*lbfor)[_i][_j][_k].setCouplForceLoc(Real3D(0.));
+                        lbfor[getSiteIdx(_i,_j,_k)].setCouplForceLoc(Real3D(0.));
                      }
                   }
                }
@@ -917,7 +921,7 @@ namespace espressopp {
                int _i, _j, _k;
 
                while (couplForcesFile >> _i >> _j >> _k >> _fx >> _fy >> _fz) {
-                  (*lbfor)[_i][_j][_k].setCouplForceLoc(Real3D(_fx,_fy,_fz));
+                  lbfor[getSiteIdx(_i,_j,_k)].setCouplForceLoc(Real3D(_fx,_fy,_fz));
                }
 
                couplForcesFile.close();
@@ -950,10 +954,10 @@ namespace espressopp {
                   _j = _y + 1 - _myPos[1]*(_myNi[1]-2*_offset);
                   _k = _z + 1 - _myPos[2]*(_myNi[2]-2*_offset);
 
-                  (*lbmom)[_i][_j][_k].setMom_i(0, _rho);
-                  (*lbmom)[_i][_j][_k].setMom_i(1, _vx * _rho);
-                  (*lbmom)[_i][_j][_k].setMom_i(2, _vy * _rho);
-                  (*lbmom)[_i][_j][_k].setMom_i(3, _vz * _rho);
+                  lbmom.setValue(getSiteIdx(_i,_j,_k), 0, _rho);
+                  lbmom.setValue(getSiteIdx(_i,_j,_k), 1, _vx * _rho);
+                  lbmom.setValue(getSiteIdx(_i,_j,_k), 2, _vy * _rho);
+                  lbmom.setValue(getSiteIdx(_i,_j,_k), 3, _vz * _rho);
                }
 
                fluidFile.close();
@@ -1066,7 +1070,7 @@ namespace espressopp {
          for ( int _i = 0; _i < _myNi[0]; _i++ ) {
             for ( int _j = 0; _j < _myNi[1]; _j++ ) {
                for ( int _k = 0; _k < _myNi[2]; _k++ ) {
-                  Real3D _couplForceLoc = (*lbfor)[_i][_j][_k].getCouplForceLoc();
+                  Real3D _couplForceLoc = lbfor[getSiteIdx(_i,_j,_k)].getCouplForceLoc();
                   if ( _couplForceLoc.sqr() < ROUND_ERROR_PREC ) {
                   // see definition of ROUND ERROR in src/include/esconfig.hpp
                   } else {
@@ -1096,11 +1100,11 @@ namespace espressopp {
          for ( int _i = _offset; _i < _myNi[0]-_offset; _i++ ) {
             for ( int _j = _offset; _j < _myNi[1]-_offset; _j++ ) {
                for ( int _k = _offset; _k < _myNi[2]-_offset; _k++ ) {
-                  real _rho = (*lbmom)[_i][_j][_k].getMom_i(0);
+                  real _rho = lbmom.getValue(getSiteIdx(_i,_j,_k), 0);
                   real _jx, _jy, _jz;
-                  _jx = (*lbmom)[_i][_j][_k].getMom_i(1);
-                  _jy = (*lbmom)[_i][_j][_k].getMom_i(2);
-                  _jz = (*lbmom)[_i][_j][_k].getMom_i(3);
+                  _jx = lbmom.getValue(getSiteIdx(_i,_j,_k), 1);
+                  _jy = lbmom.getValue(getSiteIdx(_i,_j,_k), 2);
+                  _jz = lbmom.getValue(getSiteIdx(_i,_j,_k), 3);
 
                   // -1 comes from the offset. we have to output the first real node as 0
                   fprintf (fluidFile, "%d %d %d %15.10f %15.10f %15.10f %15.10f\n",
@@ -1270,11 +1274,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (j=0; j<_myNi[1]; j++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(1);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(7);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(9);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(11);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(13);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 1);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 7);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 9);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 11);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 13);
             }
          }
 
@@ -1296,11 +1300,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (j=0; j<_myNi[1]; j++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(1, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(7, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(9, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(11, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(13, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 1, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 7, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 9, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 11, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 13, bufToRecv[idx+4]);
             }
          }
 
@@ -1313,11 +1317,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (j=0; j<_myNi[1]; j++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(2);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(8);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(10);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(12);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(14);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 2);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 8);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 10);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 12);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 14);
             }
          }
 
@@ -1339,11 +1343,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (j=0; j<_myNi[1]; j++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(2, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(8, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(10, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(12, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(14, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 2, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 8, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 10, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 12, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 14, bufToRecv[idx+4]);
             }
          }
 
@@ -1363,11 +1367,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(3);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(7);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(10);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(15);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(17);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 3);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 7);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 10);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 15);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 17);
             }
          }
 
@@ -1389,11 +1393,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(3, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(7, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(10, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(15, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(17, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 3, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 7, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 10, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 15, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 17, bufToRecv[idx+4]);
             }
          }
 
@@ -1406,11 +1410,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(4);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(8);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(9);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(16);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(18);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 4);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 8);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 9);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 16);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 18);
             }
          }
 
@@ -1432,11 +1436,11 @@ namespace espressopp {
          idx = 0;
          for (k=0; k<_myNi[2]; k++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(4, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(8, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(9, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(16, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(18, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 4, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 8, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 9, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 16, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 18, bufToRecv[idx+4]);
             }
          }
 
@@ -1456,11 +1460,11 @@ namespace espressopp {
          idx = 0;
          for (j=0; j<_myNi[1]; j++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(5);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(11);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(14);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(15);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(18);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 5);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 11);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 14);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 15);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 18);
             }
          }
 
@@ -1482,11 +1486,11 @@ namespace espressopp {
          idx = 0;
          for (j=0; j<_myNi[1]; j++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(5, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(11, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(14, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(15, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(18, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 5, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 11, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 14, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 15, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 18, bufToRecv[idx+4]);
             }
          }
 
@@ -1499,11 +1503,11 @@ namespace espressopp {
          idx = 0;
          for (j=0; j<_myNi[1]; j++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               bufToSend[idx] = (*ghostlat)[i][j][k].getF_i(6);
-               bufToSend[idx+1] = (*ghostlat)[i][j][k].getF_i(12);
-               bufToSend[idx+2] = (*ghostlat)[i][j][k].getF_i(13);
-               bufToSend[idx+3] = (*ghostlat)[i][j][k].getF_i(16);
-               bufToSend[idx+4] = (*ghostlat)[i][j][k].getF_i(17);
+               bufToSend[idx] = ghostlat.getValue(getSiteIdx(i,j,k), 6);
+               bufToSend[idx+1] = ghostlat.getValue(getSiteIdx(i,j,k), 12);
+               bufToSend[idx+2] = ghostlat.getValue(getSiteIdx(i,j,k), 13);
+               bufToSend[idx+3] = ghostlat.getValue(getSiteIdx(i,j,k), 16);
+               bufToSend[idx+4] = ghostlat.getValue(getSiteIdx(i,j,k), 17);
             }
          }
 
@@ -1525,11 +1529,11 @@ namespace espressopp {
          idx = 0;
          for (j=0; j<_myNi[1]; j++) {
             for (i=0; i<_myNi[0]; i++, idx += numPopTransf) {
-               (*ghostlat)[i][j][k].setF_i(6, bufToRecv[idx]);
-               (*ghostlat)[i][j][k].setF_i(12, bufToRecv[idx+1]);
-               (*ghostlat)[i][j][k].setF_i(13, bufToRecv[idx+2]);
-               (*ghostlat)[i][j][k].setF_i(16, bufToRecv[idx+3]);
-               (*ghostlat)[i][j][k].setF_i(17, bufToRecv[idx+4]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 6, bufToRecv[idx]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 12, bufToRecv[idx+1]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 13, bufToRecv[idx+2]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 16, bufToRecv[idx+3]);
+               ghostlat.setValue(getSiteIdx(i,j,k), 17, bufToRecv[idx+4]);
             }
          }
 
@@ -1572,7 +1576,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[1]*k + j*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1596,7 +1600,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numForceComp*_myNi[1]*k + j*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1611,7 +1615,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[1]*k + j*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1635,7 +1639,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numForceComp*_myNi[1]*k + j*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1657,7 +1661,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[0]*k + i*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1681,7 +1685,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numForceComp*_myNi[0]*k + i*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1696,7 +1700,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[0]*k + i*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1720,7 +1724,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numForceComp*_myNi[0]*k + i*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1742,7 +1746,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[0]*j + i*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1766,7 +1770,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numForceComp*_myNi[0]*j + i*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1781,7 +1785,7 @@ namespace espressopp {
                idx = numForceComp*_myNi[0]*j + i*numForceComp;
 
                for ( int _dir = 0; _dir < 3; ++_dir ) {
-                  bufToSend[idx+_dir] = (*lbfor)[i][j][k].getCouplForceLoc().getItem(_dir);
+                  bufToSend[idx+_dir] = lbfor[getSiteIdx(i,j,k)].getCouplForceLoc().getItem(_dir);
                }
             }
          }
@@ -1805,7 +1809,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numForceComp*_myNi[0]*j + i*numForceComp;
                _addForce = Real3D(bufToRecv[idx], bufToRecv[idx+1], bufToRecv[idx+2]);
-               (*lbfor)[i][j][k].addCouplForceLoc(_addForce);
+               lbfor[getSiteIdx(i,j,k)].addCouplForceLoc(_addForce);
             }
          }
 
@@ -1845,7 +1849,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numPopTransf*_myNi[1]*k + j*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -1869,7 +1873,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numPopTransf*_myNi[1]*k + j*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
@@ -1884,7 +1888,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numPopTransf*_myNi[1]*k + j*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -1908,7 +1912,7 @@ namespace espressopp {
             for (j=0; j<_myNi[1]; j++) {
                idx = numPopTransf*_myNi[1]*k + j*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
@@ -1930,7 +1934,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*k + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -1954,7 +1958,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*k + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
@@ -1969,7 +1973,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*k + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -1993,7 +1997,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*k + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
@@ -2015,7 +2019,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*j + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -2039,7 +2043,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*j + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
@@ -2054,7 +2058,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*j + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  bufToSend[idx+l] = (*lbmom)[i][j][k].getMom_i(l);
+                  bufToSend[idx+l] = lbmom.getValue(getSiteIdx(i,j,k), l);
                }
             }
          }
@@ -2078,7 +2082,7 @@ namespace espressopp {
             for (i=0; i<_myNi[0]; i++) {
                idx = numPopTransf*_myNi[0]*j + i*numPopTransf;
                for (int l = 0; l<numPopTransf; ++l) {
-                  (*lbmom)[i][j][k].setMom_i(l, bufToRecv[idx+l]);
+                  lbmom.setValue(getSiteIdx(i,j,k), l, bufToRecv[idx+l]);
                }
             }
          }
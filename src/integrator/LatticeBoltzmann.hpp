@@ -27,15 +27,13 @@
 #include "logging.hpp"
 #include "Extension.hpp"
 #include "boost/signals2.hpp"
+#include "boost/unordered_map.hpp"
+#include "Buffer.hpp"
 #include "esutil/Timer.hpp"
 #include "Real3D.hpp"
 #include "Int3D.hpp"
 #include "LatticeSite.hpp"
 
-typedef std::vector< std::vector< std::vector<espressopp::integrator::LBSite> > > lblattice;
-typedef std::vector< std::vector< std::vector<espressopp::integrator::LBMom> > > lbmoments;
-typedef std::vector< std::vector< std::vector<espressopp::integrator::LBForce> > > lbforces;
-
 namespace espressopp {
    namespace integrator {
       class LatticeBoltzmann : public Extension {
@@ -164,9 +162,9 @@ namespace espressopp {
          void setTotNPart (int _totNPart);            // tot num of MD particles in the whole system (sum over CPUs)
          int getTotNPart ();
 
-         void setFOnPart (int _id, Real3D _fOnPart);  // force on particle
-         Real3D getFOnPart (int _id);
-         void addFOnPart (int _id, Real3D _fOnPart);
+         void setFOnPart (longint _id, Real3D _fOnPart);  // force on local particle
+         Real3D getFOnPart (longint _id);
+         void addFOnPart (longint _id, Real3D _fOnPart);
 
          void keepLBDump ();
 
@@ -224,9 +222,7 @@ namespace espressopp {
          void calcDenMom ();
          real convMDtoLB (int _opCode);
 
-         void collideStream ();                    // use collide-stream scheme
-
-         void streaming (int _i, int _j, int _k); // streaming along velocities
+         void collideStream ();                    // fused collide-stream sweep
 
          /* MPI FUNCTIONS */
          void findMyNeighbours ();
@@ -275,17 +271,25 @@ namespace espressopp {
          bool extForce;                         // flag for an external force
 
          // LATTICES
-         lblattice *lbfluid;
-         lblattice *ghostlat;
-         lbmoments *lbmom;
-         lbforces *lbfor;
+         // all lattices share the flat site index of getSiteIdx()
+         LBLattice lbfluid;                     // populations
+         LBLattice ghostlat;                    // populations after streaming
+         LBLattice lbmom;                       // density and mass flux
+         std::vector<LBForce> lbfor;            // ext and coupling forces
+
+         // flat index of site (i,j,k) incl. halo, k runs fastest
+         int getSiteIdx (int _i, int _j, int _k) {
+            return (_i * myNi[1] + _j) * myNi[2] + _k;
+         }
 
          // COUPLING
          bool coupling;                         // flag for a coupling force
          int nSteps;                            // # of MD steps between LB update
          int totNPart;                          // total number of MD particles
          real fricCoeff;                        // friction in LB-MD coupling (LJ-units)
-         std::vector<Real3D> fOnPart;           // force acting onto an MD particle
+         // force acting onto an MD particle, kept for the local particles
+         // only and migrated with them, see beforeSendParticles()
+         boost::unordered_map<longint, Real3D> fOnPart;
          int saveStep;                          // step numbers of LBConfs to save
 
          // MPI THINGS
@@ -299,6 +303,8 @@ namespace espressopp {
          // SIGNALS
          boost::signals2::connection _befIntV;
          boost::signals2::connection _recalc2;
+         boost::signals2::connection _beforeSend;
+         boost::signals2::connection _afterRecv;
 
          // TIMERS
          esutil::WallTimer swapping, colstream, comm;
@@ -309,6 +315,10 @@ namespace espressopp {
          void connect();
          void disconnect();
 
+         // move the coupling forces along with the particles
+         void beforeSendParticles(ParticleList& pl, OutBuffer& buf);
+         void afterRecvParticles(ParticleList& pl, InBuffer& buf);
+
          /** Logger */
          static LOG4ESPP_DECL_LOGGER(theLogger);
       };
@@ -23,6 +23,7 @@
 #include "python.hpp"
 #include "LatticeSite.hpp"
 #include <iomanip>
+#include <algorithm>
 
 #include "types.hpp"
 #include "System.hpp"
@@ -35,23 +36,15 @@ namespace espressopp {
   using namespace iterator;
   namespace integrator {
     LBSite::LBSite () {
-            f   = std::vector<real>(LatticePar::getNumVelsLoc(), 0.);
+            for (int i = 0; i < 19; i++) f[i] = 0.;
     }
 
 /*******************************************************************************************/
 
         /* SET AND GET PART */
-    void LBSite::setF_i (int _i, real _f) { f[_i] = _f;}
-    real LBSite::getF_i (int _i) { return f[_i];}
-
     void LBSite::setPhiLoc (int _i, real _phi) { phiLoc[_i] = _phi;}
     real LBSite::getPhiLoc (int _i) { return phiLoc[_i];}
 
-/*******************************************************************************************/
-
-    /* HELPFUL OPERATIONS WITH POPULATIONS AND MOMENTS */
-    void LBSite::scaleF_i (int _i, real _value) { f[_i] *= _value;}
-
 /*******************************************************************************************/
 
     /* MANAGING STATIC VARIABLES */
@@ -279,15 +272,20 @@ namespace espressopp {
 
 /*******************************************************************************************/
 
-    LBMom::LBMom () {
-      mom = std::vector<real>(4, 0.);
+    LBLattice::LBLattice () : numSites(0) {
     }
 
-        /* SET AND GET PART */
-    void LBMom::setMom_i (int _i, real _mom) { mom[_i] = _mom;}
-    real LBMom::getMom_i (int _i) { return mom[_i];}
+    void LBLattice::resize (int _numSites, int _numComps) {
+      numSites = _numSites;
+      data.assign(_numComps * _numSites, 0.);
+    }
+
+    void LBLattice::swap (LBLattice& _other) {
+      std::swap(numSites, _other.numSites);
+      data.swap(_other.data);
+    }
 
-    LBMom::~LBMom() {
+    LBLattice::~LBLattice() {
     }
 
 /*******************************************************************************************/
@@ -25,6 +25,7 @@
 #define _INTEGRATOR_LATTICEMODEL_HPP
 
 #include "Real3D.hpp"
+#include <vector>
 
 namespace espressopp {
    namespace integrator {
@@ -32,9 +33,9 @@ namespace espressopp {
          /**
           * \brief Description of the properties of the LBSite class
           *
-          * This is a LBSite class for storing of the populations, ext and coupling forces on the lattice site. Through its methods this class handles everything that happens on the node during collision. It also sets the values to the D3Q19 model-related parameters on EVERY lattice site.
+          * This is a LBSite class holding the populations of one lattice site while it undergoes the collision. Through its methods this class handles everything that happens on the node during collision. It also sets the values to the D3Q19 model-related parameters on EVERY lattice site.
           *
-          * The normal lattice and its ghost counterpart are based on this LBSite class. They are defined in LatticeBoltzmann.*pp files.
+          * The lattices themselves are stored in the LBLattice class below. The collide-stream sweep in LatticeBoltzmann.cpp gathers the populations of a site into an LBSite, collides them and pushes them to the neighbours.
           *
           * Please note that by default ESPResSo++ supports only D3Q19 lattice model.
           * However, you can code other lattice models, it should not be difficult.
@@ -44,14 +45,14 @@ namespace espressopp {
          ~LBSite ();
 
          /* SET AND GET DECLARATION */
-         void setF_i (int _i, real _f);									// set f_i population to _f
-         real getF_i (int _i);												// get f_i population
+         void setF_i (int _i, real _f) { f[_i] = _f;}			// set f_i population to _f
+         real getF_i (int _i) { return f[_i];}						// get f_i population
 
-         void setPhiLoc (int _i, real _phi);							// set phi value to _phi
-         real getPhiLoc (int _i);											// get phi value
+         static void setPhiLoc (int _i, real _phi);				// set phi value to _phi
+         static real getPhiLoc (int _i);									// get phi value
 
          /* HELPFUL OPERATIONS WITH POPULATIONS AND MOMENTS */
-         void scaleF_i (int _i, real _value);                  // scale population i by _value
+         void scaleF_i (int _i, real _value) { f[_i] *= _value;}	// scale population i by _value
 
          /* FUNCTIONS DECLARATION */
          void collision (bool _fluct, bool _extForce,
@@ -72,28 +73,38 @@ namespace espressopp {
          void btranMomToPop (real *m);										// back-transform moms to pops
 
       private:
-         std::vector<real> f;														// populations on a site
+         real f[19];																		// populations on a site (D3Q19)
          static std::vector<real> phiLoc;								// local fluct amplitudes
       };
 
       /*******************************************************************************************/
 
-      class LBMom {
+      class LBLattice {
          /**
-          * \brief Description of the properties of the LBMom class
+          * \brief Description of the properties of the LBLattice class
           *
-          * This is a LBMom class for storing of the hydrodynamic moments on the lattice site.
-          * These include density and 3-comp. mass flux.
+          * This is a LBLattice class for storing a number of real values (populations
+          * or hydrodynamic moments) on every site of the lattice. The values are kept
+          * in a structure-of-arrays layout: component l of all sites forms one contiguous
+          * array, so that the sweeps over the lattice run over consecutive memory.
+          * Sites are addressed by their flat index, see LatticeBoltzmann::getSiteIdx().
           */
       public:
-         LBMom ();																				// constr of the ghost lattice
-         ~LBMom ();																			// destr of the ghost lattice
+         LBLattice ();
+         ~LBLattice ();
 
-         void setMom_i (int _i, real _mom);							// set f_i population to _f
-         real getMom_i (int _i);													// get f_i population
+         void resize (int _numSites, int _numComps);		// allocate and zero the storage
+
+         void setValue (int _site, int _l, real _value) { data[_l*numSites + _site] = _value;}
+         real getValue (int _site, int _l) { return data[_l*numSites + _site];}
+
+         real* getComp (int _l) { return &data[_l*numSites];}	// array of component _l
+
+         void swap (LBLattice& _other);									// exchange storage in O(1)
 
       private:
-         std::vector<real> mom;													// pops on the ghost lattice
+         int numSites;																	// number of sites incl. halo
+         std::vector<real> data;												// values of all components
       };
 
       /*******************************************************************************************/
@@ -31,7 +31,9 @@
 #include "interaction/Potential.hpp"
 #include "System.hpp"
 #include "storage/Storage.hpp"
+#include "LangevinThermostat.hpp"
 #include "mpi.hpp"
+#include <limits>
 
 #ifdef VTRACE
 #include "vampirtrace/vt_user.h"
@@ -53,6 +55,12 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "construct VelocityVerlet");
       resortFlag = true;
       maxDist    = 0.0;
+      exactSkin  = false;
+      overlapComm = false;
+      loadBalanceInterval = 0;
+      loadBalanceByTime = false;
+      baoabThermostat = 0;
+      refPositionsValid = false;
       timeIntegrate.reset();
       resetTimers();
       System& sys = getSystemRef();
@@ -61,6 +69,114 @@ namespace espressopp {
     VelocityVerlet::~VelocityVerlet()
     {
       LOG4ESPP_INFO(theLogger, "free VelocityVerlet");
+      conParticlesChanged.disconnect();
+    }
+
+    void VelocityVerlet::setExactSkin(bool _exactSkin)
+    {
+      if (exactSkin == _exactSkin) return;
+      exactSkin = _exactSkin;
+      conParticlesChanged.disconnect();
+      refPositionsValid = false;
+      refPositions.clear();
+      if (exactSkin) {
+        conParticlesChanged = getSystemRef().storage->onParticlesChanged.connect(
+          boost::bind(&VelocityVerlet::saveReferencePositions, this));
+        // the reference positions are taken at the next resort
+        resortFlag = true;
+      }
+    }
+
+    void VelocityVerlet::saveReferencePositions()
+    {
+      CellList realCells = getSystemRef().storage->getRealCells();
+      refPositions.clear();
+      for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
+        refPositions.push_back(cit->position());
+      }
+      refPositionsValid = true;
+    }
+
+    real VelocityVerlet::localDisplacement()
+    {
+      CellList realCells = getSystemRef().storage->getRealCells();
+
+      // an invalid reference (e.g. particles were added or removed without
+      // a resort) counts as infinite displacement and forces a rebuild
+      if (!refPositionsValid) return std::numeric_limits<real>::max();
+
+      real maxSqDist = 0.0;
+      size_t count = 0;
+      CellListIterator cit(realCells);
+      for(; !cit.isDone() && count < refPositions.size(); ++cit, ++count) {
+        Real3D dist = cit->position() - refPositions[count];
+        maxSqDist = std::max(maxSqDist, dist.sqr());
+      }
+      if (!cit.isDone() || count != refPositions.size()) {
+        return std::numeric_limits<real>::max();
+      }
+      return sqrt(maxSqDist);
+    }
+
+    bool VelocityVerlet::exceedsSkin(real skinHalf)
+    {
+      System& system = getSystemRef();
+
+      // the nodes whose bound stays below skin/2 skip the sweep
+      if (maxDist > skinHalf) maxDist = localDisplacement();
+
+      real globalMax;
+      mpi::all_reduce(*system.comm, maxDist, globalMax, boost::mpi::maximum<real>());
+
+      LOG4ESPP_INFO(theLogger, "max displacement bound = " << globalMax << ", skin/2 = " << skinHalf);
+
+      return globalMax > skinHalf;
+    }
+
+    real VelocityVerlet::tuneSkin(int nsteps, real minSkin, real maxSkin, int numSkins)
+    {
+      if (nsteps < 1 || numSkins < 1) {
+        throw std::invalid_argument("tuneSkin needs at least one step and one skin");
+      }
+      if (minSkin <= 0.0 || maxSkin < minSkin) {
+        throw std::invalid_argument("tuneSkin needs 0 < minSkin <= maxSkin");
+      }
+
+      System& system = getSystemRef();
+      storage::Storage& storage = *system.storage;
+      real bestSkin = system.getSkin();
+      real bestTime = std::numeric_limits<real>::max();
+
+      for (int i = 0; i < numSkins; i++) {
+        real skin = minSkin;
+        if (numSkins > 1) skin += i * (maxSkin - minSkin) / (numSkins - 1);
+
+        // the cell grid and the Verlet lists follow the new skin
+        system.setSkin(skin);
+        storage.cellAdjust();
+        resortFlag = true;
+
+        WallTimer timer;
+        run(nsteps);
+        real timePerStep = timer.getElapsedTime() / nsteps;
+        real maxTimePerStep;
+        mpi::all_reduce(*system.comm, timePerStep, maxTimePerStep, boost::mpi::maximum<real>());
+
+        LOG4ESPP_INFO(theLogger, "tuneSkin: skin = " << skin <<
+                      ", time per step = " << maxTimePerStep <<
+                      ", resort = " << timeResort << ", force = " << timeForce);
+
+        if (maxTimePerStep < bestTime) {
+          bestTime = maxTimePerStep;
+          bestSkin = skin;
+        }
+      }
+
+      system.setSkin(bestSkin);
+      storage.cellAdjust();
+      resortFlag = true;
+
+      return bestSkin;
     }
 
     void VelocityVerlet::run(int nsteps)
@@ -72,6 +188,11 @@ namespace espressopp {
       System& system = getSystemRef();
       storage::Storage& storage = *system.storage;
       real skinHalf = 0.5 * system.getSkin();
+      // extensions that move particles outside of the real cells (e.g.
+      // AdResS atomistic particles) only report a per-step bound through
+      // inIntP, so their runs keep the conservative criterion
+      bool exactCriterion = exactSkin && inIntP.num_slots() == 0;
+      if (exactSkin && !refPositionsValid) resortFlag = true;
 
       // Prepare the force comp timers if the size is not valid.
       const InteractionList& srIL = system.shortRangeInteractions;
@@ -132,7 +253,10 @@ namespace espressopp {
         timeBefIntPS += timeIntegrate.getElapsedTime() - time;
 
         LOG4ESPP_INFO(theLogger, "updating positions and velocities")
-        maxDist += integrate1();
+        real stepDist = integrate1();
+        // with the exact criterion a local upper bound of the
+        // displacement since the reference positions
+        maxDist += stepDist;
         timeInt1 += timeIntegrate.getElapsedTime() - time;
 
         /*real cellsize = 1.4411685442;
@@ -146,9 +270,32 @@ namespace espressopp {
         aftIntP();
         timeAftIntPS += timeIntegrate.getElapsedTime() - time;
 
-        LOG4ESPP_INFO(theLogger, "maxDist = " << maxDist << ", skin/2 = " << skinHalf);
+        if (exactCriterion) {
+          // positions may also have been changed by aftIntP, which the
+          // bound does not cover, so then measure every step
+          if (aftIntP.num_slots() > 0 ||
+              storage.getNRealParticles() != longint(refPositions.size())) {
+            maxDist = std::numeric_limits<real>::max();
+          }
+          if (exceedsSkin(skinHalf)) resortFlag = true;
+        } else {
+          LOG4ESPP_INFO(theLogger, "maxDist = " << maxDist << ", skin/2 = " << skinHalf);
+
+          if (maxDist > skinHalf) resortFlag = true;
+        }
 
-        if (maxDist > skinHalf) resortFlag = true;
+        if (loadBalanceInterval > 0 && step > 0 && step % loadBalanceInterval == 0) {
+            // load balancing redistributes the particles, so it replaces the resort
+            time = timeIntegrate.getElapsedTime();
+            real load = loadBalanceByTime ? timeForce - timeForceBalanced : -1.0;
+            real imbalance = storage.loadBalance(load, 0.5);
+            LOG4ESPP_INFO(theLogger, "step " << step << ": load balancing, imbalance was " << imbalance);
+            timeForceBalanced = timeForce;
+            maxDist = 0.0;
+            resortFlag = false;
+            nResorts ++;
+            timeResort += timeIntegrate.getElapsedTime() - time;
+        }
 
         if (resortFlag) {
             VT_TRACER("resort1");
@@ -196,6 +343,7 @@ namespace espressopp {
         }
       }
 
+      timeForceBalanced = 0.0;
       timeComm1  = 0.0;
       timeComm2  = 0.0;
       timeInt1   = 0.0;
@@ -279,6 +427,7 @@ namespace espressopp {
       // loop over all particles of the local cells
       int count = 0;
       real maxSqDist = 0.0; // maximal square distance a particle moves
+      real half_dt = 0.5 * dt;
       for(CellListIterator cit(realCells); !cit.isDone(); ++cit) {
         real sqDist = 0.0;
         LOG4ESPP_INFO(theLogger, "updating first half step of velocities and full step of positions")
@@ -302,7 +451,15 @@ namespace espressopp {
         // Propagate positions (only NVT): p(t + dt) = p(t) + dt * v(t+0.5*dt) 
         Real3D deltaP = cit->velocity();
         
-        deltaP *= dt;
+        if (baoabThermostat) {
+          // BAOAB: half a drift, the Langevin velocity update and the
+          // second half of the drift with the new velocity
+          deltaP *= half_dt;
+          baoabThermostat->frictionThermoBAOAB(*cit);
+          deltaP += half_dt * cit->velocity();
+        } else {
+          deltaP *= dt;
+        }
         cit->position() += deltaP;
         sqDist += deltaP * deltaP;
 
@@ -314,6 +471,13 @@ namespace espressopp {
       // signal
       inIntP(maxSqDist);
 
+      // with exact tracking the step displacement is not needed globally
+      if (exactSkin && inIntP.num_slots() == 0) {
+        LOG4ESPP_INFO(theLogger, "moved " << count << " particles in integrate1" <<
+		      ", max move local = " << sqrt(maxSqDist));
+        return sqrt(maxSqDist);
+      }
+
       real maxAllSqDist;
       mpi::all_reduce(*system.comm, maxSqDist, maxAllSqDist, boost::mpi::maximum<real>());
 
@@ -367,29 +531,101 @@ namespace espressopp {
 
     void VelocityVerlet::updateForces()
     {
-      LOG4ESPP_INFO(theLogger, "update ghosts, calculate forces and collect ghost forces")
+      // the aftInitF extensions (e.g. DPD, AdResS) may need the ghosts
+      if (overlapComm && aftInitF.num_slots() == 0) {
+        updateForcesOverlapped();
+      } else {
+        LOG4ESPP_INFO(theLogger, "update ghosts, calculate forces and collect ghost forces")
+        real time;
+        storage::Storage& storage = *getSystemRef().storage;
+        time = timeIntegrate.getElapsedTime();
+        {
+          VT_TRACER("commF");
+          storage.updateGhosts();
+        }
+        timeComm1 += timeIntegrate.getElapsedTime() - time;
+        time = timeIntegrate.getElapsedTime();
+        calcForces();
+        timeForce += timeIntegrate.getElapsedTime() - time;
+        time = timeIntegrate.getElapsedTime();
+        {
+          VT_TRACER("commR");
+          storage.collectGhostForces();
+        }
+        timeComm2 += timeIntegrate.getElapsedTime() - time;
+      }
+
+      timeIntegrate.startMeasure();
+      // signal
+      aftCalcF();
+      timeAftCalcFS += timeIntegrate.stopMeasure();
+    }
+
+    void VelocityVerlet::updateForcesOverlapped()
+    {
+      LOG4ESPP_INFO(theLogger, "update ghosts and collect ghost forces overlapped with the force calculation")
+
+      // the interior forces are computed in slices, one half while the
+      // ghost positions are in flight and the other half while the ghost
+      // forces are; the communication is advanced after every slice
+      const int nSlices = 8;
       real time;
       storage::Storage& storage = *getSystemRef().storage;
+      const InteractionList& srIL = getSystemRef().shortRangeInteractions;
+
       time = timeIntegrate.getElapsedTime();
-      {
-        VT_TRACER("commF");
-        storage.updateGhosts();
-      }
+      storage.startUpdateGhosts();
       timeComm1 += timeIntegrate.getElapsedTime() - time;
+
       time = timeIntegrate.getElapsedTime();
-      calcForces();
+      initForces();
       timeForce += timeIntegrate.getElapsedTime() - time;
+
+      for (int slice = 0; slice < nSlices; ++slice) {
+        if (slice == nSlices / 2) {
+          time = timeIntegrate.getElapsedTime();
+          {
+            VT_TRACER("commF");
+            storage.finishUpdateGhosts();
+          }
+          timeComm1 += timeIntegrate.getElapsedTime() - time;
+
+          for (size_t i = 0; i < srIL.size(); i++) {
+            time = timeIntegrate.getElapsedTime();
+            srIL[i]->addForcesBoundary();
+            real dt = timeIntegrate.getElapsedTime() - time;
+            timeForceComp[i] += dt;
+            timeForce += dt;
+          }
+
+          time = timeIntegrate.getElapsedTime();
+          storage.startCollectGhostForces();
+          timeComm2 += timeIntegrate.getElapsedTime() - time;
+        }
+
+        for (size_t i = 0; i < srIL.size(); i++) {
+          time = timeIntegrate.getElapsedTime();
+          srIL[i]->addForcesInterior(slice, nSlices);
+          real dt = timeIntegrate.getElapsedTime() - time;
+          timeForceComp[i] += dt;
+          timeForce += dt;
+        }
+
+        time = timeIntegrate.getElapsedTime();
+        storage.progressGhostCommunication();
+        if (slice < nSlices / 2) {
+          timeComm1 += timeIntegrate.getElapsedTime() - time;
+        } else {
+          timeComm2 += timeIntegrate.getElapsedTime() - time;
+        }
+      }
+
       time = timeIntegrate.getElapsedTime();
       {
         VT_TRACER("commR");
-        storage.collectGhostForces();
+        storage.finishCollectGhostForces();
       }
       timeComm2 += timeIntegrate.getElapsedTime() - time;
-
-      timeIntegrate.startMeasure();
-      // signal
-      aftCalcF();
-      timeAftCalcFS += timeIntegrate.stopMeasure();
     }
 
     void VelocityVerlet::initForces()
@@ -460,6 +696,11 @@ namespace espressopp {
         ("integrator_VelocityVerlet", init< shared_ptr<System> >())
         .def("getTimers", &wrapGetTimers)
         .def("resetTimers", &VelocityVerlet::resetTimers)
+        .def("tuneSkin", &VelocityVerlet::tuneSkin)
+        .add_property("exactSkin", &VelocityVerlet::getExactSkin, &VelocityVerlet::setExactSkin)
+        .add_property("overlapComm", &VelocityVerlet::getOverlapComm, &VelocityVerlet::setOverlapComm)
+        .add_property("loadBalanceInterval", &VelocityVerlet::getLoadBalanceInterval, &VelocityVerlet::setLoadBalanceInterval)
+        .add_property("loadBalanceByTime", &VelocityVerlet::getLoadBalanceByTime, &VelocityVerlet::setLoadBalanceByTime)
         ;
     }
   }
@@ -27,6 +27,7 @@
 #define _INTEGRATOR_VELOCITYVERLET_HPP
 
 #include "types.hpp"
+#include "Real3D.hpp"
 #include "MDIntegrator.hpp"
 #include "esutil/Timer.hpp"
 #include <boost/signals2.hpp>
@@ -34,6 +35,8 @@
 namespace espressopp {
   namespace integrator {
 
+    class LangevinThermostat;
+
     /** Velocity Verlet Integrator */
     class VelocityVerlet : public MDIntegrator {
 
@@ -44,6 +47,41 @@ namespace espressopp {
         virtual ~VelocityVerlet();
 
         void run(int nsteps);
+
+        /** Switch between the conservative rebuild criterion (sum of the
+            per-step maximal displacements) and exact per-particle tracking
+            of the displacement since the last rebuild. */
+        void setExactSkin(bool _exactSkin);
+        bool getExactSkin() { return exactSkin; }
+
+        /** Overlap the ghost communication with the force computation:
+            pairs of real particles are computed while the ghost
+            positions and, afterwards, the ghost forces are in flight.
+            Needs a storage with non-blocking ghost communication
+            (DomainDecompositionNonBlocking) to have an effect. */
+        void setOverlapComm(bool _overlapComm) { overlapComm = _overlapComm; }
+        bool getOverlapComm() { return overlapComm; }
+
+        /** Balance the load over the nodes every loadBalanceInterval
+            steps (0: never) with Storage::loadBalance(). The load is the
+            force computation time since the last balancing if
+            loadBalanceByTime is set, otherwise the number of particles. */
+        void setLoadBalanceInterval(int _interval) { loadBalanceInterval = _interval; }
+        int getLoadBalanceInterval() { return loadBalanceInterval; }
+        void setLoadBalanceByTime(bool _byTime) { loadBalanceByTime = _byTime; }
+        bool getLoadBalanceByTime() { return loadBalanceByTime; }
+
+        /** Langevin thermostat whose velocity update is fused into
+            integrate1() as the O step of the BAOAB splitting (0: none).
+            Set by LangevinThermostat::connect() in BAOAB mode. */
+        void setBAOABThermostat(LangevinThermostat* _thermostat) { baoabThermostat = _thermostat; }
+        LangevinThermostat* getBAOABThermostat() { return baoabThermostat; }
+
+        /** Run numSkins trial blocks of nsteps each with skins spread
+            evenly over [minSkin, maxSkin], keep the skin with the lowest
+            wall time per step and return it. The trial steps are part of
+            the trajectory. */
+        real tuneSkin(int nsteps, real minSkin, real maxSkin, int numSkins);
         
         /** Load timings in array to export to Python as a tuple. */
         void loadTimers(std::vector<real> &return_vector, std::vector<std::string> &labels);
@@ -58,10 +96,38 @@ namespace espressopp {
         bool resortFlag;  //!< true implies need for resort of particles
         real maxDist;
 
+        bool exactSkin;  //!< true: rebuild on the exact displacement since the last rebuild
+        bool refPositionsValid;
+        std::vector<Real3D> refPositions;  //!< positions at the last rebuild, in realCells order
+        boost::signals2::connection conParticlesChanged;
+
+        /** Store the current real particle positions as reference. */
+        void saveReferencePositions();
+
+        /** \return maximal distance a particle of this node has moved
+            since the reference positions were stored. */
+        real localDisplacement();
+
+        /** Collective check of the exact skin criterion, every step.
+            maxDist is a local upper bound of the displacement (the sum
+            of the step maxima), only nodes where it exceeds skin/2
+            measure the exact displacement. */
+        bool exceedsSkin(real skinHalf);
+
+        bool overlapComm;
+
+        int loadBalanceInterval;
+        bool loadBalanceByTime;
+        real timeForceBalanced;  //!< timeForce at the last load balancing
+
+        LangevinThermostat* baoabThermostat;
+
         real maxCut;
 
         /** Method updates particle positions and velocities.
-            \return maximal square distance a particle has moved.
+            \return maximal distance a particle has moved in this step
+            (the local value if the exact skin criterion makes the global
+            reduction unnecessary).
         */
         real integrate1();
 
@@ -71,6 +137,10 @@ namespace espressopp {
 
         void updateForces();
 
+        /** updateForces() with the ghost communication overlapped by the
+            interior part of the short range interactions */
+        void updateForcesOverlapped();
+
         void calcForces();
 
         void printPositions(bool withGhost);
@@ -29,6 +29,53 @@ espressopp.integrator.VelocityVerlet
 
 		:param system: 
 		:type system: 
+
+By default the particles are resorted (and the Verlet lists rebuilt) when
+the sum of the per-step maximal displacements exceeds half the skin. With
+``exactSkin = True`` the displacement of every particle since the last
+resort is tracked, and a resort happens only when the largest one exceeds
+half the skin. The nodes only measure the displacements when the sum of
+their step maxima since the last measurement exceeds half the skin; the
+maximum over the nodes is taken every step. Runs with extensions that move particles outside of the real cells
+(e.g. AdResS) keep the conservative criterion.
+
+With ``overlapComm = True`` the forces between pairs of real particles are
+computed while the ghost positions and the ghost forces are communicated;
+only the pairs involving ghosts wait for the communication. This needs a
+storage with non-blocking ghost communication
+(:class:`espressopp.storage.DomainDecompositionNonBlocking`), other storages
+give the same result without the overlap. Runs with extensions connected
+after the force initialization (e.g. DPD, AdResS) use the plain scheme.
+
+With ``loadBalanceInterval = n`` the storage moves its domain boundaries
+every n steps so that all nodes carry the same load (see
+:meth:`espressopp.storage.DomainDecomposition.loadBalance`). The load is the
+number of particles, or the force computation time since the last balancing
+if ``loadBalanceByTime = True``.
+
+.. function:: espressopp.integrator.VelocityVerlet.tuneSkin(nsteps, minSkin, maxSkin, numSkins)
+
+		Runs numSkins blocks of nsteps steps with skins spread evenly
+		between minSkin and maxSkin, sets the skin with the lowest wall
+		time per step (rebuild plus force cost) and returns it. The trial
+		steps are part of the trajectory; nsteps should span several
+		rebuilds.
+
+		:param nsteps: steps per trial skin
+		:param minSkin: smallest skin
+		:param maxSkin: largest skin
+		:param numSkins: number of skins to try
+		:type nsteps: int
+		:type minSkin: real
+		:type maxSkin: real
+		:type numSkins: int
+		:rtype: real
+
+Example:
+
+>>> integrator = espressopp.integrator.VelocityVerlet(system)
+>>> integrator.exactSkin = True
+>>> skin = integrator.tuneSkin(200, 0.1, 0.6, 6)
 """
 from espressopp.esutil import cxxinit
 from espressopp import pmi
@@ -47,6 +94,7 @@ if pmi.isController :
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
           cls =  'espressopp.integrator.VelocityVerletLocal',
-          pmicall = ['resetTimers'],
+          pmiproperty = ['exactSkin', 'overlapComm', 'loadBalanceInterval', 'loadBalanceByTime'],
+          pmicall = ['resetTimers', 'tuneSkin'],
           pmiinvoke = ['getTimers']
         )
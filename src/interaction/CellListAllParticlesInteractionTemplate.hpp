@@ -46,6 +46,12 @@ namespace espressopp {
       }
 
       virtual void addForces();
+      // the potential only works on the real cells, so everything can
+      // overlap with the ghost communication
+      virtual void addForcesInterior(int part, int nParts) {
+        if (part == 0) addForces();
+      }
+      virtual void addForcesBoundary() {}
       virtual real computeEnergy();
       virtual real computeEnergyDeriv();
       virtual real computeEnergyAA();
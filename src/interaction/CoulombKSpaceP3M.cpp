@@ -40,7 +40,9 @@ namespace espressopp {
                      real _rcut,
                      int _interpolation
               ): system(_system), C_pref(_coulomb_prefactor), alpha(_alpha),
-                    M(_M), P(_P), rc(_rcut), interpolation(_interpolation){
+                    M(_M), P(_P), rc(_rcut), interpolation(_interpolation),
+                    Q_k(NULL){
+      for(int c=0; c<3; c++) phi_k[c] = NULL;
       
       // predefined assigned function coefficients
       af_coef[1][0][0] = 1.0;
@@ -192,10 +194,8 @@ namespace espressopp {
       af_coef[7][6][6] =     64./46080.;
       
       getParticleNumber();
+      // sets up the distributed mesh and the FFTW plans
       preset();
-      
-      // first initialize
-      initialize();
         
       // This function calculates the square of all particle charges. It should be called ones,
       // if the total number of particles doesn't change.
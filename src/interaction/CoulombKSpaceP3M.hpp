@@ -25,12 +25,15 @@
 #define _INTERACTION_COULOMBKSPACEP3M_HPP
 
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 #include <boost/signals2.hpp>
 
 #include <fftw3.h>
 
 #include "mpi.hpp"
 #include "Potential.hpp"
+#include "esutil/SlabFFT.hpp"
 #include "CellListAllParticlesInteractionTemplate.hpp"
 #include "iterator/CellListIterator.hpp"
 #include "esutil/Error.hpp"
@@ -60,10 +63,15 @@ namespace espressopp {
      * 
      *  The code is based on M.Deserno's work. Reference in literature
      *  M. Deserno, C.Holm, J.Chem. Phys, 109[18] (1998) 7694
+     *
+     *  The charge mesh is distributed: every rank spreads the charges of its
+     *  particles into a local brick that covers only the mesh points they
+     *  touch, the bricks are summed into the x-slabs of a distributed FFT
+     *  (esutil::SlabFFT) and the field is sent back to the bricks for the
+     *  force interpolation. Per particle only the first stencil point and
+     *  3*P assignment weights are kept.
      */
     
-    // TODO this version is still under development. not parallel. doesn't work for several
-    // CPUs
     // TODO should be optimized (force, energy and virial calculate the same stuff)
     
     class CoulombKSpaceP3M : public PotentialTemplate< CoulombKSpaceP3M > {
@@ -93,20 +101,18 @@ namespace espressopp {
       
       vector< vector<real> > d_op; 
       
-      //vector< vector< vector<real> > >gf; // influence function
-      vector<real> gf; // influence function
+      vector<real> gf; // influence function on the local k space slab
       
-      //vector< vector< vector< dcomplex > > > QQQ;
-      vector<  dcomplex > QQQ;
-      
-      vector<vector<dcomplex> > phi;
-        
-      // reference points in the lattice, needed for the charge assignment
+      // reference points in the lattice, needed for the charge assignment,
+      // one per real particle in cell list order
       vector<Int3D> g_ca;
-      // mesh contributions of the charged particles
-      vector< vector< real > > q_l;
+      // charge assignment weights, P per direction and particle
+      vector<real> w_ca;
       
-      vector< vector< vector< int > > > map_indx;
+      // mesh points touched by the local particles: first point and extent
+      Int3D brickLo, brickLen;
+      vector<real> brickQ;    // charges spread on the brick
+      vector<real> brickPhi;  // field on the brick, 3 values per point
       
       int nParticles;  // number of particles in system
       Real3D sysL;     // system size
@@ -114,10 +120,10 @@ namespace espressopp {
       
       real af_coef[8][7][7]; // matrix of predefined assigned function coefficients
       
-      // fftw elements
-      fftw_complex *in_array;
-      fftw_plan plan;
-      int MM[3]; // auxiliary array for plan generation
+      // fftw elements, the plans are kept as long as the mesh does not change
+      shared_ptr< esutil::SlabFFT > fft;
+      fftw_complex *Q_k;       // charge mesh
+      fftw_complex *phi_k[3];  // field mesh for the three force components
       
       //real oddeven1, oddeven2; // supporting variables odd/even interpolation order
     public:
@@ -138,25 +144,11 @@ namespace espressopp {
       void preset(){
         sysL = system -> bc -> getBoxL();
         MMM = M[0] * M[1] * M[2];
-        for(int i=0; i<3; i++) MM[i] = M[i];
-        
-        // map xpos, ypos and zpos to index = zpos + M[2] * (ypos + M[1] * xpos)
-        map_indx = vector< vector< vector<int> > > (M[0],
-                           vector< vector<int> >   (M[1],
-                                   vector<int>     (M[2], 0) ));
-        for(int i=0; i<M[0]; i++){
-          int mi = M[1] * i;
-          for(int j=0; j<M[1]; j++){
-            int mj = M[2] * (j + mi);
-            for(int k=0; k<M[2]; k++){
-              map_indx[i][j][k] = k + mj;
-            }
-          }
-        }
         
         precalc_interp_caf = vector< vector<real> > (P, vector<real>(2*interpolation+1, 0.0) );
         precalc_interpol_charge_assignment_f();
         
+        initialize();
       }
       
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -193,9 +185,13 @@ namespace espressopp {
       int getInterpolation() const { return interpolation; }
 /////////////////////////////////////////////////////////////////////////////////////////
 
+
       void initialize(){
         
-        set_fftw_array();
+        if (!fft || fft->getMesh()[0] != M[0] || fft->getMesh()[1] != M[1] ||
+            fft->getMesh()[2] != M[2]) {
+          set_fftw_array();
+        }
         
         mesh_shift = vector< vector<real> >(3, vector<real>() );
         d_op = vector< vector<real> >(3, vector<real>() );
@@ -208,22 +204,9 @@ namespace espressopp {
         
         calc_differential_operator();
         
-        gf = vector<real>(MMM, 0.0);
+        gf = vector<real>((size_t)fft->getLocalNKY() * M[0] * M[2], 0.0);
         
         calc_opt_influence_function();
-        
-        // -----------------------------------------
-        // charge assignment
-        QQQ = vector<dcomplex>(MMM, 0.0);
-        
-        
-        // TODO check double use in common part
-        g_ca = vector<Int3D>(0, Int3D(0) );
-
-        q_l = vector< vector<real> > (nParticles, vector<real>(MMM, 0.0) );
-        
-        // force specific
-        phi = vector<vector<dcomplex> > (3, vector<dcomplex> (MMM, dcomplex(0.0) ));
       }
       
       // get the current particle number on the current node
@@ -273,25 +256,23 @@ namespace espressopp {
         }
       }
 
-      void create_mesh(CellList realCells){
-      }
-      void gen_mesh(CellList realCells){
-      }
-      void assign_charge_for_single_particle(real q, Real3D particle_pos){
-      }
-      
-      // calculates the optimal influence function
+
+      // calculates the optimal influence function on the local k space slab
       void calc_opt_influence_function(){
         
         real coef  = 2.0 * MMM / (sysL[0]*sysL[1]);
 
+        int ky0 = fft->getLocalKYStart();
+        int nky = fft->getLocalNKY();
+
         real denom;
         Real3D nom, D;
         Int3D i;
-        for ( i[0] = 0; i[0] < M[0]; i[0]++){
-          for ( i[1] = 0; i[1] < M[1]; i[1]++){
+        for ( int yl = 0; yl < nky; yl++){
+          i[1] = ky0 + yl;
+          for ( i[0] = 0; i[0] < M[0]; i[0]++){
             for ( i[2] = 0; i[2] < M[2]; i[2]++){
-              int indx = map_indx[i[0]][i[1]][i[2]];
+              int indx = (yl * M[0] + i[0]) * M[2] + i[2];
               if ( i == Int3D(0) )
                 gf[ indx ] = 0.0;
               else{
@@ -410,32 +391,37 @@ namespace espressopp {
         return out;
       }
       
+
       void set_fftw_array(){
-        in_array = (fftw_complex*) fftw_malloc( MMM * sizeof(fftw_complex));
-      }
-      void set_plan_frw(){
-        plan = fftw_plan_dft(3, MM, in_array, in_array, FFTW_FORWARD, FFTW_ESTIMATE);
-      }
-      void set_plan_bcw(){
-        plan = fftw_plan_dft(3, MM, in_array, in_array, FFTW_BACKWARD, FFTW_ESTIMATE);
+        clean_fftw();
+        fft = make_shared< esutil::SlabFFT >(system->comm, M, FFTW_MEASURE);
+        Q_k = fft->allocate();
+        for(int c=0; c<3; c++) phi_k[c] = fft->allocate();
       }
       void clean_fftw(){
-        fftw_destroy_plan(plan);
-        in_array = NULL;
-        fftw_free(in_array);
+        if (Q_k) fftw_free(Q_k);
+        Q_k = NULL;
+        for(int c=0; c<3; c++){
+          if (phi_k[c]) fftw_free(phi_k[c]);
+          phi_k[c] = NULL;
+        }
+        fft.reset();
       }
       
       
       real _computeEnergy(CellList realCells){
         
-        common_part(realCells, 1);
+        common_part(realCells);
         
-        real energy = 0.0;
-        
-        for (int i=0; i<MMM; i++){
-          energy += gf[i] * norm( QQQ[i] );
+        size_t localSize = (size_t)fft->getLocalNKY() * M[0] * M[2];
+        real node_energy = 0.0;
+        for (size_t i=0; i<localSize; i++){
+          node_energy += gf[i] * ( Q_k[i][0]*Q_k[i][0] + Q_k[i][1]*Q_k[i][1] );
         }
         
+        real energy = 0.0;
+        mpi::all_reduce( *system -> comm, node_energy, energy, plus<real>() );
+        
         // TODO sysL[0]?? what about [1] and [2]?
         energy *= ( C_pref * sysL[0] / (4.0*MMM*M_PIl) );
 
@@ -446,13 +432,11 @@ namespace espressopp {
         return energy;
       }
       
-      // TODO get rid of iii at the end
-      void common_part(CellList realCells, int iii){
-        initialize();
+      // assigns the charges to the mesh and transforms it to k space
+      void common_part(CellList realCells){
         
         real _2interp = 2.0 * interpolation;
-        // TODO assignshift probably should be [3]
-        int assignshift = M[0]- floor((real)(P-1)/2.0);
+        int assignshift = -((P-1)/2);
         
         real  modadd1, modadd2;
         // odd and even interpolation order
@@ -464,103 +448,94 @@ namespace espressopp {
         }
 
         g_ca.clear();
-        g_ca = vector<Int3D>(nParticles, Int3D(0) );
-        QQQ.clear();
-        QQQ = vector<dcomplex>(MMM, dcomplex(0.0));
+        g_ca.reserve(nParticles);
+        w_ca.clear();
+        w_ca.reserve(3 * P * nParticles);
         
-        Int3D Gi, arg;
         for(iterator::CellListIterator it(realCells); it.isValid(); ++it){
           Particle &p = *it;
           Real3D ppos = p.position();
           
-          Real3D d1;
+          Int3D Gi, arg;
           for(int i=0; i<3; i++){
-            d1[i] = ppos[i] * M[i] / sysL[i] + modadd1;
+            real d1 = ppos[i] * M[i] / sysL[i] + modadd1;
+            Gi[i]  = (int)floor(d1 + modadd2) + assignshift;
+            arg[i] = (int)( (d1 - dround(d1) + 0.5)*_2interp );
           }
-          Gi  = Int3D(d1 + modadd2) + assignshift;
-          arg = Int3D( (d1 - dround(d1) + 0.5)*_2interp );
-
-          // specific for force !!!!!!!!
-          g_ca[p.id()] = Gi;
-          
-          // Calculate the mesh based charges
-          real T1,T2,T3;
-          for (int i = 0; i < P; i++) {
-            int xpos = (Gi[0] + i) % M[0];
-            T1 = p.q() * precalc_interp_caf[i][arg[0]];
-            for (int j = 0; j < P; j++) {
-              int ypos = (Gi[1] + j) % M[1];
-              T2 = T1 * precalc_interp_caf[j][arg[1]];
-              for (int k = 0; k < P; k++) {
-                int zpos = (Gi[2] + k) % M[2];
-                T3 = T2 * precalc_interp_caf[k][arg[2]];
-                
-                int indx = map_indx[xpos][ypos][zpos];
-                
-                // specific for force !!!!!!!!
-                q_l[p.id()][indx] = T3;
-                
-                QQQ[indx] += dcomplex(T3, 0.0);
-              }
-            }
+          g_ca.push_back(Gi);
+          for(int i=0; i<3; i++){
+            for(int j=0; j<P; j++) w_ca.push_back(precalc_interp_caf[j][arg[i]]);
           }
-
         }
- 
-        in_array = reinterpret_cast<fftw_complex*>( &QQQ[0] );
-        set_plan_frw();
-        fftw_execute(plan);
+        
+        fft->brickFor(g_ca, P, brickLo, brickLen);
+        brickQ.assign((size_t)brickLen[0] * brickLen[1] * brickLen[2], 0.0);
+        
+        size_t n = 0;
+        for(iterator::CellListIterator it(realCells); it.isValid(); ++it, ++n){
+          fft->spread(brickLo, brickLen, g_ca[n], P, &w_ca[3 * P * n], it->q(), &brickQ[0]);
+        }
+        
+        fft->addBricks(brickLo, brickLen, brickQ, Q_k);
+        
+        fft->forward(Q_k);
       }
-
+      
       // @TODO this function could be void, 
       bool _computeForce(CellList realCells){
 
-        common_part(realCells, 0);
+        common_part(realCells);
         
         // Calculate the supporting arrays phi_?_??:
+        int ky0 = fft->getLocalKYStart();
+        int nky = fft->getLocalNKY();
         Int3D i;
-        for ( i[0]=0; i[0]<M[0]; i[0]++){
-          for ( i[1]=0; i[1]<M[1]; i[1]++){
+        for ( int yl = 0; yl < nky; yl++){
+          i[1] = ky0 + yl;
+          for ( i[0]=0; i[0]<M[0]; i[0]++){
             for ( i[2]=0; i[2]<M[2]; i[2]++) {  
-              int indx = map_indx[i[0]][i[1]][i[2]];
-              dcomplex phi_aux = gf[indx] * swap_complex( conj( QQQ[indx] ) );
+              int indx = (yl * M[0] + i[0]) * M[2] + i[2];
+              dcomplex Q(Q_k[indx][0], Q_k[indx][1]);
+              dcomplex phi_aux = gf[indx] * swap_complex( conj( Q ) );
               
-              for (int ii=0; ii<3; ii++) phi[ii][indx] = d_op[ii][i[ii]] * phi_aux;
+              for (int ii=0; ii<3; ii++){
+                dcomplex phi = d_op[ii][i[ii]] * phi_aux;
+                phi_k[ii][indx][0] = phi.real();
+                phi_k[ii][indx][1] = phi.imag();
+              }
             }
           }
         }
 
         for(int l=0; l<3; l++){
-          in_array = reinterpret_cast<fftw_complex*>( &phi[l][0] );
-          set_plan_bcw();
-          fftw_execute(plan);
+          fft->backward(phi_k[l]);
         }
         
+        fft->getBricks(brickLo, brickLen, phi_k, 3, brickPhi);
+        
         real C_MMM_inv = C_pref / (real)MMM;
-        for(iterator::CellListIterator it(realCells); it.isValid(); ++it){
+        size_t n = 0;
+        for(iterator::CellListIterator it(realCells); it.isValid(); ++it, ++n){
           Particle &p = *it;
           
-          int iii = p.id();
+          const Int3D& Gi = g_ca[n];
+          const real* w = &w_ca[3 * P * n];
           Real3D ff(0.0);
           for (int i = 0; i < P; i++) {
-            int xpos = (g_ca[iii][0] + i) % M[0];
+            int xpos = (Gi[0] - brickLo[0] + i) % M[0];
             for (int j = 0; j < P; j++) {
-              int ypos = (g_ca[iii][1] + j) % M[1];
+              int ypos = (Gi[1] - brickLo[1] + j) % M[1];
+              real wxy = w[i] * w[P + j];
+              const real* row = &brickPhi[3 * (xpos * brickLen[1] + ypos) * brickLen[2]];
               for (int k = 0; k < P; k++) {
-                int zpos = (g_ca[iii][2] + k) % M[2];
-                
-                int indx = map_indx[xpos][ypos][zpos];
-                
-                Real3D f_add( phi[0][indx].real(),
-                              phi[1][indx].real(),
-                              phi[2][indx].real());
-
-                ff += C_MMM_inv * q_l[iii][indx]  *  f_add ;
+                int zpos = (Gi[2] - brickLo[2] + k) % M[2];
+                real wxyz = wxy * w[2*P + k];
+                ff += wxyz * Real3D(row[3*zpos], row[3*zpos + 1], row[3*zpos + 2]);
               }
             }
           }
 
-          p.force() -= ff;
+          p.force() -= C_MMM_inv * p.q() * ff;
         }
         
         // usual return from espressopp
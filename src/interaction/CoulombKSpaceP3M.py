@@ -36,6 +36,12 @@ Example:
     >>> ewaldK_int = espressopp.interaction.CellListCoulombKSpaceP3M(system.storage, ewaldK_pot)
     >>> system.addInteraction(ewaldK_int)
 
+The charge mesh is distributed over the MPI ranks: every rank keeps only the
+mesh points touched by its own particles and an x-slab of the mesh for the
+parallel FFT, so the memory per rank no longer grows with the total number of
+particles. The FFTW plans are created once (FFTW_MEASURE) and reused until
+the mesh size changes.
+
 **!IMPORTANT** Coulomb interaction needs `R` space part as well CoulombRSpace_.
 
 .. _CoulombRSpace: espressopp.interaction.CoulombRSpace.html
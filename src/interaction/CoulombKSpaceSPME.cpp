@@ -0,0 +1,287 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include "CoulombKSpaceSPME.hpp"
+#include "CellListAllParticlesInteractionTemplate.hpp"
+
+namespace espressopp {
+  namespace interaction {
+
+    typedef class CellListAllParticlesInteractionTemplate <CoulombKSpaceSPME> CellListCoulombKSpaceSPME;
+
+    CoulombKSpaceSPME::CoulombKSpaceSPME(shared_ptr< System > _system, real _prefactor,
+                                         real _alpha, Int3D _M, int _P)
+      : system(_system), prefactor(_prefactor), alpha(_alpha), M(_M), P(_P), Q_k(NULL)
+    {
+      preset();
+      getParticleNumber();
+
+      // This function calculates the square of all particle charges. It should be called ones,
+      // if the total number of particles doesn't change.
+      count_charges(system->storage->getRealCells());
+
+      // make a connection to boundary conditions to invoke recalculation of the influence
+      // function if box dimensions change
+      connectionRecalcKVec = system->bc->onBoxDimensionsChanged.connect(
+        boost::bind(&CoulombKSpaceSPME::preset, this));
+      // make a connection to storage to get number of particles
+      connectionGetParticleNumber = system->storage->onParticlesChanged.connect(
+        boost::bind(&CoulombKSpaceSPME::getParticleNumber, this));
+    }
+
+    CoulombKSpaceSPME::~CoulombKSpaceSPME() {
+      connectionRecalcKVec.disconnect();
+      connectionGetParticleNumber.disconnect();
+      if (Q_k) fftw_free(Q_k);
+      Q_k = NULL;
+    }
+
+    void CoulombKSpaceSPME::bspline(real w, int n, real* data, real* ddata) {
+      // recursion M_n(x) = x/(n-1) M_{n-1}(x) + (n-x)/(n-1) M_{n-1}(x-1)
+      data[n-1] = 0.0;
+      data[1] = w;
+      data[0] = 1.0 - w;
+      for (int j = 3; j < n; j++) {
+        real div = 1.0 / (j - 1);
+        data[j-1] = div * w * data[j-2];
+        for (int k = 1; k < j - 1; k++) {
+          data[j-k-1] = div * ((w + k) * data[j-k-2] + (j - k - w) * data[j-k-1]);
+        }
+        data[0] = div * (1.0 - w) * data[0];
+      }
+
+      // M_n'(x) = M_{n-1}(x) - M_{n-1}(x-1)
+      ddata[0] = -data[0];
+      for (int j = 1; j < n; j++) ddata[j] = data[j-1] - data[j];
+
+      real div = 1.0 / (n - 1);
+      data[n-1] = div * w * data[n-2];
+      for (int k = 1; k < n - 1; k++) {
+        data[n-k-1] = div * ((w + k) * data[n-k-2] + (n - k - w) * data[n-k-1]);
+      }
+      data[0] = div * (1.0 - w) * data[0];
+    }
+
+    void CoulombKSpaceSPME::preset() {
+      esutil::Error err(system->comm);
+      // bspline() builds on the quadratic spline, the linear one (P=2)
+      // would need its own derivative
+      if (P < 3 || P > M[0] || P > M[1] || P > M[2]) {
+        std::stringstream msg;
+        msg << "SPME: the B-spline order P=" << P << " has to be at least 3 and not larger"
+            << " than the number of mesh points in any direction";
+        err.setException(msg.str());
+      }
+      err.checkException();
+
+      L = system->bc->getBoxL();
+
+      if (!fft || fft->getMesh()[0] != M[0] || fft->getMesh()[1] != M[1] ||
+          fft->getMesh()[2] != M[2]) {
+        if (Q_k) fftw_free(Q_k);
+        fft = make_shared< esutil::SlabFFT >(system->comm, M, FFTW_MEASURE);
+        Q_k = fft->allocate();
+      }
+
+      // B-spline moduli, zeros (odd orders at m = M/2) are interpolated
+      std::vector< real > data(P), ddata(P);
+      bspline(0.0, P, &data[0], &ddata[0]);
+      for (int d = 0; d < 3; d++) {
+        bsplineModuli[d].resize(M[d]);
+        for (int m = 0; m < M[d]; m++) {
+          std::complex< real > sum(0.0, 0.0);
+          for (int k = 0; k < P - 1; k++) {
+            real arg = 2.0 * M_PI * m * k / M[d];
+            sum += data[P-2-k] * std::complex< real >(cos(arg), sin(arg));
+          }
+          bsplineModuli[d][m] = std::norm(sum);
+        }
+        for (int m = 0; m < M[d]; m++) {
+          if (bsplineModuli[d][m] < 1e-7) {
+            bsplineModuli[d][m] = 0.5 * (bsplineModuli[d][(m - 1 + M[d]) % M[d]] +
+                                         bsplineModuli[d][(m + 1) % M[d]]);
+          }
+        }
+      }
+
+      // influence function exp(-pi^2 m^2/alpha^2) / (pi V m^2 B(m)) on the local slab
+      int ky0 = fft->getLocalKYStart();
+      int nky = fft->getLocalNKY();
+      real V = L[0] * L[1] * L[2];
+      real fac = M_PI * M_PI / (alpha * alpha);
+      influence.assign((size_t) nky * M[0] * M[2], 0.0);
+      for (int yl = 0; yl < nky; yl++) {
+        int ky = ky0 + yl;
+        real my = ((ky <= M[1] / 2) ? ky : ky - M[1]) / L[1];
+        for (int kx = 0; kx < M[0]; kx++) {
+          real mx = ((kx <= M[0] / 2) ? kx : kx - M[0]) / L[0];
+          for (int kz = 0; kz < M[2]; kz++) {
+            if (kx == 0 && ky == 0 && kz == 0) continue;
+            real mz = ((kz <= M[2] / 2) ? kz : kz - M[2]) / L[2];
+            real m2 = mx * mx + my * my + mz * mz;
+            real B = bsplineModuli[0][kx] * bsplineModuli[1][ky] * bsplineModuli[2][kz];
+            influence[(yl * M[0] + kx) * M[2] + kz] = exp(-fac * m2) / (M_PI * V * m2 * B);
+          }
+        }
+      }
+    }
+
+    real CoulombKSpaceSPME::spreadAndTransform(CellList realcells) {
+      firstPoint.clear();
+      firstPoint.reserve(nParticles);
+      weights.clear();
+      weights.reserve(3 * P * nParticles);
+      dweights.clear();
+      dweights.reserve(3 * P * nParticles);
+
+      std::vector< real > w(P), dw(P);
+      for (iterator::CellListIterator it(realcells); !it.isDone(); ++it) {
+        const Real3D& pos = it->position();
+        Int3D g;
+        for (int d = 0; d < 3; d++) {
+          real u = pos[d] * M[d] / L[d];
+          real fl = floor(u);
+          g[d] = (int) fl - P + 1;
+          bspline(u - fl, P, &w[0], &dw[0]);
+          weights.insert(weights.end(), w.begin(), w.end());
+          dweights.insert(dweights.end(), dw.begin(), dw.end());
+        }
+        firstPoint.push_back(g);
+      }
+
+      fft->brickFor(firstPoint, P, brickLo, brickLen);
+      brick.assign((size_t) brickLen[0] * brickLen[1] * brickLen[2], 0.0);
+
+      size_t n = 0;
+      for (iterator::CellListIterator it(realcells); !it.isDone(); ++it, ++n) {
+        real q = it->q();
+        if (q == 0.0) continue;
+        fft->spread(brickLo, brickLen, firstPoint[n], P, &weights[3 * P * n], q, &brick[0]);
+      }
+
+      fft->addBricks(brickLo, brickLen, brick, Q_k);
+      fft->forward(Q_k);
+
+      real node_energy = 0.0;
+      for (size_t i = 0; i < influence.size(); i++) {
+        node_energy += influence[i] * (Q_k[i][0] * Q_k[i][0] + Q_k[i][1] * Q_k[i][1]);
+      }
+      return 0.5 * node_energy;
+    }
+
+    bool CoulombKSpaceSPME::_computeForce(CellList realcells) {
+      spreadAndTransform(realcells);
+
+      // convolution of the charge mesh with the influence function
+      for (size_t i = 0; i < influence.size(); i++) {
+        Q_k[i][0] *= influence[i];
+        Q_k[i][1] *= influence[i];
+      }
+      fft->backward(Q_k);
+      fft->getBricks(brickLo, brickLen, &Q_k, 1, brick);
+
+      Real3D scale(M[0] / L[0], M[1] / L[1], M[2] / L[2]);
+      size_t n = 0;
+      for (iterator::CellListIterator it(realcells); !it.isDone(); ++it, ++n) {
+        real q = it->q();
+        if (q == 0.0) continue;
+        const Int3D& g = firstPoint[n];
+        const real* wx = &weights[3 * P * n];
+        const real* wy = wx + P;
+        const real* wz = wy + P;
+        const real* dx = &dweights[3 * P * n];
+        const real* dy = dx + P;
+        const real* dz = dy + P;
+
+        Real3D f(0.0);
+        for (int i = 0; i < P; i++) {
+          int xi = (g[0] - brickLo[0] + i) % M[0];
+          for (int j = 0; j < P; j++) {
+            int yj = (g[1] - brickLo[1] + j) % M[1];
+            const real* row = &brick[(xi * brickLen[1] + yj) * brickLen[2]];
+            for (int k = 0; k < P; k++) {
+              real v = row[(g[2] - brickLo[2] + k) % M[2]];
+              f[0] += dx[i] * wy[j] * wz[k] * v;
+              f[1] += wx[i] * dy[j] * wz[k] * v;
+              f[2] += wx[i] * wy[j] * dz[k] * v;
+            }
+          }
+        }
+        for (int d = 0; d < 3; d++) it->force()[d] -= prefactor * q * scale[d] * f[d];
+      }
+
+      return true;
+    }
+
+    Tensor CoulombKSpaceSPME::_computeVirialTensor(CellList realcells) {
+      spreadAndTransform(realcells);
+
+      // sum over k of E(m) (delta_ab - 2 (1 + pi^2 m^2/alpha^2) m_a m_b / m^2)
+      int ky0 = fft->getLocalKYStart();
+      int nky = fft->getLocalNKY();
+      real fac = M_PI * M_PI / (alpha * alpha);
+      Tensor I(1.0, 1.0, 1.0, 0.0, 0.0, 0.0);
+      Tensor node_virialTensor(0.0);
+      for (int yl = 0; yl < nky; yl++) {
+        int ky = ky0 + yl;
+        real my = ((ky <= M[1] / 2) ? ky : ky - M[1]) / L[1];
+        for (int kx = 0; kx < M[0]; kx++) {
+          real mx = ((kx <= M[0] / 2) ? kx : kx - M[0]) / L[0];
+          for (int kz = 0; kz < M[2]; kz++) {
+            size_t i = (yl * M[0] + kx) * M[2] + kz;
+            if (influence[i] == 0.0) continue;
+            real mz = ((kz <= M[2] / 2) ? kz : kz - M[2]) / L[2];
+            Real3D m(mx, my, mz);
+            real m2 = m.sqr();
+            real e = 0.5 * influence[i] * (Q_k[i][0] * Q_k[i][0] + Q_k[i][1] * Q_k[i][1]);
+            node_virialTensor += e * (I - 2.0 * (1.0 + fac * m2) / m2 * Tensor(m, m));
+          }
+        }
+      }
+
+      Tensor virialTensor(0.0);
+      mpi::all_reduce( *system -> comm, node_virialTensor, virialTensor, std::plus<Tensor>());
+
+      return prefactor * virialTensor;
+    }
+
+    //////////////////////////////////////////////////
+    // REGISTRATION WITH PYTHON
+    //////////////////////////////////////////////////
+    void CoulombKSpaceSPME::registerPython() {
+      using namespace espressopp::python;
+
+      class_< CoulombKSpaceSPME, bases< Potential > >
+        ("interaction_CoulombKSpaceSPME", init< shared_ptr< System >, real, real, Int3D, int >())
+        .add_property("prefactor", &CoulombKSpaceSPME::getPrefactor, &CoulombKSpaceSPME::setPrefactor)
+        .add_property("alpha", &CoulombKSpaceSPME::getAlpha, &CoulombKSpaceSPME::setAlpha)
+        .add_property("P", &CoulombKSpaceSPME::getP, &CoulombKSpaceSPME::setP)
+      ;
+
+      class_< CellListCoulombKSpaceSPME, bases< Interaction > >
+        ("interaction_CellListCoulombKSpaceSPME",
+         init< shared_ptr< storage::Storage >, shared_ptr< CoulombKSpaceSPME > >())
+        .def("getPotential", &CellListCoulombKSpaceSPME::getPotential)
+      ;
+    }
+
+  }
+}
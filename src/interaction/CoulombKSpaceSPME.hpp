@@ -0,0 +1,192 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _INTERACTION_COULOMBKSPACESPME_HPP
+#define _INTERACTION_COULOMBKSPACESPME_HPP
+
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/signals2.hpp>
+
+#include <fftw3.h>
+
+#include "mpi.hpp"
+#include "Potential.hpp"
+#include "CellListAllParticlesInteractionTemplate.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "bc/BC.hpp"
+#include "esutil/Error.hpp"
+#include "esutil/SlabFFT.hpp"
+#include "Tensor.hpp"
+#include "System.hpp"
+
+namespace espressopp {
+  namespace interaction {
+    /** This class provides methods to compute forces, energies and the
+     *  virial of the `K` space part of the Coulomb interaction with the
+     *  smooth particle mesh Ewald method,
+     *  U. Essmann et al., J. Chem. Phys. 103 (1995) 8577.
+     *
+     *  Charges are spread with cardinal B-splines of order P on a mesh of
+     *  M[0] x M[1] x M[2] points, the forces follow from the analytic
+     *  derivative of the B-splines, so only one backward FFT is needed.
+     *  The mesh is distributed over the ranks with esutil::SlabFFT.
+     *  Works with cubes and rectangular cuboids, the real space part is
+     *  CoulombRSpace with the same alpha.
+     */
+    class CoulombKSpaceSPME : public PotentialTemplate< CoulombKSpaceSPME > {
+    private:
+      shared_ptr< System > system; // we need the system object to be able to access the box
+                                   // dimensions, communicator, number of particles, signals
+      real prefactor;
+      real alpha;  // Ewald parameter
+      Int3D M;     // number of mesh points
+      int P;       // B-spline order
+
+      Real3D L;        // box size
+      int nParticles;  // number of real particles on this node
+      real sum_q2;     // sum of squared charges
+
+      shared_ptr< esutil::SlabFFT > fft;
+      fftw_complex *Q_k;  // charge mesh, in k space after the forward FFT
+
+      std::vector< real > bsplineModuli[3];  // |b_i(m)|^2
+      std::vector< real > influence;         // influence function on the local k space slab
+
+      // first mesh point, B-spline weights and derivatives of the local particles
+      std::vector< Int3D > firstPoint;
+      std::vector< real > weights;
+      std::vector< real > dweights;
+
+      // mesh points touched by the local particles
+      Int3D brickLo, brickLen;
+      std::vector< real > brick;
+
+    public:
+      static void registerPython();
+
+      CoulombKSpaceSPME(shared_ptr< System > _system, real _prefactor, real _alpha,
+                        Int3D _M, int _P);
+
+      ~CoulombKSpaceSPME();
+
+      // prepares the FFT and the influence function, it has to be called if
+      // the box or one of the parameters changes
+      void preset();
+
+      void getParticleNumber() {
+        nParticles = system->storage->getNRealParticles();
+      }
+
+      // it counts the squared charges over all system. It is used for self energy calculations
+      void count_charges(CellList realcells){
+        real node_sum_q2 = 0.0;
+        for (iterator::CellListIterator it(realcells); !it.isDone(); ++it) {
+          node_sum_q2 += it->q() * it->q();
+        }
+        sum_q2 = 0.0;
+        mpi::all_reduce( *system -> comm, node_sum_q2, sum_q2, std::plus<real>() );
+      }
+
+      // set/get the parameters
+      void setPrefactor(real _prefactor) {
+        prefactor = _prefactor;
+      }
+      real getPrefactor() const { return prefactor; }
+      void setAlpha(real _alpha) {
+        alpha = _alpha;
+        preset();
+      }
+      real getAlpha() const { return alpha; }
+      void setMesh(Int3D _M) {
+        M = _M;
+        preset();
+      }
+      Int3D getMesh() const { return M; }
+      void setP(int _P) {
+        // reject before the object is changed, the Python property
+        // raises a ValueError
+        if (_P < 3) throw std::invalid_argument("SPME: the B-spline order P has to be at least 3");
+        P = _P;
+        preset();
+      }
+      int getP() const { return P; }
+
+      /** B-spline weights M_n(w + n-1-j) and their derivatives for
+          j = 0..n-1, w in [0,1), n >= 3, see Essmann et al. eq. 4.1 */
+      static void bspline(real w, int n, real* data, real* ddata);
+
+      // spreads the charges and transforms the mesh, returns the local
+      // part of the energy sum over k
+      real spreadAndTransform(CellList realcells);
+
+      real _computeEnergy(CellList realcells){
+        real node_energy = spreadAndTransform(realcells);
+        real energy = 0.0;
+        mpi::all_reduce( *system -> comm, node_energy, energy, std::plus<real>() );
+
+        /* self energy correction */
+        energy -= sum_q2 * alpha / sqrt(M_PI);
+
+        return prefactor * energy;
+      }
+
+      bool _computeForce(CellList realcells);
+
+      // compute virial for this interaction
+      // (!note: all particle interaction contains only one potential)
+      real _computeVirial(CellList realcells){
+        Tensor virialTensor = _computeVirialTensor(realcells);
+        return virialTensor[0] + virialTensor[1] + virialTensor[2];
+      }
+
+      // compute virial Tensor for this interaction
+      // (!note: all particle interaction contains only one potential)
+      Tensor _computeVirialTensor(CellList realcells);
+
+      real _computeEnergySqrRaw(real distSqr) const {
+        esutil::Error err(system->comm);
+        std::stringstream msg;
+        msg << "There is no sense to call this function for SPME";
+        err.setException( msg.str() );
+        return 0.0;
+      }
+      bool _computeForceRaw(Real3D& force, const Real3D& dist, real distSqr) const {
+        esutil::Error err(system->comm);
+        std::stringstream msg;
+        msg << "There is no sense to call this function for SPME";
+        err.setException( msg.str() );
+        return false;
+      }
+
+    protected:
+      // it's responsible for the influence function recalculation when the box size changes
+      boost::signals2::connection connectionRecalcKVec;
+      // --||-- when the particle number is changed
+      boost::signals2::connection connectionGetParticleNumber;
+    };
+  }
+}
+
+#endif
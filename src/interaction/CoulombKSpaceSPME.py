@@ -0,0 +1,135 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+****************************************
+espressopp.interaction.CoulombKSpaceSPME
+****************************************
+
+Coulomb potential and interaction Objects (`K` space part)
+
+This is the `K` space part of the Coulomb long range interaction according to
+the smooth particle mesh Ewald method [Essmann95]_. The charges are spread on
+a mesh with cardinal B-splines of order P, the structure factor is computed
+with a distributed FFT and the forces follow from the analytic derivative of
+the B-splines. Energy, virial and virial tensor are available.
+
+Example:
+
+    >>> spme_pot = espressopp.interaction.CoulombKSpaceSPME(system, coulomb_prefactor, alpha, (32, 32, 32), 5)
+    >>> spme_int = espressopp.interaction.CellListCoulombKSpaceSPME(system.storage, spme_pot)
+    >>> system.addInteraction(spme_int)
+
+**!IMPORTANT** Coulomb interaction needs `R` space part as well CoulombRSpace_,
+with the same alpha.
+
+.. _CoulombRSpace: espressopp.interaction.CoulombRSpace.html
+
+    Potential Properties:
+
+    *   *spme_pot.prefactor*
+
+        The property 'prefactor' defines the Coulomb prefactor.
+
+    *   *spme_pot.alpha*
+
+        The property 'alpha' defines the Ewald parameter :math:`\\alpha`.
+
+    *   *spme_pot.P*
+
+        The property 'P' defines the B-spline order, at least 3 and not
+        larger than the number of mesh points in any direction.
+
+References:
+
+.. [Essmann95] U. Essmann, L. Perera, M. L. Berkowitz, T. Darden, H. Lee, L. G. Pedersen,
+   *J. Chem. Phys.*, 103(19), **1995**, p.8577
+
+.. function:: espressopp.interaction.CoulombKSpaceSPME(system, prefactor, alpha, M, P)
+
+		:param system: system object
+		:param prefactor: Coulomb prefactor
+		:param alpha: Ewald parameter
+		:param M: number of mesh points in x, y and z
+		:param P: (default: 5) B-spline order, at least 3
+		:type system: shared_ptr<System>
+		:type prefactor: real
+		:type alpha: real
+		:type M: Int3D
+		:type P: int
+
+.. function:: espressopp.interaction.CellListCoulombKSpaceSPME(storage, potential)
+
+		:param storage:
+		:param potential:
+		:type storage:
+		:type potential:
+
+.. function:: espressopp.interaction.CellListCoulombKSpaceSPME.getFixedPairList()
+
+		:rtype: A Python list of lists.
+
+.. function:: espressopp.interaction.CellListCoulombKSpaceSPME.getPotential()
+
+		:rtype:
+"""
+
+
+from espressopp import pmi
+from espressopp.esutil import *
+from espressopp import toInt3DFromVector
+
+from espressopp.interaction.Potential import *
+from espressopp.interaction.Interaction import *
+from _espressopp import interaction_CoulombKSpaceSPME, \
+                      interaction_CellListCoulombKSpaceSPME
+
+class CoulombKSpaceSPMELocal(PotentialLocal, interaction_CoulombKSpaceSPME):
+    def __init__(self, system, prefactor, alpha, M, P=5):
+
+      if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+        cxxinit(self, interaction_CoulombKSpaceSPME, system, prefactor, alpha, toInt3DFromVector(M), P)
+
+class CellListCoulombKSpaceSPMELocal(InteractionLocal, interaction_CellListCoulombKSpaceSPME):
+    def __init__(self, storage, potential):
+
+      if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+        cxxinit(self, interaction_CellListCoulombKSpaceSPME, storage, potential)
+
+    def getFixedPairList(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return []
+
+    def getPotential(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.getPotential(self)
+
+if pmi.isController:
+  class CoulombKSpaceSPME(Potential):
+    pmiproxydefs = dict(
+      cls = 'espressopp.interaction.CoulombKSpaceSPMELocal',
+      pmiproperty = ['prefactor', 'alpha', 'P']
+      )
+
+  class CellListCoulombKSpaceSPME(Interaction):
+    __metaclass__ = pmi.Proxy
+    pmiproxydefs = dict(
+      cls =  'espressopp.interaction.CellListCoulombKSpaceSPMELocal',
+      pmicall = ['getFixedPairList','getPotential']
+      )
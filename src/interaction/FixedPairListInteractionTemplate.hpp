@@ -36,6 +36,12 @@
 #include "SystemAccess.hpp"
 #include "Interaction.hpp"
 #include "types.hpp"
+#include "storage/Storage.hpp"
+#include "ThreadForces.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace espressopp {
   namespace interaction {
@@ -96,6 +102,10 @@ namespace espressopp {
       virtual int bondType() { return Pair; }
 
     protected:
+#ifdef _OPENMP
+      ThreadForces threadForces;
+      LocalParticleIndex particleIndex;
+#endif
       int ntypes;
       shared_ptr < FixedPairList > fixedpairList;
       shared_ptr < Potential > potential;
@@ -109,6 +119,41 @@ namespace espressopp {
       LOG4ESPP_INFO(_Potential::theLogger, "adding forces of FixedPairList");
       const bc::BC& bc = *getSystemRef().bc;  // boundary conditions
       real ltMaxBondSqr = fixedpairList->getLongtimeMaxBondSqr();
+
+#ifdef _OPENMP
+      const int nThreads = getSystemRef().getNumThreads();
+      if (nThreads > 1) {
+        // particles may appear in several bonds, every thread adds its
+        // bond forces to its own array
+        FixedPairList &pairs = *fixedpairList;
+        const long npairs = pairs.size();
+        particleIndex.update(getSystemRef().storage->getLocalCells());
+        threadForces.reset(nThreads, particleIndex.size());
+        real maxBondSqr = ltMaxBondSqr;
+        #pragma omp parallel num_threads(nThreads) reduction(max:maxBondSqr)
+        {
+          Real3D *f = threadForces.get(omp_get_thread_num());
+          #pragma omp for schedule(static)
+          for (long i = 0; i < npairs; ++i) {
+            Real3D dist;
+            bc.getMinimumImageVectorBox(dist, pairs[i].first->position(), pairs[i].second->position());
+            real d = dist.sqr();
+            if (d > maxBondSqr) maxBondSqr = d;
+            Real3D force;
+            if (potential->_computeForce(force, dist)) {
+              f[particleIndex(pairs[i].first)] += force;
+              f[particleIndex(pairs[i].second)] -= force;
+            }
+          }
+        }
+        if (maxBondSqr > ltMaxBondSqr) {
+          fixedpairList->setLongtimeMaxBondSqr(maxBondSqr);
+        }
+        threadForces.addTo(particleIndex.getParticles());
+        return;
+      }
+#endif
+
       for (FixedPairList::PairList::Iterator it(*fixedpairList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
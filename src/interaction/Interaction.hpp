@@ -40,6 +40,18 @@ namespace espressopp {
     public:
       virtual ~Interaction() {};
       virtual void addForces() = 0;
+
+      /** addForces() split for overlapping the force computation with
+          the ghost communication. addForcesInterior(part, nParts) adds
+          slice part of nParts of the forces that neither read ghost
+          positions nor write ghost forces, addForcesBoundary() adds the
+          rest once the ghosts are up to date. All slices plus the
+          boundary amount to addForces(); by default everything is done
+          in the boundary part.
+      */
+      virtual void addForcesInterior(int part, int nParts) {}
+      virtual void addForcesBoundary() { addForces(); }
+
       virtual real computeEnergy() = 0;
       virtual real computeEnergyDeriv() = 0;
       virtual real computeEnergyAA() = 0;
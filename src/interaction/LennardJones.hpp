@@ -111,12 +111,16 @@ namespace espressopp {
       bool _computeForceRaw(Real3D& force,
                             const Real3D& dist,
                             real distSqr) const {
+        force = dist * _computeForceFactorRaw(distSqr);
+        return true;
+      }
 
+      static const bool hasBatchKernel = true;
+
+      real _computeForceFactorRaw(real distSqr) const {
         real frac2 = 1.0 / distSqr;
         real frac6 = frac2 * frac2 * frac2;
-        real ffactor = frac6 * (ff1 * frac6 - ff2) * frac2;
-        force = dist * ffactor;
-        return true;
+        return frac6 * (ff1 * frac6 - ff2) * frac2;
       }
       static LOG4ESPP_DECL_LOGGER(theLogger);
     };
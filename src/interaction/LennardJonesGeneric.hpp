@@ -127,12 +127,17 @@ namespace espressopp {
       }
 
       bool _computeForceRaw(Real3D& force, const Real3D& dist, real distSqr) const {
+    	force = dist * _computeForceFactorRaw(distSqr);
+        return true;
+      }
+
+      static const bool hasBatchKernel = true;
+
+      real _computeForceFactorRaw(real distSqr) const {
     	real invdist = 1.0 / sqrt(distSqr);
         real ffA     = pow(invdist, a+2);
         real ffB     = pow(invdist, b+2);
-    	real ffactor = 4.0 * epsilon * (ff1*ffA - ff2*ffB);
-    	force = dist * ffactor;
-        return true;
+    	return 4.0 * epsilon * (ff1*ffA - ff2*ffB);
       }
 
       static LOG4ESPP_DECL_LOGGER(theLogger);
@@ -93,12 +93,17 @@ namespace espressopp {
       bool _computeForceRaw(Real3D& force,
                             const Real3D& dist,
                             real distSqr) const {
-        real r = sqrt(distSqr);
-        real ffactor = epsilon * (2.0 * alpha * exp(-2.0 * alpha * (r - rMin))
-                                  - 2.0 * alpha * exp(-alpha * (r - rMin))) / r;
-        force = dist * ffactor;
+        force = dist * _computeForceFactorRaw(distSqr);
         return true;
       }
+
+      static const bool hasBatchKernel = true;
+
+      real _computeForceFactorRaw(real distSqr) const {
+        real r = sqrt(distSqr);
+        return epsilon * (2.0 * alpha * exp(-2.0 * alpha * (r - rMin))
+                          - 2.0 * alpha * exp(-alpha * (r - rMin))) / r;
+      }
     };
 
     // provide pickle support
@@ -101,11 +101,25 @@ namespace espressopp {
       bool _computeForce(Real3D& force,
                          const Particle &p1, const Particle &p2, const Real3D& dist) const;
       
+      /** Batch interface used by the pair kernels of the interaction
+          templates. Evaluates the force factors F(r)/r resp. the shifted
+          energies for n squared distances, zero beyond the cutoff. Only
+          potentials that set hasBatchKernel are called through it. */
+      void _computeForceFactors(const real *distSqr, real *factor, int n) const;
+      void _computeEnergiesSqr(const real *distSqr, real *energy, int n) const;
+
+      /** Potentials that are a pure function of the distance and provide
+          an inline, branch-free _computeForceFactorRaw(real distSqr) set
+          this to true in the derived class. */
+      static const bool hasBatchKernel = false;
+
       //bool _computeForce(CellList realcells) const;
       
       // Requires the following non-virtual interface in Derived
       // real _computeEnergySqrRaw(real distSqr) const;
       // bool _computeForceRaw(const Real3D& dist, const Real3D& force) const;
+      // and, if hasBatchKernel is set,
+      // real _computeForceFactorRaw(real distSqr) const;
 
 
       // void _computeForce(const Particle &p1, const Particle &p2, 
@@ -333,6 +347,38 @@ namespace espressopp {
         return derived_this()->_computeForceRaw(force, dist, distSqr);
       }
     }
+
+    // Batch computation
+    template < class Derived >
+    inline void
+    PotentialTemplate< Derived >::
+    _computeForceFactors(const real *distSqr, real *factor, int n) const {
+      const Derived &pot = *derived_this();
+      const real rcSqr = cutoffSqr;
+      // the raw kernel is evaluated at the clamped distance and masked,
+      // so that the loop stays free of branches
+      ESPP_PRAGMA_SIMD
+      for (int k = 0; k < n; ++k) {
+        real d = distSqr[k] > rcSqr ? rcSqr : distSqr[k];
+        real f = pot._computeForceFactorRaw(d);
+        factor[k] = distSqr[k] > rcSqr ? 0.0 : f;
+      }
+    }
+
+    template < class Derived >
+    inline void
+    PotentialTemplate< Derived >::
+    _computeEnergiesSqr(const real *distSqr, real *energy, int n) const {
+      const Derived &pot = *derived_this();
+      const real rcSqr = cutoffSqr;
+      const real eShift = shift;
+      ESPP_PRAGMA_SIMD
+      for (int k = 0; k < n; ++k) {
+        real d = distSqr[k] > rcSqr ? rcSqr : distSqr[k];
+        real e = pot._computeEnergySqrRaw(d) - eShift;
+        energy[k] = distSqr[k] > rcSqr ? 0.0 : e;
+      }
+    }
     
   }
 }
@@ -0,0 +1,141 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _INTERACTION_THREADFORCES_HPP
+#define _INTERACTION_THREADFORCES_HPP
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+#include "types.hpp"
+#include "Real3D.hpp"
+#include "Particle.hpp"
+#include "Cell.hpp"
+
+namespace espressopp {
+  namespace interaction {
+
+    /** Per-thread force accumulators of the threaded force loops.
+
+        Every thread adds the forces of its pairs to its own array,
+        indexed by a local particle index, and addTo() sums the arrays of
+        all threads into the particles in parallel. No two threads write
+        the same memory, so neither atomics nor a serial sweep over the
+        pairs are needed.
+    */
+    class ThreadForces {
+    public:
+      ThreadForces() : nThreads(0), n(0) {}
+
+      /** nThreads zero arrays of n forces, to be called outside of a
+          parallel region. Every thread zeroes (and first touches) the
+          array it will use. */
+      void reset(int _nThreads, size_t _n) {
+        nThreads = _nThreads;
+        n = _n;
+        forces.resize(nThreads * n);
+        const long size = forces.size();
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nThreads) schedule(static)
+#endif
+        for (long i = 0; i < size; ++i) forces[i] = 0.0;
+      }
+
+      /** the array of thread t */
+      Real3D *get(int t) { return forces.empty() ? 0 : &forces[t * n]; }
+
+      /** add the summed forces to particles[i], i < n, in parallel */
+      void addTo(const std::vector< Particle* > &particles) {
+        const long np = std::min(particles.size(), n);
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nThreads) schedule(static)
+#endif
+        for (long i = 0; i < np; ++i) {
+          Real3D f = forces[i];
+          for (int t = 1; t < nThreads; ++t) f += forces[t * n + i];
+          particles[i]->force() += f;
+        }
+      }
+
+    private:
+      int nThreads;
+      size_t n;
+      std::vector< Real3D > forces;
+    };
+
+    /** Local index of the particles of a cell list, numbered cell after
+        cell, that can be looked up from a particle pointer. Used by the
+        threaded loops over pair lists, which only hold pointers. */
+    class LocalParticleIndex {
+    public:
+      /** rebuild the index if the particles of the cells were moved
+          since the last call, e.g. by a resort or a ghost exchange.
+          Checking the cell layout costs one pass over the cells, the
+          particles and the sort are only redone after a change. */
+      void update(const CellList &cells) {
+        bool changed = layout.size() != cells.size();
+        for (size_t c = 0; !changed && c < cells.size(); ++c) {
+          const ParticleList &pl = cells[c]->particles;
+          changed = layout[c] != std::make_pair(pl.empty() ? uintptr_t(0) : uintptr_t(&pl[0]),
+                                                pl.size());
+        }
+        if (changed) build(cells);
+      }
+
+      void build(const CellList &cells) {
+        particles.clear();
+        bases.clear();
+        layout.resize(cells.size());
+        for (size_t c = 0; c < cells.size(); ++c) {
+          const ParticleList &pl = cells[c]->particles;
+          layout[c] = std::make_pair(pl.empty() ? uintptr_t(0) : uintptr_t(&pl[0]), pl.size());
+          if (pl.empty()) continue;
+          bases.push_back(std::make_pair(uintptr_t(&pl[0]), int(particles.size())));
+          for (size_t k = 0; k < pl.size(); ++k) {
+            particles.push_back(const_cast< Particle* >(&pl[k]));
+          }
+        }
+        std::sort(bases.begin(), bases.end());
+      }
+
+      /** index of a particle of the cells, by its address */
+      int operator()(const Particle *p) const {
+        std::pair< uintptr_t, int > key(uintptr_t(p), particles.size());
+        std::vector< std::pair< uintptr_t, int > >::const_iterator it =
+          std::upper_bound(bases.begin(), bases.end(), key);
+        --it;
+        return it->second + int(p - reinterpret_cast< const Particle* >(it->first));
+      }
+
+      size_t size() const { return particles.size(); }
+      const std::vector< Particle* > &getParticles() const { return particles; }
+
+    private:
+      std::vector< Particle* > particles;
+      /// address of the first particle of each non-empty cell and its index
+      std::vector< std::pair< uintptr_t, int > > bases;
+      /// address of the first particle and size of every cell, in cell order
+      std::vector< std::pair< uintptr_t, size_t > > layout;
+    };
+  }
+}
+
+#endif
@@ -148,7 +148,8 @@ namespace espressopp {
     VerletListAdressInteractionTemplate < _PotentialAT, _PotentialCG >::
     addForces() {
       LOG4ESPP_INFO(theLogger, "add forces computed by the Verlet List");
-      std::set<Particle*> cgZone = verletList->getCGZone();
+      std::vector<Particle*>& cgZone = verletList->getCGZone();
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
       /*for (std::set<Particle*>::iterator it=cgZone.begin();
               it != cgZone.end(); ++it) {
 
@@ -265,7 +266,7 @@ namespace espressopp {
       //weights.insert(std::make_pair(&vp, 0.0));
       }*/
 
-      std::set<Particle*> adrZone = verletList->getAdrZone();
+      std::vector<Particle*>& adrZone = verletList->getAdrZone();
       /*for (std::set<Particle*>::iterator it=adrZone.begin();
               it != adrZone.end(); ++it) {
 
@@ -352,7 +353,9 @@ namespace espressopp {
 
 
       // Compute forces (AT and VP) of Pairs inside AdResS zone
-      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it) {
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
+      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it, pairIndex += 2) {
 
          // these are the two VP interacting
          Particle &p1 = *it->first;
@@ -384,27 +387,21 @@ namespace espressopp {
 
          // force between AT particles
          if (w12 != 0) { // calculate AT force if both VP are outside CG region (HY-HY, HY-AT, AT-AT)
-             FixedTupleListAdress::iterator it3;
-             FixedTupleListAdress::iterator it4;
-             it3 = fixedtupleList->find(&p1);
-             it4 = fixedtupleList->find(&p2);
+             // AT particles of the two VPs, collected at the last rebuild
+             int i1 = adrPairIdx[pairIndex];
+             int i2 = adrPairIdx[pairIndex + 1];
 
              //std::cout << "Interaction " << p1.id() << " - " << p2.id() << "\n";
-             if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-
-                 std::vector<Particle*> atList1;
-                 std::vector<Particle*> atList2;
-                 atList1 = it3->second;
-                 atList2 = it4->second;
+             if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
                  //std::cout << "AT forces ...\n";
-                 for (std::vector<Particle*>::iterator itv = atList1.begin();
-                         itv != atList1.end(); ++itv) {
+                 for (Particle** itv = verletList->atBegin(i1);
+                         itv != verletList->atEnd(i1); ++itv) {
 
                      Particle &p3 = **itv;
 
-                     for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                          itv2 != atList2.end(); ++itv2) {
+                     for (Particle** itv2 = verletList->atBegin(i2);
+                                          itv2 != verletList->atEnd(i2); ++itv2) {
 
                          Particle &p4 = **itv2;
 
@@ -441,23 +438,17 @@ namespace espressopp {
       // rotations and vibrations in the CG zone. This leads to failures in the kinetic energy. However, in Force-AdResS there is no energy conservation anyway.
       // Here we calculate CG forces/velocities and distribute them to AT particles. In contrast, in H-AdResS, we calculate AT forces from intra-molecular
       // interactions and inter-molecular center-of-mass interactions and just update the positions of the center-of-mass CG particles.
-      //std::set<Particle*> cgZone = verletList->getCGZone();
-      for (std::set<Particle*>::iterator it=cgZone.begin();
-                    it != cgZone.end(); ++it) {
+      std::vector<int>& cgZoneIdx = verletList->getCGZoneIndices();
+      for (size_t j = 0; j < cgZone.size(); ++j) {
 
-            Particle &vp = **it;
+            Particle &vp = *cgZone[j];
+            int i = cgZoneIdx[j];
 
-            FixedTupleListAdress::iterator it3;
-            it3 = fixedtupleList->find(&vp);
-
-            if (it3 != fixedtupleList->end()) {
-
-                std::vector<Particle*> atList1;
-                atList1 = it3->second;
+            if (zoneFlags[i] & VerletListAdress::HAS_AT) {
 
                 //Real3D vpfm = vp.force() / vp.getMass();
-                for (std::vector<Particle*>::iterator itv = atList1.begin();
-                        itv != atList1.end(); ++itv) {
+                for (Particle** itv = verletList->atBegin(i);
+                        itv != verletList->atEnd(i); ++itv) {
                     Particle &at = **itv;
                     at.velocity() = vp.velocity(); // Overwrite velocity - Note (Karsten): See comment above.
                     //at.force() += at.mass() * vpfm;
@@ -508,8 +499,8 @@ namespace espressopp {
     VerletListAdressInteractionTemplate < _PotentialAT, _PotentialCG >::
     computeEnergy() {
 
-      std::set<Particle*> cgZone = verletList->getCGZone();
-      for (std::set<Particle*>::iterator it=cgZone.begin();
+      std::vector<Particle*>& cgZone = verletList->getCGZone();
+      for (std::vector<Particle*>::iterator it=cgZone.begin();
           it != cgZone.end(); ++it) {
 
       Particle &vp = **it;
@@ -517,26 +508,22 @@ namespace espressopp {
       //weights.insert(std::make_pair(&vp, 0.0));
       }
 
-      std::set<Particle*> adrZone = verletList->getAdrZone();
-      for (std::set<Particle*>::iterator it=adrZone.begin();
-              it != adrZone.end(); ++it) {
+      std::vector<Particle*>& adrZone = verletList->getAdrZone();
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& adrZoneIdx = verletList->getAdrZoneIndices();
+      for (size_t j = 0; j < adrZone.size(); ++j) {
 
-          Particle &vp = **it;
-
-          FixedTupleListAdress::iterator it3;
-          it3 = fixedtupleList->find(&vp);
-
-          if (it3 != fixedtupleList->end()) {
+          Particle &vp = *adrZone[j];
+          int i = adrZoneIdx[j];
 
-              std::vector<Particle*> atList;
-              atList = it3->second;
+          if (zoneFlags[i] & VerletListAdress::HAS_AT) {
 
               // compute center of mass
               Real3D cmp(0.0, 0.0, 0.0); // center of mass position
               Real3D cmv(0.0, 0.0, 0.0); // center of mass velocity
               //real M = vp.getMass(); // sum of mass of AT particles
-              for (std::vector<Particle*>::iterator it2 = atList.begin();
-                                   it2 != atList.end(); ++it2) {
+              for (Particle** it2 = verletList->atBegin(i);
+                                   it2 != verletList->atEnd(i); ++it2) {
                   Particle &at = **it2;
                   //Real3D d1 = at.position() - vp.position();
                   //Real3D d1;
@@ -625,8 +612,10 @@ namespace espressopp {
       }
       //std::cout << "Energy CG region:" << e << "\n";
       //makeWeights();
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
       for (PairList::Iterator it(verletList->getAdrPairs());
-           it.isValid(); ++it) {
+           it.isValid(); ++it, pairIndex += 2) {
           Particle &p1 = *it->first;
           Particle &p2 = *it->second;
           real w1 = p1.lambda();
@@ -640,23 +629,18 @@ namespace espressopp {
           e += (1.0-w12)*potentialCG._computeEnergy(p1, p2);
           //std::cout << "CG Energy calculation AT/HY region done:" << e << "\n";
 
-          FixedTupleListAdress::iterator it3;
-          FixedTupleListAdress::iterator it4;
-          it3 = fixedtupleList->find(&p1);
-          it4 = fixedtupleList->find(&p2);
+          // AT particles of the two VPs, collected at the last rebuild
+          int i1 = adrPairIdx[pairIndex];
+          int i2 = adrPairIdx[pairIndex + 1];
 
-          if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-              std::vector<Particle*> atList1;
-              std::vector<Particle*> atList2;
-              atList1 = it3->second;
-              atList2 = it4->second;
+          if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-              for (std::vector<Particle*>::iterator itv = atList1.begin();
-                      itv != atList1.end(); ++itv) {
+              for (Particle** itv = verletList->atBegin(i1);
+                      itv != verletList->atEnd(i1); ++itv) {
 
                   Particle &p3 = **itv;
-                  for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                       itv2 != atList2.end(); ++itv2) {
+                  for (Particle** itv2 = verletList->atBegin(i2);
+                                       itv2 != verletList->atEnd(i2); ++itv2) {
                       Particle &p4 = **itv2;
 
                       // AT energies
@@ -688,8 +672,11 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "compute energy derivative of the Verlet list pairs, in the atomistic region");
 
       real ederiv = 0.0;
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
       for (PairList::Iterator it(verletList->getAdrPairs());
-           it.isValid(); ++it) {
+           it.isValid(); ++it, pairIndex += 2) {
           Particle &p1 = *it->first;
           Particle &p2 = *it->second;
           real w1 = p1.lambda();
@@ -698,23 +685,18 @@ namespace espressopp {
           int type1 = p1.type();
           int type2 = p2.type();
 
-          FixedTupleListAdress::iterator it3;
-          FixedTupleListAdress::iterator it4;
-          it3 = fixedtupleList->find(&p1);
-          it4 = fixedtupleList->find(&p2);
+          // AT particles of the two VPs, collected at the last rebuild
+          int i1 = adrPairIdx[pairIndex];
+          int i2 = adrPairIdx[pairIndex + 1];
 
-          if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-              std::vector<Particle*> atList1;
-              std::vector<Particle*> atList2;
-              atList1 = it3->second;
-              atList2 = it4->second;
+          if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-              for (std::vector<Particle*>::iterator itv = atList1.begin();
-                      itv != atList1.end(); ++itv) {
+              for (Particle** itv = verletList->atBegin(i1);
+                      itv != verletList->atEnd(i1); ++itv) {
 
                   Particle &p3 = **itv;
-                  for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                       itv2 != atList2.end(); ++itv2) {
+                  for (Particle** itv2 = verletList->atBegin(i2);
+                                       itv2 != verletList->atEnd(i2); ++itv2) {
                       Particle &p4 = **itv2;
 
                       // AT energies
@@ -749,8 +731,8 @@ namespace espressopp {
     computeVirialX(std::vector<real> &p_xx_total, int bins) {
       //std::cout << "Warning! At the moment computeVirialX in VerletListAdressInteractionTemplate does not work." << std::endl << "Therefore, the corresponding interactions won't be included in calculation." << std::endl;
 
-      std::set<Particle*> cgZone = verletList->getCGZone();
-      for (std::set<Particle*>::iterator it=cgZone.begin();
+      std::vector<Particle*>& cgZone = verletList->getCGZone();
+      for (std::vector<Particle*>::iterator it=cgZone.begin();
           it != cgZone.end(); ++it) {
 
       Particle &vp = **it;
@@ -758,26 +740,22 @@ namespace espressopp {
       //weights.insert(std::make_pair(&vp, 0.0));
       }
 
-      std::set<Particle*> adrZone = verletList->getAdrZone();
-      for (std::set<Particle*>::iterator it=adrZone.begin();
-              it != adrZone.end(); ++it) {
-
-          Particle &vp = **it;
+      std::vector<Particle*>& adrZone = verletList->getAdrZone();
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& adrZoneIdx = verletList->getAdrZoneIndices();
+      for (size_t j = 0; j < adrZone.size(); ++j) {
 
-          FixedTupleListAdress::iterator it3;
-          it3 = fixedtupleList->find(&vp);
+          Particle &vp = *adrZone[j];
+          int i = adrZoneIdx[j];
 
-          if (it3 != fixedtupleList->end()) {
-
-              std::vector<Particle*> atList;
-              atList = it3->second;
+          if (zoneFlags[i] & VerletListAdress::HAS_AT) {
 
               // compute center of mass
               Real3D cmp(0.0, 0.0, 0.0); // center of mass position
               Real3D cmv(0.0, 0.0, 0.0); // center of mass velocity
               //real M = vp.getMass(); // sum of mass of AT particles
-              for (std::vector<Particle*>::iterator it2 = atList.begin();
-                                   it2 != atList.end(); ++it2) {
+              for (Particle** it2 = verletList->atBegin(i);
+                                   it2 != verletList->atEnd(i); ++it2) {
                   Particle &at = **it2;
                   //Real3D d1 = at.position() - vp.position();
                   //Real3D d1;
@@ -915,7 +893,9 @@ namespace espressopp {
         }
       }
 
-      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it) {
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
+      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it, pairIndex += 2) {
          real w1, w2;
          // these are the two VP interacting
          Particle &p1 = *it->first;
@@ -973,28 +953,22 @@ namespace espressopp {
 
          // force between AT particles
          if (w12 != 0.0) { // calculate AT force if both VP are outside CG region (HY-HY, HY-AT, AT-AT)
-             FixedTupleListAdress::iterator it3;
-             FixedTupleListAdress::iterator it4;
-             it3 = fixedtupleList->find(&p1);
-             it4 = fixedtupleList->find(&p2);
+             // AT particles of the two VPs, collected at the last rebuild
+             int i1 = adrPairIdx[pairIndex];
+             int i2 = adrPairIdx[pairIndex + 1];
 
              //std::cout << "Interaction " << p1.id() << " - " << p2.id() << "\n";
-             if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-
-                 std::vector<Particle*> atList1;
-                 std::vector<Particle*> atList2;
-                 atList1 = it3->second;
-                 atList2 = it4->second;
+             if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
                  Real3D force_temp(0.0, 0.0, 0.0);
 
-                 for (std::vector<Particle*>::iterator itv = atList1.begin();
-                         itv != atList1.end(); ++itv) {
+                 for (Particle** itv = verletList->atBegin(i1);
+                         itv != verletList->atEnd(i1); ++itv) {
 
                      Particle &p3 = **itv;
 
-                     for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                          itv2 != atList2.end(); ++itv2) {
+                     for (Particle** itv2 = verletList->atBegin(i2);
+                                          itv2 != verletList->atEnd(i2); ++itv2) {
 
                          Particle &p4 = **itv2;
 
@@ -125,7 +125,7 @@ VerletListDynamicResolutionInteractionTemplate<_Potential>::
 addForces() {
   LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and add forces");
   const bc::BC& bc = *(verletList->getSystemRef()).bc;  // boundary conditions
-  for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+  for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
     Particle &p1 = *it->first;
     Particle &p2 = *it->second;
     int type1 = p1.type();
@@ -166,7 +166,7 @@ computeEnergy() {
   LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and sum up potential energies");
 
   real es = 0.0;
-  for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+  for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
     Particle &p1 = *it->first;
     Particle &p2 = *it->second;
     int type1 = p1.type();
@@ -227,7 +227,7 @@ computeVirial() {
   const bc::BC& bc = *(verletList->getSystemRef()).bc;  // boundary conditions
 
   real w = 0.0;
-  for (PairList::Iterator it(verletList->getPairs());
+  for (VerletList::PairIterator it(*verletList);
        it.isValid(); ++it) {
     Particle &p1 = *it->first;
     Particle &p2 = *it->second;
@@ -273,7 +273,7 @@ computeVirialTensor(Tensor& w) {
   LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and sum up virial tensor");
   const bc::BC& bc = *(verletList->getSystemRef()).bc;  // boundary conditions
   Tensor wlocal(0.0);
-  for (PairList::Iterator it(verletList->getPairs());
+  for (VerletList::PairIterator it(*verletList);
        it.isValid(); ++it) {
     Particle &p1 = *it->first;
     Particle &p2 = *it->second;
@@ -136,9 +136,7 @@ namespace espressopp {
       real dex;
       real dhy;
       real dex2; // dex^2
-      std::map<Particle*, real> energydiff;  // Energydifference V_AA - V_CG map for particles in hybrid region for drift term calculation in H-AdResS
-      std::set<Particle*> adrZone;  // Virtual particles in AdResS zone (HY and AT region)
-      std::set<Particle*> cgZone;
+      std::vector<real> energydiff;  // Energydifference V_AA - V_CG of the local VPs (by local index of the verlet list) in hybrid region for drift term calculation in H-AdResS
 
     };
 
@@ -150,15 +148,12 @@ namespace espressopp {
     addForces() {
       LOG4ESPP_INFO(theLogger, "add forces computed by the Verlet List");
 
-      std::set<Particle*> cgZone = verletList->getCGZone();
-      std::set<Particle*> adrZone = verletList->getAdrZone();
+      std::vector<Particle*>& adrZone = verletList->getAdrZone();
+      std::vector<int>& adrZoneIdx = verletList->getAdrZoneIndices();
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
 
-      for (std::set<Particle*>::iterator it=adrZone.begin();
-                    it != adrZone.end(); ++it) {
-                  	Particle &p = **it;
-                  	// intitialize energy diff AA-CG
-                  	energydiff[&p]=0.0;
-      }
+      // intitialize energy diff AA-CG
+      energydiff.assign(zoneFlags.size(), 0.0);
 
 
       // Pairs not inside the AdResS Zone (CG region)
@@ -183,11 +178,16 @@ namespace espressopp {
       // REMOVE FOR IDEAL GAS
 
       // Compute forces (AT and VP) of Pairs inside AdResS zone
-      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it) {
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
+      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it, pairIndex += 2) {
          real w1, w2;
          // these are the two VP interacting
          Particle &p1 = *it->first;
          Particle &p2 = *it->second;
+         // local indices of the two VP
+         int i1 = adrPairIdx[pairIndex];
+         int i2 = adrPairIdx[pairIndex + 1];
 
          w1 = p1.lambda();
          w2 = p2.lambda();
@@ -210,14 +210,14 @@ namespace espressopp {
                     }
 
                     // H-AdResS - Drift Term part 1
-                    // Compute CG energies of particles in the hybrid and store and add up in map energydiff
+                    // Compute CG energies of particles in the hybrid and store and add up in energydiff
                     if (w12 != 0.0) {   //at least one particle in hybrid region => need to do the energy calculation
                         real energyvp = potentialCG._computeEnergy(p1, p2);
                         if (w1 != 0.0) {   // if particle one is in hybrid region
-                            energydiff[&p1] += energyvp;   // add CG energy for virtual particle 1
+                            energydiff[i1] += energyvp;   // add CG energy for virtual particle 1
                         }
                         if (w2 != 0.0) {   // if particle two is in hybrid region
-                            energydiff[&p2] += energyvp;   // add CG energy for virtual particle 2
+                            energydiff[i2] += energyvp;   // add CG energy for virtual particle 2
                         }
                     }
 
@@ -226,25 +226,16 @@ namespace espressopp {
 
          // force between AT particles
          if (w12 != 0.0) { // calculate AT force if both VP are outside CG region (HY-HY, HY-AT, AT-AT)
-             FixedTupleListAdress::iterator it3;
-             FixedTupleListAdress::iterator it4;
-             it3 = fixedtupleList->find(&p1);
-             it4 = fixedtupleList->find(&p2);
-
-             if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-
-                 std::vector<Particle*> atList1;
-                 std::vector<Particle*> atList2;
-                 atList1 = it3->second;
-                 atList2 = it4->second;
+             // AT particles of the two VPs, collected at the last rebuild
+             if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-                 for (std::vector<Particle*>::iterator itv = atList1.begin();
-                         itv != atList1.end(); ++itv) {
+                 for (Particle** itv = verletList->atBegin(i1);
+                         itv != verletList->atEnd(i1); ++itv) {
 
                      Particle &p3 = **itv;
 
-                     for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                          itv2 != atList2.end(); ++itv2) {
+                     for (Particle** itv2 = verletList->atBegin(i2);
+                                          itv2 != verletList->atEnd(i2); ++itv2) {
 
                          Particle &p4 = **itv2;
 
@@ -258,14 +249,14 @@ namespace espressopp {
                          }
 
                          // H-AdResS - Drift Term part 2
-                         // Compute AT energies of particles in the hybrid and store and subtract in map energydiff
+                         // Compute AT energies of particles in the hybrid and store and subtract in energydiff
                          if(w12!=1.0){   //at least one particle in hybrid region => need to do the energy calculation
                              real energyat = potentialAT._computeEnergy(p3, p4);
                              if(w1!=1.0){   // if particle one is in hybrid region
-                                    energydiff[&p1] -= energyat;   // subtract AT energy for virtual particle 1
+                                    energydiff[i1] -= energyat;   // subtract AT energy for virtual particle 1
                              }
                              if(w2!=1.0){   // if particle two is in hybrid region
-                                    energydiff[&p2] -= energyat;   // subtract AT energy for virtual particle 2
+                                    energydiff[i2] -= energyat;   // subtract AT energy for virtual particle 2
                              }
                          }
 
@@ -285,9 +276,8 @@ namespace espressopp {
 
       // H-AdResS - Drift Term part 3
       // Iterate over all particles in the hybrid region and calculate drift force
-      for (std::set<Particle*>::iterator it=adrZone.begin();
-        it != adrZone.end(); ++it) {   // Iterate over all particles
-          Particle &vp = **it;
+      for (size_t j = 0; j < adrZone.size(); ++j) {   // Iterate over all particles
+          Particle &vp = *adrZone[j];
           real w = vp.lambda();
 
           if(w<0.9999999 && w>0.0000001){   //   only chose those in the hybrid region
@@ -324,23 +314,21 @@ namespace espressopp {
 
               if(verletList->getAdrRegionType()){
                 mindriftforce = (1.0/min1sq)*mindriftforce; // normalized driftforce vector
-                mindriftforce *= (0.5 * energydiff.find(&vp)->second); // get the energy differences which were calculated previously and put in drift force
+                mindriftforce *= (0.5 * energydiff[adrZoneIdx[j]]); // get the energy differences which were calculated previously and put in drift force
                 mindriftforce *= vp.lambdaDeriv();
                 vp.force() += mindriftforce;
               }
               else{
                 real mindriftforceX = (1.0/min1sq)*mindriftforce[0]; // normalized driftforce vector
-                mindriftforceX *= (0.5 * energydiff.find(&vp)->second); // get the energy differences which were calculated previously and put in drift force
+                mindriftforceX *= (0.5 * energydiff[adrZoneIdx[j]]); // get the energy differences which were calculated previously and put in drift force
                 mindriftforceX *= vp.lambdaDeriv();
                 Real3D driftforceadd(mindriftforceX,0.0,0.0);
                 vp.force() += driftforceadd;
               }
-              vp.drift() += 0.5 * energydiff.find(&vp)->second;
+              vp.drift() += 0.5 * energydiff[adrZoneIdx[j]];
           }
 
       }
-
-      energydiff.clear();  // clear the energy difference map
     }
 
     // Energy calculation does currently only work if integrator.run( ) (also with 0) and decompose have been executed before. This is due to the initialization of the tuples.
@@ -363,8 +351,11 @@ namespace espressopp {
       }
       // REMOVE FOR IDEAL GAS
 
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
       for (PairList::Iterator it(verletList->getAdrPairs());
-           it.isValid(); ++it) {
+           it.isValid(); ++it, pairIndex += 2) {
           Particle &p1 = *it->first;
           Particle &p2 = *it->second;
           real w1 = p1.lambda();
@@ -378,23 +369,18 @@ namespace espressopp {
           e += (1.0-w12)*potentialCG._computeEnergy(p1, p2);
           // REMOVE FOR IDEAL GAS
 
-          FixedTupleListAdress::iterator it3;
-          FixedTupleListAdress::iterator it4;
-          it3 = fixedtupleList->find(&p1);
-          it4 = fixedtupleList->find(&p2);
+          // AT particles of the two VPs, collected at the last rebuild
+          int i1 = adrPairIdx[pairIndex];
+          int i2 = adrPairIdx[pairIndex + 1];
 
-          if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-              std::vector<Particle*> atList1;
-              std::vector<Particle*> atList2;
-              atList1 = it3->second;
-              atList2 = it4->second;
+          if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-              for (std::vector<Particle*>::iterator itv = atList1.begin();
-                      itv != atList1.end(); ++itv) {
+              for (Particle** itv = verletList->atBegin(i1);
+                      itv != verletList->atEnd(i1); ++itv) {
 
                   Particle &p3 = **itv;
-                  for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                       itv2 != atList2.end(); ++itv2) {
+                  for (Particle** itv2 = verletList->atBegin(i2);
+                                       itv2 != verletList->atEnd(i2); ++itv2) {
                       Particle &p4 = **itv2;
 
                       // AT energies
@@ -426,27 +412,23 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "compute total AA energy of the Verlet list pairs");
 
       real e = 0.0;
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& vlPairIdx = verletList->getPairIndices();
+      int pairIndex = 0;
       for (PairList::Iterator it(verletList->getPairs());
-           it.isValid(); ++it) {
-          Particle &p1 = *it->first;
-          Particle &p2 = *it->second;
-          FixedTupleListAdress::iterator it3;
-          FixedTupleListAdress::iterator it4;
-          it3 = fixedtupleList->find(&p1);
-          it4 = fixedtupleList->find(&p2);
+           it.isValid(); ++it, pairIndex += 2) {
+          // AT particles of the two VPs, collected at the last rebuild
+          int i1 = vlPairIdx[pairIndex];
+          int i2 = vlPairIdx[pairIndex + 1];
 
-          if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-              std::vector<Particle*> atList1;
-              std::vector<Particle*> atList2;
-              atList1 = it3->second;
-              atList2 = it4->second;
+          if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-              for (std::vector<Particle*>::iterator itv = atList1.begin();
-                      itv != atList1.end(); ++itv) {
+              for (Particle** itv = verletList->atBegin(i1);
+                      itv != verletList->atEnd(i1); ++itv) {
 
                   Particle &p3 = **itv;
-                  for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                       itv2 != atList2.end(); ++itv2) {
+                  for (Particle** itv2 = verletList->atBegin(i2);
+                                       itv2 != verletList->atEnd(i2); ++itv2) {
                       Particle &p4 = **itv2;
 
                       // AT energies
@@ -458,27 +440,22 @@ namespace espressopp {
           }
       }
 
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      pairIndex = 0;
       for (PairList::Iterator it(verletList->getAdrPairs());
-           it.isValid(); ++it) {
-          Particle &p1 = *it->first;
-          Particle &p2 = *it->second;
-          FixedTupleListAdress::iterator it3;
-          FixedTupleListAdress::iterator it4;
-          it3 = fixedtupleList->find(&p1);
-          it4 = fixedtupleList->find(&p2);
+           it.isValid(); ++it, pairIndex += 2) {
+          // AT particles of the two VPs, collected at the last rebuild
+          int i1 = adrPairIdx[pairIndex];
+          int i2 = adrPairIdx[pairIndex + 1];
 
-          if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-              std::vector<Particle*> atList1;
-              std::vector<Particle*> atList2;
-              atList1 = it3->second;
-              atList2 = it4->second;
+          if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-              for (std::vector<Particle*>::iterator itv = atList1.begin();
-                      itv != atList1.end(); ++itv) {
+              for (Particle** itv = verletList->atBegin(i1);
+                      itv != verletList->atEnd(i1); ++itv) {
 
                   Particle &p3 = **itv;
-                  for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                       itv2 != atList2.end(); ++itv2) {
+                  for (Particle** itv2 = verletList->atBegin(i2);
+                                       itv2 != verletList->atEnd(i2); ++itv2) {
                       Particle &p4 = **itv2;
 
                       // AT energies
@@ -534,24 +511,20 @@ namespace espressopp {
     computeVirialX(std::vector<real> &p_xx_total, int bins) {
       LOG4ESPP_INFO(theLogger, "compute virial p_xx of the pressure tensor slabwise");
 
-      std::set<Particle*> cgZone = verletList->getCGZone();
-      for (std::set<Particle*>::iterator it=cgZone.begin();
-              it != cgZone.end(); ++it) {
-
-          Particle &vp = **it;
-
-          FixedTupleListAdress::iterator it3;
-          it3 = fixedtupleList->find(&vp);
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<Particle*>& cgZone = verletList->getCGZone();
+      std::vector<int>& cgZoneIdx = verletList->getCGZoneIndices();
+      for (size_t j = 0; j < cgZone.size(); ++j) {
 
-          if (it3 != fixedtupleList->end()) {
+          Particle &vp = *cgZone[j];
+          int i = cgZoneIdx[j];
 
-              std::vector<Particle*> atList;
-              atList = it3->second;
+          if (zoneFlags[i] & VerletListAdress::HAS_AT) {
 
               // compute center of mass
               Real3D cmp(0.0, 0.0, 0.0); // center of mass position
-              for (std::vector<Particle*>::iterator it2 = atList.begin();
-                                   it2 != atList.end(); ++it2) {
+              for (Particle** it2 = verletList->atBegin(i);
+                                   it2 != verletList->atEnd(i); ++it2) {
                   Particle *at = *it2;
                   cmp += at->mass() * at->position();
               }
@@ -568,24 +541,19 @@ namespace espressopp {
           }
       }
 
-      std::set<Particle*> adrZone = verletList->getAdrZone();
-      for (std::set<Particle*>::iterator it=adrZone.begin();
-              it != adrZone.end(); ++it) {
+      std::vector<Particle*>& adrZone = verletList->getAdrZone();
+      std::vector<int>& adrZoneIdx = verletList->getAdrZoneIndices();
+      for (size_t j = 0; j < adrZone.size(); ++j) {
 
-          Particle &vp = **it;
+          Particle &vp = *adrZone[j];
+          int i = adrZoneIdx[j];
 
-          FixedTupleListAdress::iterator it3;
-          it3 = fixedtupleList->find(&vp);
-
-          if (it3 != fixedtupleList->end()) {
-
-              std::vector<Particle*> atList;
-              atList = it3->second;
+          if (zoneFlags[i] & VerletListAdress::HAS_AT) {
 
               // compute center of mass
               Real3D cmp(0.0, 0.0, 0.0); // center of mass position
-              for (std::vector<Particle*>::iterator it2 = atList.begin();
-                                   it2 != atList.end(); ++it2) {
+              for (Particle** it2 = verletList->atBegin(i);
+                                   it2 != verletList->atEnd(i); ++it2) {
                   Particle &at = **it2;
                   cmp += at.mass() * at.position();
               }
@@ -674,7 +642,9 @@ namespace espressopp {
         }
       }
 
-      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it) {
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
+      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it, pairIndex += 2) {
          real w1, w2;
          // these are the two VP interacting
          Particle &p1 = *it->first;
@@ -732,27 +702,21 @@ namespace espressopp {
 
          // force between AT particles
          if (w12 != 0.0) { // calculate AT force if both VP are outside CG region (HY-HY, HY-AT, AT-AT)
-             FixedTupleListAdress::iterator it3;
-             FixedTupleListAdress::iterator it4;
-             it3 = fixedtupleList->find(&p1);
-             it4 = fixedtupleList->find(&p2);
+             // AT particles of the two VPs, collected at the last rebuild
+             int i1 = adrPairIdx[pairIndex];
+             int i2 = adrPairIdx[pairIndex + 1];
 
-             if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
-
-                 std::vector<Particle*> atList1;
-                 std::vector<Particle*> atList2;
-                 atList1 = it3->second;
-                 atList2 = it4->second;
+             if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
                  Real3D force_temp(0.0, 0.0, 0.0);
 
-                 for (std::vector<Particle*>::iterator itv = atList1.begin();
-                         itv != atList1.end(); ++itv) {
+                 for (Particle** itv = verletList->atBegin(i1);
+                         itv != verletList->atEnd(i1); ++itv) {
 
                      Particle &p3 = **itv;
 
-                     for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                          itv2 != atList2.end(); ++itv2) {
+                     for (Particle** itv2 = verletList->atBegin(i2);
+                                          itv2 != verletList->atEnd(i2); ++itv2) {
 
                          Particle &p4 = **itv2;
 
@@ -821,7 +785,10 @@ namespace espressopp {
         }
       }
 
-      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it) {
+      std::vector<unsigned char>& zoneFlags = verletList->getZoneFlags();
+      std::vector<int>& adrPairIdx = verletList->getAdrPairIndices();
+      int pairIndex = 0;
+      for (PairList::Iterator it(verletList->getAdrPairs()); it.isValid(); ++it, pairIndex += 2) {
          real w1, w2;
          // these are the two VP interacting
          Particle &p1 = *it->first;
@@ -849,25 +816,19 @@ namespace espressopp {
 
          // force between AT particles
          if (w12 != 0.0) { // calculate AT force if both VP are outside CG region (HY-HY, HY-AT, AT-AT)
-             FixedTupleListAdress::iterator it3;
-             FixedTupleListAdress::iterator it4;
-             it3 = fixedtupleList->find(&p1);
-             it4 = fixedtupleList->find(&p2);
-
-             if (it3 != fixedtupleList->end() && it4 != fixedtupleList->end()) {
+             // AT particles of the two VPs, collected at the last rebuild
+             int i1 = adrPairIdx[pairIndex];
+             int i2 = adrPairIdx[pairIndex + 1];
 
-                 std::vector<Particle*> atList1;
-                 std::vector<Particle*> atList2;
-                 atList1 = it3->second;
-                 atList2 = it4->second;
+             if (zoneFlags[i1] & zoneFlags[i2] & VerletListAdress::HAS_AT) {
 
-                 for (std::vector<Particle*>::iterator itv = atList1.begin();
-                         itv != atList1.end(); ++itv) {
+                 for (Particle** itv = verletList->atBegin(i1);
+                         itv != verletList->atEnd(i1); ++itv) {
 
                      Particle &p3 = **itv;
 
-                     for (std::vector<Particle*>::iterator itv2 = atList2.begin();
-                                          itv2 != atList2.end(); ++itv2) {
+                     for (Particle** itv2 = verletList->atBegin(i2);
+                                          itv2 != verletList->atEnd(i2); ++itv2) {
 
                          Particle &p4 = **itv2;
 
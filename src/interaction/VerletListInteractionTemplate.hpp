@@ -37,6 +37,13 @@
 #include "bc/BC.hpp"
 
 #include "storage/Storage.hpp"
+#include "ThreadForces.hpp"
+
+#include <boost/type_traits/integral_constant.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace espressopp {
   namespace interaction {
@@ -89,6 +96,8 @@ namespace espressopp {
 
 
       virtual void addForces();
+      virtual void addForcesInterior(int part, int nParts);
+      virtual void addForcesBoundary();
       virtual real computeEnergy();
       virtual real computeEnergyDeriv();
       virtual real computeEnergyAA();
@@ -102,6 +111,59 @@ namespace espressopp {
       virtual int bondType() { return Nonbonded; }
 
     protected:
+      /** Which pairs of the rows of a compact list a force loop visits:
+          all of them, or only those with a real (interior) or a ghost
+          (boundary) neighbor for the overlapped ghost communication. The
+          row particle is always real. */
+      enum PairSelection { allPairs, interiorPairs, boundaryPairs };
+      static bool isSelected(PairSelection sel, const Particle &p2) {
+        return sel == allPairs || p2.ghost() == (sel == boundaryPairs);
+      }
+
+      /** The force kernel shared by addForces and the interior/boundary
+          split: the pairs [begin, end) of the pair list, or the selected
+          pairs of the rows [begin, end) of a compact list. Dispatches to
+          the threaded, batched or plain loop. */
+      void addForcesPairs(long begin, long end);
+      void addForcesRows(long begin, long end, PairSelection sel);
+
+      /** computeEnergy for a compact VerletList */
+      real computeEnergyCompact();
+
+      /** Batched addForces and computeEnergy for systems with a single
+          particle type: the distances of up to batchSize pairs are
+          gathered into arrays and handed to the vectorized kernel of
+          the potential. Particles of other types do not interact. */
+      bool useBatch() const { return Potential::hasBatchKernel && ntypes == 1; }
+      typedef boost::integral_constant<bool, Potential::hasBatchKernel> HasBatchKernel;
+      void addForcesPairsBatch(long begin, long end, boost::true_type);
+      void addForcesPairsBatch(long begin, long end, boost::false_type) {}
+      void addForcesRowsBatch(long begin, long end, PairSelection sel, boost::true_type);
+      void addForcesRowsBatch(long begin, long end, PairSelection sel, boost::false_type) {}
+      real computeEnergyBatch(boost::true_type);
+      real computeEnergyBatch(boost::false_type) { return 0.0; }
+      static const int batchSize = 64;
+
+      /** threads per rank of the threaded loops, System::numThreads */
+      int getNumThreads() { return verletList->getSystemRef().getNumThreads(); }
+
+      /** enlarge the potential array up to the largest type, as
+          getPotential() does in the serial loops, so that the threads
+          can read it with potentialArray(type1, type2) */
+      void enlargePotentials(int maxType) {
+        if (maxType >= 0) potentialArray.at(maxType, maxType);
+      }
+
+#ifdef _OPENMP
+      /** threaded variants of the force kernel: every thread adds the
+          forces of its pairs to its own array of threadForces, the arrays
+          are summed into the particles in parallel afterwards. */
+      void addForcesPairsThreaded(long begin, long end, int nThreads);
+      void addForcesRowsThreaded(long begin, long end, PairSelection sel, int nThreads);
+      ThreadForces threadForces;
+      LocalParticleIndex particleIndex;
+#endif
+
       int ntypes;
       shared_ptr<VerletList> verletList;
       esutil::Array2D<Potential, esutil::enlarge> potentialArray;
@@ -116,9 +178,56 @@ namespace espressopp {
     addForces() {
       LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and add forces");
 
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
-        Particle &p1 = *it->first;
-        Particle &p2 = *it->second;
+      if (verletList->isCompact()) {
+        addForcesRows(0, verletList->getNeighborList().numParticles(), allPairs);
+      } else {
+        addForcesPairs(0, verletList->getPairs().size());
+      }
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesInterior(int part, int nParts) {
+      if (verletList->isCompact()) {
+        long n = verletList->getNeighborList().numParticles();
+        addForcesRows(n * part / nParts, n * (part + 1) / nParts, interiorPairs);
+      } else {
+        long nInterior = verletList->partitionInteriorPairs();
+        addForcesPairs(nInterior * part / nParts, nInterior * (part + 1) / nParts);
+      }
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesBoundary() {
+      if (verletList->isCompact()) {
+        addForcesRows(0, verletList->getNeighborList().numParticles(), boundaryPairs);
+      } else {
+        long nInterior = verletList->partitionInteriorPairs();
+        addForcesPairs(nInterior, verletList->getPairs().size());
+      }
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesPairs(long begin, long end) {
+#ifdef _OPENMP
+      int nThreads = getNumThreads();
+      if (nThreads > 1) {
+        addForcesPairsThreaded(begin, end, nThreads);
+        return;
+      }
+#endif
+
+      if (useBatch()) {
+        addForcesPairsBatch(begin, end, HasBatchKernel());
+        return;
+      }
+
+      PairList &pairs = verletList->getPairs();
+      for (long k = begin; k < end; ++k) {
+        Particle &p1 = *pairs[k].first;
+        Particle &p2 = *pairs[k].second;
         int type1 = p1.type();
         int type2 = p2.type();
         const Potential &potential = getPotential(type1, type2);
@@ -133,26 +242,276 @@ namespace espressopp {
         }
       }
     }
-    
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesRows(long begin, long end, PairSelection sel) {
+#ifdef _OPENMP
+      int nThreads = getNumThreads();
+      if (nThreads > 1) {
+        addForcesRowsThreaded(begin, end, sel, nThreads);
+        return;
+      }
+#endif
+
+      if (useBatch()) {
+        addForcesRowsBatch(begin, end, sel, HasBatchKernel());
+        return;
+      }
+
+      NeighborList &nl = verletList->getNeighborList();
+      for (long i = begin; i < end; ++i) {
+        const int kbegin = nl.start[i];
+        const int kend = nl.start[i+1];
+        if (kbegin == kend) continue;
+        Particle &p1 = *nl.particles[i];
+        int type1 = p1.type();
+        Real3D force1(0.0);
+        for (int k = kbegin; k < kend; ++k) {
+          Particle &p2 = *nl.particles[nl.neighbors[k]];
+          if (!isSelected(sel, p2)) continue;
+          const Potential &potential = getPotential(type1, p2.type());
+          Real3D force(0.0);
+          if (potential._computeForce(force, p1, p2)) {
+            force1 += force;
+            p2.force() -= force;
+          }
+        }
+        p1.force() += force1;
+      }
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesRowsBatch(long begin, long end, PairSelection sel, boost::true_type) {
+      const Potential &potential = getPotential(0, 0);
+      real dx[batchSize], dy[batchSize], dz[batchSize];
+      real distSqr[batchSize], ffactor[batchSize];
+      Particle *p2s[batchSize];
+
+      NeighborList &nl = verletList->getNeighborList();
+      for (long i = begin; i < end; ++i) {
+        Particle &p1 = *nl.particles[i];
+        if (p1.type() != 0) continue;
+        const Real3D pos1 = p1.position();
+        Real3D force1(0.0);
+        int k = nl.start[i];
+        const int kend = nl.start[i+1];
+        while (k < kend) {
+          int m = 0;
+          for (; k < kend && m < batchSize; ++k) {
+            Particle *p2 = nl.particles[nl.neighbors[k]];
+            if (p2->type() != 0 || !isSelected(sel, *p2)) continue;
+            Real3D d = pos1 - p2->position();
+            p2s[m] = p2;
+            dx[m] = d[0]; dy[m] = d[1]; dz[m] = d[2];
+            distSqr[m] = d.sqr();
+            ++m;
+          }
+          potential._computeForceFactors(distSqr, ffactor, m);
+          for (int j = 0; j < m; ++j) {
+            Real3D force(dx[j] * ffactor[j], dy[j] * ffactor[j], dz[j] * ffactor[j]);
+            force1 += force;
+            p2s[j]->force() -= force;
+          }
+        }
+        p1.force() += force1;
+      }
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesPairsBatch(long begin, long end, boost::true_type) {
+      const Potential &potential = getPotential(0, 0);
+      real dx[batchSize], dy[batchSize], dz[batchSize];
+      real distSqr[batchSize], ffactor[batchSize];
+      Particle *p1s[batchSize], *p2s[batchSize];
+
+      PairList &pairs = verletList->getPairs();
+      for (long k0 = begin; k0 < end; k0 += batchSize) {
+        int m = 0;
+        for (long k = k0; k < end && k < k0 + batchSize; ++k) {
+          Particle *p1 = pairs[k].first;
+          Particle *p2 = pairs[k].second;
+          if (p1->type() != 0 || p2->type() != 0) continue;
+          Real3D d = p1->position() - p2->position();
+          p1s[m] = p1;
+          p2s[m] = p2;
+          dx[m] = d[0]; dy[m] = d[1]; dz[m] = d[2];
+          distSqr[m] = d.sqr();
+          ++m;
+        }
+        potential._computeForceFactors(distSqr, ffactor, m);
+        for (int j = 0; j < m; ++j) {
+          Real3D force(dx[j] * ffactor[j], dy[j] * ffactor[j], dz[j] * ffactor[j]);
+          p1s[j]->force() += force;
+          p2s[j]->force() -= force;
+        }
+      }
+    }
+
+    template < typename _Potential > inline real
+    VerletListInteractionTemplate < _Potential >::
+    computeEnergyBatch(boost::true_type) {
+      const Potential &potential = getPotential(0, 0);
+      real distSqr[batchSize], energy[batchSize];
+      real es = 0.0;
+
+      if (verletList->isCompact()) {
+        NeighborList &nl = verletList->getNeighborList();
+        const long n = nl.numParticles();
+        for (long i = 0; i < n; ++i) {
+          const Particle &p1 = *nl.particles[i];
+          if (p1.type() != 0) continue;
+          const Real3D pos1 = p1.position();
+          int k = nl.start[i];
+          const int end = nl.start[i+1];
+          while (k < end) {
+            int m = 0;
+            for (; k < end && m < batchSize; ++k) {
+              const Particle &p2 = *nl.particles[nl.neighbors[k]];
+              if (p2.type() != 0) continue;
+              distSqr[m++] = (pos1 - p2.position()).sqr();
+            }
+            potential._computeEnergiesSqr(distSqr, energy, m);
+            for (int j = 0; j < m; ++j) es += energy[j];
+          }
+        }
+        return es;
+      }
+
+      PairList &pairs = verletList->getPairs();
+      const long npairs = pairs.size();
+      for (long k0 = 0; k0 < npairs; k0 += batchSize) {
+        int m = 0;
+        for (long k = k0; k < npairs && k < k0 + batchSize; ++k) {
+          const Particle &p1 = *pairs[k].first;
+          const Particle &p2 = *pairs[k].second;
+          if (p1.type() != 0 || p2.type() != 0) continue;
+          distSqr[m++] = (p1.position() - p2.position()).sqr();
+        }
+        potential._computeEnergiesSqr(distSqr, energy, m);
+        for (int j = 0; j < m; ++j) es += energy[j];
+      }
+      return es;
+    }
+
+#ifdef _OPENMP
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesPairsThreaded(long begin, long end, int nThreads) {
+      PairList &pairs = verletList->getPairs();
+      particleIndex.update(verletList->getSystemRef().storage->getLocalCells());
+
+      int maxType = -1;
+      #pragma omp parallel for num_threads(nThreads) schedule(static) reduction(max:maxType)
+      for (long k = begin; k < end; ++k) {
+        maxType = std::max(maxType, int(std::max(pairs[k].first->type(), pairs[k].second->type())));
+      }
+      enlargePotentials(maxType);
+
+      threadForces.reset(nThreads, particleIndex.size());
+      #pragma omp parallel num_threads(nThreads)
+      {
+        Real3D *f = threadForces.get(omp_get_thread_num());
+        #pragma omp for schedule(static)
+        for (long k = begin; k < end; ++k) {
+          const Particle &p1 = *pairs[k].first;
+          const Particle &p2 = *pairs[k].second;
+          Real3D force(0.0);
+          if (potentialArray(p1.type(), p2.type())._computeForce(force, p1, p2)) {
+            f[particleIndex(&p1)] += force;
+            f[particleIndex(&p2)] -= force;
+          }
+        }
+      }
+      threadForces.addTo(particleIndex.getParticles());
+    }
+
+    template < typename _Potential > inline void
+    VerletListInteractionTemplate < _Potential >::
+    addForcesRowsThreaded(long begin, long end, PairSelection sel, int nThreads) {
+      NeighborList &nl = verletList->getNeighborList();
+      const long n = nl.numParticles();
+
+      int maxType = -1;
+      #pragma omp parallel for num_threads(nThreads) schedule(static) reduction(max:maxType)
+      for (long i = 0; i < n; ++i) {
+        maxType = std::max(maxType, int(nl.particles[i]->type()));
+      }
+      enlargePotentials(maxType);
+
+      threadForces.reset(nThreads, n);
+      #pragma omp parallel num_threads(nThreads)
+      {
+        Real3D *f = threadForces.get(omp_get_thread_num());
+        #pragma omp for schedule(dynamic, 64)
+        for (long i = begin; i < end; ++i) {
+          const Particle &p1 = *nl.particles[i];
+          int type1 = p1.type();
+          Real3D force1(0.0);
+          for (int k = nl.start[i]; k < nl.start[i+1]; ++k) {
+            const int j = nl.neighbors[k];
+            const Particle &p2 = *nl.particles[j];
+            if (!isSelected(sel, p2)) continue;
+            Real3D force(0.0);
+            if (potentialArray(type1, p2.type())._computeForce(force, p1, p2)) {
+              force1 += force;
+              f[j] -= force;
+            }
+          }
+          f[i] += force1;
+        }
+      }
+      threadForces.addTo(nl.particles);
+    }
+#endif
+
     template < typename _Potential >
     inline real
     VerletListInteractionTemplate < _Potential >::
     computeEnergy() {
       LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and sum up potential energies");
 
-      real e = 0.0;
+      const int nThreads = getNumThreads();
+      const bool threaded = nThreads > 1;
+
       real es = 0.0;
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
-        Particle &p1 = *it->first;
-        Particle &p2 = *it->second;
-        int type1 = p1.type();
-        int type2 = p2.type();
-        const Potential &potential = getPotential(type1, type2);
-        // shared_ptr<Potential> potential = getPotential(type1, type2);
-        e   = potential._computeEnergy(p1, p2);
-        // e   = potential->_computeEnergy(p1, p2);
-        es += e;
-        LOG4ESPP_TRACE(_Potential::theLogger, "id1=" << p1.id() << " id2=" << p2.id() << " potential energy=" << e);
+      if (useBatch() && !threaded) {
+        es = computeEnergyBatch(HasBatchKernel());
+      } else if (verletList->isCompact()) {
+        es = computeEnergyCompact();
+      } else {
+#ifdef _OPENMP
+        PairList &pairs = verletList->getPairs();
+        const long npairs = pairs.size();
+        int maxType = -1;
+        #pragma omp parallel for num_threads(nThreads) schedule(static) reduction(max:maxType)
+        for (long i = 0; i < npairs; ++i) {
+          maxType = std::max(maxType, int(std::max(pairs[i].first->type(), pairs[i].second->type())));
+        }
+        enlargePotentials(maxType);
+        #pragma omp parallel for num_threads(nThreads) schedule(static) reduction(+:es)
+        for (long i = 0; i < npairs; ++i) {
+          const Particle &p1 = *pairs[i].first;
+          const Particle &p2 = *pairs[i].second;
+          es += potentialArray(p1.type(), p2.type())._computeEnergy(p1, p2);
+        }
+#else
+        real e = 0.0;
+        for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
+          Particle &p1 = *it->first;
+          Particle &p2 = *it->second;
+          int type1 = p1.type();
+          int type2 = p2.type();
+          const Potential &potential = getPotential(type1, type2);
+          // shared_ptr<Potential> potential = getPotential(type1, type2);
+          e   = potential._computeEnergy(p1, p2);
+          // e   = potential->_computeEnergy(p1, p2);
+          es += e;
+          LOG4ESPP_TRACE(_Potential::theLogger, "id1=" << p1.id() << " id2=" << p2.id() << " potential energy=" << e);
+        }
+#endif
       }
 
       // reduce over all CPUs
@@ -161,6 +520,32 @@ namespace espressopp {
       return esum;
     }
 
+    template < typename _Potential > inline real
+    VerletListInteractionTemplate < _Potential >::
+    computeEnergyCompact() {
+      NeighborList &nl = verletList->getNeighborList();
+      const long n = nl.numParticles();
+      real es = 0.0;
+      int maxType = -1;
+      for (long i = 0; i < n; ++i) {
+        maxType = std::max(maxType, int(nl.particles[i]->type()));
+      }
+      enlargePotentials(maxType);
+#ifdef _OPENMP
+      const int nThreads = getNumThreads();
+      #pragma omp parallel for num_threads(nThreads) schedule(dynamic, 64) reduction(+:es) if(nThreads > 1)
+#endif
+      for (long i = 0; i < n; ++i) {
+        const Particle &p1 = *nl.particles[i];
+        int type1 = p1.type();
+        for (int k = nl.start[i]; k < nl.start[i+1]; ++k) {
+          const Particle &p2 = *nl.particles[nl.neighbors[k]];
+          es += potentialArray(type1, p2.type())._computeEnergy(p1, p2);
+        }
+      }
+      return es;
+    }
+
     template < typename _Potential > inline real
     VerletListInteractionTemplate < _Potential >::
     computeEnergyDeriv() {
@@ -195,7 +580,7 @@ namespace espressopp {
       LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and sum up virial");
       
       real w = 0.0;
-      for (PairList::Iterator it(verletList->getPairs());                
+      for (VerletList::PairIterator it(*verletList);
            it.isValid(); ++it) {                                         
         Particle &p1 = *it->first;                                       
         Particle &p2 = *it->second;                                      
@@ -224,7 +609,7 @@ namespace espressopp {
       LOG4ESPP_DEBUG(_Potential::theLogger, "loop over verlet list pairs and sum up virial tensor");
 
       Tensor wlocal(0.0);
-      for (PairList::Iterator it(verletList->getPairs());
+      for (VerletList::PairIterator it(*verletList);
            it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
@@ -271,7 +656,7 @@ namespace espressopp {
       }
       
       Tensor wlocal(0.0);
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         Real3D p1pos = p1.position();
@@ -316,7 +701,7 @@ namespace espressopp {
       real z_dist = Li[2] / float(n);  // distance between two layers
       Tensor *wlocal = new Tensor[n];
       for(int i=0; i<n; i++) wlocal[i] = Tensor(0.0);
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         int type1 = p1.type();
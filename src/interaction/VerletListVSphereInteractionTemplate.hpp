@@ -114,7 +114,7 @@ namespace espressopp {
     addForces() {
       LOG4ESPP_INFO(theLogger, "add forces computed by the Verlet List");
 
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         int type1 = p1.type();
@@ -141,7 +141,7 @@ namespace espressopp {
 
       real e = 0.0;
       real es = 0.0;
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         int type1 = p1.type();
@@ -194,7 +194,7 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "compute the virial for the Verlet List");
       
       real w = 0.0;
-      for (PairList::Iterator it(verletList->getPairs());                
+      for (VerletList::PairIterator it(*verletList);
            it.isValid(); ++it) {                                         
         Particle &p1 = *it->first;                                       
         Particle &p2 = *it->second;                                      
@@ -225,7 +225,7 @@ namespace espressopp {
       LOG4ESPP_INFO(theLogger, "compute the virial tensor for the Verlet List");
 
       Tensor wlocal(0.0);
-      for (PairList::Iterator it(verletList->getPairs());
+      for (VerletList::PairIterator it(*verletList);
            it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
@@ -274,7 +274,7 @@ namespace espressopp {
       }
       
       Tensor wlocal(0.0);
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         Real3D p1pos = p1.position();
@@ -321,7 +321,7 @@ namespace espressopp {
       real z_dist = Li[2] / float(n);  // distance between two layers
       Tensor *wlocal = new Tensor[n];
       for(int i=0; i<n; i++) wlocal[i] = Tensor(0.0);
-      for (PairList::Iterator it(verletList->getPairs()); it.isValid(); ++it) {
+      for (VerletList::PairIterator it(*verletList); it.isValid(); ++it) {
         Particle &p1 = *it->first;
         Particle &p2 = *it->second;
         int type1 = p1.type();
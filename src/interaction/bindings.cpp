@@ -84,6 +84,7 @@
 #include "TersoffTripleTerm.hpp"
 
 #include "CoulombKSpaceP3M.hpp"
+#include "CoulombKSpaceSPME.hpp"
 #include "Potential.hpp"
 #include "PotentialVSpherePair.hpp"
 #include "SingleParticlePotential.hpp"
@@ -165,6 +166,7 @@ namespace espressopp {
       TersoffTripleTerm::registerPython();
       
       CoulombKSpaceP3M::registerPython();
+      CoulombKSpaceSPME::registerPython();
 
       MultiTabulated::registerPython();
       MultiMixedTabulated::registerPython();
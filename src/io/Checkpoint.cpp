@@ -0,0 +1,378 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Checkpoint.hpp"
+#include "storage/DomainDecomposition.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "esutil/RNG.hpp"
+#include "bc/BC.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    LOG4ESPP_LOGGER(Checkpoint::theLogger, "Checkpoint");
+
+    namespace {
+      const char MAGIC[8] = { 'E', 'S', 'P', 'P', 'C', 'K', 'P', 'T' };
+      const int VERSION = 2;
+
+      std::string nodeFile(const std::string& filename, longint generation, int rank) {
+        std::ostringstream name;
+        name << filename << "." << generation << "." << rank;
+        return name.str();
+      }
+
+      void writeIds(std::ofstream& out, const std::vector< longint >& ids) {
+        longint n = ids.size();
+        out.write(reinterpret_cast< const char* >(&n), sizeof(longint));
+        if (n > 0) out.write(reinterpret_cast< const char* >(&ids[0]), n * sizeof(longint));
+      }
+
+      void readIds(std::ifstream& in, std::vector< longint >& ids) {
+        longint n = 0;
+        in.read(reinterpret_cast< char* >(&n), sizeof(longint));
+        if (!in || n < 0) {
+          in.setstate(std::ios::failbit);
+          return;
+        }
+        size_t old = ids.size();
+        ids.resize(old + n);
+        if (n > 0) in.read(reinterpret_cast< char* >(&ids[old]), n * sizeof(longint));
+      }
+    }
+
+    Checkpoint::Checkpoint(shared_ptr< System > system,
+                           shared_ptr< integrator::MDIntegrator > _integrator)
+    : SystemAccess(system), integrator(_integrator) {}
+
+    void Checkpoint::addPairs(shared_ptr< FixedPairList > fpl) {
+      pairLists.push_back(fpl);
+    }
+
+    void Checkpoint::addTriples(shared_ptr< FixedTripleList > ftl) {
+      tripleLists.push_back(ftl);
+    }
+
+    void Checkpoint::addQuadruples(shared_ptr< FixedQuadrupleList > fql) {
+      quadrupleLists.push_back(fql);
+    }
+
+    void Checkpoint::addExclusions(shared_ptr< VerletList > vl) {
+      verletLists.push_back(vl);
+    }
+
+    Checkpoint::Header Checkpoint::makeHeader(int rank, longint generation, longint nParticles) {
+      System& system = getSystemRef();
+      Header h;
+      memset(&h, 0, sizeof(Header));
+      memcpy(h.magic, MAGIC, sizeof(h.magic));
+      h.version = VERSION;
+      h.particleSize = sizeof(Particle);
+      h.nprocs = system.comm->size();
+      h.rank = rank;
+      h.step = integrator ? integrator->getStep() : 0;
+      h.generation = generation;
+      Real3D L = system.bc->getBoxL();
+      for (int d = 0; d < 3; d++) h.boxL[d] = L[d];
+      h.nParticles = nParticles;
+      h.nLists[0] = pairLists.size();
+      h.nLists[1] = tripleLists.size();
+      h.nLists[2] = quadrupleLists.size();
+      h.nLists[3] = verletLists.size();
+      return h;
+    }
+
+    bool Checkpoint::checkHeader(const Header& h, const Header& expected,
+                                 const std::string& name, esutil::Error& err) {
+      std::string msg;
+      if (memcmp(h.magic, expected.magic, sizeof(h.magic)) != 0) {
+        msg = "is not a checkpoint";
+      } else if (h.version != expected.version || h.particleSize != expected.particleSize) {
+        msg = "was written by a different build of ESPResSo++";
+      } else if (h.nprocs != expected.nprocs || h.rank != expected.rank || h.step != expected.step ||
+                 h.generation != expected.generation) {
+        msg = "belongs to a different checkpoint";
+      } else if (memcmp(h.nLists, expected.nLists, sizeof(h.nLists)) != 0) {
+        msg = "was written with other fixed lists or Verlet lists than registered";
+      } else {
+        for (int d = 0; d < 3; d++) {
+          if (fabs(h.boxL[d] - expected.boxL[d]) > 1e-10 * expected.boxL[d]) msg = "has a different box";
+        }
+      }
+      if (msg.empty()) return true;
+      err.setException("Checkpoint: " + name + " " + msg);
+      return false;
+    }
+
+    void Checkpoint::write(std::string filename) {
+      System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      esutil::Error err(system.comm);
+      int rank = comm.rank();
+      int nprocs = comm.size();
+
+      // the files of the previous checkpoint stay untouched until the
+      // metadata points to the new ones
+      longint previous[2] = { 0, 0 };  // generation, nprocs
+      if (rank == 0) {
+        std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+        Header h;
+        in.read(reinterpret_cast< char* >(&h), sizeof(Header));
+        if (in && memcmp(h.magic, MAGIC, sizeof(h.magic)) == 0 && h.version == VERSION) {
+          previous[0] = h.generation;
+          previous[1] = h.nprocs;
+        }
+      }
+      mpi::broadcast(comm, previous, 2, 0);
+      longint generation = previous[0] + 1;
+
+      ParticleList particles;
+      CellList realCells = system.storage->getRealCells();
+      for (iterator::CellListIterator it(realCells); !it.isDone(); ++it) {
+        particles.push_back(*it);
+      }
+
+      std::string name = nodeFile(filename, generation, rank);
+      {
+        std::ofstream out(name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        Header h = makeHeader(rank, generation, particles.size());
+        out.write(reinterpret_cast< const char* >(&h), sizeof(Header));
+        std::string state = system.rng ? system.rng->getState() : std::string();
+        longint len = state.size();
+        out.write(reinterpret_cast< const char* >(&len), sizeof(longint));
+        out.write(state.data(), len);
+        if (!particles.empty()) {
+          out.write(reinterpret_cast< const char* >(&particles[0]), particles.size() * sizeof(Particle));
+        }
+        for (size_t l = 0; l < pairLists.size(); l++) writeIds(out, pairLists[l]->getPairList());
+        for (size_t l = 0; l < tripleLists.size(); l++) writeIds(out, tripleLists[l]->getTripleList());
+        for (size_t l = 0; l < quadrupleLists.size(); l++) writeIds(out, quadrupleLists[l]->getQuadrupleList());
+        out.close();
+        if (!out) err.setException("Checkpoint: cannot write " + name);
+      }
+      err.checkException();
+
+      longint nLocal = particles.size();
+      longint nTotal = 0;
+      mpi::reduce(comm, nLocal, nTotal, std::plus< longint >(), 0);
+
+      // all node files are complete, now switch the metadata with a
+      // rename, so that filename names either the old or the new set;
+      // the exclusions are the same on all nodes
+      if (rank == 0) {
+        std::string metaTmp = filename + ".tmp";
+        std::ofstream out(metaTmp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        Header h = makeHeader(-1, generation, nTotal);
+        out.write(reinterpret_cast< const char* >(&h), sizeof(Header));
+        for (size_t l = 0; l < verletLists.size(); l++) writeIds(out, verletLists[l]->getExcludeList());
+        out.close();
+        if (!out) {
+          err.setException("Checkpoint: cannot write " + metaTmp);
+        } else if (std::rename(metaTmp.c_str(), filename.c_str()) != 0) {
+          err.setException("Checkpoint: cannot rename " + metaTmp);
+        }
+      }
+      err.checkException();
+
+      // only then remove the previous set, which may come from another
+      // number of nodes
+      for (longint f = rank; f < previous[1]; f += nprocs) {
+        std::remove(nodeFile(filename, previous[0], f).c_str());
+      }
+
+      LOG4ESPP_INFO(theLogger, "wrote " << nLocal << " particles to " << name);
+    }
+
+    bool Checkpoint::readFile(const std::string& name, const Header& meta, int rank,
+                              ParticleList& particles, std::vector< std::vector< longint > >& tuples,
+                              esutil::Error& err) {
+      System& system = getSystemRef();
+      std::ifstream in(name.c_str(), std::ios::in | std::ios::binary);
+      Header h;
+      in.read(reinterpret_cast< char* >(&h), sizeof(Header));
+      if (!in) {
+        err.setException("Checkpoint: cannot read " + name);
+        return false;
+      }
+      Header expected = meta;
+      expected.rank = rank;
+      if (!checkHeader(h, expected, name, err)) return false;
+
+      longint len = 0;
+      in.read(reinterpret_cast< char* >(&len), sizeof(longint));
+      std::string state;
+      if (in && len >= 0 && h.nParticles >= 0) {
+        state.resize(len);
+        in.read(&state[0], len);
+        size_t old = particles.size();
+        particles.resize(old + h.nParticles);
+        if (h.nParticles > 0) {
+          in.read(reinterpret_cast< char* >(&particles[old]), h.nParticles * sizeof(Particle));
+        }
+        for (size_t l = 0; l < tuples.size(); l++) readIds(in, tuples[l]);
+      }
+      if (!in || len < 0 || h.nParticles < 0) {
+        err.setException("Checkpoint: " + name + " is truncated");
+        return false;
+      }
+
+      // the random numbers continue only on the node that wrote them
+      if (rank == system.comm->rank() && len > 0 && system.rng) {
+        system.rng->setState(state);
+      }
+      return true;
+    }
+
+    longint Checkpoint::addTuples(std::vector< longint >& t, size_t list) {
+      storage::Storage& storage = *getSystemRef().storage;
+      size_t nPairs = pairLists.size();
+      size_t nTriples = tripleLists.size();
+      longint n = 0;
+      // the key is the particle the lists store the tuple with
+      if (list < nPairs) {
+        storage.routeTuples(t, 2, 0);
+        for (size_t i = 0; i < t.size(); i += 2) {
+          if (pairLists[list]->iadd(t[i], t[i+1])) n++;
+        }
+      } else if (list < nPairs + nTriples) {
+        storage.routeTuples(t, 3, 1);
+        for (size_t i = 0; i < t.size(); i += 3) {
+          if (tripleLists[list - nPairs]->iadd(t[i], t[i+1], t[i+2])) n++;
+        }
+      } else {
+        storage.routeTuples(t, 4, 1);
+        for (size_t i = 0; i < t.size(); i += 4) {
+          if (quadrupleLists[list - nPairs - nTriples]->iadd(t[i], t[i+1], t[i+2], t[i+3])) n++;
+        }
+      }
+      return n;
+    }
+
+    longint Checkpoint::read(std::string filename) {
+      System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      esutil::Error err(system.comm);
+      int rank = comm.rank();
+      int nprocs = comm.size();
+
+      storage::DomainDecomposition* dd =
+        dynamic_cast< storage::DomainDecomposition* >(system.storage.get());
+      if (!dd) {
+        err.setException("Checkpoint: read needs a DomainDecomposition storage");
+      }
+      err.checkException();
+
+      // every node reads the metadata
+      Header meta;
+      std::vector< std::vector< longint > > exclusions(verletLists.size());
+      {
+        std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+        in.read(reinterpret_cast< char* >(&meta), sizeof(Header));
+        if (!in) {
+          err.setException("Checkpoint: cannot read " + filename);
+        } else {
+          Header expected = makeHeader(-1, meta.generation, meta.nParticles);
+          expected.nprocs = meta.nprocs;
+          expected.step = meta.step;
+          if (checkHeader(meta, expected, filename, err)) {
+            for (size_t l = 0; l < exclusions.size(); l++) readIds(in, exclusions[l]);
+            if (!in) err.setException("Checkpoint: " + filename + " is truncated");
+          }
+        }
+      }
+      err.checkException();
+
+      ParticleList particles;
+      size_t nLists = pairLists.size() + tripleLists.size() + quadrupleLists.size();
+      std::vector< std::vector< longint > > tuples(nLists);
+      for (int f = rank; f < meta.nprocs; f += nprocs) {
+        if (!readFile(nodeFile(filename, meta.generation, f), meta, f, particles, tuples, err)) break;
+      }
+      err.checkException();
+      if (meta.nprocs != nprocs && rank == 0) {
+        LOG4ESPP_WARN(theLogger, "checkpoint of " << meta.nprocs << " nodes read on " << nprocs
+                      << " nodes, the random numbers are only continued on the common nodes");
+      }
+
+      // the Verlet lists are rebuilt in decompose(), with the exclusions
+      for (size_t l = 0; l < verletLists.size(); l++) {
+        const std::vector< longint >& ex = exclusions[l];
+        for (size_t i = 0; i < ex.size(); i += 2) verletLists[l]->exclude(ex[i], ex[i+1]);
+      }
+
+      longint counts[2] = { (longint) particles.size(), dd->distributeParticles(particles) };
+      longint total[2];
+      boost::mpi::all_reduce(comm, counts, 2, total, std::plus< longint >());
+      if (total[0] != meta.nParticles || total[1] != total[0]) {
+        std::stringstream msg;
+        msg << "Checkpoint: restored " << total[1] << " of " << meta.nParticles
+            << " particles, the system has to be empty";
+        err.setException(msg.str());
+      }
+      err.checkException();
+
+      // the tuples need the ghosts
+      system.storage->decompose();
+      std::vector< longint > tupleCounts(2 * nLists), tupleTotals(2 * nLists);
+      for (size_t l = 0; l < nLists; l++) {
+        tupleCounts[2*l] = tuples[l].size();
+        tupleCounts[2*l+1] = addTuples(tuples[l], l);
+      }
+      if (nLists > 0) {
+        boost::mpi::all_reduce(comm, &tupleCounts[0], 2 * nLists, &tupleTotals[0], std::plus< longint >());
+      }
+      for (size_t l = 0; l < nLists; l++) {
+        int width = (l < pairLists.size()) ? 2 : (l < pairLists.size() + tripleLists.size()) ? 3 : 4;
+        if (tupleTotals[2*l+1] * width != tupleTotals[2*l]) {
+          std::stringstream msg;
+          msg << "Checkpoint: restored " << tupleTotals[2*l+1] << " of " << tupleTotals[2*l] / width
+              << " tuples of list " << l;
+          err.setException(msg.str());
+        }
+      }
+      err.checkException();
+
+      if (integrator) integrator->setStep(meta.step);
+      return total[1];
+    }
+
+    // Python wrapping
+    void Checkpoint::registerPython() {
+      using namespace espressopp::python;
+
+      class_< Checkpoint, boost::noncopyable >
+        ("io_Checkpoint", init< shared_ptr< System >, shared_ptr< integrator::MDIntegrator > >())
+        .def("addPairs", &Checkpoint::addPairs)
+        .def("addTriples", &Checkpoint::addTriples)
+        .def("addQuadruples", &Checkpoint::addQuadruples)
+        .def("addExclusions", &Checkpoint::addExclusions)
+        .def("write", &Checkpoint::write)
+        .def("read", &Checkpoint::read)
+        ;
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _IO_CHECKPOINT_HPP
+#define _IO_CHECKPOINT_HPP
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+#include "SystemAccess.hpp"
+#include "esutil/Error.hpp"
+#include "integrator/MDIntegrator.hpp"
+#include "FixedPairList.hpp"
+#include "FixedTripleList.hpp"
+#include "FixedQuadrupleList.hpp"
+#include "VerletList.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    /** Parallel checkpoint of the simulation state.
+
+        write(filename) is collective. Every node writes the real particles
+        of its domain as they are stored, the tuples of the registered
+        fixed lists that it owns and the state of its random number
+        generator to filename.<generation>.<rank>, where the generation
+        counts the writes. Node 0 then writes the metadata (generation,
+        number of nodes, step, box, list sizes and the exclusions of the
+        registered Verlet lists) to a temporary file and renames it to
+        filename, which switches to the new set of node files at once.
+        The files of the previous generation are removed afterwards, so
+        an interrupted write leaves the previous checkpoint intact.
+
+        read(filename) restores the state into a system with the same box,
+        the same lists and no particles. The number of nodes may differ:
+        node r reads the files r, r + nprocs, ... and the particles and
+        tuples are sent to their new owners, as in ReadNumpy. The random
+        number generators are only continued where the node had a file
+        of the same rank. The particles are stored in binary, so the files
+        can only be read by the same build.
+    */
+    class Checkpoint : public SystemAccess {
+    public:
+      Checkpoint(shared_ptr< System > system,
+                 shared_ptr< integrator::MDIntegrator > _integrator);
+      ~Checkpoint() {}
+
+      /** register a list whose tuples are saved and restored */
+      void addPairs(shared_ptr< FixedPairList > fpl);
+      void addTriples(shared_ptr< FixedTripleList > ftl);
+      void addQuadruples(shared_ptr< FixedQuadrupleList > fql);
+      /** register a Verlet list whose exclusions are saved and restored */
+      void addExclusions(shared_ptr< VerletList > vl);
+
+      void write(std::string filename);
+
+      /** returns the number of particles restored */
+      longint read(std::string filename);
+
+      static void registerPython();
+
+    private:
+      struct Header {
+        char magic[8];
+        int version;
+        int particleSize;
+        int nprocs;
+        int rank;           // -1 for the metadata
+        longint step;
+        longint generation; // counts the writes to the same filename
+        real boxL[3];
+        longint nParticles; // local in a node file, total in the metadata
+        int nLists[4];      // pairs, triples, quadruples, exclusions
+      };
+
+      Header makeHeader(int rank, longint generation, longint nParticles);
+      bool checkHeader(const Header& h, const Header& expected,
+                       const std::string& name, esutil::Error& err);
+      bool readFile(const std::string& name, const Header& meta, int rank,
+                    ParticleList& particles, std::vector< std::vector< longint > >& tuples,
+                    esutil::Error& err);
+      longint addTuples(std::vector< longint >& t, size_t list);
+
+      shared_ptr< integrator::MDIntegrator > integrator;
+
+      std::vector< shared_ptr< FixedPairList > > pairLists;
+      std::vector< shared_ptr< FixedTripleList > > tripleLists;
+      std::vector< shared_ptr< FixedQuadrupleList > > quadrupleLists;
+      std::vector< shared_ptr< VerletList > > verletLists;
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
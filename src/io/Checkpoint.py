@@ -0,0 +1,125 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+**************************
+espressopp.io.Checkpoint
+**************************
+
+Parallel checkpoint and restart of a simulation.
+
+write() saves the particles with all their properties, the tuples of the
+registered fixed lists, the exclusions of the registered Verlet lists,
+the state of the random number generators and the integrator step. Every
+node writes its own domain to filename.<generation>.<rank>, node 0 then
+writes the metadata to filename. The metadata is replaced by a rename
+once all node files are complete, and only then the files of the previous
+generation are removed. An interrupted write leaves the previous
+checkpoint readable.
+
+read() restores a checkpoint into a system that has been set up in the
+same way (box, storage, interactions, the same lists registered in the
+same order), but without particles. The number of nodes may differ from
+the run that wrote the checkpoint; the random numbers are then only
+continued on the nodes that exist in both runs. The files are binary and
+can only be read by the same build of ESPResSo++.
+
+Other state, e.g. of the integrator extensions, is set up by the script as
+before; the thermostats continue with the restored random numbers.
+
+Example:
+
+>>> checkpoint = espressopp.io.Checkpoint(system, integrator)
+>>> checkpoint.add(fpl)
+>>> checkpoint.add(vl)
+>>> for i in range(100):
+>>>   integrator.run(1000)
+>>>   checkpoint.write('state.chk')
+
+and on restart, after setting up system, fpl, vl and integrator:
+
+>>> checkpoint = espressopp.io.Checkpoint(system, integrator)
+>>> checkpoint.add(fpl)
+>>> checkpoint.add(vl)
+>>> checkpoint.read('state.chk')
+
+.. function:: espressopp.io.Checkpoint(system, integrator=None)
+
+		:param system: system object
+		:param integrator: integrator whose step is saved
+		:type system: shared_ptr<System>
+		:type integrator: shared_ptr<MDIntegrator>
+
+.. function:: espressopp.io.Checkpoint.add(fixedlist)
+
+		Registers a FixedPairList, FixedTripleList or FixedQuadrupleList,
+		whose tuples are saved, or a VerletList, whose exclusions are saved.
+
+.. function:: espressopp.io.Checkpoint.write(filename)
+
+		:param filename: name of the metadata file
+		:type filename: str
+
+.. function:: espressopp.io.Checkpoint.read(filename)
+
+		:param filename: name of the metadata file
+		:type filename: str
+		:return: number of particles restored
+"""
+
+import _espressopp
+from espressopp.esutil import cxxinit
+from espressopp import pmi
+
+from _espressopp import io_Checkpoint
+
+class CheckpointLocal(io_Checkpoint):
+
+    def __init__(self, system, integrator=None):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            cxxinit(self, io_Checkpoint, system, integrator)
+
+    def add(self, fixedlist):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            if isinstance(fixedlist, _espressopp.FixedPairList):
+                self.cxxclass.addPairs(self, fixedlist)
+            elif isinstance(fixedlist, _espressopp.FixedTripleList):
+                self.cxxclass.addTriples(self, fixedlist)
+            elif isinstance(fixedlist, _espressopp.FixedQuadrupleList):
+                self.cxxclass.addQuadruples(self, fixedlist)
+            elif isinstance(fixedlist, _espressopp.VerletList):
+                self.cxxclass.addExclusions(self, fixedlist)
+            else:
+                raise TypeError('expected a fixed pair, triple or quadruple list or a Verlet list')
+
+    def write(self, filename):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.write(self, filename)
+
+    def read(self, filename):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.read(self, filename)
+
+if pmi.isController:
+    class Checkpoint(object):
+        __metaclass__ = pmi.Proxy
+        pmiproxydefs = dict(
+            cls = 'espressopp.io.CheckpointLocal',
+            pmicall = [ 'add', 'write', 'read' ]
+            )
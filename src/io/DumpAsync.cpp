@@ -0,0 +1,226 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <cstring>
+#include <sstream>
+
+#include "DumpAsync.hpp"
+#include "io/FileBackup.hpp"
+#include "storage/Storage.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "bc/BC.hpp"
+#include "esutil/Error.hpp"
+#include "esutil/Timer.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    LOG4ESPP_LOGGER(DumpAsync::theLogger, "DumpAsync");
+
+    namespace {
+      const int VERSION = 1;
+
+      template< class T >
+      char* copyVectors(char* dst, const std::vector< Real3D >& src) {
+        T* d = reinterpret_cast< T* >(dst);
+        for (size_t i = 0; i < src.size(); i++) {
+          for (int k = 0; k < 3; k++) d[3*i+k] = src[i][k];
+        }
+        return reinterpret_cast< char* >(d + 3 * src.size());
+      }
+    }
+
+    DumpAsync::DumpAsync(shared_ptr< System > system,
+                         shared_ptr< integrator::MDIntegrator > _integrator,
+                         std::string _file_name,
+                         bool _unfolded,
+                         bool _store_velocities,
+                         bool _single_precision,
+                         bool _append)
+    : ParticleAccess(system), integrator(_integrator), file_name(_file_name),
+      unfolded(_unfolded), store_velocities(_store_velocities),
+      single_precision(_single_precision), append(_append),
+      hasPending(false), stopWriter(false), stallTime(0.0) {}
+
+    DumpAsync::~DumpAsync() {
+      stop();
+    }
+
+    void DumpAsync::start() {
+      std::stringstream name;
+      name << file_name << "." << getSystem()->comm->rank();
+      // the first frame replaces an old trajectory unless appending,
+      // later ones (after close) are appended
+      std::ios::openmode mode = std::ios::out | std::ios::binary;
+      if (append) {
+        mode |= std::ios::app;
+      } else {
+        FileBackup backup(name.str());
+        mode |= std::ios::trunc;
+        append = true;
+      }
+      out.open(name.str().c_str(), mode);
+      if (!out) error = "DumpAsync: cannot open " + name.str();
+
+      stopWriter = false;
+      writer = std::thread(&DumpAsync::writeFrames, this);
+    }
+
+    void DumpAsync::stop() {
+      if (!writer.joinable()) return;
+      {
+        std::lock_guard< std::mutex > lock(mutex);
+        stopWriter = true;
+      }
+      cond.notify_all();
+      writer.join();
+      out.close();
+    }
+
+    void DumpAsync::writeFrames() {
+      std::unique_lock< std::mutex > lock(mutex);
+      while (true) {
+        cond.wait(lock, [this] { return hasPending || stopWriter; });
+        // the pending frame is still written when stopping
+        if (!hasPending) break;
+        lock.unlock();
+        if (out) {
+          out.write(&pending[0], pending.size());
+          out.flush();
+        }
+        bool failed = !out;
+        lock.lock();
+        if (failed && error.empty()) error = "DumpAsync: cannot write to " + file_name;
+        hasPending = false;
+        cond.notify_all();
+      }
+    }
+
+    void DumpAsync::dump() {
+      System& system = getSystemRef();
+      if (!writer.joinable()) start();
+
+      CellList realCells = system.storage->getRealCells();
+      longint n = system.storage->getNRealParticles();
+
+      FrameHeader h;
+      memset(&h, 0, sizeof(FrameHeader));
+      memcpy(h.magic, "ESPT", sizeof(h.magic));
+      h.version = VERSION;
+      h.nprocs = system.comm->size();
+      h.rank = system.comm->rank();
+      h.step = integrator->getStep();
+      h.time = h.step * integrator->getTimeStep();
+      Real3D L = system.bc->getBoxL();
+      for (int d = 0; d < 3; d++) h.boxL[d] = L[d];
+      h.nParticles = n;
+      h.flags = (store_velocities ? FLAG_VELOCITIES : 0) | (unfolded ? FLAG_UNFOLDED : 0)
+        | (single_precision ? FLAG_SINGLE : 0);
+
+      std::vector< int64_t > ids;
+      std::vector< int > types;
+      std::vector< Real3D > pos, vel;
+      ids.reserve(n);
+      types.reserve(n);
+      pos.reserve(n);
+      if (store_velocities) vel.reserve(n);
+      for (iterator::CellListIterator it(realCells); !it.isDone(); ++it) {
+        ids.push_back(it->id());
+        types.push_back(it->type());
+        pos.push_back(unfolded ? system.bc->getUnfoldedPosition(it->position(), it->image())
+                      : it->position());
+        if (store_velocities) vel.push_back(it->velocity());
+      }
+
+      size_t realSize = single_precision ? sizeof(float) : sizeof(real);
+      staging.resize(sizeof(FrameHeader) + n * (sizeof(int64_t) + sizeof(int))
+                     + (store_velocities ? 2 : 1) * 3 * n * realSize);
+      char* buf = &staging[0];
+      memcpy(buf, &h, sizeof(FrameHeader));
+      buf += sizeof(FrameHeader);
+      if (n > 0) memcpy(buf, &ids[0], n * sizeof(int64_t));
+      buf += n * sizeof(int64_t);
+      buf = single_precision ? copyVectors< float >(buf, pos) : copyVectors< real >(buf, pos);
+      if (store_velocities) {
+        buf = single_precision ? copyVectors< float >(buf, vel) : copyVectors< real >(buf, vel);
+      }
+      if (n > 0) memcpy(buf, &types[0], n * sizeof(int));
+
+      // hand the frame over, waiting only while the previous one is written
+      {
+        std::unique_lock< std::mutex > lock(mutex);
+        if (hasPending) {
+          esutil::WallTimer timer;
+          timer.reset();
+          cond.wait(lock, [this] { return !hasPending; });
+          stallTime += timer.getElapsedTime();
+        }
+        staging.swap(pending);
+        hasPending = true;
+      }
+      cond.notify_all();
+    }
+
+    void DumpAsync::checkError() {
+      esutil::Error err(getSystem()->comm);
+      {
+        std::lock_guard< std::mutex > lock(mutex);
+        if (!error.empty()) {
+          err.setException(error);
+          error.clear();
+        }
+      }
+      err.checkException();
+    }
+
+    void DumpAsync::flush() {
+      {
+        std::unique_lock< std::mutex > lock(mutex);
+        cond.wait(lock, [this] { return !hasPending; });
+      }
+      checkError();
+    }
+
+    void DumpAsync::close() {
+      stop();
+      checkError();
+    }
+
+    // Python wrapping
+    void DumpAsync::registerPython() {
+      using namespace espressopp::python;
+
+      class_< DumpAsync, bases< ParticleAccess >, boost::noncopyable >
+        ("io_DumpAsync", init< shared_ptr< System >, shared_ptr< integrator::MDIntegrator >,
+                               std::string, bool, bool, bool, bool >())
+        .add_property("filename", &DumpAsync::getFilename)
+        .add_property("unfolded", &DumpAsync::getUnfolded, &DumpAsync::setUnfolded)
+        .add_property("store_velocities", &DumpAsync::getStoreVelocities, &DumpAsync::setStoreVelocities)
+        .add_property("single_precision", &DumpAsync::getSinglePrecision, &DumpAsync::setSinglePrecision)
+        .add_property("append", &DumpAsync::getAppend)
+        .add_property("stall_time", &DumpAsync::getStallTime)
+        .def("dump", &DumpAsync::dump)
+        .def("flush", &DumpAsync::flush)
+        .def("close", &DumpAsync::close)
+        ;
+    }
+  }
+}
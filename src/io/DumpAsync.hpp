@@ -0,0 +1,137 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _IO_DUMPASYNC_HPP
+#define _IO_DUMPASYNC_HPP
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+#include "System.hpp"
+#include "ParticleAccess.hpp"
+#include "integrator/MDIntegrator.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    /** Trajectory writer that does the file I/O in a background thread.
+
+        dump() copies the ids, positions, optionally the velocities, and
+        the types of the real particles of this node into a staging buffer,
+        hands it to the writer thread and returns. The thread appends the
+        frame to the file of the node, file_name.<rank>, while the
+        integration continues. There are two buffers, so dump() only waits
+        if the previous frame of this node is still being written, and no
+        communication is needed at all: the frames of the nodes are only
+        merged when the trajectory is read (see read_dump_async in
+        DumpAsync.py).
+
+        A frame is a FrameHeader followed by n ids (int64_t), n positions
+        and n velocities (3 floats or 3 reals each) and n types (int).
+
+        Write errors of the thread are reported by flush() and close(),
+        which wait for the pending frame and are collective.
+    */
+    class DumpAsync : public ParticleAccess {
+    public:
+      DumpAsync(shared_ptr< System > system,
+                shared_ptr< integrator::MDIntegrator > _integrator,
+                std::string _file_name,
+                bool _unfolded,
+                bool _store_velocities,
+                bool _single_precision,
+                bool _append);
+      ~DumpAsync();
+
+      void perform_action() { dump(); }
+
+      void dump();
+
+      /** wait until all frames are written */
+      void flush();
+
+      /** flush and stop the writer thread, the next dump() appends */
+      void close();
+
+      std::string getFilename() { return file_name; }
+      bool getUnfolded() { return unfolded; }
+      void setUnfolded(bool v) { unfolded = v; }
+      bool getStoreVelocities() { return store_velocities; }
+      void setStoreVelocities(bool v) { store_velocities = v; }
+      bool getSinglePrecision() { return single_precision; }
+      void setSinglePrecision(bool v) { single_precision = v; }
+      bool getAppend() { return append; }
+      /** wall time dump() waited for the writer thread */
+      real getStallTime() { return stallTime; }
+
+      static void registerPython();
+
+      struct FrameHeader {
+        char magic[4];      // "ESPT"
+        int version;
+        int nprocs;
+        int rank;
+        int64_t step;
+        real time;
+        real boxL[3];
+        int64_t nParticles;
+        int flags;          // FLAG_*
+        int reserved;
+      };
+
+      enum { FLAG_VELOCITIES = 1, FLAG_UNFOLDED = 2, FLAG_SINGLE = 4 };
+
+    private:
+      void start();
+      void stop();
+      void writeFrames();
+      void checkError();
+
+      shared_ptr< integrator::MDIntegrator > integrator;
+      std::string file_name;
+      bool unfolded;
+      bool store_velocities;
+      bool single_precision;
+      bool append;
+
+      std::ofstream out;            // only used by the writer thread while it runs
+      std::thread writer;
+      std::mutex mutex;
+      std::condition_variable cond;
+      std::vector< char > staging;  // filled by dump()
+      std::vector< char > pending;  // owned by the writer while hasPending
+      bool hasPending;
+      bool stopWriter;
+      std::string error;
+      real stallTime;
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,146 @@
+#  Copyright (C) 2017
+#      Max Planck Institute for Polymer Research
+#
+#  This file is part of ESPResSo++.
+#
+#  ESPResSo++ is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  ESPResSo++ is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+r"""
+*************************
+espressopp.io.DumpAsync
+*************************
+
+Trajectory writer that does not stall the integration. dump() copies the
+particles of every node into a staging buffer and returns; a background
+thread of each node writes the frame to filename.<rank>. The nodes do not
+communicate, the frames are only merged by :py:func:`read_dump_async`.
+dump() only waits if the previous frame of the node is not written yet;
+the accumulated waiting time is available as stall_time.
+
+Call flush() or close() before reading the files, they also report write
+errors of the background threads.
+
+Example:
+
+>>> dump = espressopp.io.DumpAsync(system, integrator, filename='traj.bin', store_velocities=True)
+>>> ext_dump = espressopp.integrator.ExtAnalyze(dump, interval=100)
+>>> integrator.addExtension(ext_dump)
+>>> integrator.run(100000)
+>>> dump.close()
+>>> for frame in espressopp.io.read_dump_async('traj.bin'):
+>>>   print frame['step'], frame['pos'][0]
+
+.. function:: espressopp.io.DumpAsync(system, integrator, filename='out.bin', unfolded=False, store_velocities=False, single_precision=True, append=False)
+
+		:param system: system object
+		:param integrator: integrator, for the step and time
+		:param filename: base name of the files, one per node
+		:param bool unfolded: store unfolded positions
+		:param bool store_velocities: store the velocities as well
+		:param bool single_precision: store positions and velocities as float
+		:param bool append: append to existing files, otherwise they are backed up
+
+.. function:: espressopp.io.DumpAsync.dump()
+
+.. function:: espressopp.io.DumpAsync.flush()
+
+		Waits until all frames are written.
+
+.. function:: espressopp.io.DumpAsync.close()
+
+		Waits for the frames and stops the background threads; the next
+		dump() appends.
+
+.. function:: espressopp.io.read_dump_async(filename)
+
+		Reads the files written by DumpAsync and yields one dictionary per
+		frame with step, time, box, and id, type, pos and v (if stored)
+		sorted by particle id. Needs numpy.
+"""
+
+from espressopp.esutil import cxxinit
+from espressopp import pmi
+
+from espressopp.ParticleAccess import *
+from _espressopp import io_DumpAsync
+
+class DumpAsyncLocal(ParticleAccessLocal, io_DumpAsync):
+
+    def __init__(self, system, integrator, filename='out.bin', unfolded=False, store_velocities=False, single_precision=True, append=False):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            cxxinit(self, io_DumpAsync, system, integrator, filename, unfolded, store_velocities, single_precision, append)
+
+    def dump(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.dump(self)
+
+    def flush(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.flush(self)
+
+    def close(self):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            self.cxxclass.close(self)
+
+
+def read_dump_async(filename):
+    import numpy as np
+
+    header = np.dtype([('magic', 'S4'), ('version', 'i4'), ('nprocs', 'i4'), ('rank', 'i4'),
+                       ('step', 'i8'), ('time', 'f8'), ('box', 'f8', 3), ('n', 'i8'),
+                       ('flags', 'i4'), ('reserved', 'i4')])
+
+    def frames(f):
+        while True:
+            h = np.fromfile(f, header, 1)
+            if len(h) == 0:
+                return
+            h = h[0]
+            if h['magic'] != 'ESPT':
+                raise IOError('{} is not a DumpAsync trajectory'.format(f.name))
+            n = h['n']
+            real = 'f4' if h['flags'] & 4 else 'f8'
+            frame = dict(step=h['step'], time=h['time'], box=h['box'], nprocs=h['nprocs'])
+            frame['id'] = np.fromfile(f, 'i8', n)
+            frame['pos'] = np.fromfile(f, real, 3 * n).reshape(n, 3)
+            if h['flags'] & 1:
+                frame['v'] = np.fromfile(f, real, 3 * n).reshape(n, 3)
+            frame['type'] = np.fromfile(f, 'i4', n)
+            yield frame
+
+    first = open('{}.0'.format(filename), 'rb')
+    nprocs = np.fromfile(first, header, 1)[0]['nprocs']
+    first.seek(0)
+    readers = [frames(first)] + [frames(open('{}.{}'.format(filename, r), 'rb')) for r in range(1, nprocs)]
+    while True:
+        parts = [next(r, None) for r in readers]
+        if any(p is None for p in parts):
+            return
+        frame = dict(parts[0])
+        order = np.argsort(np.concatenate([p['id'] for p in parts]), kind='mergesort')
+        for key in ['id', 'pos', 'v', 'type']:
+            if key in frame:
+                frame[key] = np.concatenate([p[key] for p in parts])[order]
+        yield frame
+
+
+if pmi.isController:
+    class DumpAsync(ParticleAccess):
+        __metaclass__ = pmi.Proxy
+        pmiproxydefs = dict(
+            cls = 'espressopp.io.DumpAsyncLocal',
+            pmicall = [ 'dump', 'flush', 'close' ],
+            pmiproperty = [ 'filename', 'unfolded', 'store_velocities', 'single_precision', 'append', 'stall_time' ]
+            )
@@ -0,0 +1,282 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "python.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "DumpCompressed.hpp"
+#include "io/FileBackup.hpp"
+#include "storage/Storage.hpp"
+#include "iterator/CellListIterator.hpp"
+#include "bc/BC.hpp"
+#include "esutil/Error.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    LOG4ESPP_LOGGER(DumpCompressed::theLogger, "DumpCompressed");
+
+    namespace {
+      const int VERSION = 2;
+
+      inline uint64_t zigzag(int64_t d) {
+        return (static_cast< uint64_t >(d) << 1) ^ static_cast< uint64_t >(d >> 63);
+      }
+
+      inline int bitWidth(uint64_t v) {
+        int w = 0;
+        while (w < 64 && (v >> w) != 0) w++;
+        return w;
+      }
+
+      void appendBytes(std::vector< unsigned char >& out, const void* data, size_t size) {
+        const unsigned char* p = static_cast< const unsigned char* >(data);
+        out.insert(out.end(), p, p + size);
+      }
+
+      // the lowest w bits of the values, most significant bit first,
+      // padded to a full byte
+      void appendBits(std::vector< unsigned char >& out, const uint64_t* values, size_t count, int w) {
+        int used = 8;
+        for (size_t i = 0; i < count; i++) {
+          int left = w;
+          while (left > 0) {
+            if (used == 8) {
+              out.push_back(0);
+              used = 0;
+            }
+            int take = std::min(left, 8 - used);
+            unsigned bits = (values[i] >> (left - take)) & ((1u << take) - 1);
+            out.back() |= bits << (8 - used - take);
+            used += take;
+            left -= take;
+          }
+        }
+      }
+    }
+
+    const int DumpCompressed::BLOCK;
+
+    DumpCompressed::DumpCompressed(shared_ptr< System > system,
+                                   shared_ptr< integrator::MDIntegrator > _integrator,
+                                   std::string _file_name,
+                                   bool _unfolded,
+                                   real _length_factor,
+                                   real _precision,
+                                   bool _append)
+    : ParticleAccess(system), integrator(_integrator), file_name(_file_name),
+      unfolded(_unfolded), length_factor(_length_factor), precision(_precision),
+      append(_append), isOpen(false), fileOffset(0) {
+      if (system->comm->rank() == 0 && !append) {
+        FileBackup backup(file_name);
+      }
+    }
+
+    DumpCompressed::~DumpCompressed() {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (isOpen && !finalized) MPI_File_close(&fh);
+    }
+
+    void DumpCompressed::pack(const std::vector< uint64_t >& values, std::vector< unsigned char >& out) {
+      std::vector< uint64_t > high;
+      std::vector< unsigned char > where;
+      for (size_t start = 0; start < values.size(); start += BLOCK) {
+        size_t count = std::min(values.size() - start, size_t(BLOCK));
+        const uint64_t* v = &values[start];
+
+        // the width b of the block is the one of the smallest encoding;
+        // the values wider than b are exceptions that store the bits
+        // above b separately, so that a few jumps, e.g. at chain ends or
+        // box boundaries, do not widen the whole block
+        int histogram[65] = { 0 };
+        int maxWidth = 0;
+        for (size_t i = 0; i < count; i++) {
+          int w = bitWidth(v[i]);
+          histogram[w]++;
+          maxWidth = std::max(maxWidth, w);
+        }
+        int b = maxWidth;
+        size_t best = (count * maxWidth + 7) / 8;
+        size_t exceptions = 0;
+        for (int w = maxWidth - 1; w >= 0; w--) {
+          exceptions += histogram[w + 1];
+          size_t size = exceptions + 1 + (exceptions * (maxWidth - w) + 7) / 8 + (count * w + 7) / 8;
+          if (size < best) {
+            best = size;
+            b = w;
+          }
+        }
+
+        high.clear();
+        where.clear();
+        for (size_t i = 0; i < count; i++) {
+          if ((v[i] >> b) != 0) {
+            where.push_back(i);
+            high.push_back(v[i] >> b);
+          }
+        }
+        out.push_back(b);
+        out.push_back(where.size());
+        if (!where.empty()) {
+          out.insert(out.end(), where.begin(), where.end());
+          out.push_back(maxWidth - b);
+          appendBits(out, &high[0], high.size(), maxWidth - b);
+        }
+        appendBits(out, v, count, b);
+      }
+    }
+
+    void DumpCompressed::open() {
+      System& system = getSystemRef();
+      esutil::Error err(system.comm);
+      MPI_Comm comm = *system.comm;
+      int rc = MPI_File_open(comm, const_cast< char* >(file_name.c_str()),
+                             MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &fh);
+      if (rc != MPI_SUCCESS) err.setException("DumpCompressed: cannot open " + file_name);
+      err.checkException();
+      isOpen = true;
+
+      // a new trajectory starts empty, later frames are appended
+      if (append) {
+        MPI_File_get_size(fh, &fileOffset);
+      } else {
+        MPI_File_set_size(fh, 0);
+        fileOffset = 0;
+        append = true;
+      }
+    }
+
+    void DumpCompressed::close() {
+      if (!isOpen) return;
+      MPI_File_close(&fh);
+      isOpen = false;
+    }
+
+    void DumpCompressed::dump() {
+      System& system = getSystemRef();
+      mpi::communicator& comm = *system.comm;
+      esutil::Error err(system.comm);
+      if (!isOpen) open();
+
+      std::vector< std::pair< int64_t, Real3D > > local;
+      local.reserve(system.storage->getNRealParticles());
+      CellList realCells = system.storage->getRealCells();
+      for (iterator::CellListIterator it(realCells); !it.isDone(); ++it) {
+        Real3D pos = unfolded ? system.bc->getUnfoldedPosition(it->position(), it->image())
+          : it->position();
+        local.push_back(std::make_pair((int64_t) it->id(), pos));
+      }
+      std::sort(local.begin(), local.end(),
+                [](const std::pair< int64_t, Real3D >& a, const std::pair< int64_t, Real3D >& b) {
+                  return a.first < b.first;
+                });
+
+      // the chunk of this node: n, then the id, x, y and z streams
+      int64_t n = local.size();
+      std::vector< unsigned char > chunk;
+      chunk.reserve(sizeof(int64_t) + 4 * (n + n / 2) + 4 * (n / BLOCK + 1));
+      appendBytes(chunk, &n, sizeof(int64_t));
+      std::vector< uint64_t > z(n);
+      int64_t prev = 0;
+      for (int64_t i = 0; i < n; i++) {
+        z[i] = zigzag(local[i].first - prev);
+        prev = local[i].first;
+      }
+      pack(z, chunk);
+      real scale = length_factor * precision;
+      for (int d = 0; d < 3; d++) {
+        prev = 0;
+        for (int64_t i = 0; i < n; i++) {
+          int64_t q = llround(local[i].second[d] * scale);
+          z[i] = zigzag(q - prev);
+          prev = q;
+        }
+        pack(z, chunk);
+      }
+
+      // the only communication: chunk sizes and particle numbers
+      int nprocs = comm.size();
+      int rank = comm.rank();
+      int64_t mine[2] = { (int64_t) chunk.size(), n };
+      std::vector< int64_t > all(2 * nprocs);
+      boost::mpi::all_gather(comm, mine, 2, &all[0]);
+      std::vector< int64_t > sizes(nprocs);
+      MPI_Offset headerSize = sizeof(FrameHeader) + nprocs * sizeof(int64_t);
+      MPI_Offset offset = fileOffset + headerSize;
+      int64_t total = 0;
+      int64_t nTotal = 0;
+      for (int r = 0; r < nprocs; r++) {
+        sizes[r] = all[2*r];
+        if (r < rank) offset += sizes[r];
+        total += sizes[r];
+        nTotal += all[2*r+1];
+      }
+
+      int rc = MPI_SUCCESS;
+      MPI_Status status;
+      if (rank == 0) {
+        FrameHeader h;
+        memset(&h, 0, sizeof(FrameHeader));
+        memcpy(h.magic, "ESPC", sizeof(h.magic));
+        h.version = VERSION;
+        h.nprocs = nprocs;
+        h.flags = unfolded ? 1 : 0;
+        h.step = integrator->getStep();
+        h.time = h.step * integrator->getTimeStep();
+        Real3D L = system.bc->getBoxL();
+        for (int d = 0; d < 3; d++) h.boxL[d] = L[d] * length_factor;
+        h.precision = precision;
+        h.nParticles = nTotal;
+        std::vector< unsigned char > header;
+        appendBytes(header, &h, sizeof(FrameHeader));
+        appendBytes(header, &sizes[0], nprocs * sizeof(int64_t));
+        rc = MPI_File_write_at(fh, fileOffset, &header[0], header.size(), MPI_BYTE, &status);
+      }
+      int rcChunk = MPI_File_write_at_all(fh, offset, chunk.empty() ? 0 : &chunk[0], chunk.size(),
+                                          MPI_BYTE, &status);
+      if (rc != MPI_SUCCESS || rcChunk != MPI_SUCCESS) {
+        err.setException("DumpCompressed: cannot write to " + file_name);
+      }
+      err.checkException();
+      fileOffset += headerSize + total;
+    }
+
+    // Python wrapping
+    void DumpCompressed::registerPython() {
+      using namespace espressopp::python;
+
+      class_< DumpCompressed, bases< ParticleAccess >, boost::noncopyable >
+        ("io_DumpCompressed", init< shared_ptr< System >, shared_ptr< integrator::MDIntegrator >,
+                                    std::string, bool, real, real, bool >())
+        .add_property("filename", &DumpCompressed::getFilename)
+        .add_property("unfolded", &DumpCompressed::getUnfolded, &DumpCompressed::setUnfolded)
+        .add_property("length_factor", &DumpCompressed::getLengthFactor, &DumpCompressed::setLengthFactor)
+        .add_property("precision", &DumpCompressed::getPrecision, &DumpCompressed::setPrecision)
+        .add_property("append", &DumpCompressed::getAppend)
+        .def("dump", &DumpCompressed::dump)
+        .def("close", &DumpCompressed::close)
+        ;
+    }
+  }
+}
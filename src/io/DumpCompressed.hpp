@@ -0,0 +1,130 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _IO_DUMPCOMPRESSED_HPP
+#define _IO_DUMPCOMPRESSED_HPP
+
+#include <mpi.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+#include "System.hpp"
+#include "ParticleAccess.hpp"
+#include "integrator/MDIntegrator.hpp"
+
+namespace espressopp {
+  namespace io {
+
+    /** Lossy compressed trajectory in the spirit of XTC, without GROMACS.
+
+        The positions are scaled by length_factor and rounded to
+        multiples of 1/precision, as in XTC. Every node sorts its real
+        particles by id and compresses its own chunk: the ids and the
+        three coordinates are each delta encoded against the previous
+        particle, zigzag mapped to unsigned integers and bit packed in
+        blocks of BLOCK values (patched frame of reference): the block
+        gets the bit width that packs it smallest, and the few values
+        that are wider, such as the jumps at chain ends and box
+        boundaries, are stored as exceptions. Consecutive particles of a
+        chain give small deltas, as in XTC.
+
+        A frame is a FrameHeader, the chunk sizes of all nodes (int64_t)
+        and the chunks in the order of the ranks. The nodes only exchange
+        their chunk sizes and write their chunks in parallel at their
+        offsets with MPI-IO. A chunk is the number of particles (int64_t)
+        followed by the id, x, y and z streams. A block of a stream is
+        one byte with the bit width b, one byte with the number of
+        exceptions e and, if e > 0, e bytes with their positions in the
+        block, one byte with the width h of their upper bits and these
+        upper bits (value >> b), h bits each; then the lowest b bits of
+        all values of the block. Bit fields are written most significant
+        bit first and padded to a full byte.
+
+        The files are read with read_dump_compressed in DumpCompressed.py.
+    */
+    class DumpCompressed : public ParticleAccess {
+    public:
+      DumpCompressed(shared_ptr< System > system,
+                     shared_ptr< integrator::MDIntegrator > _integrator,
+                     std::string _file_name,
+                     bool _unfolded,
+                     real _length_factor,
+                     real _precision,
+                     bool _append);
+      ~DumpCompressed();
+
+      void perform_action() { dump(); }
+
+      void dump();
+
+      /** close the file, the next dump() appends. Collective. */
+      void close();
+
+      std::string getFilename() { return file_name; }
+      bool getUnfolded() { return unfolded; }
+      void setUnfolded(bool v) { unfolded = v; }
+      real getLengthFactor() { return length_factor; }
+      void setLengthFactor(real v) { length_factor = v; }
+      real getPrecision() { return precision; }
+      void setPrecision(real v) { precision = v; }
+      bool getAppend() { return append; }
+
+      static void registerPython();
+
+      struct FrameHeader {
+        char magic[4];      // "ESPC"
+        int version;
+        int nprocs;         // number of chunks
+        int flags;          // 1: unfolded
+        int64_t step;
+        real time;
+        real boxL[3];
+        real precision;
+        int64_t nParticles;
+      };
+
+      static const int BLOCK = 128;
+
+      /** bit pack unsigned values as described above */
+      static void pack(const std::vector< uint64_t >& values, std::vector< unsigned char >& out);
+
+    private:
+      void open();
+
+      shared_ptr< integrator::MDIntegrator > integrator;
+      std::string file_name;
+      bool unfolded;
+      real length_factor;
+      real precision;
+      bool append;
+
+      MPI_File fh;
+      bool isOpen;
+      MPI_Offset fileOffset;  // end of the last frame
+
+      static LOG4ESPP_DECL_LOGGER(theLogger);
+    };
+  }
+}
+
+#endif
@@ -26,6 +26,10 @@ r"""
   write configuration to trajectory file in XTC format (Gromacs/Gromos compressed coordinate trajectory). By default filename is "out.xtc",
   coordinates are folded.
 
+  DumpXTC needs ESPResSo++ built with GROMACS and gathers every frame on
+  node 0. :py:class:`espressopp.io.DumpCompressed` writes a similarly
+  compressed trajectory in parallel without GROMACS.
+
   Properties
 
 * `filename`
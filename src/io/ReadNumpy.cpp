@@ -22,6 +22,7 @@
 
 #include "ReadNumpy.hpp"
 #include "python.hpp"
+#include "storage/DomainDecomposition.hpp"
 
 
 using namespace espressopp;  // NOLINT
@@ -102,6 +103,184 @@ bool ReadNumpy::LoadPosition(PyObject *ids, PyObject *data) {
   return true;
 }
 
+namespace {
+
+// buffer of an optional column, released on destruction. A column of the
+// wrong format is reported to err, so that all nodes fail together.
+struct Column {
+  Py_buffer view;
+  bool present;
+
+  Column(PyObject *data, const char *format, longint rows, int width, const char *name,
+         esutil::Error &err)
+      : present(data != Py_None) {
+    if (!present) return;
+    if (PyObject_GetBuffer(data, &view, PyBUF_ANY_CONTIGUOUS | PyBUF_FORMAT) == -1) {
+      PyErr_Clear();
+      present = false;
+      err.setException(std::string("Wrong format of ") + name);
+      return;
+    }
+    // rows < 0 takes any number of rows
+    if (strcmp(view.format, format) != 0 ||
+        (rows >= 0 && view.len / view.itemsize != rows * width)) {
+      PyBuffer_Release(&view);
+      present = false;
+      std::stringstream msg;
+      msg << "Expected ";
+      if (rows >= 0) msg << rows << " x " << width << " ";
+      msg << "values of format " << format << " for " << name;
+      err.setException(msg.str());
+    }
+  }
+  ~Column() {
+    if (present) PyBuffer_Release(&view);
+  }
+
+  const long *ints() const { return static_cast<const long*>(view.buf); }  // NOLINT
+  const double *doubles() const { return static_cast<const double*>(view.buf); }
+};
+
+}  // end namespace
+
+longint ReadNumpy::LoadParticles(PyObject *ids, PyObject *pos, PyObject *types,
+                                 PyObject *masses, PyObject *velocities, PyObject *charges) {
+  System &system = getSystemRef();
+  esutil::Error err(system.comm);
+
+  storage::DomainDecomposition *dd =
+      dynamic_cast<storage::DomainDecomposition*>(system.storage.get());
+  if (!dd) {
+    err.setException("load_particles needs a DomainDecomposition storage");
+  }
+  err.checkException();
+
+  Column id_col(ids, "l", -1, 1, "ids", err);
+  if (!id_col.present) {
+    err.setException("load_particles needs an array of ids");
+  }
+  err.checkException();
+  longint num_particles = id_col.view.len / id_col.view.itemsize;
+  Column pos_col(pos, "d", num_particles, 3, "positions", err);
+  if (!pos_col.present) {
+    err.setException("load_particles needs an array of positions");
+  }
+  Column type_col(types, "l", num_particles, 1, "types", err);
+  Column mass_col(masses, "d", num_particles, 1, "masses", err);
+  Column v_col(velocities, "d", num_particles, 3, "velocities", err);
+  Column q_col(charges, "d", num_particles, 1, "charges", err);
+  err.checkException();
+
+  // a repeated id can end up on two nodes, so check before inserting
+  std::vector<longint> id_list(id_col.ints(), id_col.ints() + num_particles);
+  longint repeated = system.storage->countRepeatedIds(id_list);
+  if (repeated > 0) {
+    std::stringstream msg;
+    msg << repeated << " particle ids appear more than once, no particles were added";
+    err.setException(msg.str());
+  }
+  err.checkException();
+
+  ParticleList pl;
+  pl.reserve(num_particles);
+  for (longint i = 0; i < num_particles; i++) {
+    Particle n;
+    n.init();
+    n.id() = id_col.ints()[i];
+    n.position() = Real3D(pos_col.doubles() + 3*i);
+    n.image() = Int3D(0);
+    if (type_col.present) n.type() = type_col.ints()[i];
+    if (mass_col.present) n.mass() = mass_col.doubles()[i];
+    if (v_col.present) n.velocity() = Real3D(v_col.doubles() + 3*i);
+    if (q_col.present) n.q() = q_col.doubles()[i];
+    pl.push_back(n);
+  }
+
+  longint counts[2] = { num_particles, dd->distributeParticles(pl) };
+  longint total[2];
+  boost::mpi::all_reduce(*system.comm, counts, 2, total, std::plus<longint>());
+  if (total[1] != total[0]) {
+    std::stringstream msg;
+    msg << (total[0] - total[1]) << " of " << total[0]
+        << " particles were not added, their ids exist already";
+    err.setException(msg.str());
+  }
+  err.checkException();
+  return total[1];
+}
+
+std::vector<longint> ReadNumpy::LoadTuples(PyObject *tuples, int width) {
+  esutil::Error err(getSystemRef().comm);
+  Column col(tuples, "l", -1, 1, "tuples", err);
+  std::vector<longint> result;
+  if (col.present) {
+    longint n = col.view.len / col.view.itemsize;
+    if (n % width != 0) {
+      std::stringstream msg;
+      msg << "Expected an array of integers with " << width << " columns";
+      err.setException(msg.str());
+    } else {
+      result.assign(col.ints(), col.ints() + n);
+    }
+  }
+  err.checkException();
+  return result;
+}
+
+longint ReadNumpy::CheckTuples(longint num_tuples, longint num_added) {
+  System &system = getSystemRef();
+  esutil::Error err(system.comm);
+  longint counts[2] = { num_tuples, num_added };
+  longint total[2];
+  boost::mpi::all_reduce(*system.comm, counts, 2, total, std::plus<longint>());
+  if (total[1] != total[0]) {
+    std::stringstream msg;
+    msg << (total[0] - total[1]) << " of " << total[0] << " tuples were not added: "
+        << "unknown particle ids, duplicates, or particles too far apart "
+        << "(call decompose() after loading the particles)";
+    err.setException(msg.str());
+  }
+  err.checkException();
+  return total[1];
+}
+
+longint ReadNumpy::LoadPairs(shared_ptr<FixedPairList> fpl, PyObject *tuples) {
+  std::vector<longint> t = LoadTuples(tuples, 2);
+  longint num_tuples = t.size() / 2;
+  // FixedPairList stores a pair with the smaller id
+  for (size_t i = 0; i < t.size(); i += 2) {
+    if (t[i] > t[i + 1]) std::swap(t[i], t[i + 1]);
+  }
+  getSystemRef().storage->routeTuples(t, 2, 0);
+  longint num_added = 0;
+  for (size_t i = 0; i < t.size(); i += 2) {
+    if (fpl->iadd(t[i], t[i + 1])) num_added++;
+  }
+  return CheckTuples(num_tuples, num_added);
+}
+
+longint ReadNumpy::LoadTriples(shared_ptr<FixedTripleList> ftl, PyObject *tuples) {
+  std::vector<longint> t = LoadTuples(tuples, 3);
+  longint num_tuples = t.size() / 3;
+  getSystemRef().storage->routeTuples(t, 3, 1);
+  longint num_added = 0;
+  for (size_t i = 0; i < t.size(); i += 3) {
+    if (ftl->iadd(t[i], t[i + 1], t[i + 2])) num_added++;
+  }
+  return CheckTuples(num_tuples, num_added);
+}
+
+longint ReadNumpy::LoadQuadruples(shared_ptr<FixedQuadrupleList> fql, PyObject *tuples) {
+  std::vector<longint> t = LoadTuples(tuples, 4);
+  longint num_tuples = t.size() / 4;
+  getSystemRef().storage->routeTuples(t, 4, 1);
+  longint num_added = 0;
+  for (size_t i = 0; i < t.size(); i += 4) {
+    if (fql->iadd(t[i], t[i + 1], t[i + 2], t[i + 3])) num_added++;
+  }
+  return CheckTuples(num_tuples, num_added);
+}
+
 // Python wrapping
 void ReadNumpy::registerPython() {
   using namespace espressopp::python;  // NOLINT
@@ -110,7 +289,11 @@ void ReadNumpy::registerPython() {
 
   class_< ReadNumpy>
       ("io_ReadNumpy", init<shared_ptr<System> >())
-          .def("load_position", &ReadNumpy::LoadPosition);
+          .def("load_position", &ReadNumpy::LoadPosition)
+          .def("load_particles", &ReadNumpy::LoadParticles)
+          .def("load_pairs", &ReadNumpy::LoadPairs)
+          .def("load_triples", &ReadNumpy::LoadTriples)
+          .def("load_quadruples", &ReadNumpy::LoadQuadruples);
 }
 
 }  // end namespace io
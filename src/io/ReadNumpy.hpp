@@ -23,12 +23,16 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 #include "boost/python/numeric.hpp"
 
 #include "esutil/Error.hpp"
 
 #include "storage/Storage.hpp"
 #include "bc/BC.hpp"
+#include "FixedPairList.hpp"
+#include "FixedTripleList.hpp"
+#include "FixedQuadrupleList.hpp"
 
 namespace espressopp {
 namespace io {
@@ -47,6 +51,31 @@ class ReadNumpy: public SystemAccess {
   long* LoadIds(PyObject *ids, long &num_particles);  // NOLINT
   bool LoadPosition(PyObject *ids, PyObject *data);
 
+  /** Bulk loading of new particles. Every rank passes its own slice of
+   *  the particles (ids and types as int64, the rest as float64; types,
+   *  masses, velocities and charges may be None). The particles are sent
+   *  to their owners with one all-to-all exchange and put into the cells
+   *  by the storage, which has to be a DomainDecomposition. Collective.
+   *  Returns the total number of particles added.
+   */
+  longint LoadParticles(PyObject *ids, PyObject *pos, PyObject *types,
+                        PyObject *masses, PyObject *velocities, PyObject *charges);
+
+  /** Bulk loading of bonds, angles and dihedrals. Every rank passes its
+   *  own slice of the tuples as an int64 array with 2, 3 or 4 columns.
+   *  Each tuple is routed to the owner of its key particle, via a
+   *  directory that maps the ids to the ranks, and added there with
+   *  iadd(). The ghosts have to be up to date, i.e. decompose() has to
+   *  be called after loading the particles. Collective.
+   *  Returns the total number of tuples added.
+   */
+  longint LoadPairs(shared_ptr<FixedPairList> fpl, PyObject *tuples);
+  longint LoadTriples(shared_ptr<FixedTripleList> ftl, PyObject *tuples);
+  longint LoadQuadruples(shared_ptr<FixedQuadrupleList> fql, PyObject *tuples);
+
+  std::vector<longint> LoadTuples(PyObject *tuples, int width);
+  longint CheckTuples(longint num_tuples, longint num_added);
+
   Py_buffer LoadBuffer(PyObject *data);
 };
 }  // end namespace io
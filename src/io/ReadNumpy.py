@@ -21,13 +21,90 @@ r"""
 *********************************************
 **ReadNumpy** - IO Object
 *********************************************
+
+Loads particle data from NumPy arrays in C++.
+
+load_position(ids, positions) overwrites the positions of existing particles.
+
+load_particles() and load_bonds() create a system in bulk, instead of
+:py:meth:`espressopp.storage.Storage.addParticles` and
+:py:meth:`espressopp.FixedPairList.addBonds`, which walk through the lists in
+Python on every rank. Every rank takes its own slice of the rows and
+sends the particles to their owners with a single all-to-all exchange;
+the tuples are routed to the owner of their key particle. The arguments
+are NumPy arrays or names of .npy files. Files are memory-mapped, so a
+rank only reads its slice. load_h5md() reads the particles of one time
+step of an H5MD file, as written by :py:class:`espressopp.io.DumpH5MD`,
+in the same way.
+
+The calls are broadcast by PMI, so NumPy arrays in the memory of the
+controller are sent whole to every rank, which then drops all but its
+slice. For large systems save the arrays with numpy.save() to a file
+system that all ranks can read and pass the file names instead.
+
+Example:
+
+>>> reader = espressopp.io.ReadNumpy(system)
+>>> reader.load_particles(ids, pos, types=types, masses=masses)
+>>> system.storage.decompose()
+>>> fpl = espressopp.FixedPairList(system.storage)
+>>> reader.load_bonds(fpl, bonds)
+
+.. function:: espressopp.io.ReadNumpy.load_particles(ids, pos, types=None, masses=None, v=None, q=None)
+
+        Fails without adding a particle if an id appears more than once
+        in ids, and fails if an id exists already.
+
+        :param ids: particle ids, N
+        :param pos: positions, N x 3
+        :param types: types, N
+        :param masses: masses, N
+        :param v: velocities, N x 3
+        :param q: charges, N
+        :return: number of particles added
+
+.. function:: espressopp.io.ReadNumpy.load_bonds(fixedlist, tuples)
+
+        Adds tuples of particle ids to a FixedPairList (N x 2),
+        FixedTripleList (N x 3) or FixedQuadrupleList (N x 4).
+        Call storage.decompose() after loading the particles first.
+
+        :return: number of tuples added
+
+.. function:: espressopp.io.ReadNumpy.load_h5md(filename, group='atoms', step=-1)
+
+        :param filename: H5MD file
+        :param group: particle group in /particles
+        :param step: index of the time step
+        :return: number of particles added
 """
 
+import numpy as np
+
 from _espressopp import io_ReadNumpy
 from espressopp import pmi
 from espressopp.esutil import cxxinit
 
 
+def _rows(data):
+    if data is None:
+        return None
+    if isinstance(data, str):
+        return np.load(data, mmap_mode='r')
+    return data
+
+
+def _slice(n):
+    rank, size = pmi._MPIcomm.rank, pmi._MPIcomm.size
+    return n * rank / size, n * (rank + 1) / size
+
+
+def _column(data, dtype, lo, hi):
+    if data is None:
+        return None
+    return np.ascontiguousarray(data[lo:hi], dtype=dtype)
+
+
 class ReadNumpyLocal(io_ReadNumpy):
     def __init__(self, system):
         cxxinit(self, io_ReadNumpy, system)
@@ -36,11 +113,80 @@ class ReadNumpyLocal(io_ReadNumpy):
         if pmi.workerIsActive():
             self.cxxclass.load_position(self, ids, input_ndarray)
 
+    def load_particles(self, ids, pos, types=None, masses=None, v=None, q=None):
+        if pmi.workerIsActive():
+            ids = _rows(ids)
+            lo, hi = _slice(len(ids))
+            return self.cxxclass.load_particles(
+                self,
+                _column(ids, np.int64, lo, hi),
+                _column(_rows(pos), np.float64, lo, hi),
+                _column(_rows(types), np.int64, lo, hi),
+                _column(_rows(masses), np.float64, lo, hi),
+                _column(_rows(v), np.float64, lo, hi),
+                _column(_rows(q), np.float64, lo, hi))
+
+    def load_bonds(self, fixedlist, tuples):
+        if pmi.workerIsActive():
+            tuples = _rows(tuples)
+            width = tuples.shape[1] if len(tuples.shape) == 2 else 0
+            lo, hi = _slice(len(tuples))
+            local = _column(tuples, np.int64, lo, hi).reshape(-1, max(width, 1))
+            if width == 2:
+                return self.cxxclass.load_pairs(self, fixedlist, local)
+            elif width == 3:
+                return self.cxxclass.load_triples(self, fixedlist, local)
+            elif width == 4:
+                return self.cxxclass.load_quadruples(self, fixedlist, local)
+            raise ValueError('expected an array with 2, 3 or 4 columns, got shape {}'.format(tuples.shape))
+
+    def load_h5md(self, filename, group='atoms', step=-1):
+        if pmi.workerIsActive():
+            import h5py
+            h5 = h5py.File(filename, 'r')
+            part = h5['particles'][group]
+
+            def element(name):
+                if name not in part:
+                    return None
+                return part[name]['value']
+
+            ids = element('id')
+            lo, hi = _slice(ids.shape[1])
+            ids = ids[step, lo:hi]
+            valid = ids >= 0  # unused slots are filled with -1
+
+            def column(name):
+                data = element(name)
+                return None if data is None else data[step, lo:hi][valid]
+
+            pos = column('position')
+            image = column('image')
+            if image is not None:
+                edges = part['box']['edges']
+                if isinstance(edges, h5py.Group):
+                    edges = edges['value'][step]
+                pos = pos + image * np.asarray(edges)
+            types = column('species')
+            masses = column('mass')
+            v = column('velocity')
+            q = column('charge')
+            h5.close()
+
+            return self.cxxclass.load_particles(
+                self,
+                _column(ids[valid], np.int64, None, None),
+                _column(pos, np.float64, None, None),
+                _column(types, np.int64, None, None),
+                _column(masses, np.float64, None, None),
+                _column(v, np.float64, None, None),
+                _column(q, np.float64, None, None))
+
 
 if pmi.isController:
     class ReadNumpy():
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
             cls='espressopp.io.ReadNumpyLocal',
-            pmicall=['load_position'],
+            pmicall=['load_position', 'load_particles', 'load_bonds', 'load_h5md'],
         )
@@ -28,6 +28,9 @@ from espressopp.io.DumpGRO import *
 from espressopp.io.DumpGROAdress import *
 from espressopp.io.DumpXYZ import *
 from espressopp.io.ReadNumpy import *
+from espressopp.io.Checkpoint import *
+from espressopp.io.DumpAsync import *
+from espressopp.io.DumpCompressed import *
 
 try:
     from espressopp.io.DumpH5MD import *
@@ -28,6 +28,9 @@
 #include "DumpTopology.hpp"
 #include "FileBackup.hpp"
 #include "ReadNumpy.hpp"
+#include "Checkpoint.hpp"
+#include "DumpAsync.hpp"
+#include "DumpCompressed.hpp"
 
 #ifdef HAS_GROMACS
 #include "DumpXTC.hpp"
@@ -42,6 +45,9 @@ namespace espressopp {
       DumpH5MD::registerPython();
       DumpTopology::registerPython();
       ReadNumpy::registerPython();
+      Checkpoint::registerPython();
+      DumpAsync::registerPython();
+      DumpCompressed::registerPython();
 #ifdef HAS_GROMACS
       DumpXTC::registerPython();
 #endif
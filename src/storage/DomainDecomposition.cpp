@@ -82,9 +82,6 @@ namespace espressopp {
   }
 
   void DomainDecomposition:: createCellGrid(const Int3D& _nodeGrid, const Int3D& _cellGrid) {
-    real myLeft[3];
-    real myRight[3];
-
     nodeGrid = NodeGrid(_nodeGrid, getSystem()->comm->rank(), getSystem()->bc->getBoxL());
 
     if (nodeGrid.getNumberOfCells() != getSystem()->comm->size()) {
@@ -105,6 +102,13 @@ namespace espressopp {
            << nodeGrid.getNodeNeighborIndex(4) << "<->"
            << nodeGrid.getNodeNeighborIndex(5));
 
+    initCellGrid(_cellGrid);
+  }
+
+  void DomainDecomposition::initCellGrid(const Int3D& _cellGrid) {
+    real myLeft[3];
+    real myRight[3];
+
     for (int i = 0; i < 3; ++i) {
       myLeft[i] = nodeGrid.getMyLeft(i);
       myRight[i] = nodeGrid.getMyRight(i);
@@ -157,6 +161,34 @@ namespace espressopp {
         }
       }
     }
+    if (curve != NoCurve) sortRealCells();
+  }
+
+  void DomainDecomposition::sortRealCells() {
+    if (curve == NoCurve) {
+      // back to the plain grid order of markCells()
+      std::sort(realCells.begin(), realCells.end());
+      return;
+    }
+
+    int maxSize = 1;
+    for (int i = 0; i < 3; ++i) {
+      maxSize = std::max(maxSize, cellGrid.getFrameGridSize(i));
+    }
+    int bits = 1;
+    while ((1 << bits) < maxSize) ++bits;
+
+    std::vector< std::pair<uint64_t, Cell*> > keys;
+    keys.reserve(realCells.size());
+    for (CellList::Iterator it(realCells); it.isValid(); ++it) {
+      int m, n, o;
+      cellGrid.mapIndexToPosition(m, n, o, *it - &cells[0]);
+      keys.push_back(std::make_pair(curveKey(curve, m, n, o, bits), *it));
+    }
+    std::sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      realCells[i] = keys[i].second;
+    }
   }
 
   // TODO one should take care of rc and system size
@@ -230,18 +262,34 @@ namespace espressopp {
   }
 
   void DomainDecomposition::cellAdjust(){
+    resetCellGrid();
+    exchangeGhosts();
+    onParticlesChanged();
+  }
+
+  void DomainDecomposition::resetCellGrid(){
     // create an appropriate cell grid
     Real3D box_sizeL = getSystem() -> bc -> getBoxL();
     real skinL = getSystem() -> getSkin();
     real maxCutoffL = getSystem() -> maxCutoff;
-            
-    // nodeGrid is already defined
-    Int3D _nodeGrid(nodeGrid.getGridSize());
-    // new cellGrid
+
+    // the node grid keeps its relative boundaries, fit them to the box
+    Real3D scale(1.0, 1.0, 1.0);
+    bool rescale = false;
+    for (int i = 0; i < 3; ++i) {
+      real length = nodeGrid.getBoundaries(i).back();
+      if (fabs(box_sizeL[i] - length) > ROUND_ERROR_PREC) {
+        scale[i] = box_sizeL[i] / length;
+        rescale = true;
+      }
+    }
+    if (rescale) nodeGrid.scaleVolume(scale);
+
+    // new cellGrid, the domains may differ in size
     real rc_skin = maxCutoffL + skinL;
-    int ix = (int)(box_sizeL[0] / (rc_skin * _nodeGrid[0]));
-    int iy = (int)(box_sizeL[1] / (rc_skin * _nodeGrid[1]));
-    int iz = (int)(box_sizeL[2] / (rc_skin * _nodeGrid[2]));
+    int ix = (int)(nodeGrid.getLocalBoxSize(0) / rc_skin);
+    int iy = (int)(nodeGrid.getLocalBoxSize(1) / rc_skin);
+    int iz = (int)(nodeGrid.getLocalBoxSize(2) / rc_skin);
     Int3D _newCellGrid(ix, iy, iz);
 
     // save all particles to temporary vector
@@ -264,7 +312,7 @@ namespace espressopp {
     }
     
     // creating new grids
-    createCellGrid(_nodeGrid, _newCellGrid);
+    initCellGrid(_newCellGrid);
     initCellInteractions();
     prepareGhostCommunication();
     
@@ -281,9 +329,107 @@ namespace espressopp {
     for(CellList::Iterator it(realCells); it.isValid(); ++it) {
       updateLocalParticles((*it)->particles);
     }
-    
-    exchangeGhosts();
-    onParticlesChanged();
+  }
+
+  /* Equal-load boundaries for n domains along an axis from the load
+     histogram h of nb bins, each domain at least minWidth wide. */
+  static void balancedBoundaries(const real *h, int nb, real length, real minWidth,
+                                 std::vector<real> &b) {
+    int n = b.size() - 1;
+    real total = 0.0;
+    for (int j = 0; j < nb; ++j) total += h[j];
+    if (total <= 0.0 || n * minWidth > length) return;
+
+    real binWidth = length / nb;
+    b[0] = 0.0;
+    b[n] = length;
+    real sum = 0.0;
+    int k = 1;
+    for (int j = 0; j < nb && k < n; ++j) {
+      while (k < n && sum + h[j] >= k * total / n) {
+        real frac = (h[j] > 0.0) ? (k * total / n - sum) / h[j] : 0.0;
+        b[k++] = (j + frac) * binWidth;
+      }
+      sum += h[j];
+    }
+    for (; k < n; ++k) b[k] = length;
+
+    for (k = 1; k < n; ++k) b[k] = std::max(b[k], b[k-1] + minWidth);
+    for (k = n - 1; k > 0; --k) b[k] = std::min(b[k], b[k+1] - minWidth);
+  }
+
+  real DomainDecomposition::loadBalance(real load, real relax) {
+    System& system = getSystemRef();
+    mpi::communicator& comm = *system.comm;
+
+    longint nLocal = getNRealParticles();
+    if (load < 0.0) load = nLocal;
+
+    real maxLoad, sumLoad;
+    mpi::all_reduce(comm, load, maxLoad, mpi::maximum<real>());
+    mpi::all_reduce(comm, load, sumLoad, std::plus<real>());
+    real imbalance = (sumLoad > 0.0) ? maxLoad * comm.size() / sumLoad : 1.0;
+
+    LOG4ESPP_INFO(logger, "load balancing, imbalance max/mean = " << imbalance);
+
+    // histogram of the load along each axis, the load of a node is
+    // spread evenly over its particles
+    const int binsPerNode = 32;
+    Real3D boxL = system.bc->getBoxL();
+    int nBins[3], offset[3];
+    int totalBins = 0;
+    for (int i = 0; i < 3; ++i) {
+      nBins[i] = binsPerNode * nodeGrid.getGridSize(i);
+      offset[i] = totalBins;
+      totalBins += nBins[i];
+    }
+    std::vector<real> hist(totalBins, 0.0), totalHist(totalBins, 0.0);
+    real weight = (nLocal > 0) ? load / nLocal : 0.0;
+    for (iterator::CellListIterator it(realCells); !it.isDone(); ++it) {
+      const Real3D& pos = it->position();
+      for (int i = 0; i < 3; ++i) {
+        int bin = static_cast<int>(pos[i] / boxL[i] * nBins[i]);
+        bin = std::min(std::max(bin, 0), nBins[i] - 1);
+        hist[offset[i] + bin] += weight;
+      }
+    }
+    mpi::reduce(comm, &hist[0], totalBins, &totalHist[0], std::plus<real>(), 0);
+
+    // the new boundaries are computed on the root only, so that all
+    // nodes get bitwise identical values
+    real minWidth = system.maxCutoff + system.getSkin();
+    for (int i = 0; i < 3; ++i) {
+      int n = nodeGrid.getGridSize(i);
+      if (n == 1) continue;
+      std::vector<real> b(nodeGrid.getBoundaries(i));
+      if (comm.rank() == 0) {
+        std::vector<real> target(b);
+        balancedBoundaries(&totalHist[offset[i]], nBins[i], boxL[i], minWidth, target);
+        for (int k = 1; k < n; ++k) {
+          b[k] += relax * (target[k] - b[k]);
+        }
+      }
+      mpi::broadcast(comm, &b[0], n + 1, 0);
+      nodeGrid.setBoundaries(i, b);
+    }
+
+    LOG4ESPP_INFO(logger, "new local box "
+          << nodeGrid.getMyLeft(0) << "-" << nodeGrid.getMyRight(0) << ", "
+          << nodeGrid.getMyLeft(1) << "-" << nodeGrid.getMyRight(1) << ", "
+          << nodeGrid.getMyLeft(2) << "-" << nodeGrid.getMyRight(2));
+
+    // rebuild the cells and move the particles to their new nodes
+    resetCellGrid();
+    decompose();
+
+    return imbalance;
+  }
+
+  python::list DomainDecomposition::getNodeBoundaries(int axis) {
+    python::list ret;
+    const std::vector<real> &b = nodeGrid.getBoundaries(axis);
+    for (size_t k = 0; k < b.size(); ++k) ret.append(b[k]);
+    return ret;
   }
 
   void DomainDecomposition::initCellInteractions() {
@@ -349,6 +495,47 @@ namespace espressopp {
     return getSystem()->comm->rank() == mapPositionToNodeClipped(pos);
   }
 
+  longint DomainDecomposition::distributeParticles(ParticleList &pl) {
+    mpi::communicator& comm = *getSystem()->comm;
+    int nprocs = comm.size();
+    int rank = comm.rank();
+
+    std::vector< ParticleList > sendLists(nprocs);
+    for (ParticleList::Iterator it(pl); it.isValid(); ++it) {
+      getSystem()->bc->foldPosition(it->position(), it->image());
+      sendLists[mapPositionToNodeClipped(it->position())].push_back(*it);
+    }
+    pl.clear();
+
+    std::vector< int > sendCounts(nprocs), recvCounts(nprocs);
+    for (int r = 0; r < nprocs; ++r) sendCounts[r] = sendLists[r].size();
+    mpi::all_to_all(comm, sendCounts, recvCounts);
+
+    // particles are sent as plain bytes, as in sendParticles
+    const int tag = 0x6d1;
+    std::vector< ParticleList > recvLists(nprocs);
+    std::vector< mpi::request > requests;
+    for (int r = 0; r < nprocs; ++r) {
+      if (r == rank) continue;
+      if (recvCounts[r] > 0) {
+        recvLists[r].resize(recvCounts[r]);
+        requests.push_back(comm.irecv(r, tag, reinterpret_cast< char* >(&recvLists[r][0]),
+                                      recvCounts[r] * sizeof(Particle)));
+      }
+      if (sendCounts[r] > 0) {
+        requests.push_back(comm.isend(r, tag, reinterpret_cast< const char* >(&sendLists[r][0]),
+                                      sendCounts[r] * sizeof(Particle)));
+      }
+    }
+    mpi::wait_all(requests.begin(), requests.end());
+    recvLists[rank].swap(sendLists[rank]);
+
+    longint n = 0;
+    for (int r = 0; r < nprocs; ++r) n += insertParticles(recvLists[r]);
+    LOG4ESPP_INFO(logger, "distributeParticles: added " << n << " particles");
+    return n;
+  }
+
   bool DomainDecomposition::appendParticles(ParticleList &l, int dir) {
     bool outlier = false;
 
@@ -649,6 +836,48 @@ namespace espressopp {
     }
   }
   
+  PersistentExchange *DomainDecomposition::
+  getGhostExchange(int dir, bool realToGhosts, int extradata) {
+    // only the position update with the standard data and the force
+    // collection repeat every step
+    if (realToGhosts && extradata != dataOfUpdateGhosts) return 0;
+
+    int coord = dir / 2;
+    int oppositeDir = 2 * coord + (1 - dir % 2);
+    longint receiver, sender;
+    int sendSize = 0, recvSize = 0;
+    if (realToGhosts) {
+      receiver = nodeGrid.getNodeNeighborIndex(dir);
+      sender = nodeGrid.getNodeNeighborIndex(oppositeDir);
+      for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
+        sendSize += commCells[dir].reals[i]->particles.size();
+        recvSize += commCells[dir].ghosts[i]->particles.size();
+      }
+      sendSize *= Buffer::particleDataSize(extradata);
+      recvSize *= Buffer::particleDataSize(extradata);
+    } else {
+      receiver = nodeGrid.getNodeNeighborIndex(oppositeDir);
+      sender = nodeGrid.getNodeNeighborIndex(dir);
+      for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
+        sendSize += commCells[dir].ghosts[i]->particles.size();
+        recvSize += commCells[dir].reals[i]->particles.size();
+      }
+      sendSize *= sizeof(ParticleForce);
+      recvSize *= sizeof(ParticleForce);
+    }
+
+    // the requests are renewed whenever the ghost layer changed its size
+    shared_ptr< PersistentExchange > &exchange = ghostExchanges[dir][realToGhosts ? 0 : 1];
+    if (!exchange) {
+      exchange = boost::make_shared< PersistentExchange >(*getSystem()->comm);
+    }
+    if (!exchange->isValid() || exchange->getSendSize() != sendSize ||
+        exchange->getRecvSize() != recvSize) {
+      exchange->init(receiver, sender, DD_COMM_TAG, sendSize, recvSize);
+    }
+    return exchange.get();
+  }
+
   void DomainDecomposition::
   doGhostCommunication(bool sizesFirst, bool realToGhosts, int extradata) {
     LOG4ESPP_DEBUG(logger, "do ghost communication " << (sizesFirst ? "with sizes " : "")
@@ -729,26 +958,35 @@ namespace espressopp {
             LOG4ESPP_DEBUG(logger, "exchanging ghost cell sizes done");
           }
 
+          // the regular updates go through a persistent exchange with
+          // fixed message sizes
+          PersistentExchange *exchange = sizesFirst ? 0 : getGhostExchange(dir, realToGhosts, extradata);
+          OutBuffer &sendBuffer = exchange ? exchange->getOutBuffer() : outBuffer;
+          InBuffer &recvBuffer = exchange ? exchange->getInBuffer() : inBuffer;
+
           // prepare send and receive buffers
           longint receiver, sender;
-          outBuffer.reset();
+          sendBuffer.reset();
           if (realToGhosts) {
             receiver = nodeGrid.getNodeNeighborIndex(dir);
             sender = nodeGrid.getNodeNeighborIndex(oppositeDir);
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              packPositionsEtc(outBuffer, *commCells[dir].reals[i], extradata, shift);
+              packPositionsEtc(sendBuffer, *commCells[dir].reals[i], extradata, shift);
             }
           }
           else {
             receiver = nodeGrid.getNodeNeighborIndex(oppositeDir);
             sender = nodeGrid.getNodeNeighborIndex(dir);
             for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
-              packForces(outBuffer, *commCells[dir].ghosts[i]);
+              packForces(sendBuffer, *commCells[dir].ghosts[i]);
             }
           }
 
+          if (exchange) {
+            exchange->exchange();
+          }
           // exchange particles, odd-even rule
-          if (nodeGrid.getNodePosition(coord) % 2 == 0) {
+          else if (nodeGrid.getNodePosition(coord) % 2 == 0) {
             outBuffer.send(receiver, DD_COMM_TAG);
             inBuffer.recv(sender, DD_COMM_TAG);
           } else {
@@ -759,12 +997,12 @@ namespace espressopp {
           // unpack received data
           if (realToGhosts) {
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              unpackPositionsEtc(*commCells[dir].ghosts[i], inBuffer, extradata);
+              unpackPositionsEtc(*commCells[dir].ghosts[i], recvBuffer, extradata);
             }
           }
           else {
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              unpackAndAddForces(*commCells[dir].reals[i], inBuffer);
+              unpackAndAddForces(*commCells[dir].reals[i], recvBuffer);
             }
           }
         }
@@ -784,6 +1022,8 @@ namespace espressopp {
     .def("getCellGrid", &DomainDecomposition::getInt3DCellGrid)
     .def("getNodeGrid", &DomainDecomposition::getInt3DNodeGrid)
     .def("cellAdjust", &DomainDecomposition::cellAdjust)
+    .def("loadBalance", &DomainDecomposition::loadBalance)
+    .def("getNodeBoundaries", &DomainDecomposition::getNodeBoundaries)
     ;
   }
 
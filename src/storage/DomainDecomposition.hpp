@@ -27,6 +27,7 @@
 #include "types.hpp"
 #include "CellGrid.hpp"
 #include "NodeGrid.hpp"
+#include "PersistentExchange.hpp"
 
 
 namespace espressopp {
@@ -57,12 +58,35 @@ namespace espressopp {
       // as a consequence of the system resizing
       virtual void cellAdjust();
 
+      /** Move the domain boundaries so that every node gets the same
+          share of the load. load is this node's load (e.g. the force
+          time since the last call), a negative value takes the number
+          of real particles. The boundaries stay planes through the
+          whole box, every node keeps its six neighbors; along each axis
+          the load histogram of all nodes is split evenly, with domains
+          of at least cutoff+skin. relax in (0,1] damps the move.
+          Rebuilds the cells and redistributes the particles.
+          \return max/mean load before balancing
+      */
+      virtual real loadBalance(real load, real relax);
+
+      /// boundaries of the domains along axis, as a python list
+      python::list getNodeBoundaries(int axis);
+
       virtual Cell *mapPositionToCell(const Real3D& pos);
       virtual Cell *mapPositionToCellClipped(const Real3D& pos);
       virtual Cell *mapPositionToCellChecked(const Real3D& pos);
 
       longint mapPositionToNodeClipped(const Real3D& pos);
 
+      /** Send every particle of pl to the node whose domain contains
+          its folded position, with one all-to-all exchange, and insert
+          the particles received with insertParticles(). pl is cleared.
+          Collective call.
+          \return number of particles added on this node
+      */
+      longint distributeParticles(ParticleList &pl);
+
       const NodeGrid &getNodeGrid() const { return nodeGrid; }
       const CellGrid &getCellGrid() const { return cellGrid; }
 
@@ -90,12 +114,24 @@ namespace espressopp {
 
       void prepareGhostCommunication();
 
+      /** persistent exchange for a ghost update of direction dir that
+          repeats every step (positions with dataOfUpdateGhosts, or
+          forces), 0 for other data */
+      PersistentExchange *getGhostExchange(int dir, bool realToGhosts, int extradata);
+
       /// init global Verlet list
       void initCellInteractions();
       /// set the grids and allocate space accordingly
       void createCellGrid(const Int3D& nodeGrid, const Int3D& cellGrid);
+      /// set up the local cells of the current node grid
+      void initCellGrid(const Int3D& cellGrid);
+      /** recreate the cells for the current box, node boundaries and
+          cutoff, the particles are put into the nearest new cell */
+      void resetCellGrid();
       /// sort cells into local/ghost cell arrays
       void markCells();
+      /// order the real cells along the space-filling curve of the cell grid
+      virtual void sortRealCells();
       /// fill a list of cells with the cells from a certain region of the domain grid
       void fillCells(std::vector<Cell *> &,
 		     const int leftBoundary[3],
@@ -129,6 +165,9 @@ namespace espressopp {
       */
       CommCells commCells[6];
 
+      /// persistent exchanges per direction, for positions and forces
+      shared_ptr< PersistentExchange > ghostExchanges[6][2];
+
       static LOG4ESPP_DECL_LOGGER(logger);
     };
   }
@@ -41,6 +41,30 @@ espressopp.storage.DomainDecomposition
 .. function:: espressopp.storage.DomainDecomposition.getNodeGrid()
 
 		:rtype: 
+
+.. function:: espressopp.storage.DomainDecomposition.loadBalance(load, relax)
+
+		Moves the domain boundaries so that every node carries the same
+		share of the load, then rebuilds the cells and redistributes the
+		particles. The boundaries remain planes through the whole box,
+		so along each axis the slabs of nodes are resized; every domain
+		stays at least cutoff+skin wide. Collective call.
+
+		:param load: load of this node, e.g. its force time; by default
+		             the number of its particles
+		:param relax: fraction of the computed move that is applied
+		:type load: real
+		:type relax: real
+		:rtype: real, max/mean load before balancing
+
+.. function:: espressopp.storage.DomainDecomposition.getNodeBoundaries(axis)
+
+		:param axis: 0, 1 or 2
+		:type axis: int
+		:rtype: list of the domain boundaries along axis
+
+Modules with their own evenly split grid, e.g. LatticeBoltzmann, assume the
+default domains and must not be combined with load balancing.
 """
 from espressopp import pmi
 from espressopp.esutil import cxxinit
@@ -65,12 +89,21 @@ class DomainDecompositionLocal(StorageLocal, storage_DomainDecomposition):
     def getNodeGrid(self):
         if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
             return self.cxxclass.getNodeGrid(self)
+
+    def loadBalance(self, load=-1.0, relax=1.0):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.loadBalance(self, load, relax)
+
+    def getNodeBoundaries(self, axis):
+        if not (pmi._PMIComm and pmi._PMIComm.isActive()) or pmi._MPIcomm.rank in pmi._PMIComm.getMPIcpugroup():
+            return self.cxxclass.getNodeBoundaries(self, axis)
           
 if pmi.isController:
     class DomainDecomposition(Storage):
         pmiproxydefs = dict(
           cls = 'espressopp.storage.DomainDecompositionLocal',  
-          pmicall = ['getCellGrid', 'getNodeGrid', 'cellAdjust', 'mapPositionToNodeClipped']
+          pmicall = ['getCellGrid', 'getNodeGrid', 'cellAdjust', 'mapPositionToNodeClipped',
+                     'loadBalance', 'getNodeBoundaries']
         )
         def __init__(self, system, 
                      nodeGrid='auto', 
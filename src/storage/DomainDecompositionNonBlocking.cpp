@@ -43,6 +43,8 @@ namespace espressopp {
 
 
   const int DD_COMM_TAG = 0xab;
+  // split ghost communication, one tag per direction of a coordinate
+  const int DD_GHOST_TAG = 0xac;
 
   DomainDecompositionNonBlocking::
   DomainDecompositionNonBlocking(shared_ptr< System > _system,
@@ -54,7 +56,12 @@ namespace espressopp {
       outBufferL(*_system->comm),
       outBufferR(*_system->comm),
       inBufferG(*_system->comm),
-      outBufferG(*_system->comm) {}
+      outBufferG(*_system->comm),
+      ghostCommActive(false),
+      ghostCommRealToGhosts(true),
+      ghostCommData(0),
+      ghostCommStage(0),
+      nGhostRequests(0) {}
 
   void DomainDecompositionNonBlocking::decomposeRealParticles() {
 
@@ -311,46 +318,56 @@ namespace espressopp {
             LOG4ESPP_DEBUG(logger, "exchanging ghost cell sizes done");
           }
 
+          // the regular updates go through a persistent exchange with
+          // fixed message sizes
+          PersistentExchange *exchange = sizesFirst ? 0 : getGhostExchange(dir, realToGhosts, extradata);
+          OutBuffer &sendBuffer = exchange ? exchange->getOutBuffer() : outBufferG;
+          InBuffer &recvBuffer = exchange ? exchange->getInBuffer() : inBufferG;
+
           // prepare send and receive buffers
           longint receiver, sender;
-          outBufferG.reset();
+          sendBuffer.reset();
           if (realToGhosts) {
             receiver = nodeGrid.getNodeNeighborIndex(dir);
             sender = nodeGrid.getNodeNeighborIndex(oppositeDir);
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              packPositionsEtc(outBufferG, *commCells[dir].reals[i], extradata, shift);
+              packPositionsEtc(sendBuffer, *commCells[dir].reals[i], extradata, shift);
             }
           }
           else {
             receiver = nodeGrid.getNodeNeighborIndex(oppositeDir);
             sender = nodeGrid.getNodeNeighborIndex(dir);
             for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
-              packForces(outBufferG, *commCells[dir].ghosts[i]);
+              packForces(sendBuffer, *commCells[dir].ghosts[i]);
             }
           }
 
-          mpi::request reqs[2];
-
-          // exchange particles, odd-even rule
-          if (nodeGrid.getNodePosition(coord) % 2 == 0) {
-            reqs[0]=outBufferG.isend(receiver, DD_COMM_TAG);
-            reqs[1]=inBufferG.irecv(sender, DD_COMM_TAG);
+          if (exchange) {
+            exchange->exchange();
           } else {
-            reqs[0]=inBufferG.irecv(sender, DD_COMM_TAG);
-            reqs[1]=outBufferG.isend(receiver, DD_COMM_TAG);
-          }
+            mpi::request reqs[2];
 
-          mpi::wait_all(reqs, reqs + 2);
+            // exchange particles, odd-even rule
+            if (nodeGrid.getNodePosition(coord) % 2 == 0) {
+              reqs[0]=outBufferG.isend(receiver, DD_COMM_TAG);
+              reqs[1]=inBufferG.irecv(sender, DD_COMM_TAG);
+            } else {
+              reqs[0]=inBufferG.irecv(sender, DD_COMM_TAG);
+              reqs[1]=outBufferG.isend(receiver, DD_COMM_TAG);
+            }
+
+            mpi::wait_all(reqs, reqs + 2);
+          }
 
           // unpack received data
           if (realToGhosts) {
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              unpackPositionsEtc(*commCells[dir].ghosts[i], inBufferG, extradata);
+              unpackPositionsEtc(*commCells[dir].ghosts[i], recvBuffer, extradata);
             }
           }
           else {
             for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
-              unpackAndAddForces(*commCells[dir].reals[i], inBufferG);
+              unpackAndAddForces(*commCells[dir].reals[i], recvBuffer);
             }
           }
         }
@@ -359,11 +376,158 @@ namespace espressopp {
     LOG4ESPP_DEBUG(logger, "ghost communication finished");
   }
 
+  void DomainDecompositionNonBlocking::startUpdateGhosts() {
+    LOG4ESPP_DEBUG(logger, "startUpdateGhosts -> split ghost communication, real->ghost");
+    startGhostCommunication(true, dataOfUpdateGhosts);
+  }
+
+  void DomainDecompositionNonBlocking::finishUpdateGhosts() {
+    advanceGhostCommunication(true);
+  }
+
+  void DomainDecompositionNonBlocking::startCollectGhostForces() {
+    LOG4ESPP_DEBUG(logger, "startCollectGhostForces -> split ghost communication, ghost->real");
+    startGhostCommunication(false, 0);
+  }
+
+  void DomainDecompositionNonBlocking::finishCollectGhostForces() {
+    advanceGhostCommunication(true);
+  }
+
+  bool DomainDecompositionNonBlocking::progressGhostCommunication() {
+    return advanceGhostCommunication(false);
+  }
+
+  void DomainDecompositionNonBlocking::
+  startGhostCommunication(bool realToGhosts, int extradata) {
+    if (ghostCommActive) {
+      throw std::runtime_error("DomainDecompositionNonBlocking::startGhostCommunication: previous ghost communication not finished");
+    }
+    ghostCommActive = true;
+    ghostCommRealToGhosts = realToGhosts;
+    ghostCommData = extradata;
+    ghostCommStage = 0;
+    postGhostStage();
+  }
+
+  void DomainDecompositionNonBlocking::postGhostStage() {
+    // same processing order as in doGhostCommunication
+    int coord = ghostCommRealToGhosts ? ghostCommStage : (2 - ghostCommStage);
+    real curCoordBoxL = getSystem()->bc->getBoxL()[coord];
+
+    LOG4ESPP_DEBUG(logger, "post ghost communication for coordinate " << coord);
+
+    nGhostRequests = 0;
+    for (int lr = 0; lr < 2; ++lr) {
+      int dir         = 2 * coord + lr;
+      int oppositeDir = 2 * coord + (1 - lr);
+
+      Real3D shift(0, 0, 0);
+      shift[coord] = nodeGrid.getBoundary(dir) * curCoordBoxL;
+
+      if (nodeGrid.getGridSize(coord) == 1) {
+        // copy operation, we have to receive as many cells as we send
+        if (commCells[dir].ghosts.size() != commCells[dir].reals.size()) {
+          throw std::runtime_error("DomainDecompositionNonBlocking::postGhostStage: send/recv cell structure mismatch during local copy");
+        }
+
+        for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
+          if (ghostCommRealToGhosts) {
+            copyRealsToGhosts(*commCells[dir].reals[i], *commCells[dir].ghosts[i], ghostCommData, shift);
+          } else {
+            addGhostForcesToReals(*commCells[dir].ghosts[i], *commCells[dir].reals[i]);
+          }
+        }
+        continue;
+      }
+
+      OutBuffer &outBuffer = (lr == 0) ? outBufferL : outBufferR;
+      InBuffer &inBuffer = (lr == 0) ? inBufferL : inBufferR;
+
+      // the message sizes are known from the last exchangeGhosts, so the
+      // receive can be posted without probing
+      longint receiver, sender;
+      int recvSize = 0;
+      outBuffer.reset();
+      if (ghostCommRealToGhosts) {
+        receiver = nodeGrid.getNodeNeighborIndex(dir);
+        sender = nodeGrid.getNodeNeighborIndex(oppositeDir);
+        for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
+          packPositionsEtc(outBuffer, *commCells[dir].reals[i], ghostCommData, shift);
+        }
+        for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
+          recvSize += commCells[dir].ghosts[i]->particles.size();
+        }
+        recvSize *= Buffer::particleDataSize(ghostCommData);
+      }
+      else {
+        receiver = nodeGrid.getNodeNeighborIndex(oppositeDir);
+        sender = nodeGrid.getNodeNeighborIndex(dir);
+        for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
+          packForces(outBuffer, *commCells[dir].ghosts[i]);
+        }
+        for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
+          recvSize += commCells[dir].reals[i]->particles.size();
+        }
+        recvSize *= sizeof(ParticleForce);
+      }
+
+      ghostRequests[nGhostRequests++] = inBuffer.irecv(sender, DD_GHOST_TAG + lr, recvSize);
+      ghostRequests[nGhostRequests++] = outBuffer.isend(receiver, DD_GHOST_TAG + lr);
+    }
+  }
+
+  void DomainDecompositionNonBlocking::finishGhostStage() {
+    int coord = ghostCommRealToGhosts ? ghostCommStage : (2 - ghostCommStage);
+
+    if (nodeGrid.getGridSize(coord) > 1) {
+      for (int lr = 0; lr < 2; ++lr) {
+        int dir = 2 * coord + lr;
+        InBuffer &inBuffer = (lr == 0) ? inBufferL : inBufferR;
+
+        if (ghostCommRealToGhosts) {
+          for (int i = 0, end = commCells[dir].ghosts.size(); i < end; ++i) {
+            unpackPositionsEtc(*commCells[dir].ghosts[i], inBuffer, ghostCommData);
+          }
+        }
+        else {
+          for (int i = 0, end = commCells[dir].reals.size(); i < end; ++i) {
+            unpackAndAddForces(*commCells[dir].reals[i], inBuffer);
+          }
+        }
+      }
+    }
+
+    nGhostRequests = 0;
+    ++ghostCommStage;
+  }
+
+  bool DomainDecompositionNonBlocking::advanceGhostCommunication(bool wait) {
+    while (ghostCommActive) {
+      if (nGhostRequests > 0) {
+        if (wait) {
+          mpi::wait_all(ghostRequests, ghostRequests + nGhostRequests);
+        } else if (!mpi::test_all(ghostRequests, ghostRequests + nGhostRequests)) {
+          return false;
+        }
+      }
+      finishGhostStage();
+      if (ghostCommStage == 3) {
+        ghostCommActive = false;
+        LOG4ESPP_DEBUG(logger, "split ghost communication finished");
+      } else {
+        postGhostStage();
+      }
+    }
+    return true;
+  }
+
   mpi::request DomainDecompositionNonBlocking::isendParticles(OutBuffer &data, ParticleList &list, longint node)
   {
     LOG4ESPP_DEBUG(logger, "initiate non blocking isend " << list.size() << " particles to " << node);
     data.reset();
     int size = list.size();
+    data.reserve(sizeof(int) + size * sizeof(Particle));
     data.write(size);
     for (ParticleList::Iterator it(list); it.isValid(); ++it) {
         removeFromLocalParticles(&(*it));
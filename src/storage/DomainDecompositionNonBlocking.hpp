@@ -34,6 +34,13 @@ namespace espressopp {
               const Int3D& _nodeGrid,
 			  const Int3D& _cellGrid);
       virtual ~DomainDecompositionNonBlocking() {}
+
+      virtual void startUpdateGhosts();
+      virtual void finishUpdateGhosts();
+      virtual void startCollectGhostForces();
+      virtual void finishCollectGhostForces();
+      virtual bool progressGhostCommunication();
+
       static void registerPython();
     protected:
       virtual void decomposeRealParticles();
@@ -41,6 +48,20 @@ namespace espressopp {
       mpi::request isendParticles(OutBuffer &data, ParticleList &list, longint node);
       mpi::request irecvParticles_initiate(InBuffer &data, longint node);
       void irecvParticles_finish(InBuffer &data, ParticleList &list);
+
+      /** Split ghost communication: the directions of one coordinate are
+          exchanged concurrently, the next coordinate is posted as soon as
+          the previous one has been unpacked (corner ghosts are forwarded
+          through several nodes). The particle exchange buffers are reused
+          for the two directions.
+      */
+      void startGhostCommunication(bool realToGhosts, int extradata);
+      /// post the exchange of the current coordinate
+      void postGhostStage();
+      /// unpack the current coordinate and advance to the next one
+      void finishGhostStage();
+      /// advance as far as possible; if wait is set, block until done
+      bool advanceGhostCommunication(bool wait);
     private:
       InBuffer inBufferL;
       InBuffer inBufferR;
@@ -48,6 +69,14 @@ namespace espressopp {
       OutBuffer outBufferR;
       InBuffer inBufferG;   // used for ghost communication
       OutBuffer outBufferG;  // used for ghost communication
+
+      // state of a split ghost communication
+      bool ghostCommActive;
+      bool ghostCommRealToGhosts;
+      int ghostCommData;
+      int ghostCommStage;    // number of coordinates done so far
+      int nGhostRequests;
+      mpi::request ghostRequests[4];
     };
   }
 }
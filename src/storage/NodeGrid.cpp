@@ -20,6 +20,7 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>. 
 */
 
+#include <algorithm>
 #include "log4espp.hpp"
 
 #include "Real3D.hpp"
@@ -43,13 +44,40 @@ namespace espressopp {
         throw NodeGridIllegal();
       }
 
+      calcNodeNeighbors(nodeId);
+
       for(int i = 0; i < 3; ++i) {
-        localBoxSize[i] = domainSize[i]/static_cast<real>(getGridSize(i));
+        real size = domainSize[i]/static_cast<real>(getGridSize(i));
+        nodeBoundaries[i].resize(getGridSize(i) + 1);
+        for (int k = 0; k <= getGridSize(i); ++k) {
+          nodeBoundaries[i][k] = k*size;
+        }
+      }
+      // only now all three axes have their boundaries
+      updateLocalBox();
+    }
+
+    void NodeGrid::setBoundaries(int axis, const std::vector<real> &b)
+    {
+      if (static_cast<int>(b.size()) != getGridSize(axis) + 1) {
+        throw std::invalid_argument("NodeGrid::setBoundaries: need one boundary more than nodes");
+      }
+      for (size_t k = 1; k < b.size(); ++k) {
+        if (b[k] <= b[k-1]) {
+          throw std::invalid_argument("NodeGrid::setBoundaries: boundaries have to be increasing");
+        }
+      }
+      nodeBoundaries[axis] = b;
+      updateLocalBox();
+    }
+
+    void NodeGrid::updateLocalBox()
+    {
+      for (int i = 0; i < 3; ++i) {
+        localBoxSize[i] = getMyRight(i) - getMyLeft(i);
         invLocalBoxSize[i] = 1.0/localBoxSize[i];
       }
       smallestLocalBoxDiameter = std::min(std::min(localBoxSize[0], localBoxSize[1]), localBoxSize[2]);
-
-      calcNodeNeighbors(nodeId);
     }
 
     longint NodeGrid::
@@ -58,7 +86,9 @@ namespace espressopp {
       Int3D cpos;
     
       for (int i = 0; i < 3; ++i) {
-        cpos[i] = static_cast< int >(pos[i]*invLocalBoxSize[i]);
+        // last boundary not above pos
+        const std::vector<real> &b = nodeBoundaries[i];
+        cpos[i] = static_cast< int >(std::upper_bound(b.begin(), b.end(), pos[i]) - b.begin()) - 1;
         if (cpos[i] < 0) {
           cpos[i] = 0;
         }
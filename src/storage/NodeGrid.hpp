@@ -29,6 +29,7 @@
 */
 
 #include <stdexcept>
+#include <vector>
 #include "types.hpp"
 #include "logging.hpp"
 #include "esutil/Grid.hpp"
@@ -49,7 +50,8 @@ namespace espressopp {
     class NodeGrid: public esutil::Grid
     {
     public:
-      NodeGrid() {}
+      NodeGrid()
+        : localBoxSize(0.0), invLocalBoxSize(0.0), smallestLocalBoxDiameter(0.0) {}
 
       /// order of node neighbors
       enum Directions {
@@ -78,14 +80,20 @@ namespace espressopp {
       /// inverse of the size of a cell
       real getInverseLocalBoxSize(int axis) const { return invLocalBoxSize[axis]; }
 
+      /** Positions of the domain boundaries along an axis, getGridSize(axis)+1
+          increasing values from 0 to the box length. Initially the box is
+          split evenly, load balancing may move the inner boundaries. */
+      const std::vector<real> &getBoundaries(int axis) const { return nodeBoundaries[axis]; }
+      void setBoundaries(int axis, const std::vector<real> &b);
+
       /// calculate start of local box
-      real getMyLeft(int axis) const { return nodePos[axis]*localBoxSize[axis]; }
+      real getMyLeft(int axis) const { return nodeBoundaries[axis][nodePos[axis]]; }
       Real3D getMyLeft() const { 
         return Real3D(getMyLeft(0), getMyLeft(1), getMyLeft(2));
       }
 
       /// calculate end of local box
-      real getMyRight(int axis) const { return (nodePos[axis] + 1)*localBoxSize[axis]; }
+      real getMyRight(int axis) const { return nodeBoundaries[axis][nodePos[axis] + 1]; }
       Real3D getMyRight() const { 
         return Real3D(getMyRight(0), getMyRight(1), getMyRight(2));
       }
@@ -121,6 +129,7 @@ namespace espressopp {
           for (int i=0; i<3; ++i) {
             localBoxSize[i] *= s;
             invLocalBoxSize[i] /= s;
+            for (size_t k = 0; k < nodeBoundaries[i].size(); ++k) nodeBoundaries[i][k] *= s;
           }
           smallestLocalBoxDiameter *= s;
         }
@@ -134,6 +143,7 @@ namespace espressopp {
           for (int i=0; i<3; ++i) {
             localBoxSize[i] *= s[i];
             invLocalBoxSize[i] /= s[i];
+            for (size_t k = 0; k < nodeBoundaries[i].size(); ++k) nodeBoundaries[i][k] *= s[i];
           }
           smallestLocalBoxDiameter = std::min(std::min(localBoxSize[0], localBoxSize[1]), localBoxSize[2]);
         }
@@ -145,6 +155,8 @@ namespace espressopp {
       
     private:
       void calcNodeNeighbors(longint node);
+      /// local box sizes of all axes from the boundaries
+      void updateLocalBox();
 
       /// position of this node in node grid
       Int3D nodePos;
@@ -152,8 +164,10 @@ namespace espressopp {
       longint nodeNeighbors[6];
       /// where to fold particles that leave local box in direction i
       int boundaries[6];
+      /// domain boundaries along each axis
+      std::vector<real> nodeBoundaries[3];
 
-      /// cell size
+      /// size of the local box
       Real3D localBoxSize;
       /// inverse domain size
       Real3D invLocalBoxSize;
@@ -0,0 +1,72 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdexcept>
+#include "PersistentExchange.hpp"
+
+namespace espressopp {
+  namespace storage {
+
+    PersistentExchange::PersistentExchange(const mpi::communicator &_comm)
+      : comm(_comm), outBuffer(_comm), inBuffer(_comm),
+        sendSize(0), recvSize(0), valid(false) {}
+
+    PersistentExchange::~PersistentExchange() {
+      // the storage may outlive MPI at the exit of the interpreter
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (!finalized) free();
+    }
+
+    void PersistentExchange::init(longint receiver, longint sender, int tag,
+                                  int _sendSize, int _recvSize) {
+      free();
+      sendSize = _sendSize;
+      recvSize = _recvSize;
+
+      // size the buffers now, their addresses must not change while the
+      // requests exist
+      outBuffer.reset();
+      outBuffer.reserve(sendSize);
+      inBuffer.prepare(recvSize);
+
+      MPI_Comm mpiComm = comm;
+      MPI_Send_init(outBuffer.getBuffer(), sendSize, MPI_BYTE, receiver, tag, mpiComm, &requests[0]);
+      MPI_Recv_init(inBuffer.getBuffer(), recvSize, MPI_BYTE, sender, tag, mpiComm, &requests[1]);
+      valid = true;
+    }
+
+    void PersistentExchange::free() {
+      if (!valid) return;
+      MPI_Request_free(&requests[0]);
+      MPI_Request_free(&requests[1]);
+      valid = false;
+    }
+
+    void PersistentExchange::exchange() {
+      if (outBuffer.getSize() != sendSize) {
+        throw std::runtime_error("PersistentExchange::exchange: packed data does not match the message size");
+      }
+      MPI_Startall(2, requests);
+      MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+      inBuffer.prepare(recvSize);
+    }
+  }
+}
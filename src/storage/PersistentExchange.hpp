@@ -0,0 +1,79 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _STORAGE_PERSISTENTEXCHANGE_HPP
+#define _STORAGE_PERSISTENTEXCHANGE_HPP
+
+#include "types.hpp"
+#include "log4espp.hpp"
+#include "mpi.hpp"
+#include "Buffer.hpp"
+
+namespace espressopp {
+  namespace storage {
+
+    /** Send/receive pair with fixed message sizes on persistent MPI
+        requests (MPI_Send_init/MPI_Recv_init), for the ghost updates
+        that repeat every step with the same amount of data. The
+        buffers are sized once in init(), so a step neither allocates
+        nor probes for the incoming message size.
+
+        Boost.MPI has no persistent requests, so this uses the C
+        interface on the communicator's MPI_Comm.
+    */
+    class PersistentExchange {
+    public:
+      PersistentExchange(const mpi::communicator &_comm);
+      ~PersistentExchange();
+
+      /** set up the requests, sendSize bytes to receiver and recvSize
+          bytes from sender */
+      void init(longint receiver, longint sender, int tag, int sendSize, int recvSize);
+      /** release the requests */
+      void free();
+      bool isValid() const { return valid; }
+
+      int getSendSize() const { return sendSize; }
+      int getRecvSize() const { return recvSize; }
+
+      /** pack exactly getSendSize() bytes into this buffer */
+      OutBuffer &getOutBuffer() { return outBuffer; }
+      /** the received message after exchange() */
+      InBuffer &getInBuffer() { return inBuffer; }
+
+      /** start both requests and wait for their completion */
+      void exchange();
+
+    private:
+      const mpi::communicator &comm;
+      OutBuffer outBuffer;
+      InBuffer inBuffer;
+      MPI_Request requests[2];
+      int sendSize, recvSize;
+      bool valid;
+
+      // non-copyable, the requests point into the buffers
+      PersistentExchange(const PersistentExchange &);
+      PersistentExchange &operator=(const PersistentExchange &);
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SpaceFillingCurve.hpp"
+
+namespace espressopp {
+  namespace storage {
+
+    uint64_t mortonKey(unsigned x, unsigned y, unsigned z, int bits) {
+      uint64_t key = 0;
+      for (int b = bits - 1; b >= 0; --b) {
+        key = (key << 3)
+          | (uint64_t((x >> b) & 1) << 2)
+          | (uint64_t((y >> b) & 1) << 1)
+          |  uint64_t((z >> b) & 1);
+      }
+      return key;
+    }
+
+    uint64_t hilbertKey(unsigned x, unsigned y, unsigned z, int bits) {
+      unsigned X[3] = { x, y, z };
+      const unsigned M = 1u << (bits - 1);
+
+      // inverse undo excess work
+      for (unsigned Q = M; Q > 1; Q >>= 1) {
+        unsigned P = Q - 1;
+        for (int i = 0; i < 3; ++i) {
+          if (X[i] & Q) {
+            X[0] ^= P;
+          } else {
+            unsigned t = (X[0] ^ X[i]) & P;
+            X[0] ^= t;
+            X[i] ^= t;
+          }
+        }
+      }
+
+      // gray encode
+      for (int i = 1; i < 3; ++i) X[i] ^= X[i-1];
+      unsigned t = 0;
+      for (unsigned Q = M; Q > 1; Q >>= 1) {
+        if (X[2] & Q) t ^= Q - 1;
+      }
+      for (int i = 0; i < 3; ++i) X[i] ^= t;
+
+      // the transposed coordinates interleaved give the key
+      return mortonKey(X[0], X[1], X[2], bits);
+    }
+
+    uint64_t curveKey(int curve, unsigned x, unsigned y, unsigned z, int bits) {
+      switch (curve) {
+      case MortonCurve:
+        return mortonKey(x, y, z, bits);
+      case HilbertCurve:
+        return hilbertKey(x, y, z, bits);
+      default:
+        return 0;
+      }
+    }
+
+  }
+}
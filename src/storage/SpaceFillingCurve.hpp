@@ -0,0 +1,51 @@
+/*
+  Copyright (C) 2017
+      Max Planck Institute for Polymer Research
+
+  This file is part of ESPResSo++.
+
+  ESPResSo++ is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo++ is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// ESPP_CLASS
+#ifndef _STORAGE_SPACEFILLINGCURVE_HPP
+#define _STORAGE_SPACEFILLINGCURVE_HPP
+
+#include <stdint.h>
+
+namespace espressopp {
+  namespace storage {
+
+    /** Space-filling curves used to order cells and particles so that
+        neighbors in space are close in memory. */
+    enum SpaceFillingCurve {
+      NoCurve = 0,
+      MortonCurve = 1,
+      HilbertCurve = 2
+    };
+
+    /** Position of the grid point (x, y, z) along the given curve. The
+        coordinates must be smaller than 2^bits, bits is at most 21. */
+    uint64_t curveKey(int curve, unsigned x, unsigned y, unsigned z, int bits);
+
+    /** Morton (Z-order) key: the bits of x, y and z interleaved. */
+    uint64_t mortonKey(unsigned x, unsigned y, unsigned z, int bits);
+
+    /** Hilbert key after J. Skilling, "Programming the Hilbert curve",
+        AIP Conf. Proc. 707, 381 (2004). */
+    uint64_t hilbertKey(unsigned x, unsigned y, unsigned z, int bits);
+
+  }
+}
+#endif
@@ -37,7 +37,10 @@
 #include "esutil/Error.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
 #include <boost/unordered/unordered_map.hpp>
+#include <boost/unordered/unordered_set.hpp>
 using namespace std;
 
 using namespace boost;
@@ -56,7 +59,8 @@ namespace espressopp {
     Storage::Storage(shared_ptr< System > system)
       : SystemAccess(system),
         inBuffer(*system->comm),
-        outBuffer(*system->comm)
+        outBuffer(*system->comm),
+        curve(NoCurve)
     {
       //logger.setLevel(log4espp::Logger::TRACE);
       LOG4ESPP_INFO(logger, "Created new storage object for a system, has buffers");
@@ -280,6 +284,119 @@ namespace espressopp {
 
       return &cell->particles.back();
     }
+
+    longint Storage::insertParticles(ParticleList &pl) {
+      std::vector<bool> touched(localCells.size(), false);
+      // the new particles are indexed only at the end, so the ids of
+      // this batch are tracked separately
+      boost::unordered_set< size_t > batch;
+      longint n = 0;
+      for (ParticleList::Iterator it(pl); it.isValid(); ++it) {
+        if (lookupRealParticle(it->id()) || !batch.insert(it->id()).second) {
+          LOG4ESPP_WARN(logger, "particle " << it->id() << " exists already, not inserted");
+          continue;
+        }
+        Cell *cell = mapPositionToCellClipped(it->position());
+        appendUnindexedParticle(cell->particles, *it);
+        touched[cell - getFirstCell()] = true;
+        n++;
+      }
+
+      // appending may have moved the particles of a cell, so index
+      // the cells only now
+      for (size_t c = 0; c < touched.size(); ++c) {
+        if (touched[c]) updateLocalParticles(localCells[c]->particles);
+      }
+      return n;
+    }
+
+    namespace {
+      // all-to-all exchange of one buffer per node
+      void exchangeIds(mpi::communicator &comm,
+                       std::vector< std::vector< longint > > &send,
+                       std::vector< std::vector< longint > > &recv) {
+        int nprocs = comm.size();
+        int rank = comm.rank();
+        std::vector< int > sendCounts(nprocs), recvCounts(nprocs);
+        for (int r = 0; r < nprocs; ++r) sendCounts[r] = send[r].size();
+        mpi::all_to_all(comm, sendCounts, recvCounts);
+
+        const int tag = 0x6d2;
+        recv.assign(nprocs, std::vector< longint >());
+        std::vector< mpi::request > requests;
+        for (int r = 0; r < nprocs; ++r) {
+          if (r == rank) continue;
+          if (recvCounts[r] > 0) {
+            recv[r].resize(recvCounts[r]);
+            requests.push_back(comm.irecv(r, tag, &recv[r][0], recvCounts[r]));
+          }
+          if (sendCounts[r] > 0) {
+            requests.push_back(comm.isend(r, tag, &send[r][0], sendCounts[r]));
+          }
+        }
+        mpi::wait_all(requests.begin(), requests.end());
+        recv[rank].swap(send[rank]);
+      }
+    }
+
+    void Storage::routeTuples(std::vector< longint > &tuples, int width, int key) {
+      mpi::communicator &comm = *getSystem()->comm;
+      int nprocs = comm.size();
+      std::vector< std::vector< longint > > send(nprocs), recv;
+
+      // directory: node id % nprocs knows the owner of id
+      for (CellListIterator it(realCells); !it.isDone(); ++it) {
+        send[it->id() % nprocs].push_back(it->id());
+      }
+      exchangeIds(comm, send, recv);
+      boost::unordered_map< longint, int > owner;
+      for (int r = 0; r < nprocs; ++r) {
+        for (size_t i = 0; i < recv[r].size(); ++i) owner[recv[r][i]] = r;
+      }
+
+      // the tuples go to the directory of their key particle ...
+      send.assign(nprocs, std::vector< longint >());
+      for (size_t t = 0; t < tuples.size(); t += width) {
+        std::vector< longint > &buf = send[tuples[t + key] % nprocs];
+        buf.insert(buf.end(), tuples.begin() + t, tuples.begin() + t + width);
+      }
+      exchangeIds(comm, send, recv);
+
+      // ... which forwards them to the owner
+      send.assign(nprocs, std::vector< longint >());
+      for (int r = 0; r < nprocs; ++r) {
+        for (size_t t = 0; t < recv[r].size(); t += width) {
+          boost::unordered_map< longint, int >::const_iterator it = owner.find(recv[r][t + key]);
+          if (it == owner.end()) continue;
+          std::vector< longint > &buf = send[it->second];
+          buf.insert(buf.end(), recv[r].begin() + t, recv[r].begin() + t + width);
+        }
+      }
+      exchangeIds(comm, send, recv);
+
+      tuples.clear();
+      for (int r = 0; r < nprocs; ++r) tuples.insert(tuples.end(), recv[r].begin(), recv[r].end());
+    }
+
+    longint Storage::countRepeatedIds(const std::vector< longint > &ids) {
+      mpi::communicator &comm = *getSystem()->comm;
+      int nprocs = comm.size();
+      std::vector< std::vector< longint > > send(nprocs), recv;
+
+      // node id % nprocs sees all copies of id
+      for (size_t i = 0; i < ids.size(); ++i) send[ids[i] % nprocs].push_back(ids[i]);
+      exchangeIds(comm, send, recv);
+      boost::unordered_set< longint > seen;
+      longint repeated = 0;
+      for (int r = 0; r < nprocs; ++r) {
+        for (size_t i = 0; i < recv[r].size(); ++i) {
+          if (!seen.insert(recv[r][i]).second) repeated++;
+        }
+      }
+      longint total;
+      mpi::all_reduce(comm, repeated, total, std::plus< longint >());
+      return total;
+    }
     
     int Storage::removeParticle(longint id){
       Particle* p = lookupRealParticle(id);
@@ -496,6 +613,7 @@ namespace espressopp {
 
       data.reset();
       int size = list.size();
+      data.reserve(sizeof(int) + size * sizeof(Particle));
       data.write(size);
       for (ParticleList::Iterator it(list); it.isValid(); ++it) {
           removeFromLocalParticles(&(*it));
@@ -555,10 +673,78 @@ namespace espressopp {
     void Storage::decompose() {
       invalidateGhosts();
       decomposeRealParticles();
+      // sort before the ghost exchange, the ghosts then follow the same order
+      sortRealParticles();
       exchangeGhosts();
       onParticlesChanged();
     }
 
+    void Storage::setSpaceFillingCurve(const std::string &_curve) {
+      if (_curve == "none") {
+        curve = NoCurve;
+      } else if (_curve == "morton") {
+        curve = MortonCurve;
+      } else if (_curve == "hilbert") {
+        curve = HilbertCurve;
+      } else {
+        throw std::invalid_argument("unknown space-filling curve '" + _curve +
+                                    "', use 'none', 'morton' or 'hilbert'");
+      }
+      // the particles are sorted on the next decompose(), the cells right
+      // away, which invalidates the lists built over the old cell order
+      sortRealCells();
+      onParticlesChanged();
+    }
+
+    std::string Storage::getSpaceFillingCurve() const {
+      switch (curve) {
+      case MortonCurve:  return "morton";
+      case HilbertCurve: return "hilbert";
+      default:           return "none";
+      }
+    }
+
+    void Storage::sortRealParticles() {
+      if (curve == NoCurve) return;
+
+      // 2^10 grid points per dimension of the local box
+      const int bits = 10;
+      const unsigned maxCoord = (1u << bits) - 1;
+      const real lo[3] = { getLocalBoxXMin(), getLocalBoxYMin(), getLocalBoxZMin() };
+      const real hi[3] = { getLocalBoxXMax(), getLocalBoxYMax(), getLocalBoxZMax() };
+      real scale[3];
+      for (int d = 0; d < 3; ++d) {
+        scale[d] = hi[d] > lo[d] ? (maxCoord + 1) / (hi[d] - lo[d]) : 0.0;
+      }
+
+      std::vector< std::pair<uint64_t, size_t> > keys;
+      ParticleList sorted;
+      for (CellList::Iterator it(getRealCells()); it.isValid(); ++it) {
+        ParticleList &pl = (*it)->particles;
+        if (pl.size() < 2) continue;
+
+        keys.resize(pl.size());
+        for (size_t k = 0; k < pl.size(); ++k) {
+          const Real3D &pos = pl[k].position();
+          unsigned q[3];
+          for (int d = 0; d < 3; ++d) {
+            real x = (pos[d] - lo[d]) * scale[d];
+            q[d] = x <= 0.0 ? 0 : std::min(maxCoord, unsigned(x));
+          }
+          keys[k] = std::make_pair(curveKey(curve, q[0], q[1], q[2], bits), k);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        sorted.clear();
+        sorted.reserve(pl.size());
+        for (size_t k = 0; k < keys.size(); ++k) {
+          sorted.push_back(pl[keys[k].second]);
+        }
+        pl.swap(sorted);
+        updateLocalParticles(pl);
+      }
+    }
+
     void Storage::packPositionsEtc(OutBuffer &buf,
 				   Cell &_reals, int extradata, const Real3D& shift) {
       ParticleList &reals  = _reals.particles;
@@ -572,6 +758,7 @@ namespace espressopp {
       LOG4ESPP_DEBUG(logger, "positions are shifted by "
 		     << shift[0] << "," << shift[1] << "," << shift[2]);
 
+      buf.reserve(reals.size() * Buffer::particleDataSize(extradata));
       for(ParticleList::iterator src = reals.begin(), end = reals.end(); src != end; ++src) {
 
         buf.write(*src, extradata, shift);
@@ -632,6 +819,7 @@ namespace espressopp {
 
       ParticleList &ghosts = _ghosts.particles;
   
+      buf.reserve(ghosts.size() * sizeof(ParticleForce));
       for(ParticleList::iterator src = ghosts.begin(), end = ghosts.end(); src != end; ++src) {
 
         buf.write(src->particleForce());
@@ -765,6 +953,7 @@ namespace espressopp {
 	    .def("decompose", &Storage::decompose)
 	    .def("getRealParticleIDs", &Storage::getRealParticleIDs)
         .add_property("system", &Storage::getSystem)
+        .add_property("spaceFillingCurve", &Storage::getSpaceFillingCurve, &Storage::setSpaceFillingCurve)
 	    ;
     }
   }
@@ -35,6 +35,7 @@
 #include "log4espp.hpp"
 #include "FixedTupleListAdress.hpp"
 #include "Cell.hpp"
+#include "SpaceFillingCurve.hpp"
 #include "Buffer.hpp"
 #include "types.hpp"
 
@@ -63,6 +64,11 @@ namespace espressopp {
       
       /** It should be used at the place where is the possibility of cell size<cutoff+skin*/
       virtual void cellAdjust() = 0;
+
+      /** Balance the load over the nodes, see DomainDecomposition.
+          Storages with fixed domains do nothing.
+          \return max/mean load before balancing */
+      virtual real loadBalance(real load, real relax) { return 1.0; }
       
       /** It should return cell grid as an integer vector*/
       virtual Int3D getInt3DCellGrid() =0;
@@ -81,6 +87,26 @@ namespace espressopp {
       */
       Particle* addParticle(longint id, const Real3D& pos);
 
+      /** append particles that belong to this node to their cells,
+	  localParticles is updated once per cell instead of once per
+	  particle. The positions have to be folded. Particles whose id
+	  is already stored here or appeared before in pl are skipped.
+	  \return number of particles added
+      */
+      longint insertParticles(ParticleList &pl);
+
+      /** number of ids that occur more than once in the ids of all
+	  nodes. Collective.
+      */
+      longint countRepeatedIds(const std::vector< longint > &ids);
+
+      /** send tuples of particle ids (width ids each) to the node that
+	  owns the id in column key. A directory, where node id % nprocs
+	  knows the owner of id, is built from the real particles; tuples
+	  with an unknown key are dropped. Collective.
+      */
+      void routeTuples(std::vector< longint > &tuples, int width, int key);
+
       // remove particle from the system
       int removeParticle(longint id);
       
@@ -172,6 +198,13 @@ namespace espressopp {
 
       python::list getRealParticleIDs();
 
+      /** Order the real cells and the real particles within each cell
+          along a space-filling curve ("morton" or "hilbert") on every
+          decompose(), or keep the plain arrival order ("none", default).
+      */
+      void setSpaceFillingCurve(const std::string &_curve);
+      std::string getSpaceFillingCurve() const;
+
       const Cell* getFirstCell() const { return &(cells[0]); }
 
       /** map a position to a valid cell on this node. Used for AdResS */
@@ -228,6 +261,21 @@ namespace espressopp {
       */
       virtual void collectGhostForces() = 0;
 
+      /** Split variants of updateGhosts() and collectGhostForces() for
+          overlapping the ghost communication with computation. Between
+          start and finish the caller may only read the positions and
+          write the forces of real particles, and should call
+          progressGhostCommunication() now and then; it returns true
+          once the communication is complete. Storages without
+          non-blocking ghost communication do all the work in
+          startUpdateGhosts() and finishCollectGhostForces().
+      */
+      virtual void startUpdateGhosts() { updateGhosts(); }
+      virtual void finishUpdateGhosts() {}
+      virtual void startCollectGhostForces() {}
+      virtual void finishCollectGhostForces() { collectGhostForces(); }
+      virtual bool progressGhostCommunication() { return true; }
+
       /** Ths signal will be called whenever the storage was modified
 	  such that particle pointers have become invalid, e.g. at the
 	  end of decompose().  Classes that connect to this signal can
@@ -416,6 +464,14 @@ namespace espressopp {
       void restorePositions();
       void clearSavedPositions();
 
+      /// sort the particles of each real cell along the space-filling curve
+      void sortRealParticles();
+      /** order the list of real cells along the space-filling curve, or
+          restore the plain grid order if no curve is set */
+      virtual void sortRealCells() {}
+      /// one of the SpaceFillingCurve values
+      int curve;
+
     private:
       // map particle id to Particle * for all particles on this node
       boost::unordered_map<longint, Particle*> localParticles;
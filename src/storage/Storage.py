@@ -91,6 +91,17 @@ All derived classes implement at least the following methods:
 
   The property 'system' returns the System object of the storage.
 
+* 'spaceFillingCurve':
+
+  Order of the real particles in memory. With 'morton' or 'hilbert', the
+  real cells and the particles within each cell are sorted along that
+  space-filling curve on every decompose, so that particles close in space
+  are close in memory. Particle pointers, the local particle map and all
+  fixed tuple lists are updated as after any other resort. Default is
+  'none', which keeps the arrival order.
+
+  >>> system.storage.spaceFillingCurve = 'hilbert'
+
 Examples:
 
 >>> s.storage.addParticles([[1, espressopp.Real3D(3,3,3)], [2, espressopp.Real3D(4,4,4)]],'id','pos')
@@ -421,7 +432,7 @@ if pmi.isController:
         __metaclass__ = pmi.Proxy
         pmiproxydefs = dict(
             pmicall = [ "decompose", "addParticles", "setFixedTuplesAdress", "removeAllParticles"],
-            pmiproperty = [ "system" ],
+            pmiproperty = [ "system", "spaceFillingCurve" ],
             pmiinvoke = ["getRealParticleIDs", "printRealParticles"]
             )
 
@@ -128,6 +128,94 @@ class TestLangevinThermostat(unittest.TestCase):
         self.assertNotEqual(before[7], after[7])
         self.assertNotEqual(before[8], after[8])
 
+    def run_counterRNG(self, order, seed=1, reseed=None):
+        system = espressopp.System()
+        system.rng = espressopp.esutil.RNG()
+        system.rng.seed(seed)
+        system.bc = espressopp.bc.OrthorhombicBC(system.rng, (10, 10, 10))
+        system.skin = 0.3
+        system.comm = MPI.COMM_WORLD
+        nodeGrid = espressopp.tools.decomp.nodeGrid(espressopp.MPI.COMM_WORLD.size)
+        cellGrid = espressopp.tools.decomp.cellGrid((10, 10, 10), nodeGrid, 1.5, 0.3)
+        system.storage = espressopp.storage.DomainDecomposition(system, nodeGrid, cellGrid)
+
+        # particles in the same cell, added in the given order
+        particle_list = [
+            (1, 1, espressopp.Real3D(5.5, 5.0, 5.0), 1.0),
+            (2, 1, espressopp.Real3D(5.7, 5.0, 5.0), 1.0),
+            (3, 1, espressopp.Real3D(5.9, 5.0, 5.0), 1.0),
+        ]
+        system.storage.addParticles([particle_list[i] for i in order], 'id', 'type', 'pos', 'mass')
+        system.storage.decompose()
+
+        integrator = espressopp.integrator.VelocityVerlet(system)
+        integrator.dt = 0.01
+        langevin = espressopp.integrator.LangevinThermostat(system)
+        langevin.gamma = 1.0
+        langevin.temperature = 1.0
+        langevin.counterRNG = True
+        integrator.addExtension(langevin)
+        if reseed is not None:
+            system.rng.seed(reseed)
+        integrator.run(10)
+        return [system.storage.getParticle(i).pos[j] for i in range(1,4) for j in range(3)]
+
+    def test_counterRNG(self):
+        # the noise of a particle must not depend on the order in which the
+        # particles are stored
+        first = self.run_counterRNG([0, 1, 2])
+        second = self.run_counterRNG([2, 0, 1])
+        for a, b in zip(first, second):
+            self.assertAlmostEqual(a, b, places=10)
+        self.assertNotEqual(first[0], 5.5)
+
+    def test_counterRNG_reseed(self):
+        # the counter RNG takes the seed of system.rng at the start of the run
+        reseeded = self.run_counterRNG([0, 1, 2], seed=1, reseed=2)
+        seeded = self.run_counterRNG([0, 1, 2], seed=2)
+        for a, b in zip(reseeded, seeded):
+            self.assertAlmostEqual(a, b, places=10)
+        self.assertNotEqual(reseeded, self.run_counterRNG([0, 1, 2], seed=1))
+
+    def test_baoab(self):
+        nodeGrid = espressopp.tools.decomp.nodeGrid(espressopp.MPI.COMM_WORLD.size)
+        cellGrid = espressopp.tools.decomp.cellGrid((10, 10, 10), nodeGrid, 1.5, 0.3)
+        self.system.storage = espressopp.storage.DomainDecomposition(self.system, nodeGrid, cellGrid)
+
+        # ideal gas, the first particle is excluded from thermostating
+        particle_list = [(pid, 0, espressopp.Real3D(0.5 + pid % 10, 0.5 + pid / 10 % 10, 0.5 + pid / 100), 1.0)
+                         for pid in range(1, 301)]
+        self.system.storage.addParticles(particle_list, 'id', 'type', 'pos', 'mass')
+        self.system.storage.decompose()
+
+        integrator = espressopp.integrator.VelocityVerlet(self.system)
+        integrator.dt = 0.01
+        langevin = espressopp.integrator.LangevinThermostat(self.system)
+        langevin.gamma = 1.0
+        langevin.temperature = 1.0
+        langevin.baoab = True
+        langevin.addExclusions([1])
+        integrator.addExtension(langevin)
+
+        # the excluded particle keeps its velocity and moves ballistically
+        v = espressopp.Real3D(0.1, 0.2, 0.3)
+        self.system.storage.modifyParticle(1, 'v', v)
+        before = self.system.storage.getParticle(1).pos
+        integrator.run(500)
+        temperature = espressopp.analysis.Temperature(self.system)
+        T = 0.0
+        for i in range(40):
+            integrator.run(25)
+            T += temperature.compute() / 40
+        after = self.system.storage.getParticle(1).pos
+
+        self.assertEqual(self.system.storage.getParticle(1).v, v)
+        for d in range(3):
+            self.assertAlmostEqual(after[d], before[d] + 1500 * 0.01 * v[d], places=8)
+        # 40 samples over 10 time units of 300 particles, sigma about 0.01
+        self.assertAlmostEqual(T, 1.0, delta=0.04)
+
+
 
 if __name__ == '__main__':
     unittest.main()
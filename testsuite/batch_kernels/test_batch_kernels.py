@@ -0,0 +1,40 @@
+import espressopp
+import lattice_fixture as fixture
+import unittest
+
+rc = fixture.rc
+
+potentials = {
+    'LennardJones': lambda: espressopp.interaction.LennardJones(epsilon=1., sigma=0.5, cutoff=rc),
+    'LennardJonesGeneric': lambda: espressopp.interaction.LennardJonesGeneric(epsilon=1., sigma=0.5, a=12, b=6, cutoff=rc),
+    'Morse': lambda: espressopp.interaction.Morse(epsilon=1., alpha=2., rMin=0.8, cutoff=rc),
+}
+
+class TestBatchKernels(unittest.TestCase):
+    def run_system(self, name, batched, compact):
+        system, integrator = fixture.default_system()
+        fixture.add_particles(system)
+
+        vl = espressopp.VerletList(system, cutoff=rc)
+        vl.compact = compact
+        inter = getattr(espressopp.interaction, 'VerletList' + name)(vl)
+        inter.setPotential(type1=0, type2=0, potential=potentials[name]())
+        if not batched:
+            # the batch kernel only runs for a single particle type, a
+            # potential for the unused type 1 selects the per-pair loop
+            inter.setPotential(type1=1, type2=1, potential=potentials[name]())
+        system.addInteraction(inter)
+
+        integrator.run(10)
+        return inter.computeEnergy(), fixture.forces(system)
+
+    def test_batched(self):
+        for name in sorted(potentials):
+            for compact in [False, True]:
+                energy_ref, forces_ref = self.run_system(name, False, compact)
+                energy, forces = self.run_system(name, True, compact)
+                self.assertAlmostEqual(energy / energy_ref, 1.0, places=10)
+                fixture.assertForcesEqual(self, forces, forces_ref, 1e-8)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,87 @@
+import espressopp
+import numpy as np
+import os
+import tempfile
+import unittest
+
+L             = 10.
+box           = (L, L, L)
+num_chains    = 20
+chain_length  = 10
+num_particles = num_chains * chain_length
+
+class TestBulkLoader(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.01, temperature=1.)
+        self.system = system
+
+        # straight chains along x with bonds of length 0.9, partly outside the box
+        rng = np.random.RandomState(4711)
+        self.ids = np.arange(1, num_particles + 1)
+        start = rng.uniform(0, L, (num_chains, 3))
+        self.pos = np.array([start[c] + [0.9 * i, 0, 0] for c in range(num_chains) for i in range(chain_length)])
+        self.types = self.ids % 3
+        self.masses = rng.uniform(1, 2, num_particles)
+        self.v = rng.normal(size=(num_particles, 3))
+        self.bonds = np.array([(c * chain_length + i + 1, c * chain_length + i + 2)
+                               for c in range(num_chains) for i in range(chain_length - 1)])
+
+    def check_particles(self):
+        for i in range(num_particles):
+            p = self.system.storage.getParticle(int(self.ids[i]))
+            self.assertEqual(p.type, self.types[i])
+            self.assertAlmostEqual(p.mass, self.masses[i], places=12)
+            for j in range(3):
+                self.assertAlmostEqual(p.v[j], self.v[i][j], places=12)
+                folded = self.pos[i][j] - L * np.floor(self.pos[i][j] / L)
+                self.assertAlmostEqual(p.pos[j], folded, places=10)
+
+    def test_arrays(self):
+        reader = espressopp.io.ReadNumpy(self.system)
+        n = reader.load_particles(self.ids, self.pos, types=self.types, masses=self.masses, v=self.v)
+        self.assertEqual(n, num_particles)
+        self.system.storage.decompose()
+        self.check_particles()
+
+        fpl = espressopp.FixedPairList(self.system.storage)
+        n = reader.load_bonds(fpl, self.bonds)
+        self.assertEqual(n, len(self.bonds))
+        self.assertEqual(fpl.totalSize(), len(self.bonds))
+
+        # the same ids again are rejected
+        self.assertRaises(Exception, reader.load_particles, self.ids, self.pos)
+
+    def test_repeated_ids(self):
+        reader = espressopp.io.ReadNumpy(self.system)
+        # a repeated row, and a repeated id at another position, which
+        # goes to another node
+        for other in [self.pos[0], self.pos[0] + [L / 2, L / 2, L / 2]]:
+            ids = np.append(self.ids, self.ids[0])
+            pos = np.vstack([self.pos, other])
+            self.assertRaises(Exception, reader.load_particles, ids, pos)
+
+        # nothing was added
+        n = reader.load_particles(self.ids, self.pos, types=self.types, masses=self.masses, v=self.v)
+        self.assertEqual(n, num_particles)
+        self.system.storage.decompose()
+        self.check_particles()
+
+    def test_npy_files(self):
+        tmpdir = tempfile.mkdtemp()
+        files = {}
+        for name in ['ids', 'pos', 'types', 'masses', 'v', 'bonds']:
+            files[name] = os.path.join(tmpdir, name + '.npy')
+            np.save(files[name], getattr(self, name))
+
+        reader = espressopp.io.ReadNumpy(self.system)
+        reader.load_particles(files['ids'], files['pos'], types=files['types'],
+                              masses=files['masses'], v=files['v'])
+        self.system.storage.decompose()
+        self.check_particles()
+
+        fpl = espressopp.FixedPairList(self.system.storage)
+        reader.load_bonds(fpl, files['bonds'])
+        self.assertEqual(fpl.totalSize(), len(self.bonds))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,137 @@
+import espressopp
+import os
+import random
+import shutil
+import tempfile
+import unittest
+
+L            = 8.
+box          = (L, L, L)
+num_chains   = 16
+chain_length = 8
+
+def make_system():
+    # without thermostat, so that the order of the particles does not matter
+    system, integrator = espressopp.standard_system.Default(box, rc=2.5, skin=0.3, dt=0.005)
+    system.rng.seed(12345)
+
+    bonds, angles = [], []
+    for c in range(num_chains):
+        for i in range(chain_length - 1):
+            pid = c * chain_length + i + 1
+            bonds.append((pid, pid + 1))
+            if i < chain_length - 2:
+                angles.append((pid, pid + 1, pid + 2))
+
+    vl = espressopp.VerletList(system, cutoff=2.5, exclusionlist=bonds)
+    lj = espressopp.interaction.VerletListLennardJones(vl)
+    lj.setPotential(type1=0, type2=0, potential=espressopp.interaction.LennardJones(1.0, 1.0, cutoff=2.5, shift='auto'))
+    system.addInteraction(lj)
+    fpl = espressopp.FixedPairList(system.storage)
+    harmonic = espressopp.interaction.FixedPairListHarmonic(system, fpl, espressopp.interaction.Harmonic(K=30., r0=1.0))
+    system.addInteraction(harmonic)
+    ftl = espressopp.FixedTripleList(system.storage)
+    return system, integrator, vl, fpl, ftl, bonds, angles
+
+def positions(system):
+    n = num_chains * chain_length
+    return [system.storage.getParticle(pid).pos for pid in range(1, n + 1)]
+
+class TestCheckpoint(unittest.TestCase):
+    def setUp(self):
+        self.tmpdir = tempfile.mkdtemp()
+        self.filename = os.path.join(self.tmpdir, 'state.chk')
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def checkpoint(self, system, integrator, vl, fpl, ftl):
+        checkpoint = espressopp.io.Checkpoint(system, integrator)
+        checkpoint.add(fpl)
+        checkpoint.add(ftl)
+        checkpoint.add(vl)
+        return checkpoint
+
+    def test_restart(self):
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        random.seed(4711)
+        particles = []
+        for c in range(num_chains):
+            x0 = espressopp.Real3D(c % 4 * 2.0, c / 4 * 2.0, 0.5)
+            for i in range(chain_length):
+                v = espressopp.Real3D(*[random.gauss(0, 1) for d in range(3)])
+                particles.append([c * chain_length + i + 1, x0 + espressopp.Real3D(0.3, 0.3, i * 1.0), v])
+        system.storage.addParticles(particles, 'id', 'pos', 'v')
+        system.storage.decompose()
+        fpl.addBonds(bonds)
+        ftl.addTriples(angles)
+
+        integrator.run(200)
+        checkpoint = self.checkpoint(system, integrator, vl, fpl, ftl)
+        checkpoint.write(self.filename)
+        random_numbers = [system.rng() for i in range(5)]
+        integrator.run(100)
+        reference = positions(system)
+        reference_step = integrator.step
+
+        # a fresh system continues from the checkpoint
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        checkpoint = self.checkpoint(system, integrator, vl, fpl, ftl)
+        n = checkpoint.read(self.filename)
+        self.assertEqual(n, num_chains * chain_length)
+        self.assertEqual(integrator.step, 200)
+        self.assertEqual(fpl.totalSize(), len(bonds))
+        self.assertEqual(ftl.totalSize(), len(angles))
+        self.assertEqual(vl.excludeListSize(), 2 * len(bonds))
+        self.assertEqual([system.rng() for i in range(5)], random_numbers)
+
+        integrator.run(100)
+        self.assertEqual(integrator.step, reference_step)
+        for p, q in zip(positions(system), reference):
+            for d in range(3):
+                self.assertAlmostEqual(p[d], q[d], places=8)
+
+    def test_generations(self):
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        system.storage.addParticles([[1, espressopp.Real3D(1, 1, 1)], [2, espressopp.Real3D(5, 5, 5)]], 'id', 'pos')
+        system.storage.decompose()
+        checkpoint = self.checkpoint(system, integrator, vl, fpl, ftl)
+        nprocs = espressopp.MPI.COMM_WORLD.size
+        def files(generation):
+            return sorted(['state.chk'] + ['state.chk.%d.%d' % (generation, r) for r in range(nprocs)])
+
+        checkpoint.write(self.filename)
+        self.assertEqual(sorted(os.listdir(self.tmpdir)), files(1))
+
+        # an interrupted write leaves partial files of the next generation,
+        # which the metadata does not refer to
+        with open(os.path.join(self.tmpdir, 'state.chk.2.0'), 'wb') as f:
+            f.write('partial')
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        self.assertEqual(self.checkpoint(system, integrator, vl, fpl, ftl).read(self.filename), 2)
+
+        # the next write replaces them, and removes the previous generation
+        checkpoint.write(self.filename)
+        self.assertEqual(sorted(os.listdir(self.tmpdir)), files(2))
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        self.assertEqual(self.checkpoint(system, integrator, vl, fpl, ftl).read(self.filename), 2)
+
+    def test_mismatch(self):
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        system.storage.addParticles([[1, espressopp.Real3D(1, 1, 1)]], 'id', 'pos')
+        self.checkpoint(system, integrator, vl, fpl, ftl).write(self.filename)
+
+        # other lists registered
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        checkpoint = espressopp.io.Checkpoint(system, integrator)
+        checkpoint.add(fpl)
+        self.assertRaises(Exception, checkpoint.read, self.filename)
+
+        # particles exist already
+        system, integrator, vl, fpl, ftl, bonds, angles = make_system()
+        system.storage.addParticles([[1, espressopp.Real3D(1, 1, 1)]], 'id', 'pos')
+        checkpoint = self.checkpoint(system, integrator, vl, fpl, ftl)
+        self.assertRaises(Exception, checkpoint.read, self.filename)
+
+if __name__ == '__main__':
+    unittest.main()
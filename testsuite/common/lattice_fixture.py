@@ -0,0 +1,73 @@
+"""Shared setup of the short range force tests: 400 Lennard-Jones
+particles on a jittered simple cubic lattice in a cubic box of 8, with
+cutoff 2.5. Every particle has many neighbours, but no two overlap, so
+the forces are moderate and two runs can be compared pair by pair.
+
+The tests only keep what they compare, e.g.
+
+>>> system, integrator = lattice_fixture.default_system()
+>>> lattice_fixture.add_particles(system)
+>>> vl, interLJ = lattice_fixture.verlet_lj(system)
+>>> integrator.run(10)
+>>> forces = lattice_fixture.forces(system)
+"""
+
+import espressopp
+import random
+
+L              = 8.
+box            = (L, L, L)
+rc             = 2.5
+skin           = 0.3
+num_particles  = 400
+
+def default_system(dt=0.001, temperature=None):
+    """a standard system for the lattice; without temperature there is no
+    thermostat and two runs are deterministic"""
+    return espressopp.standard_system.Default(box, rc=rc, skin=skin, dt=dt, temperature=temperature)
+
+def add_particles(system, type_of=None, velocity=None, jitter=0.1):
+    """adds the particles, displaced at random by up to jitter from the
+    lattice sites, always with the same seed, and decomposes.
+    type_of(pid) gives the type (0 by default), velocity a gaussian
+    velocity of that width per component."""
+    random.seed(4711)
+    particle_list = []
+    for pid in range(1, num_particles+1):
+        i = pid - 1
+        pos = espressopp.Real3D(i % 8 + 0.5 + random.uniform(-jitter, jitter),
+                                (i / 8) % 8 + 0.5 + random.uniform(-jitter, jitter),
+                                i / 64 + 0.5 + random.uniform(-jitter, jitter))
+        particle = [pid, type_of(pid) if type_of else 0, pos]
+        if velocity is not None:
+            particle.append(espressopp.Real3D(random.gauss(0, velocity), random.gauss(0, velocity),
+                                              random.gauss(0, velocity)))
+        particle_list.append(particle)
+    if velocity is not None:
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos', 'v')
+    else:
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+    system.storage.decompose()
+
+def lennard_jones(shift='auto'):
+    return espressopp.interaction.LennardJones(epsilon=1., sigma=0.5, cutoff=rc, shift=shift)
+
+def verlet_lj(system, compact=False, shift='auto', add=True):
+    """a Verlet list and a Lennard-Jones interaction of type 0 on it,
+    added to the system unless add is False"""
+    vl = espressopp.VerletList(system, cutoff=rc)
+    vl.compact = compact
+    interLJ = espressopp.interaction.VerletListLennardJones(vl)
+    interLJ.setPotential(type1=0, type2=0, potential=lennard_jones(shift))
+    if add:
+        system.addInteraction(interLJ)
+    return vl, interLJ
+
+def forces(system):
+    return [system.storage.getParticle(pid).f for pid in range(1, num_particles+1)]
+
+def assertForcesEqual(test, forces, forces_ref, rel):
+    """every force component agrees to rel, relative to 1 + |f_ref|"""
+    for f, f_ref in zip(forces, forces_ref):
+        for d in range(3):
+            test.assertAlmostEqual(f[d], f_ref[d], delta=rel * (1. + abs(f_ref[d])))
@@ -0,0 +1,61 @@
+import espressopp
+import os
+import shutil
+import tempfile
+import unittest
+
+L             = 6.
+box           = (L, L, L)
+num_particles = 200
+
+class TestConfigurations(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.005, temperature=1.)
+        system.rng.seed(4711)
+        # ids with gaps, some positions outside of the box
+        particles = [[2 * pid + 1, system.bc.getRandomPos() + espressopp.Real3D(L * (pid % 3), 0, 0), 1. + 0.1 * (pid % 2)]
+                     for pid in range(num_particles)]
+        system.storage.addParticles(particles, 'id', 'pos', 'radius')
+        system.storage.decompose()
+        integrator.run(20)
+        self.system, self.integrator = system, integrator
+        self.ids = [2 * pid + 1 for pid in range(num_particles)]
+
+    def test_gather(self):
+        configurations = espressopp.analysis.Configurations(self.system, vel=True, radius=True)
+        configurations.gather()
+        conf = configurations[0]
+
+        self.assertEqual(conf.size, num_particles)
+        self.assertEqual(len(conf), num_particles)
+        self.assertEqual(list(conf), self.ids)
+        for pid in self.ids:
+            p = self.system.storage.getParticle(pid)
+            pos = self.system.bc.getUnfoldedPosition(p.pos, p.imageBox)
+            for d in range(3):
+                self.assertAlmostEqual(conf[pid][d], pos[d], places=12)
+        self.assertRaises(IndexError, lambda: conf[2])
+        self.assertRaises(IndexError, lambda: conf[2 * num_particles + 1])
+
+    def test_gather_to_file(self):
+        tmpdir = tempfile.mkdtemp()
+        try:
+            filename = os.path.join(tmpdir, 'conf.bin')
+            configurations = espressopp.analysis.Configurations(self.system, vel=True, radius=True, folded=True)
+            configurations.gatherToFile(filename)
+            data = espressopp.analysis.read_configuration_file(filename)
+        finally:
+            shutil.rmtree(tmpdir)
+
+        self.assertTrue(data['folded'])
+        self.assertEqual(list(data['id']), self.ids)
+        for i, pid in enumerate(self.ids):
+            p = self.system.storage.getParticle(pid)
+            for d in range(3):
+                self.assertAlmostEqual(data['pos'][i][d], p.pos[d], places=12)
+                self.assertAlmostEqual(data['v'][i][d], p.v[d], places=12)
+            self.assertAlmostEqual(data['radius'][i], p.radius, places=12)
+        self.assertFalse('f' in data)
+
+if __name__ == '__main__':
+    unittest.main()
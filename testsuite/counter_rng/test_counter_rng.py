@@ -0,0 +1,32 @@
+import espressopp
+import unittest
+
+# known answers of Philox4x32-10 (Random123 kat_vectors), the first three
+# words; the counter is (id, id, step, stream << 16 ^ step >> 32) and the
+# key the seed, so id, step and seed -1 set all bits
+kat = [
+    (0, 0, 0, (0x6627e8d5, 0xe169c58d, 0xbc57ac4c)),
+    (-1, -1, -1, (0x408f276d, 0x41c83b0e, 0xa20bc7c6)),
+]
+
+class TestCounterRNG(unittest.TestCase):
+    def test_known_answers(self):
+        for seed, step, pid, words in kat:
+            crng = espressopp.esutil.CounterRNG(seed)
+            u = crng.uniform3(step, pid, 0)
+            for d in range(3):
+                self.assertAlmostEqual(u[d], (words[d] + 0.5) / 2.**32, places=14)
+
+    def test_pure_function(self):
+        crng = espressopp.esutil.CounterRNG(4711)
+        a = crng.uniform3(10, 5, 0)
+        # no state: the same arguments give the same numbers
+        self.assertEqual(list(a), list(crng.uniform3(10, 5, 0)))
+        self.assertNotEqual(list(a), list(crng.uniform3(11, 5, 0)))
+        self.assertNotEqual(list(a), list(crng.uniform3(10, 6, 0)))
+        self.assertNotEqual(list(a), list(crng.uniform3(10, 5, 1)))
+        crng.seed(4712)
+        self.assertNotEqual(list(a), list(crng.uniform3(10, 5, 0)))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,67 @@
+import espressopp
+import os
+import shutil
+import tempfile
+import unittest
+
+L             = 6.
+box           = (L, L, L)
+num_particles = 100
+
+class TestDumpAsync(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.005, temperature=1.)
+        system.rng.seed(4711)
+        particles = [[pid, system.bc.getRandomPos(), pid % 2] for pid in range(1, num_particles + 1)]
+        system.storage.addParticles(particles, 'id', 'pos', 'type')
+        system.storage.decompose()
+        self.system, self.integrator = system, integrator
+        self.tmpdir = tempfile.mkdtemp()
+        self.filename = os.path.join(self.tmpdir, 'traj.bin')
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def check_frame(self, frame, places):
+        self.assertEqual(frame['step'], self.integrator.step)
+        self.assertEqual(list(frame['id']), range(1, num_particles + 1))
+        for i in range(num_particles):
+            p = self.system.storage.getParticle(i + 1)
+            self.assertEqual(frame['type'][i], p.type)
+            for d in range(3):
+                self.assertAlmostEqual(frame['pos'][i][d], p.pos[d], places=places)
+                self.assertAlmostEqual(frame['v'][i][d], p.v[d], places=places)
+
+    def test_frames(self):
+        dump = espressopp.io.DumpAsync(self.system, self.integrator, filename=self.filename,
+                                       store_velocities=True, single_precision=False)
+        self.integrator.addExtension(espressopp.integrator.ExtAnalyze(dump, interval=10))
+        self.integrator.run(50)
+        dump.dump()
+        dump.close()
+
+        frames = list(espressopp.io.read_dump_async(self.filename))
+        self.assertEqual([f['step'] for f in frames][-1], 50)
+        self.assertTrue(len(frames) >= 5)
+        self.check_frame(frames[-1], 12)
+
+        # after close the next frames are appended
+        self.integrator.run(5)
+        dump.dump()
+        dump.flush()
+        frames = list(espressopp.io.read_dump_async(self.filename))
+        self.check_frame(frames[-1], 12)
+        dump.close()
+
+    def test_single_precision(self):
+        dump = espressopp.io.DumpAsync(self.system, self.integrator, filename=self.filename,
+                                       store_velocities=True)
+        self.integrator.run(20)
+        dump.dump()
+        dump.flush()
+        frame = list(espressopp.io.read_dump_async(self.filename))[-1]
+        self.check_frame(frame, 4)
+        dump.close()
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,97 @@
+import espressopp
+import os
+import shutil
+import tempfile
+import unittest
+
+L            = 10.
+box          = (L, L, L)
+num_chains   = 10
+chain_length = 20
+precision    = 1000.
+
+class TestDumpCompressed(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.005, temperature=1.)
+        system.rng.seed(4711)
+        # random walks, partly outside of the box
+        particles = []
+        for c in range(num_chains):
+            x = system.bc.getRandomPos()
+            for i in range(chain_length):
+                particles.append([c * chain_length + i + 1, x])
+                x = x + 0.9 * system.rng.uniformOnSphere()
+        system.storage.addParticles(particles, 'id', 'pos')
+        system.storage.decompose()
+        self.system, self.integrator = system, integrator
+        self.num_particles = num_chains * chain_length
+        self.tmpdir = tempfile.mkdtemp()
+        self.filename = os.path.join(self.tmpdir, 'traj.espc')
+
+    def tearDown(self):
+        shutil.rmtree(self.tmpdir)
+
+    def check_frame(self, frame, unfolded, length_factor):
+        self.assertEqual(frame['step'], self.integrator.step)
+        self.assertEqual(list(frame['id']), range(1, self.num_particles + 1))
+        for i in range(self.num_particles):
+            p = self.system.storage.getParticle(i + 1)
+            pos = self.system.bc.getUnfoldedPosition(p.pos, p.imageBox) if unfolded else p.pos
+            for d in range(3):
+                self.assertTrue(abs(frame['pos'][i][d] - pos[d] * length_factor) <= 0.5 / precision + 1e-12)
+
+    def test_folded(self):
+        dump = espressopp.io.DumpCompressed(self.system, self.integrator, filename=self.filename)
+        self.integrator.addExtension(espressopp.integrator.ExtAnalyze(dump, interval=10))
+        self.integrator.run(30)
+        dump.dump()
+        dump.close()
+
+        frames = list(espressopp.io.read_dump_compressed(self.filename))
+        self.assertTrue(len(frames) >= 4)
+        self.check_frame(frames[-1], False, 1.0)
+        for d in range(3):
+            self.assertAlmostEqual(frames[-1]['box'][d], L)
+
+        # positions rounded to 1/1000 need less than a float
+        self.assertTrue(os.path.getsize(self.filename) < len(frames) * self.num_particles * 3 * 4)
+
+    def test_unfolded_append(self):
+        dump = espressopp.io.DumpCompressed(self.system, self.integrator, filename=self.filename,
+                                            unfolded=True, length_factor=0.34)
+        dump.dump()
+        dump.close()
+        self.integrator.run(10)
+        dump.dump()
+        dump.close()
+        frames = list(espressopp.io.read_dump_compressed(self.filename))
+        self.assertEqual(len(frames), 2)
+        self.assertTrue(frames[-1]['unfolded'])
+        self.check_frame(frames[-1], True, 0.34)
+
+    def test_ratio(self):
+        # a melt of 50 chains of 100 beads, 2.5 times smaller than floats;
+        # packing every block with the width of its largest jump would
+        # only give a ratio of 2
+        melt_L = 18.
+        system, integrator = espressopp.standard_system.Default((melt_L, melt_L, melt_L), rc=1.5,
+                                                                skin=0.3, dt=0.005, temperature=1.)
+        system.rng.seed(4711)
+        particles = []
+        for c in range(50):
+            x = system.bc.getRandomPos()
+            for i in range(100):
+                particles.append([c * 100 + i + 1, x])
+                x = x + 0.9 * system.rng.uniformOnSphere()
+        system.storage.addParticles(particles, 'id', 'pos')
+        system.storage.decompose()
+
+        dump = espressopp.io.DumpCompressed(system, integrator, filename=self.filename)
+        dump.dump()
+        dump.close()
+        frame = list(espressopp.io.read_dump_compressed(self.filename))[0]
+        self.assertEqual(len(frame['id']), 5000)
+        self.assertTrue(os.path.getsize(self.filename) < 5000 * 3 * 4 / 2.4)
+
+if __name__ == '__main__':
+    unittest.main()
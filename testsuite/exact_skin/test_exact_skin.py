@@ -0,0 +1,49 @@
+import espressopp
+import lattice_fixture as fixture
+import unittest
+
+skin = fixture.skin
+
+class TestExactSkin(unittest.TestCase):
+    def run_system(self, exactSkin):
+        system, integrator = fixture.default_system(dt=0.005, temperature=2.)
+        integrator.exactSkin = exactSkin
+        fixture.add_particles(system, velocity=1.4)
+        vl, interLJ = fixture.verlet_lj(system)
+
+        builds = vl.builds
+        for block in range(10):
+            integrator.run(20)
+            # a list that missed a rebuild lacks pairs that a fresh list has
+            vl_fresh, interLJ_fresh = fixture.verlet_lj(system, add=False)
+            self.assertAlmostEqual(interLJ.computeEnergy() / interLJ_fresh.computeEnergy(), 1.0, places=10)
+            vl_fresh.disconnect()
+        return vl.builds - builds
+
+    def test_rebuilds(self):
+        builds_bound = self.run_system(False)
+        builds_exact = self.run_system(True)
+        print 'rebuilds: summed bound', builds_bound, 'exact', builds_exact
+        # the particles move several skins, so the exact criterion still rebuilds
+        self.assertTrue(builds_exact > 1)
+        self.assertTrue(builds_exact <= builds_bound)
+
+    def test_kick(self):
+        # particles at rest on the lattice, so nothing moves until the kick
+        system, integrator = fixture.default_system(dt=0.005)
+        integrator.exactSkin = True
+        fixture.add_particles(system, jitter=0.)
+        vl = espressopp.VerletList(system, cutoff=fixture.rc)
+
+        integrator.run(20)
+        builds = vl.builds
+        integrator.run(20)
+        self.assertEqual(vl.builds, builds)
+
+        # one particle moves by skin in one step
+        system.storage.modifyParticle(1, 'v', espressopp.Real3D(skin / 0.005, 0, 0))
+        integrator.run(1)
+        self.assertEqual(vl.builds, builds + 1)
+
+if __name__ == '__main__':
+    unittest.main()
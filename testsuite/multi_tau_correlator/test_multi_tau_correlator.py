@@ -0,0 +1,48 @@
+import espressopp
+import random
+import unittest
+
+L             = 8.
+box           = (L, L, L)
+num_particles = 100
+dt            = 0.01
+
+class TestMultiTauCorrelator(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=dt, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            particle_list.append([pid, 0, pos])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+        system.storage.decompose()
+
+        self.system = system
+        self.integrator = integrator
+
+    def test_velocity(self):
+        p = 8
+        corr = espressopp.analysis.MultiTauCorrelator(self.system, quantity='velocity', p=p, m=2, levels=6, dt=dt, exact=True)
+        self.integrator.addExtension(espressopp.integrator.ExtAnalyze(corr, interval=1))
+        self.integrator.run(500)
+
+        self.assertEqual(corr.n_samples, 500)
+        multi = corr.compute()
+        exact = corr.computeExact()
+        self.assertEqual(len(exact), 500)
+        self.assertTrue(len(multi) > p)
+
+        # the first level is not block averaged and has to agree with the exact correlation
+        for j in range(p):
+            self.assertAlmostEqual(multi[j][0], exact[j][0], places=10)
+            self.assertAlmostEqual(multi[j][1], exact[j][1], places=8)
+
+        # lags are increasing, C(0) is <v_x^2> = kT/m
+        for j in range(1, len(multi)):
+            self.assertTrue(multi[j][0] > multi[j-1][0])
+        self.assertAlmostEqual(multi[0][1], 1.0, delta=0.2)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,59 @@
+import espressopp
+import mpi4py.MPI as MPI
+import random
+import unittest
+
+# a box of different lengths along the axes
+box            = (6., 9., 12.)
+rc             = 2.5
+skin           = 0.3
+num_particles  = 200
+
+class TestNodeGrid(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=rc, skin=skin, dt=0.005)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, box[0]), random.uniform(0, box[1]), random.uniform(0, box[2]))
+            particle_list.append([pid, 0, pos])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+        system.storage.decompose()
+
+        vl = espressopp.VerletList(system, cutoff=rc)
+        interLJ = espressopp.interaction.VerletListLennardJones(vl)
+        interLJ.setPotential(type1=0, type2=0,
+                             potential=espressopp.interaction.LennardJones(epsilon=1., sigma=0.5, cutoff=rc))
+        system.addInteraction(interLJ)
+        self.system = system
+        self.nodeGrid = espressopp.tools.decomp.nodeGrid(MPI.COMM_WORLD.size)
+
+    def checkGrid(self):
+        # the cell grid follows the local box size of every axis
+        for axis in range(3):
+            b = self.system.storage.getNodeBoundaries(axis)
+            self.assertEqual(len(b), self.nodeGrid[axis] + 1)
+            self.assertAlmostEqual(b[0], 0.)
+            self.assertAlmostEqual(b[-1], box[axis])
+            for k in range(1, len(b)):
+                self.assertTrue(b[k] > b[k-1])
+        cellGrid = self.system.storage.getCellGrid()
+        for axis in range(3):
+            if self.nodeGrid[axis] == 1:
+                self.assertEqual(cellGrid[axis], int(box[axis] / (rc + skin)))
+
+    def test_boundaries(self):
+        for axis in range(3):
+            b = self.system.storage.getNodeBoundaries(axis)
+            for k in range(len(b)):
+                self.assertAlmostEqual(b[k], k * box[axis] / self.nodeGrid[axis])
+        self.system.storage.cellAdjust()
+        self.checkGrid()
+        self.system.storage.loadBalance()
+        self.checkGrid()
+        ids = sum([list(node_ids) for node_ids in self.system.storage.getRealParticleIDs()], [])
+        self.assertEqual(sorted(ids), range(1, num_particles+1))
+
+if __name__ == '__main__':
+    unittest.main()
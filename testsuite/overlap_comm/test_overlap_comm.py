@@ -0,0 +1,36 @@
+import espressopp
+import lattice_fixture as fixture
+import mpi4py.MPI as MPI
+import unittest
+
+class TestOverlapComm(unittest.TestCase):
+    def run_system(self, overlapComm, compact, numThreads):
+        system         = espressopp.System()
+        system.rng     = espressopp.esutil.RNG()
+        system.bc      = espressopp.bc.OrthorhombicBC(system.rng, fixture.box)
+        system.skin    = fixture.skin
+        system.numThreads = numThreads
+        nodeGrid       = espressopp.tools.decomp.nodeGrid(MPI.COMM_WORLD.size)
+        cellGrid       = espressopp.tools.decomp.cellGrid(fixture.box, nodeGrid, fixture.rc, fixture.skin)
+        system.storage = espressopp.storage.DomainDecompositionNonBlocking(system, nodeGrid, cellGrid)
+
+        fixture.add_particles(system)
+        vl, interLJ = fixture.verlet_lj(system, compact, shift=0.)
+
+        integrator     = espressopp.integrator.VelocityVerlet(system)
+        integrator.dt  = 0.001
+        integrator.overlapComm = overlapComm
+        integrator.run(10)
+        return fixture.forces(system)
+
+    def test_overlap(self):
+        # the single particle type runs the batched kernel, numThreads=2
+        # the threaded one (where OpenMP is available)
+        for compact in [False, True]:
+            for numThreads in [1, 2]:
+                forces_ref = self.run_system(False, compact, numThreads)
+                forces = self.run_system(True, compact, numThreads)
+                fixture.assertForcesEqual(self, forces, forces_ref, 1e-8)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,58 @@
+import espressopp
+import random
+import unittest
+
+# initial parameters of the simulation
+L              = 10.
+box            = (L, L, L)
+rc             = 3.
+num_particles  = 100
+alpha          = 1.
+prefactor      = 1.
+
+class makeConf(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=rc, skin=0.3, dt=0.005, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            q = 1. if pid % 2 else -1.
+            particle_list.append([pid, 0, pos, q])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos', 'q')
+        system.storage.decompose()
+
+        self.system = system
+        self.integrator = integrator
+
+    def forces(self, interaction):
+        self.system.addInteraction(interaction, 'kspace')
+        self.integrator.run(0)
+        self.system.removeInteractionByName('kspace')
+        return [self.system.storage.getParticle(pid).f for pid in range(1, num_particles+1)]
+
+class TestP3MvsEwald(makeConf):
+    def test_kspace(self):
+        # the mesh is split over the ranks only if there are several of them
+        self.assertTrue(espressopp.MPI.COMM_WORLD.size >= 2)
+
+        ewald_pot = espressopp.interaction.CoulombKSpaceEwald(self.system, prefactor, alpha, 20)
+        ewald_int = espressopp.interaction.CellListCoulombKSpaceEwald(self.system.storage, ewald_pot)
+        p3m_pot = espressopp.interaction.CoulombKSpaceP3M(self.system, prefactor, alpha,
+                                                          espressopp.Int3D(32, 32, 32), 5, rc)
+        p3m_int = espressopp.interaction.CellListCoulombKSpaceP3M(self.system.storage, p3m_pot)
+
+        energy_ewald = ewald_int.computeEnergy()
+        energy_p3m = p3m_int.computeEnergy()
+        print 'k space energy: Ewald', energy_ewald, 'P3M', energy_p3m
+        self.assertAlmostEqual(energy_p3m / energy_ewald, 1.0, places=3)
+
+        f_ewald = self.forces(ewald_int)
+        f_p3m = self.forces(p3m_int)
+        fmax = max(f.abs() for f in f_ewald)
+        for fe, fp in zip(f_ewald, f_p3m):
+            self.assertTrue((fe - fp).abs() < 5e-3 * fmax)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,66 @@
+import espressopp
+import math
+import random
+import unittest
+
+L             = 8.
+box           = (L, L, L)
+num_particles = 200
+rmax          = 1.8
+bins          = 18
+
+class TestRDFCellList(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.01, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            particle_list.append([pid, pid % 2, pos])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+        system.storage.decompose()
+
+        self.system = system
+        self.integrator = integrator
+
+    def bruteForce(self, hist, type1, type2):
+        # all pairs with the minimum image convention
+        particles = [self.system.storage.getParticle(pid) for pid in range(1, num_particles+1)]
+        pos = [(p.pos[0], p.pos[1], p.pos[2]) for p in particles]
+        types = [p.type for p in particles]
+        for i in range(num_particles):
+            for j in range(num_particles):
+                if i == j or types[i] != type1 or types[j] != type2:
+                    continue
+                d = [pos[i][k] - pos[j][k] for k in range(3)]
+                d = [x - L * round(x / L) for x in d]
+                r = math.sqrt(sum(x * x for x in d))
+                if r < rmax:
+                    hist[int(r * bins / rmax)] += 1
+
+    def test_rdf(self):
+        rdf = espressopp.analysis.RDFCellList(self.system, rmax=rmax, bins=bins)
+
+        hist = [0.0] * bins
+        for i in range(3):
+            self.integrator.run(50)
+            rdf.sample()
+            self.bruteForce(hist, 0, 1)
+        self.assertEqual(rdf.n_samples, 3)
+
+        n0 = 3 * num_particles / 2
+        rho1 = 0.5 * num_particles / L**3
+        dr = rmax / bins
+        g = rdf.compute(0, 1)
+        self.assertEqual(len(g), bins)
+        for i in range(bins):
+            shell = 4. / 3. * math.pi * ((i + 1)**3 - i**3) * dr**3
+            self.assertAlmostEqual(g[i][0], (i + 0.5) * dr, places=10)
+            self.assertAlmostEqual(g[i][1], hist[i] / (n0 * rho1 * shell), places=8)
+
+    def test_rmax_too_large(self):
+        self.assertRaises(Exception, espressopp.analysis.RDFCellList, self.system, rmax=L/2, bins=bins)
+
+if __name__ == '__main__':
+    unittest.main()
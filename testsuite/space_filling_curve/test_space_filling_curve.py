@@ -0,0 +1,32 @@
+import espressopp
+import lattice_fixture as fixture
+import unittest
+
+class TestSpaceFillingCurve(unittest.TestCase):
+    def run_system(self, curve, compact):
+        system, integrator = fixture.default_system()
+        fixture.add_particles(system)
+        vl, interLJ = fixture.verlet_lj(system, compact)
+
+        integrator.run(10)
+        # change the curve in the middle of the run, the lists built over
+        # the old cell order must be rebuilt
+        builds = vl.builds
+        system.storage.spaceFillingCurve = curve
+        if curve != 'none':
+            self.assertTrue(vl.builds > builds)
+        energy_switch = interLJ.computeEnergy()
+        integrator.run(10)
+        return energy_switch, interLJ.computeEnergy(), fixture.forces(system)
+
+    def test_curves(self):
+        for compact in [False, True]:
+            energy_switch_ref, energy_ref, forces_ref = self.run_system('none', compact)
+            for curve in ['morton', 'hilbert']:
+                energy_switch, energy, forces = self.run_system(curve, compact)
+                self.assertAlmostEqual(energy_switch / energy_switch_ref, 1.0, places=10)
+                self.assertAlmostEqual(energy / energy_ref, 1.0, places=8)
+                fixture.assertForcesEqual(self, forces, forces_ref, 1e-6)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,82 @@
+import espressopp
+import random
+import unittest
+
+# initial parameters of the simulation
+L              = 10.
+box            = (L, L, L)
+rc             = 3.
+num_particles  = 100
+alpha          = 1.
+prefactor      = 1.
+
+class makeConf(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=rc, skin=0.3, dt=0.005, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            q = 1. if pid % 2 else -1.
+            particle_list.append([pid, 0, pos, q])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos', 'q')
+        system.storage.decompose()
+
+        self.system = system
+        self.integrator = integrator
+
+    def forces(self, interaction):
+        self.system.addInteraction(interaction, 'kspace')
+        self.integrator.run(0)
+        self.system.removeInteractionByName('kspace')
+        return [self.system.storage.getParticle(pid).f for pid in range(1, num_particles+1)]
+
+    def pressureTensor(self, interaction):
+        self.system.addInteraction(interaction, 'kspace')
+        pt = espressopp.analysis.PressureTensor(self.system).compute()
+        self.system.removeInteractionByName('kspace')
+        return pt
+
+class TestSPMEvsEwald(makeConf):
+    def test_kspace(self):
+        ewald_pot = espressopp.interaction.CoulombKSpaceEwald(self.system, prefactor, alpha, 20)
+        ewald_int = espressopp.interaction.CellListCoulombKSpaceEwald(self.system.storage, ewald_pot)
+        spme_pot = espressopp.interaction.CoulombKSpaceSPME(self.system, prefactor, alpha, (32, 32, 32), 6)
+        spme_int = espressopp.interaction.CellListCoulombKSpaceSPME(self.system.storage, spme_pot)
+
+        energy_ewald = ewald_int.computeEnergy()
+        energy_spme = spme_int.computeEnergy()
+        print 'k space energy: Ewald', energy_ewald, 'SPME', energy_spme
+        self.assertAlmostEqual(energy_spme / energy_ewald, 1.0, places=4)
+
+        f_ewald = self.forces(ewald_int)
+        f_spme = self.forces(spme_int)
+        fmax = max(f.abs() for f in f_ewald)
+        for fe, fs in zip(f_ewald, f_spme):
+            self.assertTrue((fe - fs).abs() < 1e-3 * fmax)
+
+        virial_ewald = ewald_int.computeVirial()
+        virial_spme = spme_int.computeVirial()
+        print 'k space virial: Ewald', virial_ewald, 'SPME', virial_spme
+        self.assertAlmostEqual(virial_spme / virial_ewald, 1.0, places=3)
+
+        # the kinetic part is the same in both, the difference is the k space virial
+        pt_ewald = self.pressureTensor(ewald_int)
+        pt_spme = self.pressureTensor(spme_int)
+        ptmax = max(abs(p) for p in pt_ewald[:3])
+        for pe, ps in zip(pt_ewald, pt_spme):
+            self.assertTrue(abs(pe - ps) < 1e-3 * ptmax)
+
+    def test_order(self):
+        # the linear spline is not supported
+        self.assertRaises(Exception, espressopp.interaction.CoulombKSpaceSPME,
+                          self.system, prefactor, alpha, (32, 32, 32), 2)
+        spme_pot = espressopp.interaction.CoulombKSpaceSPME(self.system, prefactor, alpha, (32, 32, 32), 3)
+        def setP(P):
+            spme_pot.P = P
+        self.assertRaises(ValueError, setP, 2)
+        self.assertEqual(spme_pot.P, 3)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,69 @@
+import espressopp
+import cmath
+import math
+import random
+import unittest
+
+L             = 8.
+box           = (L, L, L)
+num_particles = 100
+qmax          = 2.5
+bins          = 5
+
+class TestStaticStructFMesh(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=1.5, skin=0.3, dt=0.01, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            particle_list.append([pid, pid % 2, pos])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+        system.storage.decompose()
+
+        self.system = system
+
+    def direct(self, type1, type2):
+        # S(q) from the sums over the particles, binned like StaticStructFMesh
+        particles = [self.system.storage.getParticle(pid) for pid in range(1, num_particles+1)]
+        nmax = int(qmax * L / (2 * math.pi)) + 1
+        nk = [0] * bins
+        sumq = [0.0] * bins
+        sums = [0.0] * bins
+        for mx in range(-nmax, nmax+1):
+            for my in range(-nmax, nmax+1):
+                for mz in range(-nmax, nmax+1):
+                    q = 2 * math.pi / L * math.sqrt(mx*mx + my*my + mz*mz)
+                    if q == 0 or q >= qmax:
+                        continue
+                    rho = [0j, 0j]
+                    for p in particles:
+                        e = cmath.exp(-2j * math.pi / L * (mx*p.pos[0] + my*p.pos[1] + mz*p.pos[2]))
+                        rho[p.type] += e
+                    r1 = rho[0] + rho[1] if type1 < 0 else rho[type1]
+                    r2 = rho[0] + rho[1] if type2 < 0 else rho[type2]
+                    b = int(q * bins / qmax)
+                    nk[b] += 1
+                    sumq[b] += q
+                    sums[b] += (r1 * r2.conjugate()).real
+        n1 = num_particles if type1 < 0 else num_particles / 2
+        n2 = num_particles if type2 < 0 else num_particles / 2
+        return [(sumq[b] / nk[b], sums[b] / nk[b] / math.sqrt(n1 * n2)) for b in range(bins) if nk[b] > 0]
+
+    def test_vs_direct(self):
+        sq = espressopp.analysis.StaticStructFMesh(self.system, mesh=(32, 32, 32), P=5, bins=bins, qmax=qmax, types=[0, 1])
+        sq.sample()
+        sq.sample()
+        self.assertEqual(sq.n_samples, 2)
+
+        for type1, type2 in [(-1, -1), (0, 0), (0, 1)]:
+            mesh = sq.compute(type1, type2)
+            direct = self.direct(type1, type2)
+            self.assertEqual(len(mesh), len(direct))
+            for (q1, s1), (q2, s2) in zip(mesh, direct):
+                self.assertAlmostEqual(q1, q2, places=10)
+                self.assertAlmostEqual(s1, s2, delta=1e-3 * max(1.0, abs(s2)))
+
+if __name__ == '__main__':
+    unittest.main()
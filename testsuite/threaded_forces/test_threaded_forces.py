@@ -0,0 +1,39 @@
+import espressopp
+import lattice_fixture as fixture
+import os
+import unittest
+
+class TestThreadedForces(unittest.TestCase):
+    def run_system(self, numThreads, compact):
+        system, integrator = fixture.default_system()
+        system.numThreads = numThreads
+        self.assertEqual(system.numThreads, numThreads)
+
+        # type 1 has no potential set, as in the serial loops it gets the default one
+        fixture.add_particles(system, type_of=lambda pid: int(pid % 5 == 0))
+        vl, interLJ = fixture.verlet_lj(system, compact, shift=0.)
+
+        bonds = espressopp.FixedPairList(system.storage)
+        bonds.addBonds([(pid, pid+1) for pid in range(1, fixture.num_particles, 2)])
+        interFENE = espressopp.interaction.FixedPairListFENE(system, bonds,
+                                                             potential=espressopp.interaction.FENE(K=30., r0=0., rMax=fixture.L))
+        system.addInteraction(interFENE)
+
+        integrator.run(10)
+        energy = interLJ.computeEnergy() + interFENE.computeEnergy()
+        return energy, fixture.forces(system)
+
+    def test_default(self):
+        system, integrator = fixture.default_system()
+        self.assertEqual(system.numThreads, 1)
+
+    @unittest.skipUnless(os.environ.get('ESPP_WITH_OPENMP'), 'built without OpenMP')
+    def test_threads(self):
+        for compact in [False, True]:
+            energy_ref, forces_ref = self.run_system(1, compact)
+            energy, forces = self.run_system(4, compact)
+            self.assertAlmostEqual(energy / energy_ref, 1.0, places=8)
+            fixture.assertForcesEqual(self, forces, forces_ref, 1e-6)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,63 @@
+import espressopp
+import random
+import unittest
+
+# initial parameters of the simulation
+L              = 8.
+box            = (L, L, L)
+rc             = 2.5
+num_particles  = 400
+
+class makeConf(unittest.TestCase):
+    def setUp(self):
+        system, integrator = espressopp.standard_system.Default(box, rc=rc, skin=0.3, dt=0.005, temperature=1.)
+
+        random.seed(4711)
+        particle_list = []
+        for pid in range(1, num_particles+1):
+            pos = espressopp.Real3D(random.uniform(0, L), random.uniform(0, L), random.uniform(0, L))
+            particle_list.append([pid, 0, pos])
+        system.storage.addParticles(particle_list, 'id', 'type', 'pos')
+        system.storage.decompose()
+
+        self.system = system
+        self.exclusions = [(pid, pid+1) for pid in range(1, num_particles, 2)]
+
+    def buildList(self, compact, subCellBuild):
+        vl = espressopp.VerletList(self.system, cutoff=rc, exclusionlist=self.exclusions)
+        vl.compact = compact
+        vl.subCellBuild = subCellBuild
+        interLJ = espressopp.interaction.VerletListLennardJones(vl)
+        interLJ.setPotential(type1=0, type2=0,
+                             potential=espressopp.interaction.LennardJones(epsilon=1., sigma=0.5, cutoff=rc, shift=0.))
+        return vl, interLJ
+
+def sortedPairs(vl):
+    # pairs of all nodes, every pair as (smaller id, larger id)
+    pairs = []
+    for node_pairs in vl.getAllPairs():
+        pairs.extend(tuple(sorted(pair)) for pair in node_pairs)
+    return sorted(pairs)
+
+class TestVerletListLayouts(makeConf):
+    def test_layouts(self):
+        vl_ref, inter_ref = self.buildList(False, False)
+        size_ref = vl_ref.totalSize()
+        pairs_ref = sortedPairs(vl_ref)
+        energy_ref = inter_ref.computeEnergy()
+        virial_ref = inter_ref.computeVirial()
+        self.assertTrue(size_ref > 0)
+        self.assertEqual(len(pairs_ref), len(set(pairs_ref)))
+
+        for compact, subCellBuild in [(True, False), (False, True), (True, True)]:
+            vl, inter = self.buildList(compact, subCellBuild)
+            print 'compact =', compact, 'subCellBuild =', subCellBuild, 'pairs =', vl.totalSize()
+            self.assertEqual(vl.totalSize(), size_ref)
+            # the same pairs, none listed twice across node or periodic boundaries
+            self.assertEqual(sortedPairs(vl), pairs_ref)
+            self.assertAlmostEqual(inter.computeEnergy() / energy_ref, 1.0, places=10)
+            # the virial loops walk the compact rows with VerletList::PairIterator
+            self.assertAlmostEqual(inter.computeVirial() / virial_ref, 1.0, places=10)
+
+if __name__ == '__main__':
+    unittest.main()